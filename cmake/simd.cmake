@@ -34,6 +34,23 @@ if (CMAKE_COMPILER_IS_GNUCC OR CMAKE_COMPILER_IS_CLANG )
     CC_HAS_AVX_INTRINSICS)
 endif()
 
+#
+# Check compiler for AVX2 intrinsics
+#
+if (CMAKE_COMPILER_IS_GNUCC OR CMAKE_COMPILER_IS_CLANG )
+    set(CMAKE_REQUIRED_FLAGS "-mavx2")
+    check_c_source_runs("
+    #include <immintrin.h>
+
+    int main()
+    {
+    __m256i a = _mm256_set1_epi32(1);
+    a = _mm256_sllv_epi32(a, a);
+    return 0;
+    }"
+    CC_HAS_AVX2_INTRINSICS)
+endif()
+
 if ((CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64") AND CC_HAS_SSE2_INTRINSICS)
     # any amd64 supports sse2 instructions
     set(ENABLE_SSE2_DEFAULT ON)
@@ -43,6 +60,7 @@ endif()
 
 option(ENABLE_SSE2 "Enable compile-time SSE2 support." ${ENABLE_SSE2_DEFAULT})
 option(ENABLE_AVX  "Enable compile-time AVX support." OFF)
+option(ENABLE_AVX2 "Enable compile-time AVX2 support." OFF)
 
 if (ENABLE_SSE2)
     if (!CC_HAS_SSE2_INTRINSICS)
@@ -63,3 +81,13 @@ if (ENABLE_AVX)
             "${CC_HAS_AVX_INTRINSICS}")
     endif()
 endif()
+
+if (ENABLE_AVX2)
+    if (!CC_HAS_AVX2_INTRINSICS)
+        message(SEND_ERROR "AVX2 is enabled, but is not supported by compiler.")
+    else()
+        add_compile_flags("C;CXX" "-mavx2")
+        find_package_message(AVX2 "AVX2 is enabled - target CPU must support it"
+            "${CC_HAS_AVX2_INTRINSICS}")
+    endif()
+endif()
@@ -54,6 +54,7 @@ extras="            \
     SPACE           \
     ILLEGAL         \
     GETITEM         \
+    WINDOW          \
 "
 
 IFS=" "
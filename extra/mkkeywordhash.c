@@ -59,7 +59,7 @@ static Keyword aKeywordTable[] = {
   { "AFTER",                  "TK_AFTER",       false },
   { "ALL",                    "TK_ALL",         true  },
   { "ALTER",                  "TK_ALTER",       true  },
-  { "ANALYZE",                "TK_STANDARD",    true  },
+  { "ANALYZE",                "TK_ANALYZE",     true  },
   { "AND",                    "TK_AND",         true  },
   { "ARRAY",                  "TK_ARRAY",       true  },
   { "AS",                     "TK_AS",          true  },
@@ -225,12 +225,12 @@ static Keyword aKeywordTable[] = {
   { "NUM",                    "TK_STANDARD",    true  },
   { "NUMERIC",                "TK_STANDARD",    true  },
   { "OUT",                    "TK_STANDARD",    true  },
-  { "OVER",                   "TK_STANDARD",    true  },
-  { "PARTITION",              "TK_STANDARD",    true  },
+  { "OVER",                   "TK_OVER",        true  },
+  { "PARTITION",              "TK_PARTITION",   true  },
   { "PRECISION",              "TK_STANDARD",    true  },
   { "PROCEDURE",              "TK_STANDARD",    true  },
   { "RANGE",                  "TK_STANDARD",    true  },
-  { "RANK",                   "TK_STANDARD",    true  },
+  { "RANK",                   "TK_RANK",        true  },
   { "READS",                  "TK_STANDARD",    true  },
   { "REAL",                   "TK_STANDARD",    true  },
   { "REPEAT",                 "TK_STANDARD",    true  },
@@ -238,7 +238,7 @@ static Keyword aKeywordTable[] = {
   { "RETURN",                 "TK_STANDARD",    true  },
   { "REVOKE",                 "TK_STANDARD",    true  },
   { "ROWS",                   "TK_STANDARD",    true  },
-  { "ROW_NUMBER",             "TK_STANDARD",    true  },
+  { "ROW_NUMBER",             "TK_ROW_NUMBER",  true  },
   { "SENSITIVE",              "TK_STANDARD",    true  },
   { "SIGNAL",                 "TK_STANDARD",    true  },
   { "SMALLINT",               "TK_ID",          true  },
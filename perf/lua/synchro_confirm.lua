@@ -0,0 +1,100 @@
+-- Measures the throughput of small synchronous transactions depending
+-- on the synchronous replication quorum.
+--
+-- The script starts REPLICA_COUNT replicas as child processes and for
+-- each quorum from 1 to REPLICA_COUNT + 1 commits TXN_COUNT single-row
+-- synchronous transactions from FIBER_COUNT fibers concurrently. For
+-- each quorum it prints the transaction rate and the average number of
+-- transactions confirmed by one CONFIRM entry.
+--
+-- It is recommended to run benchmark using taskset for stable results.
+-- taskset -c 1-4 tarantool synchro_confirm.lua
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local popen = require('popen')
+local t = require('tarantool')
+
+local _, _, build_type = string.match(t.build.target, "^(.+)-(.+)-(.+)$")
+if build_type == "Debug" then
+    print("WARNING: tarantool has built with enabled debug mode")
+end
+
+local REPLICA_COUNT = 2
+local TXN_COUNT = 200000
+local FIBER_COUNT = 1000
+
+local work_dir = fio.tempdir()
+local master_uri = fio.pathjoin(work_dir, 'master.sock')
+box.cfg{
+    work_dir = work_dir,
+    log = 'master.log',
+    listen = master_uri,
+    replication_synchro_timeout = 1000,
+}
+box.schema.user.grant('guest', 'replication')
+box.ctl.promote()
+
+local replica_script = fio.pathjoin(work_dir, 'replica.lua')
+local f = fio.open(replica_script, {'O_CREAT', 'O_WRONLY'},
+                   tonumber('644', 8))
+f:write(string.format([[
+local id = ...
+local dir = %q .. '/replica' .. id
+require('fio').mkdir(dir)
+box.cfg{
+    work_dir = dir,
+    log = 'replica.log',
+    replication = %q,
+    read_only = true,
+}
+]], work_dir, master_uri))
+f:close()
+
+local replicas = {}
+for i = 1, REPLICA_COUNT do
+    replicas[i] = popen.new({arg[-1], replica_script, tostring(i)})
+end
+while #box.info.replication < REPLICA_COUNT + 1 do
+    fiber.sleep(0.1)
+end
+
+local s = box.schema.space.create('test', {is_sync = true})
+s:create_index('pk')
+
+local function bench(quorum)
+    box.cfg{replication_synchro_quorum = quorum}
+    s:truncate()
+    local lsn = box.info.lsn
+    local start = clock.monotonic()
+    local fibers = {}
+    for i = 1, FIBER_COUNT do
+        fibers[i] = fiber.new(function()
+            for j = i, TXN_COUNT, FIBER_COUNT do
+                s:insert({j})
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    for i = 1, FIBER_COUNT do
+        fibers[i]:join()
+    end
+    local elapsed = clock.monotonic() - start
+    -- CONFIRM entries take LSNs of the master like the transactions.
+    local confirm_count = box.info.lsn - lsn - TXN_COUNT
+    print(string.format('quorum %d: %.0f txn/sec, %.1f txn/confirm',
+                        quorum, TXN_COUNT / elapsed,
+                        TXN_COUNT / math.max(confirm_count, 1)))
+end
+
+for quorum = 1, REPLICA_COUNT + 1 do
+    bench(quorum)
+end
+
+for _, ph in ipairs(replicas) do
+    ph:kill()
+    ph:wait()
+end
+fio.rmtree(work_dir)
+os.exit(0)
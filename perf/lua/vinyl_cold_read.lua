@@ -0,0 +1,78 @@
+-- Measures the rate of concurrent vinyl point lookups that miss
+-- the cache and have to read pages from disk.
+--
+-- The script fills a space, then performs random lookups from
+-- FIBER_COUNT fibers concurrently. The cache is disabled and each
+-- lookup hits a random page so that almost every lookup results in
+-- a disk read. The OS page cache is dropped before the lookups if
+-- the script has the permission to do it.
+--
+-- It is recommended to run benchmark using taskset for stable results.
+-- taskset -c 1 tarantool vinyl_cold_read.lua
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local t = require('tarantool')
+
+local _, _, build_type = string.match(t.build.target, "^(.+)-(.+)-(.+)$")
+if build_type == "Debug" then
+    print("WARNING: tarantool has built with enabled debug mode")
+end
+
+local ROW_COUNT = 1000000
+local LOOKUP_COUNT = 200000
+local FIBER_COUNT = 256
+local PADDING = string.rep('x', 200)
+
+local work_dir = fio.tempdir()
+box.cfg{
+    work_dir = work_dir,
+    log = 'tarantool.log',
+    vinyl_cache = 0,
+    vinyl_read_threads = 1,
+}
+
+local s = box.schema.space.create('test', {engine = 'vinyl'})
+s:create_index('pk', {page_size = 4096})
+box.begin()
+for i = 1, ROW_COUNT do
+    s:replace({i, PADDING})
+    if i % 1000 == 0 then
+        box.commit()
+        box.begin()
+    end
+end
+box.commit()
+box.snapshot()
+
+local f = io.open('/proc/sys/vm/drop_caches', 'w')
+if f ~= nil then
+    f:write('3')
+    f:close()
+else
+    print("WARNING: failed to drop the OS page cache")
+end
+
+local done = fiber.channel(FIBER_COUNT)
+local start = clock.monotonic()
+for _ = 1, FIBER_COUNT do
+    fiber.create(function()
+        for _ = 1, LOOKUP_COUNT / FIBER_COUNT do
+            s:get(math.random(ROW_COUNT))
+        end
+        done:put(true)
+    end)
+end
+for _ = 1, FIBER_COUNT do
+    done:get()
+end
+local time = clock.monotonic() - start
+
+local stat = s.index.pk:stat()
+print(("lookup %8.0f req/sec  pages read %d"):format(
+    LOOKUP_COUNT / time, stat.disk.iterator.read.pages))
+
+s:drop()
+fio.rmtree(work_dir)
+os.exit(0)
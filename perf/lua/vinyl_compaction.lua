@@ -0,0 +1,101 @@
+-- Compares vinyl compaction strategies on a time series workload.
+--
+-- The workload inserts rows with monotonically growing keys (like
+-- timestamps), occasionally overwrites recent rows, and performs
+-- random point lookups over the recent data. Memory dumps are
+-- forced every DUMP_EVERY rows so that each strategy gets the same
+-- sequence of runs to compact.
+--
+-- For each strategy the script prints the write amplification
+-- (bytes written by dump and compaction divided by bytes dumped),
+-- the number of runs left on disk, which bounds read
+-- amplification, and the lookup rate.
+--
+-- It is recommended to run benchmark using taskset for stable results.
+-- taskset -c 1 tarantool vinyl_compaction.lua
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local t = require('tarantool')
+
+local _, _, build_type = string.match(t.build.target, "^(.+)-(.+)-(.+)$")
+if build_type == "Debug" then
+    print("WARNING: tarantool has built with enabled debug mode")
+end
+
+local ROW_COUNT = 200000
+local DUMP_EVERY = 10000
+local OVERWRITE_RATIO = 0.1
+local LOOKUP_COUNT = 100000
+local PADDING = string.rep('x', 100)
+
+local STRATEGIES = {
+    {compaction_strategy = 'tiered'},
+    {compaction_strategy = 'leveled'},
+    {compaction_strategy = 'time_window', compaction_time_window = 2},
+}
+
+local work_dir = fio.tempdir()
+box.cfg{
+    work_dir = work_dir,
+    log = 'tarantool.log',
+    vinyl_memory = 128 * 1024 * 1024,
+    vinyl_cache = 0,
+}
+
+local function wait_compaction()
+    while box.stat.vinyl().scheduler.tasks_inprogress > 0 or
+          box.stat.vinyl().scheduler.compaction_queue > 0 do
+        fiber.sleep(0.01)
+    end
+end
+
+local function bench(opts)
+    local s = box.schema.space.create('test', {engine = 'vinyl'})
+    local index_opts = {
+        page_size = 4096,
+        range_size = 64 * 1024 * 1024,
+        run_count_per_level = 2,
+        run_size_ratio = 3.5,
+    }
+    for k, v in pairs(opts) do
+        index_opts[k] = v
+    end
+    s:create_index('pk', index_opts)
+
+    local start = clock.monotonic()
+    for i = 1, ROW_COUNT do
+        s:replace({i, PADDING})
+        if math.random() < OVERWRITE_RATIO then
+            s:replace({math.random(math.max(1, i - DUMP_EVERY), i), PADDING})
+        end
+        if i % DUMP_EVERY == 0 then
+            box.snapshot()
+        end
+    end
+    wait_compaction()
+    local write_time = clock.monotonic() - start
+
+    start = clock.monotonic()
+    for _ = 1, LOOKUP_COUNT do
+        s:get(math.random(ROW_COUNT))
+    end
+    local read_time = clock.monotonic() - start
+
+    local stat = s.index.pk:stat()
+    local dumped = stat.disk.dump.output.bytes
+    local written = dumped + stat.disk.compaction.output.bytes
+    print(("%-12s write_amp %5.2f  runs %3d  write %8.0f rows/sec  " ..
+           "lookup %8.0f req/sec"):format(
+        opts.compaction_strategy, written / dumped, stat.run_count,
+        ROW_COUNT / write_time, LOOKUP_COUNT / read_time))
+    s:drop()
+end
+
+for _, opts in ipairs(STRATEGIES) do
+    bench(opts)
+end
+
+fio.rmtree(work_dir)
+os.exit(0)
@@ -240,12 +240,29 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			 "run_size_ratio must be greater than 1");
 		return -1;
 	}
+	if (opts->compaction_strategy == compaction_strategy_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "compaction_strategy must be one of 'tiered', "
+			 "'leveled' or 'time_window'");
+		return -1;
+	}
+	if (opts->compaction_time_window <= 0) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "compaction_time_window must be greater than 0");
+		return -1;
+	}
 	if (opts->bloom_fpr <= 0 || opts->bloom_fpr > 1) {
 		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
 			 "bloom_fpr must be greater than 0 and "
 			 "less than or equal to 1");
 		return -1;
 	}
+	if (opts->bloom_type == tuple_bloom_type_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "bloom_type must be one of 'classic', "
+			 "'split_block' or 'ribbon'");
+		return -1;
+	}
 	return 0;
 }
 
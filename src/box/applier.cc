@@ -30,6 +30,7 @@
  */
 #include "applier.h"
 
+#include <fcntl.h>
 #include <msgpuck.h>
 
 #include "authentication.h"
@@ -39,6 +40,7 @@
 #include "iostream.h"
 #include "coio.h"
 #include "coio_buf.h"
+#include "coio_file.h"
 #include "wal.h"
 #include "xrow.h"
 #include "replication.h"
@@ -58,6 +60,13 @@
 #include "txn_limbo.h"
 #include "journal.h"
 #include "raft.h"
+#include "resync.h"
+#include "engine.h"
+#include "memtx_engine.h"
+#include "space.h"
+#include "index.h"
+#include "tuple.h"
+#include "small/mempool.h"
 #include "small/static.h"
 #include "tt_static.h"
 #include "memory.h"
@@ -65,6 +74,13 @@
 
 STRS(applier_state, applier_STATE);
 
+const char *applier_latency_stage_strs[] = {
+	/* [APPLIER_LATENCY_NETWORK] = */ "network",
+	/* [APPLIER_LATENCY_DECODE] = */ "decode",
+	/* [APPLIER_LATENCY_APPLY] = */ "apply",
+	/* [APPLIER_LATENCY_WAL] = */ "wal",
+};
+
 enum {
 	/**
 	 * How often to log received row count. Used during join and register.
@@ -109,6 +125,7 @@ applier_log_error(struct applier *applier, struct error *e)
 	case APPLIER_WAIT_SNAPSHOT:
 	case APPLIER_FETCH_SNAPSHOT:
 	case APPLIER_FINAL_JOIN:
+	case APPLIER_RESYNC:
 		say_info("can't read row");
 		break;
 	default:
@@ -757,6 +774,70 @@ applier_connect(struct applier *applier)
 	applier_set_state(applier, APPLIER_READY);
 }
 
+/** Size of a chunk of a checkpoint file read from the master. */
+enum { APPLIER_FILE_CHUNK_SIZE = 1024 * 1024 };
+
+/**
+ * Receive the master checkpoint file following IPROTO_JOIN_FILE to a
+ * temporary file in the snapshot directory and load it as a local
+ * snapshot. The file blocks have checksums, so the data is verified
+ * while it's loaded. Returns the number of loaded rows.
+ */
+static uint64_t
+applier_fetch_checkpoint_file(struct applier *applier,
+			      const struct xrow_header *row)
+{
+	uint64_t size;
+	xrow_decode_join_file_xc(row, &size);
+	struct memtx_engine *memtx =
+		(struct memtx_engine *)engine_by_name("memtx");
+	char path[PATH_MAX];
+	strlcpy(path, xdir_format_filename(&memtx->snap_dir,
+					   vclock_sum(&replicaset.vclock),
+					   INPROGRESS), sizeof(path));
+	int fd = coio_file_open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to create '%s'", path);
+		diag_raise();
+	}
+	auto file_guard = make_scoped_guard([&] {
+		if (fd >= 0)
+			coio_file_close(fd);
+		coio_unlink(path);
+	});
+
+	say_info("receiving checkpoint file, %llu bytes",
+		 (unsigned long long)size);
+	struct ibuf *ibuf = &applier->ibuf;
+	while (size > 0) {
+		if (ibuf_used(ibuf) == 0) {
+			coio_breadn(&applier->io, ibuf,
+				    MIN(size, (uint64_t)APPLIER_FILE_CHUNK_SIZE));
+		}
+		size_t len = MIN((uint64_t)ibuf_used(ibuf), size);
+		if (coio_write(fd, ibuf->rpos, len) < 0) {
+			diag_set(SystemError, "failed to write '%s'", path);
+			diag_raise();
+		}
+		ibuf->rpos += len;
+		size -= len;
+		applier->last_row_time = ev_monotonic_now(loop());
+	}
+	int rc = coio_file_close(fd);
+	fd = -1;
+	if (rc != 0) {
+		diag_set(SystemError, "failed to close '%s'", path);
+		diag_raise();
+	}
+
+	say_info("loading checkpoint file");
+	uint64_t row_count;
+	if (memtx_engine_recover_join_file(memtx, path, &replicaset.vclock,
+					   &row_count) != 0)
+		diag_raise();
+	return row_count;
+}
+
 static uint64_t
 applier_wait_snapshot(struct applier *applier)
 {
@@ -820,7 +901,10 @@ applier_wait_snapshot(struct applier *applier)
 	uint64_t row_count = 0;
 	while (true) {
 		applier->last_row_time = ev_monotonic_now(loop());
-		if (iproto_type_is_dml(row.type)) {
+		if (row.type == IPROTO_JOIN_FILE) {
+			row_count = applier_fetch_checkpoint_file(applier,
+								  &row);
+		} else if (iproto_type_is_dml(row.type)) {
 			if (apply_snapshot_row(&row) != 0)
 				diag_raise();
 			if (++row_count % ROWS_PER_LOG == 0) {
@@ -870,6 +954,8 @@ applier_fetch_snapshot(struct applier *applier)
 
 struct applier_read_ctx {
 	struct ibuf *ibuf;
+	/** Decompressor of the stream or NULL if it isn't compressed. */
+	struct xrow_decompressor *decompressor;
 	struct applier_tx_row *(*alloc_row)(struct applier *);
 	void (*save_body)(struct applier *, struct xrow_header *);
 };
@@ -900,6 +986,13 @@ struct applier_tx_row {
 		/** The vclock sync decoded from master's heartbeat. */
 		uint64_t vclock_sync;
 	} req;
+	/**
+	 * Monotonic start time of the current stage of the transaction if
+	 * its latency is traced, 0 otherwise. Set in the last row only.
+	 */
+	double trace_time;
+	/** Latency of APPLIER_LATENCY_NETWORK, set with trace_time. */
+	double network_latency;
 };
 
 /** A structure representing a single incoming transaction. */
@@ -972,6 +1065,7 @@ applier_wait_register(struct applier *applier, uint64_t row_count)
 
 	const struct applier_read_ctx ctx = {
 		.ibuf = &applier->ibuf,
+		.decompressor = NULL,
 		.alloc_row = tx_alloc_row,
 		.save_body = tx_save_body,
 	};
@@ -1047,6 +1141,9 @@ applier_join(struct applier *applier)
 	req.instance_uuid = INSTANCE_UUID;
 	strlcpy(req.instance_name, cfg_instance_name, NODE_NAME_SIZE_MAX);
 	req.version_id = tarantool_version_id();
+	req.is_checkpoint_join = replication_checkpoint_join &&
+		iproto_features_test(&applier->features,
+				     IPROTO_FEATURE_CHECKPOINT_JOIN);
 	RegionGuard region_guard(&fiber()->gc);
 	xrow_encode_join(&row, &req);
 	coio_write_xrow(io, &row);
@@ -1084,7 +1181,12 @@ applier_read_tx_row(struct applier *applier, const struct applier_read_ctx *ctx,
 
 	ERROR_INJECT_YIELD(ERRINJ_APPLIER_READ_TX_ROW_DELAY);
 
-	coio_read_xrow_timeout_xc(io, ctx->ibuf, row, timeout);
+	if (ctx->decompressor != NULL) {
+		coio_read_xrow_compressed_timeout_xc(io, ctx->decompressor,
+						     ctx->ibuf, row, timeout);
+	} else {
+		coio_read_xrow_timeout_xc(io, ctx->ibuf, row, timeout);
+	}
 
 	if (row->tm > 0)
 		applier->lag = ev_now(loop()) - row->tm;
@@ -1187,6 +1289,13 @@ applier_read_tx(struct applier *applier, struct stailq *rows,
 		applier_parse_tx_row(tx_row);
 		++row_count;
 	} while (tsn != 0);
+	struct applier_tx_row *last =
+		stailq_last_entry(rows, struct applier_tx_row, next);
+	last->trace_time = 0;
+	if (replication_latency_is_sampled(&last->row) && last->row.tm > 0) {
+		last->trace_time = ev_monotonic_time();
+		last->network_latency = ev_time() - last->row.tm;
+	}
 	return row_count;
 }
 
@@ -1240,6 +1349,13 @@ struct replica_cb_data {
 	 * a transaction.
 	 */
 	double txn_last_tm;
+	/**
+	 * Monotonic time when a traced transaction started to be applied
+	 * or 0 if its latency isn't traced.
+	 */
+	double apply_time;
+	/** Monotonic time when a traced transaction was submitted to WAL. */
+	double submit_time;
 };
 
 /** Update replica associated data once write is complete. */
@@ -1247,8 +1363,16 @@ static void
 replica_txn_wal_write_cb(struct replica_cb_data *rcb)
 {
 	struct replica *r = replica_by_id(rcb->replica_id);
-	if (likely(r != NULL))
-		r->applier_txn_last_tm = rcb->txn_last_tm;
+	if (unlikely(r == NULL))
+		return;
+	r->applier_txn_last_tm = rcb->txn_last_tm;
+	if (rcb->apply_time != 0 && r->applier != NULL) {
+		struct latency *latency = r->applier->latency;
+		latency_collect(&latency[APPLIER_LATENCY_APPLY],
+				rcb->submit_time - rcb->apply_time);
+		latency_collect(&latency[APPLIER_LATENCY_WAL],
+				ev_monotonic_time() - rcb->submit_time);
+	}
 }
 
 static int
@@ -1322,6 +1446,7 @@ apply_synchro_req(uint32_t replica_id, struct xrow_header *row, struct synchro_r
 
 	rcb_data.replica_id = replica_id;
 	rcb_data.txn_last_tm = row->tm;
+	rcb_data.apply_time = 0;
 	entry.rcb = &rcb_data;
 
 	/*
@@ -1375,9 +1500,13 @@ applier_handle_raft_request(struct applier *applier, struct raft_request *req)
 	return box_raft_process(req, applier->instance_id);
 }
 
-static int
-apply_plain_tx(uint32_t replica_id, struct stailq *rows,
-	       bool skip_conflict, bool use_triggers)
+/**
+ * Begin a transaction and execute all the rows in it. Returns the
+ * transaction ready to be committed with apply_plain_tx_commit() or
+ * NULL in case of an error, in which case the transaction is aborted.
+ */
+static struct txn *
+apply_plain_tx_rows(struct stailq *rows, bool skip_conflict)
 {
 	/*
 	 * Explicitly begin the transaction so that we can
@@ -1388,7 +1517,7 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 	struct txn *txn = txn_begin();
 	struct applier_tx_row *item;
 	if (txn == NULL)
-		 return -1;
+		 return NULL;
 	txn->isolation = TXN_ISOLATION_READ_COMMITTED;
 
 	stailq_foreach_entry(item, rows, next) {
@@ -1411,10 +1540,23 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 				res = apply_nop(row);
 			}
 		}
-		if (res != 0)
-			goto fail;
+		if (res != 0) {
+			txn_abort(txn);
+			return NULL;
+		}
 	}
+	return txn;
+}
 
+/**
+ * Commit a transaction executed by apply_plain_tx_rows(). The
+ * transaction is aborted in case of an error.
+ */
+static int
+apply_plain_tx_commit(struct txn *txn, uint32_t replica_id,
+		      struct stailq *rows, bool use_triggers)
+{
+	struct applier_tx_row *item;
 	/*
 	 * We are going to commit so it's a high time to check if
 	 * the current transaction has non-local effects.
@@ -1466,6 +1608,9 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 		item = stailq_last_entry(rows, struct applier_tx_row, next);
 		rcb->replica_id = replica_id;
 		rcb->txn_last_tm = item->row.tm;
+		rcb->apply_time = item->trace_time;
+		if (rcb->apply_time != 0)
+			rcb->submit_time = ev_monotonic_time();
 
 		trigger_create(on_wal_write, applier_txn_wal_write_cb, rcb, NULL);
 		txn_on_wal_write(txn, on_wal_write);
@@ -1477,6 +1622,16 @@ fail:
 	return -1;
 }
 
+static int
+apply_plain_tx(uint32_t replica_id, struct stailq *rows,
+	       bool skip_conflict, bool use_triggers)
+{
+	struct txn *txn = apply_plain_tx_rows(rows, skip_conflict);
+	if (txn == NULL)
+		return -1;
+	return apply_plain_tx_commit(txn, replica_id, rows, use_triggers);
+}
+
 /** A simpler version of applier_apply_tx() for final join stage. */
 static int
 apply_final_join_tx(uint32_t replica_id, struct stailq *rows)
@@ -1581,6 +1736,78 @@ applier_process_heartbeat(struct applier *applier, struct applier_tx_row *txr)
 	return 0;
 }
 
+/**
+ * In a full mesh topology, the same set of changes may arrive via two
+ * concurrently running appliers. Hence we need a latch to strictly
+ * order all changes that belong to the same server id. Return the
+ * latch for the transaction starting with the given row.
+ */
+static struct latch *
+applier_order_latch(struct xrow_header *first_row)
+{
+	struct replica *replica = replica_by_id(first_row->replica_id);
+	return replica != NULL ? &replica->order_latch :
+				 &replicaset.applier.order_latch;
+}
+
+/**
+ * Drop the rows of a transaction that have already been applied.
+ * Return true if the whole transaction has been applied. Must be
+ * called under the order latch of the transaction.
+ */
+static bool
+applier_skip_applied_rows(struct stailq *rows)
+{
+	struct xrow_header *first_row =
+		&stailq_first_entry(rows, struct applier_tx_row, next)->row;
+	struct xrow_header *last_row =
+		&stailq_last_entry(rows, struct applier_tx_row, next)->row;
+	if (vclock_get(&replicaset.applier.vclock,
+		       last_row->replica_id) >= last_row->lsn) {
+		return true;
+	} else if (vclock_get(&replicaset.applier.vclock,
+			      first_row->replica_id) >= first_row->lsn) {
+		/*
+		 * We've received part of the tx from an old
+		 * instance not knowing of tx boundaries.
+		 * Skip the already applied part.
+		 */
+		struct xrow_header *tmp;
+		while (true) {
+			tmp = &stailq_first_entry(rows,
+						  struct applier_tx_row,
+						  next)->row;
+			if (tmp->lsn <= vclock_get(&replicaset.applier.vclock,
+						   tmp->replica_id)) {
+				stailq_shift(rows);
+			} else {
+				break;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Account the stages a traced transaction has passed before it started
+ * to be applied. The rest of the stages are accounted once it's written
+ * to WAL.
+ */
+static void
+applier_trace_tx_apply(struct applier *applier, struct stailq *rows)
+{
+	struct applier_tx_row *txr =
+		stailq_last_entry(rows, struct applier_tx_row, next);
+	if (txr->trace_time == 0)
+		return;
+	double now = ev_monotonic_time();
+	latency_collect(&applier->latency[APPLIER_LATENCY_NETWORK],
+			MAX(txr->network_latency, 0));
+	latency_collect(&applier->latency[APPLIER_LATENCY_DECODE],
+			now - txr->trace_time);
+	txr->trace_time = now;
+}
+
 /**
  * Apply all rows in the rows queue as a single transaction.
  *
@@ -1611,40 +1838,11 @@ applier_apply_tx(struct applier *applier, struct stailq *rows)
 	struct xrow_header *first_row = &txr->row;
 	struct xrow_header *last_row;
 	last_row = &stailq_last_entry(rows, struct applier_tx_row, next)->row;
-	struct replica *replica = replica_by_id(first_row->replica_id);
 	int rc = 0;
-	/*
-	 * In a full mesh topology, the same set of changes
-	 * may arrive via two concurrently running appliers.
-	 * Hence we need a latch to strictly order all changes
-	 * that belong to the same server id.
-	 */
-	struct latch *latch = (replica ? &replica->order_latch :
-			       &replicaset.applier.order_latch);
+	struct latch *latch = applier_order_latch(first_row);
 	latch_lock(latch);
-	if (vclock_get(&replicaset.applier.vclock,
-		       last_row->replica_id) >= last_row->lsn) {
+	if (applier_skip_applied_rows(rows))
 		goto finish;
-	} else if (vclock_get(&replicaset.applier.vclock,
-			      first_row->replica_id) >= first_row->lsn) {
-		/*
-		 * We've received part of the tx from an old
-		 * instance not knowing of tx boundaries.
-		 * Skip the already applied part.
-		 */
-		struct xrow_header *tmp;
-		while (true) {
-			tmp = &stailq_first_entry(rows,
-						  struct applier_tx_row,
-						  next)->row;
-			if (tmp->lsn <= vclock_get(&replicaset.applier.vclock,
-						   tmp->replica_id)) {
-				stailq_shift(rows);
-			} else {
-				break;
-			}
-		}
-	}
 	applier_synchro_filter_tx(rows);
 	if (unlikely(iproto_type_is_synchro_request(first_row->type))) {
 		/*
@@ -1656,6 +1854,7 @@ applier_apply_tx(struct applier *applier, struct stailq *rows)
 		rc = apply_synchro_req(applier->instance_id, &txr->row,
 				       &txr->req.synchro);
 	} else {
+		applier_trace_tx_apply(applier, rows);
 		rc = apply_plain_tx(applier->instance_id, rows,
 				    replication_skip_conflict, true);
 	}
@@ -1832,6 +2031,472 @@ applier_handle_raft(struct applier *applier, struct applier_tx_row *txr)
 	return 0;
 }
 
+/**
+ * Parallel apply.
+ *
+ * With replication_apply_fibers > 1 the applier fiber doesn't apply
+ * asynchronous transactions writing to user vinyl spaces itself but hands
+ * them out to a pool of worker fibers. Vinyl may yield on disk reads
+ * while executing a statement, so a transaction waiting for a cold read
+ * doesn't stall the whole stream anymore. Any other transaction is a
+ * barrier: it's applied by the applier fiber after all the transactions
+ * handed out before it are done.
+ *
+ * Every transaction handed out gets a sequence number and a write set,
+ * which consists of the (space id, primary key hash) pairs it modifies.
+ * A worker starts executing a transaction only after the last transaction
+ * with an intersecting write set is committed, and commits it only after
+ * the previous transaction in the stream is committed, so transactions
+ * are submitted to WAL in the original order. A write that can't be
+ * reduced to a primary key (e.g. to a space with a unique secondary index
+ * or by a secondary key) covers the whole space. A hash collision results
+ * in a false dependency, which is safe.
+ *
+ * Transactions handed out are applied under the order latch of their
+ * origin, which is held by the applier fiber until all of them are done.
+ */
+struct applier_wset_node {
+	/** Space id, possibly combined with a primary key hash. */
+	uint64_t key;
+	/** Sequence number of the last transaction writing the key. */
+	int64_t seq;
+};
+
+#define mh_name _applier_wset
+#define mh_key_t uint64_t
+#define mh_node_t struct applier_wset_node
+#define mh_arg_t void *
+#define mh_hash(a, arg) ((a)->key)
+#define mh_hash_key(a, arg) (a)
+#define mh_cmp(a, b, arg) ((a)->key != (b)->key)
+#define mh_cmp_key(a, b, arg) ((a) != (b)->key)
+#define MH_SOURCE 1
+#include "salad/mhash.h"
+
+/** A transaction handed out to the parallel apply pool. */
+struct applier_apply_job {
+	/** Link in applier_apply_pool::queue. */
+	struct stailq_entry in_queue;
+	/** The transaction rows. */
+	struct stailq *rows;
+	/** Position of the transaction in the stream. */
+	int64_t seq;
+	/**
+	 * Sequence number of the last transaction this one conflicts
+	 * with or 0.
+	 */
+	int64_t dep;
+};
+
+struct applier_apply_pool {
+	/** The applier the pool applies transactions for. */
+	struct applier *applier;
+	/** Worker fibers. */
+	struct fiber **workers;
+	/** Number of worker fibers. */
+	int worker_count;
+	/** Memory pool for jobs. */
+	struct mempool job_pool;
+	/** Jobs not picked up by a worker yet. */
+	struct stailq queue;
+	/** Signalled when a job is queued or the pool is stopped. */
+	struct fiber_cond queue_cond;
+	/** Set when the worker fibers must exit. */
+	bool is_stopped;
+	/** Sequence number of the next job. */
+	int64_t next_seq;
+	/** Sequence number of the last done job. Jobs are done in order. */
+	int64_t done_seq;
+	/** Signalled when a job is done. */
+	struct fiber_cond done_cond;
+	/** The order latch held while there are jobs not done, or NULL. */
+	struct latch *latch;
+	/** (space id, key hash) -> the last job writing the key. */
+	struct mh_applier_wset_t *keys;
+	/** Space id -> the last job writing to the space. */
+	struct mh_applier_wset_t *spaces;
+	/** Space id -> the last job writing to the whole space. */
+	struct mh_applier_wset_t *space_barriers;
+	/**
+	 * Batches to be returned to the applier thread once all their
+	 * transactions are done, and the sequence numbers of their last
+	 * transactions. The thread has only two batch messages.
+	 */
+	struct applier_data_msg *batches[2];
+	int64_t batch_seq[2];
+	int batch_count;
+	/** Set if a job failed. All the jobs after it are rolled back. */
+	bool is_failed;
+	/** The error of the failed job. */
+	struct diag diag;
+};
+
+/** Wait until the job with the given sequence number is done. */
+static void
+applier_apply_pool_wait(struct applier_apply_pool *pool, int64_t seq)
+{
+	while (pool->done_seq < seq)
+		fiber_cond_wait(&pool->done_cond);
+}
+
+/** Return the batch to the applier thread. */
+static void
+applier_return_batch(struct applier *applier, struct applier_data_msg *msg)
+{
+	cmsg_init(&msg->base.base, return_route);
+	cpipe_push(&applier->applier_thread->thread_pipe, &msg->base.base);
+}
+
+/** Return the batches with all transactions done to the applier thread. */
+static void
+applier_apply_pool_return_batches(struct applier_apply_pool *pool)
+{
+	while (pool->batch_count > 0 &&
+	       pool->batch_seq[0] <= pool->done_seq) {
+		applier_return_batch(pool->applier, pool->batches[0]);
+		pool->batches[0] = pool->batches[1];
+		pool->batch_seq[0] = pool->batch_seq[1];
+		pool->batch_count--;
+	}
+}
+
+/**
+ * Return the batch to the applier thread once the transactions handed
+ * out so far are done.
+ */
+static void
+applier_apply_pool_add_batch(struct applier_apply_pool *pool,
+			     struct applier_data_msg *msg)
+{
+	assert(pool->batch_count < 2);
+	pool->batches[pool->batch_count] = msg;
+	pool->batch_seq[pool->batch_count] = pool->next_seq - 1;
+	pool->batch_count++;
+	applier_apply_pool_return_batches(pool);
+}
+
+/**
+ * Wait until all the jobs are done and release the order latch. Doesn't
+ * check if the jobs failed, see applier_apply_pool_check().
+ */
+static void
+applier_apply_pool_drain(struct applier_apply_pool *pool)
+{
+	applier_apply_pool_wait(pool, pool->next_seq - 1);
+	assert(pool->batch_count == 0);
+	assert(stailq_empty(&pool->queue));
+	if (pool->latch == NULL)
+		return;
+	/* Jobs are handed out only under the latch. */
+	latch_unlock(pool->latch);
+	pool->latch = NULL;
+	mh_applier_wset_clear(pool->keys);
+	mh_applier_wset_clear(pool->spaces);
+	mh_applier_wset_clear(pool->space_barriers);
+}
+
+/** Set the diag and return -1 if a job failed. */
+static int
+applier_apply_pool_check(struct applier_apply_pool *pool)
+{
+	if (!pool->is_failed)
+		return 0;
+	assert(!diag_is_empty(&pool->diag));
+	diag_move(&pool->diag, diag_get());
+	return -1;
+}
+
+/** Execute and commit the transaction of a job in a worker fiber. */
+static void
+applier_apply_job(struct applier_apply_pool *pool,
+		  struct applier_apply_job *job)
+{
+	struct txn *txn = NULL;
+	applier_trace_tx_apply(pool->applier, job->rows);
+	applier_apply_pool_wait(pool, job->dep);
+	if (!pool->is_failed)
+		txn = apply_plain_tx_rows(job->rows, replication_skip_conflict);
+	/* Commit in the stream order. */
+	applier_apply_pool_wait(pool, job->seq - 1);
+	if (pool->is_failed) {
+		if (txn != NULL)
+			txn_abort(txn);
+		diag_clear(diag_get());
+	} else if (txn == NULL ||
+		   apply_plain_tx_commit(txn, pool->applier->instance_id,
+					 job->rows, true) != 0) {
+		pool->is_failed = true;
+		diag_move(diag_get(), &pool->diag);
+	} else {
+		struct xrow_header *last_row =
+			&stailq_last_entry(job->rows, struct applier_tx_row,
+					   next)->row;
+		vclock_follow(&replicaset.applier.vclock, last_row->replica_id,
+			      last_row->lsn);
+	}
+	pool->done_seq = job->seq;
+	mempool_free(&pool->job_pool, job);
+	fiber_cond_broadcast(&pool->done_cond);
+	applier_apply_pool_return_batches(pool);
+}
+
+static int
+applier_apply_worker_f(va_list ap)
+{
+	struct applier_apply_pool *pool =
+		va_arg(ap, struct applier_apply_pool *);
+	/* Same as in the applier fiber, see applier_f(). */
+	struct session *session = session_new_on_demand();
+	session_set_type(session, SESSION_TYPE_APPLIER);
+	while (true) {
+		while (stailq_empty(&pool->queue) && !pool->is_stopped)
+			fiber_cond_wait(&pool->queue_cond);
+		if (stailq_empty(&pool->queue))
+			break;
+		RegionGuard region_guard(&fiber()->gc);
+		struct applier_apply_job *job =
+			stailq_shift_entry(&pool->queue,
+					   struct applier_apply_job, in_queue);
+		applier_apply_job(pool, job);
+	}
+	return 0;
+}
+
+/** Create the parallel apply pool and start the worker fibers. */
+static struct applier_apply_pool *
+applier_apply_pool_new(struct applier *applier, int worker_count)
+{
+	struct applier_apply_pool *pool = (struct applier_apply_pool *)
+		xcalloc(1, sizeof(*pool));
+	pool->applier = applier;
+	mempool_create(&pool->job_pool, &cord()->slabc,
+		       sizeof(struct applier_apply_job));
+	stailq_create(&pool->queue);
+	fiber_cond_create(&pool->queue_cond);
+	fiber_cond_create(&pool->done_cond);
+	pool->next_seq = 1;
+	pool->keys = mh_applier_wset_new();
+	pool->spaces = mh_applier_wset_new();
+	pool->space_barriers = mh_applier_wset_new();
+	diag_create(&pool->diag);
+	pool->workers = (struct fiber **)
+		xmalloc(worker_count * sizeof(*pool->workers));
+	for (int i = 0; i < worker_count; i++) {
+		pool->workers[i] = applier_fiber_new(applier, "applierw",
+						     applier_apply_worker_f,
+						     true);
+		pool->worker_count++;
+		fiber_start(pool->workers[i], pool);
+	}
+	return pool;
+}
+
+/** Stop the worker fibers and destroy the pool. */
+static void
+applier_apply_pool_delete(struct applier_apply_pool *pool)
+{
+	applier_apply_pool_drain(pool);
+	pool->is_stopped = true;
+	fiber_cond_broadcast(&pool->queue_cond);
+	for (int i = 0; i < pool->worker_count; i++)
+		fiber_join(pool->workers[i]);
+	free(pool->workers);
+	mh_applier_wset_delete(pool->keys);
+	mh_applier_wset_delete(pool->spaces);
+	mh_applier_wset_delete(pool->space_barriers);
+	diag_destroy(&pool->diag);
+	mempool_destroy(&pool->job_pool);
+	fiber_cond_destroy(&pool->queue_cond);
+	fiber_cond_destroy(&pool->done_cond);
+	free(pool);
+}
+
+/**
+ * Check if a transaction can be handed out to the parallel apply pool:
+ * it must be asynchronous and write only to user vinyl spaces that
+ * don't run triggers or foreign key checks, which may read anything.
+ */
+static bool
+applier_tx_is_parallel(struct stailq *rows)
+{
+	struct applier_tx_row *item;
+	stailq_foreach_entry(item, rows, next) {
+		struct xrow_header *row = &item->row;
+		if (row->wait_sync)
+			return false;
+		if (row->type == IPROTO_NOP)
+			continue;
+		if (!iproto_type_is_dml(row->type))
+			return false;
+		struct space *space = space_by_id(item->req.dml.space_id);
+		if (space == NULL || !space_is_vinyl(space) ||
+		    space_is_system(space) ||
+		    !rlist_empty(&space->before_replace) ||
+		    !rlist_empty(&space->on_replace) ||
+		    space->sql_triggers != NULL || space->has_foreign_keys)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Calculate the hash of the primary key modified by a request. Return
+ * false if the request may modify other keys or the key is unknown.
+ */
+static bool
+applier_request_key_hash(struct space *space, struct request *request,
+			 uint32_t *hash)
+{
+	struct index *pk = space_index(space, 0);
+	if (pk == NULL)
+		return false;
+	/*
+	 * A unique secondary key can be freed by a statement that doesn't
+	 * mention it, e.g. DELETE by the primary key.
+	 */
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		if (space->index[i]->def->opts.is_unique)
+			return false;
+	}
+	struct key_def *key_def = pk->def->key_def;
+	RegionGuard region_guard(&fiber()->gc);
+	const char *key;
+	switch (request->type) {
+	case IPROTO_INSERT:
+	case IPROTO_REPLACE:
+	case IPROTO_UPSERT:
+		key = tuple_extract_key_raw(request->tuple, request->tuple_end,
+					    key_def, MULTIKEY_NONE, NULL);
+		if (key == NULL) {
+			diag_clear(diag_get());
+			return false;
+		}
+		break;
+	case IPROTO_UPDATE:
+	case IPROTO_DELETE:
+		if (request->index_id != 0)
+			return false;
+		key = request->key;
+		break;
+	default:
+		return false;
+	}
+	uint32_t part_count = mp_decode_array(&key);
+	if (part_count != key_def->part_count ||
+	    exact_key_validate(key_def, key, part_count) != 0) {
+		diag_clear(diag_get());
+		return false;
+	}
+	*hash = key_hash(key, key_def);
+	return true;
+}
+
+/** Return the sequence number stored for the key or 0. */
+static int64_t
+applier_wset_get(struct mh_applier_wset_t *h, uint64_t key)
+{
+	mh_int_t k = mh_applier_wset_find(h, key, NULL);
+	return k != mh_end(h) ? mh_applier_wset_node(h, k)->seq : 0;
+}
+
+/** Store the sequence number for the key. */
+static void
+applier_wset_put(struct mh_applier_wset_t *h, uint64_t key, int64_t seq)
+{
+	struct applier_wset_node node = {key, seq};
+	mh_applier_wset_put(h, &node, NULL, NULL);
+}
+
+/** Make a job depend on the job with the given sequence number. */
+static void
+applier_apply_job_add_dep(struct applier_apply_job *job, int64_t seq)
+{
+	/* A transaction may write the same key more than once. */
+	if (seq != job->seq)
+		job->dep = MAX(job->dep, seq);
+}
+
+/**
+ * Add the rows of a job to the write set of the pool and find the last
+ * job the job depends on.
+ */
+static void
+applier_apply_pool_add_wset(struct applier_apply_pool *pool,
+			    struct applier_apply_job *job)
+{
+	struct applier_tx_row *item;
+	stailq_foreach_entry(item, job->rows, next) {
+		if (item->row.type == IPROTO_NOP)
+			continue;
+		struct request *request = &item->req.dml;
+		struct space *space = space_by_id(request->space_id);
+		assert(space != NULL);
+		uint64_t id = space->def->id;
+		uint32_t hash;
+		if (applier_request_key_hash(space, request, &hash)) {
+			uint64_t key = id << 32 | hash;
+			applier_apply_job_add_dep(
+				job, applier_wset_get(pool->keys, key));
+			applier_apply_job_add_dep(
+				job, applier_wset_get(pool->space_barriers,
+						      id));
+			applier_wset_put(pool->keys, key, job->seq);
+		} else {
+			applier_apply_job_add_dep(
+				job, applier_wset_get(pool->spaces, id));
+			applier_wset_put(pool->space_barriers, id, job->seq);
+		}
+		applier_wset_put(pool->spaces, id, job->seq);
+	}
+}
+
+/**
+ * Apply a transaction or hand it out to the parallel apply pool if the
+ * applier has one. Return 0 for success or -1 in case of an error.
+ */
+static int
+applier_dispatch_tx(struct applier *applier, struct stailq *rows)
+{
+	struct applier_apply_pool *pool = applier->apply_pool;
+	if (pool == NULL)
+		return applier_apply_tx(applier, rows);
+	if (pool->is_failed ||
+	    (applier->state != APPLIER_SYNC &&
+	     applier->state != APPLIER_FOLLOW) ||
+	    !applier_tx_is_parallel(rows)) {
+		applier_apply_pool_drain(pool);
+		if (applier_apply_pool_check(pool) != 0)
+			return -1;
+		return applier_apply_tx(applier, rows);
+	}
+	struct xrow_header *first_row =
+		&stailq_first_entry(rows, struct applier_tx_row, next)->row;
+	struct latch *latch = applier_order_latch(first_row);
+	if (pool->latch != latch) {
+		applier_apply_pool_drain(pool);
+		if (applier_apply_pool_check(pool) != 0)
+			return -1;
+		latch_lock(latch);
+		pool->latch = latch;
+	}
+	if (applier_skip_applied_rows(rows))
+		return 0;
+	try {
+		applier_synchro_filter_tx(rows);
+	} catch (Exception *) {
+		return -1;
+	}
+	struct applier_apply_job *job = (struct applier_apply_job *)
+		xmempool_alloc(&pool->job_pool);
+	job->rows = rows;
+	job->seq = pool->next_seq++;
+	job->dep = 0;
+	applier_apply_pool_add_wset(pool, job);
+	stailq_add_tail_entry(&pool->queue, job, in_queue);
+	fiber_cond_signal(&pool->queue_cond);
+	return 0;
+}
+
 /**
  * The tx part of applier-in-thread machinery. Apply all the parsed
  * transactions.
@@ -1841,6 +2506,15 @@ applier_process_batch(struct cmsg *base)
 {
 	struct applier_data_msg *msg = (struct applier_data_msg *)base;
 	struct applier *applier = msg->base.applier;
+	struct applier_apply_pool *pool = applier->apply_pool;
+	/*
+	 * The transactions handed out to the pool refer to the batch rows,
+	 * so wait for them before the rows are freed on error.
+	 */
+	auto pool_guard = make_scoped_guard([&] {
+		if (pool != NULL)
+			applier_apply_pool_drain(pool);
+	});
 	struct applier_tx *tx;
 	stailq_foreach_entry(tx, &msg->txs, next) {
 		struct applier_tx_row *last_txr =
@@ -1862,7 +2536,7 @@ applier_process_batch(struct cmsg *base)
 				diag_raise();
 			applier_signal_ack(applier);
 			applier_check_sync(applier);
-		} else if (applier_apply_tx(applier, &tx->rows) != 0) {
+		} else if (applier_dispatch_tx(applier, &tx->rows) != 0) {
 			diag_raise();
 		}
 		if (applier->state == APPLIER_FINAL_JOIN &&
@@ -1874,9 +2548,12 @@ applier_process_batch(struct cmsg *base)
 		}
 	}
 
+	pool_guard.is_active = false;
 	/* Return the message to applier thread. */
-	cmsg_init(&msg->base.base, return_route);
-	cpipe_push(&applier->applier_thread->thread_pipe, &msg->base.base);
+	if (pool != NULL)
+		applier_apply_pool_add_batch(pool, msg);
+	else
+		applier_return_batch(applier, msg);
 }
 
 /** The callback invoked on the message return to applier thread. */
@@ -2013,6 +2690,9 @@ applier_thread_reader_f(va_list ap)
 	struct lsregion *lsr = &applier->thread.lsr;
 	const struct applier_read_ctx ctx = {
 		.ibuf = &applier->thread.ibuf,
+		.decompressor = applier->compression !=
+				REPLICATION_COMPRESSION_NONE ?
+				&applier->thread.decompressor : NULL,
 		.alloc_row = thread_alloc_row,
 		.save_body = thread_save_body,
 	};
@@ -2148,11 +2828,15 @@ applier_thread_ibuf_init(struct applier *applier)
 	ibuf_create(&applier->thread.ibuf, &cord()->slabc, 1024);
 	/*
 	 * Move unparsed data, if any, from the previously used tx ibuf to the
-	 * new buf.
+	 * new buf. If the stream is compressed, the data is yet to be
+	 * decompressed.
 	 */
+	struct ibuf *ibuf = &applier->thread.ibuf;
+	if (applier->compression != REPLICATION_COMPRESSION_NONE)
+		ibuf = &applier->thread.decompressor.ibuf;
 	size_t parse_size = ibuf_used(&applier->ibuf);
 	if (parse_size > 0)
-		ibuf_move_tail(&applier->ibuf, &applier->thread.ibuf, parse_size);
+		ibuf_move_tail(&applier->ibuf, ibuf, parse_size);
 }
 
 /** Initialize applier thread messages. */
@@ -2202,6 +2886,10 @@ applier_thread_attach_applier(struct cbus_call_msg *base)
 {
 	struct applier *applier = ((struct applier_cfg_msg *)base)->applier;
 
+	if (applier->compression != REPLICATION_COMPRESSION_NONE &&
+	    xrow_decompressor_create(&applier->thread.decompressor,
+				     &cord()->slabc) != 0)
+		return -1;
 	lsregion_create(&applier->thread.lsr, &runtime);
 	fiber_cond_create(&applier->thread.writer_cond);
 	applier_thread_ibuf_init(applier);
@@ -2227,6 +2915,8 @@ applier_thread_detach_applier(struct cbus_call_msg *base)
 	applier->thread.reader = NULL;
 	lsregion_destroy(&applier->thread.lsr);
 	fiber_cond_destroy(&applier->thread.writer_cond);
+	if (applier->compression != REPLICATION_COMPRESSION_NONE)
+		xrow_decompressor_destroy(&applier->thread.decompressor);
 	return 0;
 }
 
@@ -2275,8 +2965,11 @@ applier_thread_data_create(struct applier *applier,
 	struct applier_cfg_msg msg;
 	msg.applier = applier;
 
-	cbus_call(&thread->thread_pipe, &thread->tx_pipe, &msg.base,
-		  applier_thread_attach_applier);
+	if (cbus_call(&thread->thread_pipe, &thread->tx_pipe, &msg.base,
+		      applier_thread_attach_applier) != 0) {
+		fiber_cond_destroy(&applier->msg_cond);
+		return -1;
+	}
 
 	ibuf_reset(&applier->ibuf);
 
@@ -2296,6 +2989,176 @@ applier_unwatch_ballot(struct applier *applier)
 	}
 }
 
+/**
+ * Move the vclock of the applied rows to the vclock of the master read
+ * view the data was resynced from by writing a NOP for each component
+ * the replica lags behind in. Must be called under all the order
+ * latches, see applier_resync_lock().
+ */
+static void
+applier_resync_vclock(const struct vclock *vclock)
+{
+	struct vclock_iterator it;
+	vclock_iterator_init(&it, vclock);
+	vclock_foreach(&it, c) {
+		if (c.id == 0)
+			continue;
+		struct xrow_header row;
+		memset(&row, 0, sizeof(row));
+		row.type = IPROTO_NOP;
+		row.replica_id = c.id;
+		row.lsn = c.lsn;
+		if (vclock_get(&replicaset.applier.vclock, c.id) >= c.lsn)
+			continue;
+		struct request request;
+		memset(&request, 0, sizeof(request));
+		request.type = IPROTO_NOP;
+		request.header = &row;
+		struct txn *txn = txn_begin();
+		if (txn == NULL)
+			diag_raise();
+		txn_set_flags(txn, TXN_FORCE_ASYNC);
+		if (process_nop(&request) != 0) {
+			txn_abort(txn);
+			diag_raise();
+		}
+		if (txn_commit(txn) != 0)
+			diag_raise();
+		vclock_follow(&replicaset.applier.vclock, c.id, c.lsn);
+	}
+}
+
+/**
+ * Lock the order latches of all the replicas so that no other applier
+ * applies rows and forbid local writes. Returns the number of the locked
+ * latches stored in @a latches.
+ */
+static int
+applier_resync_lock(struct latch **latches)
+{
+	int count = 0;
+	for (uint32_t id = 0; id < VCLOCK_MAX; id++) {
+		struct replica *replica = replica_by_id(id);
+		if (replica != NULL)
+			latches[count++] = &replica->order_latch;
+	}
+	latches[count++] = &replicaset.applier.order_latch;
+	for (int i = 0; i < count; i++)
+		latch_lock(latches[i]);
+	box_set_resync(true);
+	/* Wait for the local writes submitted before. */
+	if (wal_sync(NULL) != 0)
+		diag_log();
+	return count;
+}
+
+/** Undo applier_resync_lock(). */
+static void
+applier_resync_unlock(struct latch **latches, int count)
+{
+	box_set_resync(false);
+	for (int i = count - 1; i >= 0; i--)
+		latch_unlock(latches[i]);
+}
+
+/**
+ * Execute RESYNC request: bring the local data in line with a read
+ * view of the master data and continue from its vclock. The master
+ * expects SUBSCRIBE right after that.
+ *
+ * The other appliers and local writes are stopped until the data is
+ * resynced. Otherwise a newer version of a tuple applied meanwhile
+ * would be overwritten with the older one from the master read view
+ * and never corrected, because its row would be considered applied.
+ */
+static void
+applier_resync(struct applier *applier)
+{
+	struct iostream *io = &applier->io;
+	struct ibuf *ibuf = &applier->ibuf;
+	struct latch *latches[VCLOCK_MAX + 1];
+	int latch_count = applier_resync_lock(latches);
+	auto lock_guard = make_scoped_guard([&] {
+		applier_resync_unlock(latches, latch_count);
+	});
+	struct xrow_header row;
+	struct resync_request req;
+	memset(&req, 0, sizeof(req));
+	req.replicaset_uuid = REPLICASET_UUID;
+	req.instance_uuid = INSTANCE_UUID;
+	vclock_copy(&req.vclock, &replicaset.vclock);
+	req.version_id = tarantool_version_id();
+	RegionGuard region_guard(&fiber()->gc);
+	xrow_encode_resync(&row, &req);
+	coio_write_xrow(io, &row);
+
+	coio_read_xrow(io, ibuf, &row);
+	if (iproto_type_is_error(row.type)) {
+		xrow_decode_error_xc(&row);
+	} else if (row.type != IPROTO_OK) {
+		tnt_raise(ClientError, ER_PROTOCOL,
+			  "Invalid response to RESYNC");
+	}
+	struct vclock vclock;
+	xrow_decode_vclock_xc(&row, &vclock);
+	/*
+	 * The local rows or the rows of other masters the master doesn't
+	 * have would be lost, so the replica has to be rejoined in this
+	 * case.
+	 */
+	if (vclock_compare_ignore0(&replicaset.vclock, &vclock) > 0 ||
+	    vclock_compare_ignore0(&replicaset.applier.vclock, &vclock) > 0) {
+		tnt_raise(ClientError, ER_UNSUPPORTED, "Resync",
+			  "a replica having rows the master doesn't have");
+	}
+	say_info("resyncing data, local vclock %s remote vclock %s",
+		 vclock_to_string(&replicaset.vclock),
+		 vclock_to_string(&vclock));
+	applier_set_state(applier, APPLIER_RESYNC);
+	resync_data(io, ibuf);
+	applier_resync_vclock(&vclock);
+	applier->need_resync = false;
+	say_info("data resynced");
+}
+
+/**
+ * Check if the replica has to resync its data after an xlog gap error
+ * from the master. It has to if the master confirms in its ballot that
+ * it has collected the WALs the replica needs and no other connected
+ * master can send the missing rows instead.
+ */
+static bool
+applier_needs_resync(struct applier *applier)
+{
+	if (!replication_resync || box_is_anon() ||
+	    !iproto_features_test(&applier->features, IPROTO_FEATURE_RESYNC))
+		return false;
+	const struct vclock *gc_vclock = &applier->ballot.gc_vclock;
+	if (vclock_compare_ignore0(gc_vclock, &replicaset.vclock) <= 0)
+		return false;
+	replicaset_foreach(replica) {
+		struct applier *other = replica->applier;
+		if (other == NULL || other == applier)
+			continue;
+		if (other->state == APPLIER_OFF ||
+		    other->state == APPLIER_CONNECT ||
+		    other->state == APPLIER_STOPPED ||
+		    other->state == APPLIER_DISCONNECTED)
+			continue;
+		const struct ballot *ballot = &other->ballot;
+		/*
+		 * The other master keeps all the rows following the
+		 * replica vclock up to the rows the master still has.
+		 */
+		int cmp = vclock_compare_ignore0(&ballot->vclock, gc_vclock);
+		if (vclock_compare_ignore0(&ballot->gc_vclock,
+					   &replicaset.vclock) <= 0 &&
+		    cmp >= 0 && cmp != VCLOCK_ORDER_UNDEFINED)
+			return false;
+	}
+	return true;
+}
+
 /**
  * Execute and process SUBSCRIBE request (follow updates from a master).
  */
@@ -2329,6 +3192,27 @@ applier_subscribe(struct applier *applier)
 	 * instance as soon as local WAL starts accepting writes.
 	 */
 	req.id_filter = box_is_orphan() ? 0 : 1 << instance_id;
+	/* Ask the master to compress the stream if it's able to. */
+	applier->compression = REPLICATION_COMPRESSION_NONE;
+	if (replication_compression != REPLICATION_COMPRESSION_NONE &&
+	    iproto_features_test(&applier->features,
+				 IPROTO_FEATURE_REPLICATION_COMPRESSION))
+		applier->compression = replication_compression;
+	req.compression = applier->compression;
+	/*
+	 * Subscribe to a part of the user spaces if the master is able to
+	 * filter them out. Otherwise fall back to all the spaces.
+	 */
+	if (replication_space_filter != NULL) {
+		if (iproto_features_test(&applier->features,
+					 IPROTO_FEATURE_SPACE_FILTER)) {
+			req.space_filter = replication_space_filter;
+			req.space_filter_end = replication_space_filter_end;
+		} else {
+			say_warn("the master doesn't support space filters, "
+				 "subscribing to all spaces");
+		}
+	}
 	RegionGuard region_guard(&fiber()->gc);
 	xrow_encode_subscribe(&row, &req);
 	coio_write_xrow(io, &row);
@@ -2451,12 +3335,38 @@ applier_subscribe(struct applier *applier)
 		trigger_clear(&on_rollback);
 	});
 
+	/*
+	 * Must be destroyed before the applier is detached from the
+	 * thread, because it may return batches to the thread.
+	 */
+	if (replication_apply_fibers > 1) {
+		applier->apply_pool = applier_apply_pool_new(
+			applier, replication_apply_fibers);
+	}
+	auto pool_guard = make_scoped_guard([&] {
+		if (applier->apply_pool != NULL) {
+			applier_apply_pool_delete(applier->apply_pool);
+			applier->apply_pool = NULL;
+		}
+	});
+
 	/*
 	 * Process a stream of rows from the binary log.
 	 */
 	while (true) {
 		if (applier->pending_msg_cnt == 0) {
-			fiber_cond_wait(&applier->msg_cond);
+			/*
+			 * Don't hold the order latch while waiting for
+			 * the master.
+			 */
+			if (applier->apply_pool != NULL) {
+				applier_apply_pool_drain(applier->apply_pool);
+				if (applier_apply_pool_check(
+						applier->apply_pool) != 0)
+					diag_raise();
+			}
+			if (applier->pending_msg_cnt == 0)
+				fiber_cond_wait(&applier->msg_cond);
 		}
 		fiber_testcancel();
 		struct applier_msg *msg = applier_thread_msg_take(applier);
@@ -2529,6 +3439,8 @@ applier_f(va_list ap)
 				strcmp(INSTANCE_NAME, cfg_instance_name) != 0;
 			if (need_id || need_name)
 				applier_register(applier, was_anon);
+			if (applier->need_resync)
+				applier_resync(applier);
 			applier_subscribe(applier);
 			/*
 			 * subscribe() has an infinite loop which
@@ -2622,8 +3534,16 @@ applier_f(va_list ap)
 			 * In that case node2 should retry connecting to node3,
 			 * and in the meantime try to get newer changes from
 			 * node1.
+			 *
+			 * If the master has collected the WALs the replica
+			 * needs and no other master has them, the replica
+			 * can resync its data instead of rejoining.
 			 */
 			applier_log_error(applier, e);
+			if (applier_needs_resync(applier)) {
+				say_info("will resync data on reconnect");
+				applier->need_resync = true;
+			}
 			applier_disconnect(applier, APPLIER_LOADING);
 			goto reconnect;
 		} catch (FiberIsCancelled *e) {
@@ -2707,6 +3627,10 @@ applier_new(const struct uri *uri)
 	rlist_create(&applier->on_state);
 	fiber_cond_create(&applier->resume_cond);
 	diag_create(&applier->diag);
+	for (int i = 0; i < applier_latency_stage_MAX; i++) {
+		if (latency_create(&applier->latency[i]) != 0)
+			panic("Applier failed to allocate latency histogram");
+	}
 
 	return applier;
 }
@@ -2721,6 +3645,8 @@ applier_delete(struct applier *applier)
 	uri_destroy(&applier->uri);
 	trigger_destroy(&applier->on_state);
 	diag_destroy(&applier->diag);
+	for (int i = 0; i < applier_latency_stage_MAX; i++)
+		latency_destroy(&applier->latency[i]);
 	free(applier);
 }
 
@@ -39,6 +39,7 @@
 
 #include "fiber_cond.h"
 #include "iostream.h"
+#include "latency.h"
 #include "trigger.h"
 #include "trivia/util.h"
 #include "tt_uuid.h"
@@ -47,6 +48,7 @@
 #include "cbus.h"
 
 #include "xrow.h"
+#include "xrow_io.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -72,11 +74,38 @@ enum { APPLIER_SOURCE_MAXLEN = 1024 }; /* enough to fit URI with passwords */
 	_(APPLIER_WAIT_SNAPSHOT, 14)                                 \
 	_(APPLIER_REGISTER, 15)                                      \
 	_(APPLIER_REGISTERED, 16)                                    \
+	_(APPLIER_RESYNC, 17)                                        \
 
 /** States for the applier */
 ENUM(applier_state, applier_STATE);
 extern const char *applier_state_strs[];
 
+/**
+ * Stages of a replicated transaction whose latency is traced by the
+ * applier, see replication_latency_is_sampled().
+ */
+enum applier_latency_stage {
+	/**
+	 * From the write to the master WAL to the receipt of the last
+	 * transaction row. Measured with the realtime clocks of the master
+	 * and the replica, so it includes the difference between them.
+	 */
+	APPLIER_LATENCY_NETWORK,
+	/**
+	 * From the receipt of the last transaction row to the start of
+	 * applying the transaction, including decoding and queueing.
+	 */
+	APPLIER_LATENCY_DECODE,
+	/** From the start of applying to the submission to the WAL. */
+	APPLIER_LATENCY_APPLY,
+	/** From the submission to the WAL to the end of the write. */
+	APPLIER_LATENCY_WAL,
+	applier_latency_stage_MAX,
+};
+
+/** Stage names by enum applier_latency_stage. */
+extern const char *applier_latency_stage_strs[];
+
 /** A base message used in applier-thread <-> tx communication. */
 struct applier_msg {
 	struct cmsg base;
@@ -163,12 +192,22 @@ struct applier {
 	uint32_t version_id;
 	/** Remote instance features. */
 	struct iproto_features features;
+	/**
+	 * Compression of the stream received from the master, see
+	 * enum replication_compression.
+	 */
+	uint32_t compression;
 	/** Remote ballot at the time of connect. */
 	struct ballot ballot;
 	/** The fiber responsible for ballot updates. */
 	struct fiber *ballot_watcher;
 	/** Last requested vclock sync. */
 	uint64_t last_vclock_sync;
+	/**
+	 * Latency of the stages of the sampled transactions received from
+	 * the master, see enum applier_latency_stage. Tx thread only.
+	 */
+	struct latency latency[applier_latency_stage_MAX];
 	/** Remote address */
 	union {
 		struct sockaddr addr;
@@ -191,6 +230,11 @@ struct applier {
 	bool is_paused;
 	/** Condition variable signaled to resume the applier. */
 	struct fiber_cond resume_cond;
+	/**
+	 * Set if the master has collected the WALs the replica needs
+	 * and the replica has to resync its data on reconnect.
+	 */
+	bool need_resync;
 	/* Diag to raise an error. */
 	struct diag diag;
 	/* Master's vclock at the time of SUBSCRIBE. */
@@ -220,6 +264,11 @@ struct applier {
 	bool is_ack_sent;
 	/** True if ACK was signalled in tx while ack_msg was en route. */
 	bool is_ack_pending;
+	/**
+	 * Fibers applying independent transactions concurrently or NULL
+	 * if replication_apply_fibers is 1.
+	 */
+	struct applier_apply_pool *apply_pool;
 	/** Fields used only by applier thread. */
 	struct {
 		alignas(CACHELINE_SIZE)
@@ -231,6 +280,11 @@ struct applier {
 		struct applier_data_msg msgs[2];
 		/** The input buffer used in thread to read rows. */
 		struct ibuf ibuf;
+		/**
+		 * Decompressor of the stream. Used only if the stream is
+		 * compressed.
+		 */
+		struct xrow_decompressor decompressor;
 		/** The lsregion for allocating rows in thread. */
 		struct lsregion lsr;
 		/** A growing identifier to track lsregion allocations. */
@@ -45,6 +45,7 @@
 #include "recovery.h"
 #include "wal.h"
 #include "relay.h"
+#include "relay_feed.h"
 #include "applier.h"
 #include <rmean.h>
 #include "main.h"
@@ -73,6 +74,8 @@
 #include "xrow.h"
 #include "xrow_io.h"
 #include "xstream.h"
+#include "read_view.h"
+#include "resync.h"
 #include "authentication.h"
 #include "security.h"
 #include "path_lock.h"
@@ -84,6 +87,7 @@
 #include "func.h"
 #include "sequence.h"
 #include "sql_stmt_cache.h"
+#include "sql_cursor.h"
 #include "msgpack.h"
 #include "raft.h"
 #include "watcher.h"
@@ -94,6 +98,7 @@
 #include "flightrec.h"
 #include "wal_ext.h"
 #include "mp_util.h"
+#include "small/ibuf.h"
 #include "small/static.h"
 #include "memory.h"
 #include "node_name.h"
@@ -160,11 +165,18 @@ static fiber_cond ro_cond;
  */
 static bool is_orphan;
 
+/**
+ * The following flag is set while the instance resyncs its data
+ * with a master, see box_set_resync().
+ */
+static bool is_resync;
+
 /**
  * Summary flag incorporating all the instance attributes,
  * affecting ability to write. Currently these are:
  * - is_ro;
  * - is_orphan;
+ * - is_resync;
  */
 static bool is_ro_summary = true;
 
@@ -313,8 +325,8 @@ void
 box_update_ro_summary(void)
 {
 	bool old_is_ro_summary = is_ro_summary;
-	is_ro_summary = is_ro || is_orphan || raft_is_ro(box_raft()) ||
-			txn_limbo_is_ro(&txn_limbo);
+	is_ro_summary = is_ro || is_orphan || is_resync ||
+			raft_is_ro(box_raft()) || txn_limbo_is_ro(&txn_limbo);
 	/* In 99% nothing changes. Filter this out first. */
 	if (is_ro_summary == old_is_ro_summary)
 		return;
@@ -338,6 +350,8 @@ box_ro_reason(void)
 		return "config";
 	if (is_orphan)
 		return "orphan";
+	if (is_resync)
+		return "resync";
 	return NULL;
 }
 
@@ -415,6 +429,8 @@ box_check_writable(void)
 			error_append_msg(e, "box.cfg.read_only is true");
 		else if (is_orphan)
 			error_append_msg(e, "it is an orphan");
+		else if (is_resync)
+			error_append_msg(e, "it is resyncing data");
 		else
 			assert(false);
 	}
@@ -541,6 +557,13 @@ box_do_set_orphan(bool orphan)
 	}
 }
 
+void
+box_set_resync(bool resync)
+{
+	is_resync = resync;
+	box_update_ro_summary();
+}
+
 void
 box_set_orphan(bool orphan)
 {
@@ -1240,6 +1263,103 @@ box_check_replication_threads(void)
 	return 0;
 }
 
+static int
+box_check_replication_apply_fibers(void)
+{
+	int count = cfg_geti("replication_apply_fibers");
+	if (count <= 0 || count > REPLICATION_APPLY_FIBERS_MAX) {
+		diag_set(ClientError, ER_CFG, "replication_apply_fibers",
+			 tt_sprintf("must be greater than 0, less than or "
+				    "equal to %d", REPLICATION_APPLY_FIBERS_MAX));
+		return -1;
+	}
+	return 0;
+}
+
+static int64_t
+box_check_replication_relay_buffer_size(void)
+{
+	int64_t size = cfg_geti64("replication_relay_buffer_size");
+	if (size < 0) {
+		diag_set(ClientError, ER_CFG, "replication_relay_buffer_size",
+			 "the value must be greater than or equal to zero");
+		return -1;
+	}
+	return size;
+}
+
+static int
+box_check_replication_spaces(void)
+{
+	/*
+	 * A replica replicating a part of the user spaces must not count
+	 * toward the synchronous quorum and must not be elected, because
+	 * it doesn't have the rows of the other spaces.
+	 */
+	if (cfg_getb("replication_spaces") &&
+	    (cfg_geti("replication_anon") == 0 || cfg_geti("read_only") == 0)) {
+		diag_set(ClientError, ER_CFG, "replication_spaces",
+			 "the value may be set only when replication_anon is "
+			 "true and the instance is read-only");
+		return -1;
+	}
+	int count = cfg_getarr_size("replication_spaces");
+	for (int i = 0; i < count; i++) {
+		const char *space = cfg_getarr_elem("replication_spaces", i);
+		if (space == NULL || *space == '\0') {
+			diag_set(ClientError, ER_CFG, "replication_spaces",
+				 "expected an array of space ids or names");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/** Check if a replication_spaces element is a space id. */
+static bool
+box_replication_space_is_id(const char *space)
+{
+	for (const char *c = space; *c != '\0'; c++) {
+		if (!isdigit((unsigned char)*c))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Encode the replication_spaces option to the MsgPack array sent to the
+ * master on subscribe.
+ */
+static void
+box_set_replication_spaces(void)
+{
+	const char *name = "replication_spaces";
+	/* Any value except nil is true, including an empty array. */
+	if (!cfg_getb(name))
+		return;
+	int count = cfg_getarr_size(name);
+	size_t size = mp_sizeof_array(count);
+	for (int i = 0; i < count; i++) {
+		const char *space = cfg_getarr_elem(name, i);
+		if (box_replication_space_is_id(space))
+			size += mp_sizeof_uint(strtoull(space, NULL, 10));
+		else
+			size += mp_sizeof_str(strlen(space));
+	}
+	char *data = (char *)xmalloc(size);
+	char *end = mp_encode_array(data, count);
+	for (int i = 0; i < count; i++) {
+		const char *space = cfg_getarr_elem(name, i);
+		if (box_replication_space_is_id(space))
+			end = mp_encode_uint(end, strtoull(space, NULL, 10));
+		else
+			end = mp_encode_str0(end, space);
+	}
+	assert(end == data + size);
+	replication_space_filter = data;
+	replication_space_filter_end = end;
+}
+
 /** Check bootstrap_strategy option validity. */
 static enum bootstrap_strategy
 box_check_bootstrap_strategy(void)
@@ -1259,6 +1379,22 @@ box_check_bootstrap_strategy(void)
 	return BOOTSTRAP_STRATEGY_INVALID;
 }
 
+/** Check replication_compression option validity. */
+static enum replication_compression
+box_check_replication_compression(void)
+{
+	const char *str = cfg_gets("replication_compression");
+	int compression = strindex(replication_compression_strs, str,
+				   replication_compression_MAX);
+	if (compression == replication_compression_MAX) {
+		diag_set(ClientError, ER_CFG, "replication_compression",
+			 "the value should be one of the following: "
+			 "'none', 'zstd'");
+		return REPLICATION_COMPRESSION_INVALID;
+	}
+	return (enum replication_compression)compression;
+}
+
 static int
 box_check_listen(struct uri_set *uri_set)
 {
@@ -1480,6 +1616,11 @@ box_check_replication_anon(void)
 			  "the value may be set to true only when "
 			  "the instance is read-only");
 	}
+	if (!anon && cfg_getb("replication_spaces")) {
+		tnt_raise(ClientError, ER_CFG, "replication_anon",
+			  "the value may be set to false only when "
+			  "replication_spaces is not set");
+	}
 	return anon;
 }
 
@@ -1650,6 +1791,17 @@ box_check_memory_quota(const char *quota_name)
 	return -1;
 }
 
+static double
+box_check_vinyl_write_latency_target(void)
+{
+	double target = cfg_getd("vinyl_write_latency_target");
+	if (target < 0) {
+		tnt_raise(ClientError, ER_CFG, "vinyl_write_latency_target",
+			  "must be greater than or equal to 0");
+	}
+	return target;
+}
+
 static void
 box_check_vinyl_options(void)
 {
@@ -1689,6 +1841,7 @@ box_check_vinyl_options(void)
 		tnt_raise(ClientError, ER_CFG, "vinyl_bloom_fpr",
 			  "must be greater than 0 and less than or equal to 1");
 	}
+	box_check_vinyl_write_latency_target();
 }
 
 static int
@@ -1702,6 +1855,18 @@ box_check_sql_cache_size(int size)
 	return 0;
 }
 
+static double
+box_check_sql_cursor_idle_timeout(void)
+{
+	double timeout = cfg_getd("sql_cursor_idle_timeout");
+	if (timeout <= 0) {
+		diag_set(ClientError, ER_CFG, "sql_cursor_idle_timeout",
+			 "must be greater than 0");
+		return -1;
+	}
+	return timeout;
+}
+
 static int
 box_check_allocator(void)
 {
@@ -1882,9 +2047,18 @@ box_check_config(void)
 		diag_raise();
 	if (box_check_replication_threads() < 0)
 		diag_raise();
+	if (box_check_replication_apply_fibers() < 0)
+		diag_raise();
+	if (box_check_replication_spaces() != 0)
+		diag_raise();
+	if (box_check_replication_relay_buffer_size() < 0)
+		diag_raise();
 	box_check_replication_sync_timeout();
 	if (box_check_bootstrap_strategy() == BOOTSTRAP_STRATEGY_INVALID)
 		diag_raise();
+	if (box_check_replication_compression() ==
+	    REPLICATION_COMPRESSION_INVALID)
+		diag_raise();
 	if (box_check_bootstrap_leader(&uri, &uuid, name) != 0)
 		diag_raise();
 	uri_destroy(&uri);
@@ -1907,6 +2081,8 @@ box_check_config(void)
 		diag_raise();
 	if (box_check_sql_cache_size(cfg_geti("sql_cache_size")) != 0)
 		diag_raise();
+	if (box_check_sql_cursor_idle_timeout() < 0)
+		diag_raise();
 	if (box_check_txn_timeout() < 0)
 		diag_raise();
 	if (box_check_txn_isolation() == txn_isolation_level_MAX)
@@ -1945,6 +2121,14 @@ box_set_election_timeout(void)
 	return 0;
 }
 
+int
+box_set_election_leader_lease(void)
+{
+	raft_cfg_is_lease_enabled(box_raft(),
+				  cfg_getb("election_leader_lease") == 1);
+	return 0;
+}
+
 int
 box_set_election_fencing_mode(void)
 {
@@ -2064,6 +2248,17 @@ box_set_bootstrap_strategy(void)
 	return 0;
 }
 
+int
+box_set_replication_compression(void)
+{
+	enum replication_compression compression =
+		box_check_replication_compression();
+	if (compression == REPLICATION_COMPRESSION_INVALID)
+		return -1;
+	replication_compression = compression;
+	return 0;
+}
+
 static int
 box_set_bootstrap_leader(void)
 {
@@ -2629,12 +2824,9 @@ box_wait_vclock_f(struct trigger *trigger, void *event)
 	return 0;
 }
 
-/**
- * Wait until this instance's vclock reaches @a vclock or @a deadline is
- * reached.
- */
-static int
-box_wait_vclock(const struct vclock *vclock, double deadline)
+int
+box_wait_vclock(const struct vclock *vclock, double deadline,
+		const bool *is_aborted)
 {
 	if (vclock_compare_ignore0(vclock, &replicaset.vclock) <= 0)
 		return 0;
@@ -2646,12 +2838,13 @@ box_wait_vclock(const struct vclock *vclock, double deadline)
 	};
 	trigger_create(&on_wal_write, box_wait_vclock_f, &data, NULL);
 	trigger_add(&wal_on_write, &on_wal_write);
-	do {
+	while (!data.is_ready && !fiber_is_cancelled() &&
+	       (is_aborted == NULL || !*is_aborted)) {
 		if (fiber_yield_deadline(deadline))
 			break;
-	} while (!data.is_ready && !fiber_is_cancelled());
+	}
 	trigger_clear(&on_wal_write);
-	if (fiber_is_cancelled()) {
+	if (fiber_is_cancelled() || (is_aborted != NULL && *is_aborted)) {
 		diag_set(FiberIsCancelled);
 		return -1;
 	}
@@ -2669,13 +2862,23 @@ box_wait_linearization_point(double timeout)
 	struct vclock confirmed_vclock;
 	vclock_create(&confirmed_vclock);
 	/*
-	 * First find out the vclock which might be confirmed on remote
-	 * instances.
+	 * A leader holding a valid lease and owning the limbo already has all
+	 * the confirmed rows, because no one else could become a leader and
+	 * write anything meanwhile. Skip the round trip to the quorum then.
+	 */
+	bool is_lease_valid = raft_lease_remaining(box_raft()) > 0 &&
+			      txn_limbo.owner_id == instance_id &&
+			      !txn_limbo_is_ro(&txn_limbo);
+	/*
+	 * Otherwise first find out the vclock which might be confirmed on
+	 * remote instances.
 	 */
-	if (box_collect_confirmed_vclock(&confirmed_vclock, deadline) != 0)
+	if (!is_lease_valid &&
+	    box_collect_confirmed_vclock(&confirmed_vclock, deadline) != 0)
 		return -1;
 	/* Then wait until all the rows up to this vclock are received. */
-	if (box_wait_vclock(&confirmed_vclock, deadline) != 0)
+	if (!is_lease_valid &&
+	    box_wait_vclock(&confirmed_vclock, deadline, NULL) != 0)
 		return -1;
 	/*
 	 * Finally, wait until all the synchronous transactions, which should be
@@ -3133,6 +3336,15 @@ box_set_vinyl_timeout(void)
 	vinyl_engine_set_timeout(vinyl,	cfg_getd("vinyl_timeout"));
 }
 
+void
+box_set_vinyl_write_latency_target(void)
+{
+	double target = box_check_vinyl_write_latency_target();
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_write_latency_target(vinyl, target);
+}
+
 void
 box_set_force_recovery(void)
 {
@@ -3160,6 +3372,16 @@ box_set_prepared_stmt_cache_size(void)
 	return 0;
 }
 
+int
+box_set_sql_cursor_idle_timeout(void)
+{
+	double timeout = box_check_sql_cursor_idle_timeout();
+	if (timeout < 0)
+		return -1;
+	sql_cursor_set_idle_timeout(timeout);
+	return 0;
+}
+
 /**
  * Report crash information to the feedback daemon
  * (ie send it to feedback daemon).
@@ -4127,6 +4349,19 @@ box_process_auth(struct auth_request *request,
 		diag_raise();
 }
 
+/**
+ * An instance replicating a part of the user spaces has NOPs in place of
+ * the rows of the other spaces, so it must not feed other replicas.
+ */
+static void
+box_check_space_filter_relay(void)
+{
+	if (replication_space_filter != NULL) {
+		tnt_raise(ClientError, ER_UNSUPPORTED,
+			  "Replica with replication_spaces", "followers");
+	}
+}
+
 void
 box_process_fetch_snapshot(struct iostream *io,
 			   const struct xrow_header *header)
@@ -4136,6 +4371,7 @@ box_process_fetch_snapshot(struct iostream *io,
 	/* Check that bootstrap has been finished */
 	if (!is_box_configured)
 		tnt_raise(ClientError, ER_LOADING);
+	box_check_space_filter_relay();
 
 	/* Check permissions */
 	access_check_universe_xc(PRIV_R);
@@ -4262,6 +4498,41 @@ box_process_register(struct iostream *io, const struct xrow_header *header)
 	gc_guard.is_active = false;
 }
 
+/** Stops space_foreach() at the first vinyl space storing data. */
+static int
+box_find_vinyl_data(struct space *space, void *arg)
+{
+	if (!space_is_vinyl(space) || space_is_local(space) ||
+	    space_index(space, 0) == NULL ||
+	    index_size(space_index(space, 0)) == 0)
+		return 0;
+	*(bool *)arg = true;
+	return 1;
+}
+
+/**
+ * Return the checkpoint whose snapshot file can be sent to a joining
+ * replica instead of initial join rows or NULL if the replica has to
+ * be joined by rows. The snapshot stores only memtx data, vinyl runs
+ * are bound to the master vylog, so the file isn't used if there's
+ * any data in vinyl.
+ */
+static struct gc_checkpoint *
+box_checkpoint_join_checkpoint(void)
+{
+	struct gc_checkpoint *checkpoint = gc_last_checkpoint();
+	if (checkpoint == NULL)
+		return NULL;
+	bool has_vinyl_data = false;
+	space_foreach(box_find_vinyl_data, &has_vinyl_data);
+	if (has_vinyl_data) {
+		say_info("vinyl spaces aren't empty, "
+			 "falling back to join by rows");
+		return NULL;
+	}
+	return checkpoint;
+}
+
 void
 box_process_join(struct iostream *io, const struct xrow_header *header)
 {
@@ -4300,6 +4571,15 @@ box_process_join(struct iostream *io, const struct xrow_header *header)
 	 *      - `current_vclock` - master's vclock after final stage.
 	 *
 	 * All packets must have the same SYNC value as initial JOIN request.
+	 * If the replica sets CHECKPOINT_JOIN in the request and all data
+	 * is stored in memtx, the initial stage is replaced with
+	 *
+	 * <= OK { VCLOCK: start_vclock } - vclock of the last checkpoint.
+	 * <= JOIN_FILE { FILE_SIZE: size }
+	 *    Followed by `size` bytes of the checkpoint snapshot file.
+	 *
+	 * and the final stage sends WAL rows written after the checkpoint.
+	 *
 	 * Master can send ERROR at any time. Replica doesn't confirm rows
 	 * by OKs. Either initial or final stream includes:
 	 *  - Cluster UUID in _schema space
@@ -4311,6 +4591,7 @@ box_process_join(struct iostream *io, const struct xrow_header *header)
 
 	struct join_request req;
 	xrow_decode_join_xc(header, &req);
+	box_check_space_filter_relay();
 
 	/* Check that bootstrap has been finished */
 	if (!is_box_configured)
@@ -4358,11 +4639,17 @@ box_process_join(struct iostream *io, const struct xrow_header *header)
 				  tt_uuid_str(&other->uuid));
 		}
 	}
+	struct gc_checkpoint *checkpoint = NULL;
+	if (req.is_checkpoint_join)
+		checkpoint = box_checkpoint_join_checkpoint();
+	const struct vclock *gc_vclock = checkpoint != NULL ?
+					 &checkpoint->vclock :
+					 &replicaset.vclock;
 	/*
 	 * Register the replica as a WAL consumer so that
 	 * it can resume FINAL JOIN where INITIAL JOIN ends.
 	 */
-	struct gc_consumer *gc = gc_consumer_register(&replicaset.vclock,
+	struct gc_consumer *gc = gc_consumer_register(gc_vclock,
 				"replica %s", tt_uuid_str(&req.instance_uuid));
 	if (gc == NULL)
 		diag_raise();
@@ -4375,7 +4662,18 @@ box_process_join(struct iostream *io, const struct xrow_header *header)
 	 * Initial stream: feed replica with dirty data from engines.
 	 */
 	struct vclock start_vclock;
-	relay_initial_join(io, header->sync, &start_vclock, req.version_id);
+	if (checkpoint != NULL) {
+		struct memtx_engine *memtx =
+			(struct memtx_engine *)engine_by_name("memtx");
+		vclock_copy(&start_vclock, &checkpoint->vclock);
+		relay_checkpoint_join(io, header->sync, checkpoint,
+				      xdir_format_filename(&memtx->snap_dir,
+						vclock_sum(&start_vclock),
+						NONE));
+	} else {
+		relay_initial_join(io, header->sync, &start_vclock,
+				   req.version_id);
+	}
 	say_info("initial data sent.");
 	/**
 	 * Register the replica after sending the last row but before sending
@@ -4422,6 +4720,204 @@ box_process_join(struct iostream *io, const struct xrow_header *header)
 	gc_guard.is_active = false;
 }
 
+/** Spaces served to a resyncing replica. */
+static bool
+box_resync_space_filter(struct space *space, void *arg)
+{
+	(void)arg;
+	return space_is_memtx(space) && !space_is_local(space) &&
+	       space_index(space, 0) != NULL;
+}
+
+/** Only primary keys are needed to resync a replica. */
+static bool
+box_resync_index_filter(struct space *space, struct index *index, void *arg)
+{
+	(void)space;
+	(void)arg;
+	return index->def->iid == 0;
+}
+
+void
+box_process_resync(struct iostream *io, const struct xrow_header *header)
+{
+	/*
+	 * RESYNC protocol diagram
+	 * =======================
+	 *
+	 * Replica => Master
+	 *
+	 * => RESYNC { REPLICASET_UUID, INSTANCE_UUID, VCLOCK }
+	 * <= OK { VCLOCK: rv_vclock }
+	 *    The master opened a read view of its data at rv_vclock and
+	 *    keeps the WALs written after it.
+	 *
+	 * => RESYNC_HASH { SPACE_ID, KEY, KEY_END, LIMIT }
+	 * <= OK { DATA: [[key, count, hash], ...] }
+	 * => RESYNC_FETCH { SPACE_ID, KEY, KEY_END }
+	 * <= OK { DATA: [tuple, ...] }
+	 *    ...
+	 *    The replica compares key ranges of the read view with its
+	 *    own data and fetches the ranges that differ.
+	 *    ...
+	 * => SUBSCRIBE { VCLOCK: rv_vclock }
+	 *    The replica follows the master from the read view vclock as
+	 *    usual.
+	 */
+	assert(header->type == IPROTO_RESYNC);
+
+	struct resync_request req;
+	xrow_decode_resync_xc(header, &req);
+
+	/* Check that bootstrap has been finished */
+	if (!is_box_configured)
+		tnt_raise(ClientError, ER_LOADING);
+
+	/* Forbid connection to itself */
+	if (tt_uuid_is_equal(&req.instance_uuid, &INSTANCE_UUID))
+		tnt_raise(ClientError, ER_CONNECTION_TO_SELF);
+
+	if (!tt_uuid_is_equal(&req.replicaset_uuid, &REPLICASET_UUID)) {
+		tnt_raise(ClientError, ER_REPLICASET_UUID_MISMATCH,
+			  tt_uuid_str(&REPLICASET_UUID),
+			  tt_uuid_str(&req.replicaset_uuid));
+	}
+
+	/* Check permissions */
+	access_check_universe_xc(PRIV_R);
+
+	/* Only registered replicas can resync, like subscribe. */
+	struct replica *replica = replica_by_uuid(&req.instance_uuid);
+	if (replica == NULL || replica->id == REPLICA_ID_NIL) {
+		tnt_raise(ClientError, ER_TOO_EARLY_SUBSCRIBE,
+			  tt_uuid_str(&req.instance_uuid));
+	}
+	/* Don't allow multiple relays for the same replica */
+	if (relay_get_state(replica->relay) == RELAY_FOLLOW) {
+		tnt_raise(ClientError, ER_CFG, "replication",
+			  "duplicate connection with the same replica UUID");
+	}
+	/* Forbid replication with disabled WAL */
+	if (wal_mode() == WAL_NONE) {
+		tnt_raise(ClientError, ER_UNSUPPORTED, "Replication",
+			  "wal_mode = 'none'");
+	}
+	/*
+	 * Vinyl data isn't served from a read view, a replica lagging
+	 * behind a master storing it has to rejoin.
+	 */
+	bool has_vinyl_data = false;
+	space_foreach(box_find_vinyl_data, &has_vinyl_data);
+	if (has_vinyl_data)
+		tnt_raise(ClientError, ER_UNSUPPORTED, "Resync", "vinyl spaces");
+
+	say_info("resyncing replica %s at %s",
+		 tt_uuid_str(&req.instance_uuid), sio_socketname(io->fd));
+	say_info("remote vclock %s", vclock_to_string(&req.vclock));
+
+	struct read_view rv;
+	struct read_view_opts rv_opts;
+	read_view_opts_create(&rv_opts);
+	rv_opts.name = "resync";
+	rv_opts.is_system = true;
+	rv_opts.filter_space = box_resync_space_filter;
+	rv_opts.filter_index = box_resync_index_filter;
+	if (read_view_open(&rv, &rv_opts) != 0)
+		diag_raise();
+	bool is_rv_open = true;
+	auto rv_guard = make_scoped_guard([&] {
+		if (is_rv_open)
+			read_view_close(&rv);
+	});
+	/*
+	 * Sync WAL to make sure that all changes visible from the read
+	 * view are committed and obtain the corresponding vclock.
+	 */
+	struct vclock vclock;
+	if (wal_sync(&vclock) != 0)
+		diag_raise();
+	if (txn_limbo_wait_confirm(&txn_limbo) != 0)
+		diag_raise();
+	/*
+	 * Keep the WALs written after the read view so that the replica
+	 * can subscribe from its vclock when it's done.
+	 */
+	struct gc_consumer *gc = gc_consumer_register(&vclock, "replica %s",
+					tt_uuid_str(&req.instance_uuid));
+	if (gc == NULL)
+		diag_raise();
+	if (replica->gc != NULL)
+		gc_consumer_unregister(replica->gc);
+	else
+		gc_delay_unref();
+	replica->gc = gc;
+
+	struct xrow_header row;
+	RegionGuard region_guard(&fiber()->gc);
+	xrow_encode_vclock(&row, &vclock);
+	row.sync = header->sync;
+	coio_write_xrow(io, &row);
+
+	struct ibuf ibuf;
+	ibuf_create(&ibuf, &cord()->slabc, 16 * 1024);
+	auto ibuf_guard = make_scoped_guard([&] { ibuf_destroy(&ibuf); });
+	resync_serve(io, &ibuf, &rv, &row);
+	read_view_close(&rv);
+	is_rv_open = false;
+	if (row.type != IPROTO_SUBSCRIBE) {
+		tnt_raise(ClientError, ER_PROTOCOL,
+			  "Invalid request after resync");
+	}
+	say_info("replica %s resynced", tt_uuid_str(&req.instance_uuid));
+	box_process_subscribe(io, &row);
+}
+
+static int
+box_space_id_cmp(const void *a, const void *b)
+{
+	uint32_t id_a = *(const uint32_t *)a;
+	uint32_t id_b = *(const uint32_t *)b;
+	return id_a < id_b ? -1 : id_a > id_b;
+}
+
+/**
+ * Resolve the space filter of a SUBSCRIBE request, which is a MsgPack
+ * array of space ids and names, to a sorted array of space ids. The
+ * names are resolved at the moment of subscribe. The returned array
+ * must be freed by the caller.
+ */
+static uint32_t *
+box_decode_space_filter(const char *data, uint32_t *size)
+{
+	uint32_t count = mp_decode_array(&data);
+	uint32_t *ids = (uint32_t *)xmalloc((count + 1) * sizeof(*ids));
+	auto ids_guard = make_scoped_guard([&] { free(ids); });
+	for (uint32_t i = 0; i < count; i++) {
+		if (mp_typeof(*data) == MP_UINT) {
+			uint64_t id = mp_decode_uint(&data);
+			if (id > UINT32_MAX) {
+				tnt_raise(ClientError, ER_NO_SUCH_SPACE,
+					  tt_sprintf("%llu",
+						     (unsigned long long)id));
+			}
+			ids[i] = id;
+			continue;
+		}
+		uint32_t len;
+		const char *name = mp_decode_str(&data, &len);
+		struct space *space = space_by_name(name, len);
+		if (space == NULL) {
+			tnt_raise(ClientError, ER_NO_SUCH_SPACE,
+				  tt_cstr(name, len));
+		}
+		ids[i] = space_id(space);
+	}
+	qsort(ids, count, sizeof(*ids), box_space_id_cmp);
+	ids_guard.is_active = false;
+	*size = count;
+	return ids;
+}
+
 void
 box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 {
@@ -4430,6 +4926,7 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 	/* Check that bootstrap has been finished */
 	if (!is_box_configured)
 		tnt_raise(ClientError, ER_LOADING);
+	box_check_space_filter_relay();
 
 	struct subscribe_request req;
 	xrow_decode_subscribe_xc(header, &req);
@@ -4520,6 +5017,36 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 		tnt_raise(ClientError, ER_UNSUPPORTED, "Replication",
 			  "wal_mode = 'none'");
 	}
+	if (req.compression >= replication_compression_MAX) {
+		tnt_raise(ClientError, ER_UNSUPPORTED, "Replication",
+			  tt_sprintf("compression %u", req.compression));
+	}
+	uint32_t space_filter_size = 0;
+	uint32_t *space_filter = NULL;
+	/* See box_check_replication_spaces(). */
+	if (req.space_filter != NULL && !req.is_anon) {
+		tnt_raise(ClientError, ER_UNSUPPORTED, "Replication",
+			  "space filter for a non-anonymous replica");
+	}
+	if (req.space_filter != NULL) {
+		space_filter = box_decode_space_filter(req.space_filter,
+						       &space_filter_size);
+	}
+	auto space_filter_guard = make_scoped_guard([&] {
+		free(space_filter);
+	});
+	/*
+	 * All the rows sent after the response to SUBSCRIBE are
+	 * compressed if the replica asked for it.
+	 */
+	bool is_compressed = req.compression != REPLICATION_COMPRESSION_NONE;
+	struct xrow_compressor compressor;
+	if (is_compressed && xrow_compressor_create(&compressor) != 0)
+		diag_raise();
+	auto compressor_guard = make_scoped_guard([&] {
+		if (is_compressed)
+			xrow_compressor_destroy(&compressor);
+	});
 	/*
 	 * Send a response to SUBSCRIBE request, tell
 	 * the replica how many rows we have in stock for it,
@@ -4556,6 +5083,14 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 		 tt_uuid_str(&req.instance_uuid), sio_socketname(io->fd));
 	say_info("remote vclock %s local vclock %s",
 		 vclock_to_string(&req.vclock), vclock_to_string(&rsp.vclock));
+	if (is_compressed) {
+		say_info("compressing the stream with %s",
+			 replication_compression_strs[req.compression]);
+	}
+	if (space_filter != NULL) {
+		say_info("relaying the rows of %u user spaces",
+			 space_filter_size);
+	}
 	uint64_t sent_raft_term = 0;
 	if (req.version_id >= version_id(2, 6, 0) && !req.is_anon) {
 		/*
@@ -4568,7 +5103,10 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 		struct raft_request req;
 		box_raft_checkpoint_remote(&req);
 		xrow_encode_raft(&row, &fiber()->gc, &req);
-		coio_write_xrow(io, &row);
+		if (is_compressed)
+			coio_write_xrow_compressed(io, &compressor, &row);
+		else
+			coio_write_xrow(io, &row);
 		sent_raft_term = req.term;
 	}
 	/*
@@ -4601,7 +5139,9 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 	 * indefinitely).
 	 */
 	relay_subscribe(replica, io, header->sync, &req.vclock,
-			req.version_id, req.id_filter, sent_raft_term);
+			req.version_id, req.id_filter, space_filter,
+			space_filter_size, sent_raft_term,
+			is_compressed ? &compressor : NULL);
 }
 
 void
@@ -4709,6 +5249,7 @@ engine_init()
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
 	box_set_vinyl_timeout();
+	box_set_vinyl_write_latency_target();
 }
 
 /**
@@ -5272,12 +5813,16 @@ box_cfg_xc(void)
 
 	if (box_set_prepared_stmt_cache_size() != 0)
 		diag_raise();
+	if (box_set_sql_cursor_idle_timeout() != 0)
+		diag_raise();
 	box_set_net_msg_max();
 	box_set_readahead();
 	box_set_too_long_threshold();
 	box_set_replication_timeout();
 	if (box_set_bootstrap_strategy() != 0)
 		diag_raise();
+	if (box_set_replication_compression() != 0)
+		diag_raise();
 	if (box_set_bootstrap_leader() != 0)
 		diag_raise();
 	box_set_replication_connect_timeout();
@@ -5394,6 +5939,8 @@ box_cfg_xc(void)
 		diag_raise();
 	if (box_set_election_fencing_mode() != 0)
 		diag_raise();
+	if (box_set_election_leader_lease() != 0)
+		diag_raise();
 	/*
 	 * Election is enabled last. So as all the parameters are installed by
 	 * that time.
@@ -5733,6 +6280,12 @@ box_storage_init(void)
 	engine_init();
 	schema_init();
 	replication_init(cfg_geti_default("replication_threads", 1));
+	replication_apply_fibers =
+		cfg_geti_default("replication_apply_fibers", 1);
+	replication_checkpoint_join =
+		cfg_getb("replication_checkpoint_join") == 1;
+	replication_resync = cfg_getb("replication_resync") == 1;
+	box_set_replication_spaces();
 	port_init();
 	iproto_init(cfg_geti("iproto_threads"));
 	sql_init();
@@ -5743,6 +6296,7 @@ box_storage_init(void)
 	int64_t wal_max_size = box_check_wal_max_size(
 		cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
+	relay_feed_init(box_check_replication_relay_buffer_size());
 	if (wal_init(wal_mode, cfg_gets("wal_dir"), wal_max_size,
 		     &INSTANCE_UUID, on_wal_garbage_collection,
 		     on_wal_checkpoint_threshold) != 0) {
@@ -5762,6 +6316,7 @@ box_storage_free(void)
 	engine_shutdown();
 	/* schema_free(); */
 	wal_free();
+	relay_feed_free();
 	flightrec_free();
 	audit_log_free();
 	sql_built_in_functions_cache_free();
@@ -181,6 +181,13 @@ box_wait_ro(bool ro, double timeout);
 void
 box_set_orphan(bool orphan);
 
+/**
+ * Forbid or allow writes while the instance resyncs its data with
+ * a master, see applier_resync().
+ */
+void
+box_set_resync(bool resync);
+
 /**
  * Set orphan mode but don't update instance title.
  * \sa box_set_orphan
@@ -279,6 +286,18 @@ box_process_join(struct iostream *io, const struct xrow_header *header);
 void
 box_process_subscribe(struct iostream *io, const struct xrow_header *header);
 
+/**
+ * Resync a replica that can't follow the master anymore.
+ *
+ * Open a read view, answer the replica hash and fetch requests from
+ * it and subscribe the replica when it asks to.
+ *
+ * \param io I/O stream
+ * \param RESYNC packet header
+ */
+void
+box_process_resync(struct iostream *io, const struct xrow_header *header);
+
 void
 box_process_vote(struct ballot *ballot);
 
@@ -306,10 +325,12 @@ void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
 void box_set_vinyl_timeout(void);
+void box_set_vinyl_write_latency_target(void);
 void box_set_force_recovery(void);
 int box_set_election_mode(void);
 int box_set_election_timeout(void);
 int box_set_election_fencing_mode(void);
+int box_set_election_leader_lease(void);
 void box_set_replication_timeout(void);
 void box_set_replication_connect_timeout(void);
 void box_set_replication_connect_quorum(void);
@@ -325,11 +346,13 @@ void box_set_replicaset_name(void);
 void box_set_cluster_name(void);
 void box_set_net_msg_max(void);
 int box_set_prepared_stmt_cache_size(void);
+int box_set_sql_cursor_idle_timeout(void);
 int box_set_feedback(void);
 int box_set_txn_timeout(void);
 int box_set_txn_isolation(void);
 int box_set_auth_type(void);
 int box_set_bootstrap_strategy(void);
+int box_set_replication_compression(void);
 
 /**
  * Initialize logger on box init.
@@ -354,6 +377,16 @@ box_demote(void);
 int
 box_promote_qsync(void);
 
+/**
+ * Wait until this instance's vclock reaches @a vclock or @a deadline is
+ * reached. The vclock component 0 is ignored. If @a is_aborted is not
+ * NULL, the wait also stops as if the fiber was cancelled once the flag
+ * is set and the fiber is woken up.
+ */
+int
+box_wait_vclock(const struct vclock *vclock, double deadline,
+		const bool *is_aborted);
+
 /**
  * Wait for a linearization point. That is, wait until every operation that
  * might be committed on a quorum at the moment this function is called, reaches
@@ -325,6 +325,8 @@ struct errcode_record {
 	/*270 */_(ER_INSTANCE_NAME_MISMATCH,	"Instance name mismatch: expected %s, got %s") \
 	/*271 */_(ER_SCHEMA_NEEDS_UPGRADE,	"Your schema version is %u.%u.%u while Tarantool %s requires a more recent schema version. Please, consider using box.schema.upgrade().") \
 	/*272 */_(ER_SCHEMA_UPGRADE_IN_PROGRESS, "Schema upgrade is already in progress") \
+	/*273 */_(ER_NO_SUCH_SQL_CURSOR,	"SQL cursor with id %u does not exist") \
+	/*274 */_(ER_RIBBON_BUILD,		"Failed to build a ribbon filter of %u keys") \
 
 /*
  * !IMPORTANT! Please follow instructions at start of the file
@@ -30,6 +30,8 @@
  */
 #include "execute.h"
 
+#include <errno.h>
+
 #include "assoc.h"
 #include "bind.h"
 #include "iproto_constants.h"
@@ -46,9 +48,11 @@
 #include "sql/vdbe.h"
 #include "box/lua/execute.h"
 #include "box/sql_stmt_cache.h"
+#include "box/sql_cursor.h"
 #include "session.h"
 #include "rmean.h"
 #include "box/sql/port.h"
+#include "txn.h"
 
 const char *sql_info_key_strs[] = {
 	"row_count",
@@ -197,6 +201,23 @@ sql_execute(struct Vdbe *stmt, struct port *port, struct region *region)
 	return 0;
 }
 
+int
+sql_execute_rows(struct Vdbe *stmt, uint32_t row_count, struct port *port,
+		 struct region *region)
+{
+	assert(sql_column_count(stmt) > 0);
+	for (uint32_t i = 0; i < row_count; i++) {
+		int rc = sql_step(stmt);
+		if (rc == SQL_DONE)
+			return 0;
+		if (rc != SQL_ROW)
+			return -1;
+		if (sql_row_to_port(stmt, region, port) != 0)
+			return -1;
+	}
+	return 1;
+}
+
 int
 sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 		     uint32_t bind_count, struct port *port,
@@ -226,6 +247,7 @@ sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 	if (sql_bind(stmt, bind, bind_count) != 0)
 		return -1;
 	sql_reset_autoinc_id_list(stmt);
+	sql_stmt_count_execution(stmt);
 	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
 					       DQL_EXECUTE : DML_EXECUTE;
 	port_sql_create(port, stmt, format, false);
@@ -239,11 +261,389 @@ sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 	return 0;
 }
 
+enum {
+	/** Max nesting of parentheses in a parameterized statement. */
+	SQL_PARAMETERIZE_DEPTH_MAX = 64,
+};
+
+/** A significant token of a statement being parameterized. */
+struct sql_param_token {
+	/** Token type, one of TK_*. */
+	int type;
+	/** Offset of the token in the statement. */
+	uint32_t offset;
+	/** Length of the token. */
+	uint32_t len;
+};
+
+/** Return true if a literal preceded by the token is an operand. */
+static bool
+sql_param_token_is_comparison(int type)
+{
+	switch (type) {
+	case TK_EQ:
+	case TK_NE:
+	case TK_LT:
+	case TK_LE:
+	case TK_GT:
+	case TK_GE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Return true if the token can't continue an expression started
+ * by the preceding literal, i.e. the literal is a whole operand.
+ */
+static bool
+sql_param_token_ends_operand(int type)
+{
+	switch (type) {
+	case TK_SEMI:
+	case TK_RP:
+	case TK_COMMA:
+	case TK_AND:
+	case TK_OR:
+	case TK_WHERE:
+	case TK_GROUP:
+	case TK_HAVING:
+	case TK_ORDER:
+	case TK_LIMIT:
+	case TK_UNION:
+	case TK_EXCEPT:
+	case TK_INTERSECT:
+	case TK_WHEN:
+	case TK_THEN:
+	case TK_ELSE:
+	case TK_END:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Convert a literal to a bind. The conversion follows the one
+ * made by the code generator for literals.
+ * @retval 0 Success.
+ * @retval -1 The literal is out of range, no diag is set.
+ */
+static int
+sql_literal_to_bind(const char *z, uint32_t len, int type, bool is_neg,
+		    struct region *region, struct sql_bind *bind)
+{
+	memset(bind, 0, sizeof(*bind));
+	switch (type) {
+	case TK_INTEGER: {
+		int64_t value;
+		if (z[0] == '0' && (z[1] == 'x' || z[1] == 'X')) {
+			errno = 0;
+			if (is_neg)
+				value = strtoll(z, NULL, 16);
+			else
+				value = strtoull(z, NULL, 16);
+			if (errno != 0)
+				return -1;
+		} else {
+			bool unused;
+			if (sql_atoi64(z, &value, &unused, len) != 0 ||
+			    (is_neg &&
+			     (uint64_t)value > (uint64_t)INT64_MAX + 1))
+				return -1;
+		}
+		if (is_neg && value != 0) {
+			bind->type = MP_INT;
+			bind->i64 = value != INT64_MIN ? -value : value;
+		} else {
+			bind->type = MP_UINT;
+			bind->u64 = value;
+		}
+		return 0;
+	}
+	case TK_DECIMAL: {
+		char *str = xregion_alloc(region, len + 1);
+		memcpy(str, z, len);
+		str[len] = '\0';
+		decimal_t dec;
+		if (decimal_from_string(&dec, str) == NULL)
+			return -1;
+		if (is_neg)
+			decimal_minus(&bind->dec, &dec);
+		else
+			bind->dec = dec;
+		bind->type = MP_EXT;
+		bind->ext_type = MP_DECIMAL;
+		return 0;
+	}
+	case TK_FLOAT:
+		sqlAtoF(z, &bind->d, len);
+		if (is_neg)
+			bind->d = -bind->d;
+		bind->type = MP_DOUBLE;
+		return 0;
+	default: {
+		assert(type == TK_STRING);
+		assert(!is_neg && len >= 2);
+		char *str = xregion_alloc(region, len);
+		uint32_t size = 0;
+		for (uint32_t i = 1; i < len - 1; i++) {
+			str[size++] = z[i];
+			if (z[i] == '\'')
+				i++;
+		}
+		bind->type = MP_STR;
+		bind->s = str;
+		bind->bytes = size;
+		return 0;
+	}
+	}
+}
+
+/**
+ * Replace literals of an ad-hoc statement with parameters, so
+ * that statements which differ only in constants share a plan
+ * in the plan cache. Only literals which are whole operands of
+ * comparisons or items of IN and INSERT ... VALUES lists are
+ * replaced. Literals of result columns are kept since they
+ * define the result metadata, and so are ORDER BY, GROUP BY
+ * and LIMIT terms which affect the plan. Statements with
+ * parameters of their own are cached as is.
+ *
+ * @param sql SQL statement.
+ * @param len Length of the statement.
+ * @param region Region to allocate the result on.
+ * @param[out] out_sql Parameterized statement.
+ * @param[out] out_len Length of the parameterized statement.
+ * @param[out] out_bind Values of the replaced literals.
+ * @param[out] out_bind_count Number of the replaced literals.
+ *
+ * @retval 0 Success.
+ * @retval -1 The statement can't be cached, no diag is set.
+ */
+static int
+sql_stmt_parameterize(const char *sql, uint32_t len, struct region *region,
+		      const char **out_sql, uint32_t *out_len,
+		      struct sql_bind **out_bind, uint32_t *out_bind_count)
+{
+	char *str = xregion_alloc(region, len + 1);
+	memcpy(str, sql, len);
+	str[len] = '\0';
+	struct sql_param_token *tokens =
+		xregion_alloc_array(region, typeof(tokens[0]), len + 1);
+	uint32_t token_count = 0;
+	bool has_params = false;
+	for (uint32_t i = 0; i < len;) {
+		int type;
+		bool unused;
+		uint32_t n = sql_token(&str[i], &type, &unused);
+		if (type == TK_ILLEGAL)
+			return -1;
+		if (type != TK_SPACE && type != TK_LINEFEED) {
+			/* Only a single statement can be cached. */
+			if (token_count > 0 &&
+			    tokens[token_count - 1].type == TK_SEMI)
+				return -1;
+			if (type == TK_VARIABLE || type == TK_VARNUM ||
+			    type == TK_COLON)
+				has_params = true;
+			tokens[token_count].type = type;
+			tokens[token_count].offset = i;
+			tokens[token_count].len = n;
+			token_count++;
+		}
+		i += n;
+	}
+	if (token_count == 0)
+		return -1;
+	int stmt_type = tokens[0].type;
+	if (stmt_type != TK_SELECT && stmt_type != TK_INSERT &&
+	    stmt_type != TK_REPLACE && stmt_type != TK_UPDATE &&
+	    stmt_type != TK_DELETE)
+		return -1;
+	*out_bind = NULL;
+	*out_bind_count = 0;
+	if (has_params) {
+		*out_sql = str;
+		*out_len = len;
+		return 0;
+	}
+	bool is_insert = stmt_type == TK_INSERT || stmt_type == TK_REPLACE;
+	/* Whether a level of nesting is a result column list. */
+	bool is_columns[SQL_PARAMETERIZE_DEPTH_MAX + 1] = {false};
+	/* Whether a level of nesting is an IN or a VALUES list. */
+	bool is_list[SQL_PARAMETERIZE_DEPTH_MAX + 1] = {false};
+	/* Whether a level of nesting contains VALUES rows. */
+	bool is_values[SQL_PARAMETERIZE_DEPTH_MAX + 1] = {false};
+	int depth = 0;
+	char *out = xregion_alloc(region, len + 1);
+	uint32_t out_size = 0;
+	uint32_t copied = 0;
+	struct sql_bind *bind =
+		xregion_alloc_array(region, typeof(bind[0]), token_count);
+	uint32_t bind_count = 0;
+	for (uint32_t i = 0; i < token_count; i++) {
+		struct sql_param_token *token = &tokens[i];
+		int prev = i > 0 ? tokens[i - 1].type : 0;
+		switch (token->type) {
+		case TK_LP:
+			if (++depth > SQL_PARAMETERIZE_DEPTH_MAX)
+				return -1;
+			is_columns[depth] = false;
+			is_list[depth] = prev == TK_IN || is_values[depth - 1];
+			is_values[depth] = false;
+			continue;
+		case TK_RP:
+			if (depth == 0)
+				return -1;
+			depth--;
+			continue;
+		case TK_SELECT:
+			is_columns[depth] = true;
+			is_list[depth] = false;
+			continue;
+		case TK_VALUES:
+			is_values[depth] = is_insert && depth == 0;
+			continue;
+		case TK_FROM:
+		case TK_WHERE:
+		case TK_GROUP:
+		case TK_HAVING:
+		case TK_ORDER:
+		case TK_UNION:
+		case TK_EXCEPT:
+		case TK_INTERSECT:
+			is_columns[depth] = false;
+			continue;
+		case TK_INTEGER:
+		case TK_DECIMAL:
+		case TK_FLOAT:
+		case TK_STRING:
+			break;
+		default:
+			continue;
+		}
+		bool is_column = false;
+		for (int d = 0; d <= depth; d++)
+			is_column = is_column || is_columns[d];
+		if (is_column)
+			continue;
+		uint32_t first = i;
+		bool is_neg = false;
+		if (prev == TK_MINUS && token->type != TK_STRING) {
+			first = i - 1;
+			is_neg = true;
+			prev = i > 1 ? tokens[i - 2].type : 0;
+		}
+		int next = i + 1 < token_count ? tokens[i + 1].type : TK_SEMI;
+		bool is_operand;
+		if (sql_param_token_is_comparison(prev)) {
+			is_operand = sql_param_token_ends_operand(next);
+		} else {
+			is_operand = is_list[depth] &&
+				     (prev == TK_LP || prev == TK_COMMA) &&
+				     (next == TK_RP || next == TK_COMMA);
+		}
+		if (!is_operand || bind_count == SQL_BIND_PARAMETER_MAX)
+			continue;
+		if (sql_literal_to_bind(&str[token->offset], token->len,
+					token->type, is_neg, region,
+					&bind[bind_count]) != 0)
+			continue;
+		bind_count++;
+		uint32_t start = tokens[first].offset;
+		memcpy(&out[out_size], &str[copied], start - copied);
+		out_size += start - copied;
+		out[out_size++] = '?';
+		copied = token->offset + token->len;
+	}
+	memcpy(&out[out_size], &str[copied], len - copied);
+	out_size += len - copied;
+	out[out_size] = '\0';
+	*out_sql = out;
+	*out_len = out_size;
+	*out_bind = bind;
+	*out_bind_count = bind_count;
+	return 0;
+}
+
+/**
+ * Execute an ad-hoc statement using the shared plan cache.
+ * Literals of the statement are replaced with parameters and
+ * the plan compiled from the resulting text is reused by
+ * subsequent statements which differ only in constants.
+ *
+ * @retval 0 Success.
+ * @retval -1 Error.
+ * @retval 1 The plan cache can't be used for the statement.
+ */
+static int
+sql_execute_cached(const char *sql, int len, const struct sql_bind *bind,
+		   uint32_t bind_count, struct port *port,
+		   struct region *region)
+{
+	/*
+	 * The schema may be rolled back within the transaction
+	 * without bumping the schema version.
+	 */
+	struct txn *txn = in_txn();
+	if (txn != NULL && txn->is_schema_changed)
+		return 1;
+	const char *param_sql;
+	uint32_t param_len;
+	struct sql_bind *literals;
+	uint32_t literal_count;
+	if (sql_stmt_parameterize(sql, len, region, &param_sql, &param_len,
+				  &literals, &literal_count) != 0)
+		return 1;
+	if (literal_count > 0) {
+		assert(bind_count == 0);
+		bind = literals;
+		bind_count = literal_count;
+	}
+	uint32_t sql_flags = current_session()->sql_flags;
+	struct Vdbe *stmt = sql_plan_cache_find(param_sql, param_len,
+						sql_flags);
+	bool is_cached = stmt != NULL;
+	if (stmt == NULL) {
+		if (sql_stmt_compile(param_sql, param_len, NULL, &stmt,
+				     NULL) != 0) {
+			/* Let the original statement report the error. */
+			diag_clear(diag_get());
+			return 1;
+		}
+		assert(stmt != NULL);
+		is_cached = sql_plan_cache_insert(param_sql, param_len, stmt,
+						  sql_flags) == 0;
+	} else {
+		sql_unbind(stmt);
+		sql_reset_autoinc_id_list(stmt);
+		sql_stmt_count_execution(stmt);
+	}
+	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
+					       DQL_EXECUTE : DML_EXECUTE;
+	port_sql_create(port, stmt, format, !is_cached);
+	if (sql_bind(stmt, bind, bind_count) != 0 ||
+	    sql_execute(stmt, port, region) != 0) {
+		port_destroy(port);
+		if (is_cached)
+			sql_stmt_reset(stmt);
+		return -1;
+	}
+	if (is_cached)
+		sql_stmt_reset(stmt);
+	return 0;
+}
+
 int
 sql_prepare_and_execute(const char *sql, int len, const struct sql_bind *bind,
 			uint32_t bind_count, struct port *port,
 			struct region *region)
 {
+	int rc = sql_execute_cached(sql, len, bind, bind_count, port, region);
+	if (rc <= 0)
+		return rc;
 	struct Vdbe *stmt;
 	if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
 		return -1;
@@ -257,3 +657,74 @@ sql_prepare_and_execute(const char *sql, int len, const struct sql_bind *bind,
 	port_destroy(port);
 	return -1;
 }
+
+int
+sql_execute_with_cursor(const char *sql, int len,
+			const struct sql_bind *bind, uint32_t bind_count,
+			uint32_t fetch_size, struct port *port,
+			struct region *region)
+{
+	assert(fetch_size > 0);
+	/*
+	 * A cursor can't outlive a transaction, so within one the
+	 * whole result set is returned.
+	 */
+	if (in_txn() != NULL)
+		return sql_prepare_and_execute(sql, len, bind, bind_count,
+					       port, region);
+	/*
+	 * The statement is compiled anew rather than taken from the
+	 * caches, since the cursor keeps it running between requests.
+	 */
+	struct Vdbe *stmt;
+	if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
+		return -1;
+	assert(stmt != NULL);
+	if (sql_column_count(stmt) == 0) {
+		port_sql_create(port, stmt, DML_EXECUTE, true);
+		if (sql_bind(stmt, bind, bind_count) == 0 &&
+		    sql_execute(stmt, port, region) == 0)
+			return 0;
+		port_destroy(port);
+		return -1;
+	}
+	port_sql_create(port, stmt, DQL_EXECUTE, true);
+	if (sql_bind(stmt, bind, bind_count) != 0)
+		goto error;
+	rmean_collect(rmean_box, IPROTO_EXECUTE, 1);
+	int rc = sql_execute_rows(stmt, fetch_size, port, region);
+	if (rc < 0)
+		goto error;
+	if (rc == 0)
+		return 0;
+	uint32_t cursor_id = sql_cursor_new(stmt);
+	/* The statement is owned by the cursor now. */
+	struct port_sql *port_sql = (struct port_sql *)port;
+	port_sql->do_finalize = false;
+	port_sql->cursor_id = cursor_id;
+	return 0;
+error:
+	port_destroy(port);
+	return -1;
+}
+
+int
+sql_execute_prepared_with_cursor(uint32_t stmt_id,
+				 const struct sql_bind *bind,
+				 uint32_t bind_count, uint32_t fetch_size,
+				 struct port *port, struct region *region)
+{
+	if (!session_check_stmt_id(current_session(), stmt_id)) {
+		diag_set(ClientError, ER_WRONG_QUERY_ID, stmt_id);
+		return -1;
+	}
+	struct Vdbe *stmt = sql_stmt_cache_find(stmt_id);
+	assert(stmt != NULL);
+	if (!sql_stmt_schema_version_is_valid(stmt)) {
+		diag_set(ClientError, ER_SQL_EXECUTE, "statement has expired");
+		return -1;
+	}
+	const char *sql_str = sql_stmt_query_str(stmt);
+	return sql_execute_with_cursor(sql_str, strlen(sql_str), bind,
+				       bind_count, fetch_size, port, region);
+}
@@ -103,6 +103,59 @@ sql_stmt_query_str(const struct Vdbe *stmt);
 int
 sql_stmt_busy(const struct Vdbe *stmt);
 
+/**
+ * Count an execution of a statement taken from the prepared statement
+ * or the plan cache. The statement is specialized once it is executed
+ * often enough. It must not be running.
+ */
+void
+sql_stmt_count_execution(struct Vdbe *stmt);
+
+/**
+ * Make a running statement, which has just returned a row, ready to
+ * be resumed by another request: copy the values which may point to
+ * the memory of the current request.
+ */
+void
+sql_stmt_suspend(struct Vdbe *stmt);
+
+/**
+ * Execute a statement until at most @a row_count rows are appended
+ * to the port.
+ *
+ * @retval  1 There may be more rows.
+ * @retval  0 The statement is done.
+ * @retval -1 Error.
+ */
+int
+sql_execute_rows(struct Vdbe *stmt, uint32_t row_count, struct port *port,
+		 struct region *region);
+
+/**
+ * Prepare and execute an SQL statement returning at most
+ * @a fetch_size rows. If a SELECT executed outside of a transaction
+ * has more rows, they are left in an SQL cursor, which ID is stored
+ * in the port. Other statements are executed as usual.
+ *
+ * @retval  0 Success.
+ * @retval -1 Client or memory error.
+ */
+int
+sql_execute_with_cursor(const char *sql, int len,
+			const struct sql_bind *bind, uint32_t bind_count,
+			uint32_t fetch_size, struct port *port,
+			struct region *region);
+
+/**
+ * Same as sql_execute_with_cursor() but for a statement prepared in
+ * the current session.
+ */
+int
+sql_execute_prepared_with_cursor(uint32_t stmt_id,
+				 const struct sql_bind *bind,
+				 uint32_t bind_count, uint32_t fetch_size,
+				 struct port *port, struct region *region);
+
 /**
  * Prepare (compile into VDBE byte-code) statement.
  *
@@ -986,6 +986,14 @@ generic_index_create_iterator(struct index *base, enum iterator_type type,
 	return NULL;
 }
 
+struct iterator *
+generic_index_create_partial_iterator(struct index *base,
+				      enum iterator_type type,
+				      const char *key, uint32_t part_count)
+{
+	return index_create_iterator(base, type, key, part_count);
+}
+
 
 struct index_read_view *
 generic_index_create_read_view(struct index *index)
@@ -615,6 +615,17 @@ struct index_vtab {
 					    const char *key,
 					    uint32_t part_count,
 					    const char *pos);
+	/**
+	 * Create an index iterator that is only required to return
+	 * up-to-date values of the fields indexed by cmp_def. Other
+	 * fields of returned tuples may be missing or outdated. It
+	 * lets an engine skip fetching full tuples when the caller
+	 * needs only indexed fields (index-only scan).
+	 */
+	struct iterator *(*create_partial_iterator)(struct index *index,
+						    enum iterator_type type,
+						    const char *key,
+						    uint32_t part_count);
 	/** Create an index read view. */
 	struct index_read_view *(*create_read_view)(struct index *index);
 	/** Introspection (index:stat()) */
@@ -990,6 +1001,14 @@ index_create_iterator(struct index *index, enum iterator_type type,
 	return index->vtab->create_iterator(index, type, key, part_count, NULL);
 }
 
+static inline struct iterator *
+index_create_partial_iterator(struct index *index, enum iterator_type type,
+			      const char *key, uint32_t part_count)
+{
+	return index->vtab->create_partial_iterator(index, type, key,
+						    part_count);
+}
+
 static inline struct index_read_view *
 index_create_read_view(struct index *index)
 {
@@ -1135,6 +1154,10 @@ struct iterator *
 generic_index_create_iterator(struct index *base, enum iterator_type type,
 			      const char *key, uint32_t part_count,
 			      const char *pos);
+struct iterator *
+generic_index_create_partial_iterator(struct index *base,
+				      enum iterator_type type,
+				      const char *key, uint32_t part_count);
 int generic_index_build_next(struct index *, struct tuple *);
 void generic_index_end_build(struct index *);
 int
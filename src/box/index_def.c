@@ -39,6 +39,10 @@ const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
+const char *compaction_strategy_strs[] = {
+	"tiered", "leveled", "time_window"
+};
+
 const struct index_opts index_opts_default = {
 	/* .unique              = */ true,
 	/* .dimension           = */ 2,
@@ -47,7 +51,11 @@ const struct index_opts index_opts_default = {
 	/* .page_size           = */ 8192,
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
+	/* .compaction_strategy = */ COMPACTION_STRATEGY_TIERED,
+	/* .compaction_time_window = */ 3600,
 	/* .bloom_fpr           = */ 0.05,
+	/* .bloom_type          = */ TUPLE_BLOOM_CLASSIC,
+	/* .covering            = */ false,
 	/* .lsn                 = */ 0,
 	/* .stat                = */ NULL,
 	/* .func                = */ 0,
@@ -63,7 +71,14 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("page_size", OPT_INT64, struct index_opts, page_size),
 	OPT_DEF("run_count_per_level", OPT_INT64, struct index_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct index_opts, run_size_ratio),
+	OPT_DEF_ENUM("compaction_strategy", compaction_strategy,
+		     struct index_opts, compaction_strategy, NULL),
+	OPT_DEF("compaction_time_window", OPT_FLOAT, struct index_opts,
+		compaction_time_window),
 	OPT_DEF("bloom_fpr", OPT_FLOAT, struct index_opts, bloom_fpr),
+	OPT_DEF_ENUM("bloom_type", tuple_bloom_type, struct index_opts,
+		     bloom_type, NULL),
+	OPT_DEF("covering", OPT_BOOL, struct index_opts, covering),
 	OPT_DEF("lsn", OPT_INT64, struct index_opts, lsn),
 	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_DEF_LEGACY("sql"),
@@ -173,6 +188,58 @@ index_stat_sizeof(const struct index_sample *samples, uint32_t sample_count,
 	return alloc_size;
 }
 
+/**
+ * Set pointers of index_stat object to its arrays located in
+ * the same memory block. To understand memory layout see
+ * index_stat_sizeof() function.
+ *
+ * @param stat Stat to set pointers of.
+ * @param samples Samples to take key sizes from.
+ */
+static void
+index_stat_layout(struct index_stat *stat, const struct index_sample *samples)
+{
+	uint32_t array_size = stat->sample_field_count * sizeof(uint32_t);
+	uint32_t stat1_offset = sizeof(struct index_stat);
+	char *pos = (char *) stat + stat1_offset;
+	stat->tuple_stat1 = (uint32_t *) pos;
+	pos += array_size + sizeof(uint32_t);
+	stat->tuple_log_est = (log_est_t *) pos;
+	pos += array_size + sizeof(uint32_t);
+	stat->avg_eq = (uint32_t *) pos;
+	pos += array_size;
+	stat->samples = (struct index_sample *) pos;
+	pos += stat->sample_count * sizeof(struct index_sample);
+	for (uint32_t i = 0; i < stat->sample_count; ++i) {
+		stat->samples[i].key_size = samples[i].key_size;
+		stat->samples[i].eq = (uint32_t *) pos;
+		pos += array_size;
+		stat->samples[i].lt = (uint32_t *) pos;
+		pos += array_size;
+		stat->samples[i].dlt = (uint32_t *) pos;
+		pos += array_size;
+		stat->samples[i].sample_key = pos;
+		pos += stat->samples[i].key_size;
+	}
+}
+
+struct index_stat *
+index_stat_new(const struct index_sample *samples, uint32_t sample_count,
+	       uint32_t field_count)
+{
+	size_t size = index_stat_sizeof(samples, sample_count, field_count);
+	struct index_stat *stat = (struct index_stat *) malloc(size);
+	if (stat == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "index stat");
+		return NULL;
+	}
+	memset(stat, 0, size);
+	stat->sample_count = sample_count;
+	stat->sample_field_count = field_count;
+	index_stat_layout(stat, samples);
+	return stat;
+}
+
 struct index_stat *
 index_stat_dup(const struct index_stat *src)
 {
@@ -184,27 +251,7 @@ index_stat_dup(const struct index_stat *src)
 		return NULL;
 	}
 	memcpy(dup, src, size);
-	uint32_t array_size = src->sample_field_count * sizeof(uint32_t);
-	uint32_t stat1_offset = sizeof(struct index_stat);
-	char *pos = (char *) dup + stat1_offset;
-	dup->tuple_stat1 = (uint32_t *) pos;
-	pos += array_size + sizeof(uint32_t);
-	dup->tuple_log_est = (log_est_t *) pos;
-	pos += array_size + sizeof(uint32_t);
-	dup->avg_eq = (uint32_t *) pos;
-	pos += array_size;
-	dup->samples = (struct index_sample *) pos;
-	pos += src->sample_count * sizeof(struct index_sample);
-	for (uint32_t i = 0; i < src->sample_count; ++i) {
-		dup->samples[i].eq = (uint32_t *) pos;
-		pos += array_size;
-		dup->samples[i].lt = (uint32_t *) pos;
-		pos += array_size;
-		dup->samples[i].dlt = (uint32_t *) pos;
-		pos += array_size;
-		dup->samples[i].sample_key = pos;
-		pos += dup->samples[i].key_size;
-	}
+	index_stat_layout(dup, src->samples);
 	return dup;
 }
 
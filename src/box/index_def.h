@@ -33,6 +33,7 @@
 
 #include "key_def.h"
 #include "opt_def.h"
+#include "tuple_bloom.h"
 #include "small/rlist.h"
 
 #if defined(__cplusplus)
@@ -58,6 +59,28 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+/** Policy used by vinyl to decide which runs to compact. */
+enum compaction_strategy {
+	/**
+	 * Allow up to run_count_per_level runs per level, levels
+	 * differ in size by run_size_ratio. Optimized for writes.
+	 */
+	COMPACTION_STRATEGY_TIERED,
+	/**
+	 * Keep at most one run per level. Bounds read amplification
+	 * by the number of levels at the cost of extra compaction.
+	 */
+	COMPACTION_STRATEGY_LEVELED,
+	/**
+	 * Group runs by the time they were dumped into windows of
+	 * compaction_time_window seconds and never merge runs that
+	 * belong to different windows. Optimized for time series.
+	 */
+	COMPACTION_STRATEGY_TIME_WINDOW,
+	compaction_strategy_MAX
+};
+extern const char *compaction_strategy_strs[];
+
 /** Simple alias to represent logarithm metrics. */
 typedef int16_t log_est_t;
 
@@ -151,8 +174,22 @@ struct index_opts {
 	 * previous one.
 	 */
 	double run_size_ratio;
+	/** Policy used to pick runs for compaction. */
+	enum compaction_strategy compaction_strategy;
+	/**
+	 * Size of a time window, in seconds, used by the time
+	 * window compaction strategy.
+	 */
+	double compaction_time_window;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
+	/** Type of bloom filters built for runs. */
+	enum tuple_bloom_type bloom_type;
+	/**
+	 * Store full tuples in a vinyl secondary index so that
+	 * reads from it don't need to look up the primary index.
+	 */
+	bool covering;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -211,8 +248,18 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		       -1 : 1;
 	if (o1->run_size_ratio != o2->run_size_ratio)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
+	if (o1->compaction_strategy != o2->compaction_strategy)
+		return o1->compaction_strategy < o2->compaction_strategy ?
+		       -1 : 1;
+	if (o1->compaction_time_window != o2->compaction_time_window)
+		return o1->compaction_time_window <
+		       o2->compaction_time_window ? -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->bloom_type != o2->bloom_type)
+		return o1->bloom_type < o2->bloom_type ? -1 : 1;
+	if (o1->covering != o2->covering)
+		return o1->covering - o2->covering;
 	if (o1->func_id != o2->func_id)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
@@ -289,6 +336,22 @@ size_t
 index_stat_sizeof(const struct index_sample *samples, uint32_t sample_count,
 		  uint32_t field_count);
 
+/**
+ * Allocate index_stat object for @a sample_count samples with
+ * keys of the same sizes as keys of @a samples. All statistics
+ * and keys are zeroed. To understand memory layout see
+ * index_stat_sizeof() function.
+ *
+ * @param samples Array of samples needed for calculating
+ *                size of keys.
+ * @param sample_count Count of samples in samples array.
+ * @param field_count Count of fields in statistics arrays.
+ * @retval New stat or NULL on OOM.
+ */
+struct index_stat *
+index_stat_new(const struct index_sample *samples, uint32_t sample_count,
+	       uint32_t field_count);
+
 /**
  * Duplicate index_stat object.
  * To understand memory layout see index_stat_sizeof() function.
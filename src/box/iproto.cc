@@ -64,6 +64,7 @@
 #include "iproto_features.h"
 #include "rmean.h"
 #include "execute.h"
+#include "sql_cursor.h"
 #include "errinj.h"
 #include "tt_static.h"
 #include "salad/stailq.h"
@@ -706,6 +707,14 @@ struct iproto_connection
 		 * return.
 		 */
 		bool is_push_pending;
+		/** True if the connection is closed. */
+		bool is_disconnected;
+		/**
+		 * Requests waiting for IPROTO_WAIT_VCLOCK, linked by
+		 * iproto_vclock_waiter::in_connection. They are woken up
+		 * when the connection is closed.
+		 */
+		struct rlist vclock_waiters;
 	} tx;
 	/** Authentication salt. */
 	char salt[IPROTO_SALT_SIZE];
@@ -713,6 +722,14 @@ struct iproto_connection
 	struct iproto_thread *iproto_thread;
 };
 
+/** A request waiting for IPROTO_WAIT_VCLOCK. */
+struct iproto_vclock_waiter {
+	/** Link in iproto_connection::tx::vclock_waiters. */
+	struct rlist in_connection;
+	/** Fiber processing the request. */
+	struct fiber *fiber;
+};
+
 /** Returns a string suitable for logging. */
 static inline const char *
 iproto_connection_name(const struct iproto_connection *con)
@@ -1501,6 +1518,8 @@ iproto_connection_new(struct iproto_thread *iproto_thread)
 	con->state = IPROTO_CONNECTION_ALIVE;
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = false;
+	con->tx.is_disconnected = false;
+	rlist_create(&con->tx.vclock_waiters);
 	rmean_collect(iproto_thread->rmean, IPROTO_CONNECTIONS, 1);
 	return con;
 }
@@ -1600,7 +1619,8 @@ iproto_msg_prepare(struct iproto_msg *msg, const char **pos, const char *reqend,
 	stream_id = msg->header.stream_id;
 	request_is_not_for_stream =
 		((type > IPROTO_TYPE_STAT_MAX &&
-		 type != IPROTO_PING) || type == IPROTO_AUTH);
+		 type != IPROTO_PING && type != IPROTO_SQL_FETCH) ||
+		 type == IPROTO_AUTH);
 	request_is_only_for_stream =
 		(type == IPROTO_BEGIN ||
 		 type == IPROTO_COMMIT ||
@@ -1619,7 +1639,8 @@ iproto_msg_prepare(struct iproto_msg *msg, const char **pos, const char *reqend,
 	is_replication_request = type == IPROTO_JOIN ||
 				 type == IPROTO_FETCH_SNAPSHOT ||
 				 type == IPROTO_REGISTER ||
-				 type == IPROTO_SUBSCRIBE;
+				 type == IPROTO_SUBSCRIBE ||
+				 type == IPROTO_RESYNC;
 	if (is_replication_request)
 		*stop_input = true;
 
@@ -1708,6 +1729,7 @@ iproto_msg_decode(struct iproto_msg *msg, struct cmsg_hop **route)
 		return 0;
 	case IPROTO_EXECUTE:
 	case IPROTO_PREPARE:
+	case IPROTO_SQL_FETCH:
 		*route = iproto_thread->sql_route;
 		if (xrow_decode_sql(&msg->header, &msg->sql) != 0)
 			return -1;
@@ -1730,6 +1752,7 @@ iproto_msg_decode(struct iproto_msg *msg, struct cmsg_hop **route)
 		*route = iproto_thread->join_route;
 		return 0;
 	case IPROTO_SUBSCRIBE:
+	case IPROTO_RESYNC:
 		*route = iproto_thread->subscribe_route;
 		return 0;
 	case IPROTO_VOTE_DEPRECATED:
@@ -1808,6 +1831,11 @@ tx_process_disconnect(struct cmsg *m)
 {
 	struct iproto_connection *con =
 		container_of(m, struct iproto_connection, disconnect_msg);
+	/* Nobody will read the responses so don't wait for vclock. */
+	con->tx.is_disconnected = true;
+	struct iproto_vclock_waiter *waiter;
+	rlist_foreach_entry(waiter, &con->tx.vclock_waiters, in_connection)
+		fiber_wakeup(waiter->fiber);
 	if (con->session != NULL) {
 		session_close(con->session);
 		/*
@@ -1977,6 +2005,41 @@ check_watch_key(const char *key, uint32_t len)
 	return strncmp(key, box_ballot_event_key, len) == 0;
 }
 
+/**
+ * Wait until the instance vclock reaches IPROTO_WAIT_VCLOCK of a request
+ * to let the client read its writes made on another instance once they
+ * are replicated here. The wait stops if the connection is closed.
+ */
+static int
+tx_wait_vclock(struct iproto_msg *msg)
+{
+	/*
+	 * Without MVCC a yield aborts the memtx transaction of the stream
+	 * so don't wait in the middle of a transaction.
+	 */
+	if (in_txn()) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Stream transaction",
+			 "waiting for a vclock");
+		return -1;
+	}
+	struct vclock vclock;
+	if (xrow_decode_wait_vclock(&msg->header, &vclock) != 0)
+		return -1;
+	double timeout = msg->header.wait_vclock_timeout;
+	if (timeout < 0)
+		timeout = replication_sync_timeout;
+	double deadline = ev_monotonic_now(loop()) + timeout;
+	struct iproto_connection *con = msg->connection;
+	struct iproto_vclock_waiter waiter;
+	waiter.fiber = fiber();
+	rlist_add_entry(&con->tx.vclock_waiters, &waiter, in_connection);
+	int rc = box_wait_vclock(&vclock, deadline, &con->tx.is_disconnected);
+	rlist_del_entry(&waiter, in_connection);
+	if (rc != 0 && con->tx.is_disconnected)
+		diag_set(ClientError, ER_SESSION_CLOSED);
+	return rc;
+}
+
 /**
  * Check if the tx thread may continue with processing an accepted message.
  * If something's wrong, returns -1 and sets diag, otherwise returns 0.
@@ -1984,12 +2047,6 @@ check_watch_key(const char *key, uint32_t len)
 static int
 tx_check_msg(struct iproto_msg *msg)
 {
-	uint64_t new_schema_version = msg->header.schema_version;
-	if (new_schema_version != 0 && new_schema_version != schema_version) {
-		diag_set(ClientError, ER_WRONG_SCHEMA_VERSION,
-			 new_schema_version, schema_version);
-		return -1;
-	}
 	enum iproto_type type = (enum iproto_type)msg->header.type;
 	if (type != IPROTO_AUTH && type != IPROTO_PING && type != IPROTO_ID &&
 	    type != IPROTO_VOTE && type != IPROTO_VOTE_DEPRECATED &&
@@ -1997,6 +2054,15 @@ tx_check_msg(struct iproto_msg *msg)
 	     !check_watch_key(msg->watch.key, msg->watch.key_len)) &&
 	    security_check_session() != 0)
 		return -1;
+	if (msg->header.wait_vclock != NULL && tx_wait_vclock(msg) != 0)
+		return -1;
+	/* The schema could have been changed while waiting for vclock. */
+	uint64_t new_schema_version = msg->header.schema_version;
+	if (new_schema_version != 0 && new_schema_version != schema_version) {
+		diag_set(ClientError, ER_WRONG_SCHEMA_VERSION,
+			 new_schema_version, schema_version);
+		return -1;
+	}
 	return 0;
 }
 
@@ -2497,43 +2563,75 @@ tx_process_sql(struct cmsg *m)
 	int bind_count = 0;
 	const char *sql;
 	uint32_t len;
+	uint32_t fetch_size = 0;
 	bool is_unprepare = false;
 	RegionGuard region_guard(&fiber()->gc);
 
 	if (tx_check_msg(msg) != 0)
 		goto error;
 	assert(msg->header.type == IPROTO_EXECUTE ||
-	       msg->header.type == IPROTO_PREPARE);
+	       msg->header.type == IPROTO_PREPARE ||
+	       msg->header.type == IPROTO_SQL_FETCH);
 	tx_inject_delay();
 	if (msg->sql.bind != NULL) {
 		bind_count = sql_bind_list_decode(msg->sql.bind, &bind);
 		if (bind_count < 0)
 			goto error;
 	}
+	if (msg->sql.fetch_size != NULL) {
+		sql = msg->sql.fetch_size;
+		fetch_size = mp_decode_uint(&sql);
+	}
 	/*
-	 * There are four options:
+	 * There are five options:
 	 * 1. Prepare SQL query (IPROTO_PREPARE + SQL string);
 	 * 2. Unprepare SQL query (IPROTO_PREPARE + stmt id);
 	 * 3. Execute SQL query (IPROTO_EXECUTE + SQL string);
-	 * 4. Execute prepared query (IPROTO_EXECUTE + stmt id).
+	 * 4. Execute prepared query (IPROTO_EXECUTE + stmt id);
+	 * 5. Fetch rows of SQL cursor (IPROTO_SQL_FETCH + cursor id).
+	 * In case of an EXECUTE with a fetch size the rows which don't
+	 * fit into the reply are left in an SQL cursor.
 	 */
 	if (msg->header.type == IPROTO_EXECUTE) {
 		if (msg->sql.sql_text != NULL) {
 			assert(msg->sql.stmt_id == NULL);
 			sql = msg->sql.sql_text;
 			sql = mp_decode_str(&sql, &len);
-			if (sql_prepare_and_execute(sql, len, bind, bind_count,
-						    &port, &fiber()->gc) != 0)
+			if (fetch_size > 0) {
+				if (sql_execute_with_cursor(
+						sql, len, bind, bind_count,
+						fetch_size, &port,
+						&fiber()->gc) != 0)
+					goto error;
+			} else if (sql_prepare_and_execute(
+					sql, len, bind, bind_count, &port,
+					&fiber()->gc) != 0) {
 				goto error;
+			}
 		} else {
 			assert(msg->sql.sql_text == NULL);
 			assert(msg->sql.stmt_id != NULL);
 			sql = msg->sql.stmt_id;
 			uint32_t stmt_id = mp_decode_uint(&sql);
-			if (sql_execute_prepared(stmt_id, bind, bind_count,
-						 &port, &fiber()->gc) != 0)
+			if (fetch_size > 0) {
+				if (sql_execute_prepared_with_cursor(
+						stmt_id, bind, bind_count,
+						fetch_size, &port,
+						&fiber()->gc) != 0)
+					goto error;
+			} else if (sql_execute_prepared(
+					stmt_id, bind, bind_count, &port,
+					&fiber()->gc) != 0) {
 				goto error;
+			}
 		}
+	} else if (msg->header.type == IPROTO_SQL_FETCH) {
+		assert(msg->sql.cursor_id != NULL);
+		sql = msg->sql.cursor_id;
+		uint32_t cursor_id = mp_decode_uint(&sql);
+		if (sql_cursor_fetch(cursor_id, fetch_size, &port,
+				     &fiber()->gc) != 0)
+			goto error;
 	} else {
 		/* IPROTO_PREPARE */
 		if (msg->sql.sql_text != NULL) {
@@ -2624,6 +2722,14 @@ tx_process_replication(struct cmsg *m)
 			 */
 			box_process_subscribe(io, &msg->header);
 			break;
+		case IPROTO_RESYNC:
+			/*
+			 * Resync reads the replica requests from the
+			 * socket itself and ends with subscribe, so the
+			 * connection is closed the same way.
+			 */
+			box_process_resync(io, &msg->header);
+			break;
 		default:
 			unreachable();
 		}
@@ -3758,7 +3864,8 @@ iproto_override(uint32_t req_type, iproto_handler_t cb,
 		iproto_handler_destroy_t destroy, void *ctx)
 {
 	if (req_type == IPROTO_JOIN || req_type == IPROTO_FETCH_SNAPSHOT ||
-	    req_type == IPROTO_REGISTER || req_type == IPROTO_SUBSCRIBE) {
+	    req_type == IPROTO_REGISTER || req_type == IPROTO_SUBSCRIBE ||
+	    req_type == IPROTO_RESYNC) {
 		const char *feature = tt_sprintf("%s request type",
 						 iproto_type_name(req_type));
 		diag_set(ClientError, ER_UNSUPPORTED,
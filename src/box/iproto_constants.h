@@ -91,6 +91,16 @@ extern const char *iproto_flag_bit_strs[];
 	_(TSN, 0x08, MP_UINT)						\
 	_(FLAGS, 0x09, MP_UINT)						\
 	_(STREAM_ID, 0x0a, MP_UINT)					\
+	/**
+	 * Vclock the instance must reach before executing the request.
+	 * Lets a client read its writes made on another instance.
+	 */								\
+	_(WAIT_VCLOCK, 0x0b, MP_MAP)					\
+	/**
+	 * Timeout of waiting for IPROTO_WAIT_VCLOCK, in seconds.
+	 * replication_sync_timeout is used if not set.
+	 */								\
+	_(WAIT_VCLOCK_TIMEOUT, 0x0c, MP_DOUBLE)				\
 	/* Leave a gap for other keys in the header. */			\
 	_(SPACE_ID, 0x10, MP_UINT)					\
 	_(INDEX_ID, 0x11, MP_UINT)					\
@@ -164,6 +174,14 @@ extern const char *iproto_flag_bit_strs[];
 	 */								\
 	_(SQL_INFO, 0x42, MP_MAP)					\
 	_(STMT_ID, 0x43, MP_UINT)					\
+	/**
+	 * Max number of rows to return in reply to IPROTO_EXECUTE or
+	 * IPROTO_SQL_FETCH. If more rows remain, the reply contains
+	 * IPROTO_SQL_CURSOR_ID to fetch them with IPROTO_SQL_FETCH.
+	 */								\
+	_(SQL_FETCH_SIZE, 0x44, MP_UINT)				\
+	/** ID of a server-side SQL cursor. */				\
+	_(SQL_CURSOR_ID, 0x45, MP_UINT)					\
 	/* Leave a gap between SQL keys and additional request keys */	\
 	_(REPLICA_ANON, 0x50, MP_BOOL)					\
 	_(ID_FILTER, 0x51, MP_ARRAY)					\
@@ -208,6 +226,29 @@ extern const char *iproto_flag_bit_strs[];
 	 * when identifier is present (i.e., the identifier is ignored).
 	 */								\
 	_(INDEX_NAME, 0x5f, MP_STR)					\
+	/**
+	 * Compression of the replication stream requested by a replica
+	 * in IPROTO_SUBSCRIBE, see enum replication_compression.
+	 */								\
+	_(COMPRESSION, 0x60, MP_UINT)					\
+	/**
+	 * Set in IPROTO_JOIN by a replica that wants to receive the master
+	 * checkpoint file instead of a stream of rows, see IPROTO_JOIN_FILE.
+	 */								\
+	_(CHECKPOINT_JOIN, 0x61, MP_BOOL)				\
+	/** Size of the raw file data following IPROTO_JOIN_FILE. */	\
+	_(FILE_SIZE, 0x62, MP_UINT)					\
+	/**
+	 * Exclusive upper bound of a primary key range in IPROTO_RESYNC_HASH
+	 * and IPROTO_RESYNC_FETCH. The range is unbounded if omitted.
+	 */								\
+	_(KEY_END, 0x63, MP_ARRAY)					\
+	/**
+	 * Ids and names of the user spaces a replica subscribes to in
+	 * IPROTO_SUBSCRIBE. Rows of the other user spaces are sent as
+	 * IPROTO_NOP.
+	 */								\
+	_(SPACE_FILTER, 0x64, MP_ARRAY)					\
 
 #define IPROTO_KEY_MEMBER(s, v, ...) IPROTO_ ## s = v,
 
@@ -378,6 +419,38 @@ iproto_key_bit(unsigned char key)
 	 * a notification key without subscribing to changes.
 	 */								\
 	_(WATCH_ONCE, 77)						\
+	/**
+	 * Fetch the next rows of an SQL cursor opened by IPROTO_EXECUTE
+	 * with IPROTO_SQL_FETCH_SIZE. The cursor is closed if the fetch
+	 * size is 0 or there are no more rows.
+	 */								\
+	_(SQL_FETCH, 78)						\
+	/**
+	 * Sent by the master in the initial join stream instead of
+	 * IPROTO_JOIN_META if the replica set IPROTO_CHECKPOINT_JOIN.
+	 * The row is followed by IPROTO_FILE_SIZE bytes of the last
+	 * checkpoint file.
+	 */								\
+	_(JOIN_FILE, 79)						\
+	/**
+	 * Start an anti-entropy resync of a replica that can't follow the
+	 * master because the WALs it needs have been collected. The master
+	 * opens a read view and answers with its vclock. Then the replica
+	 * sends IPROTO_RESYNC_HASH and IPROTO_RESYNC_FETCH requests for the
+	 * primary key ranges it needs and finishes with IPROTO_SUBSCRIBE.
+	 */								\
+	_(RESYNC, 80)							\
+	/**
+	 * Split a primary key range of a space in the resync read view into
+	 * IPROTO_LIMIT subranges and return the lower bound, the number of
+	 * tuples and the hash of each subrange.
+	 */								\
+	_(RESYNC_HASH, 81)						\
+	/**
+	 * Return the tuples of a primary key range of the resync read
+	 * view.
+	 */								\
+	_(RESYNC_FETCH, 82)						\
 									\
 	/**
 	 * The following three requests are reserved for vinyl types.
@@ -572,6 +645,10 @@ request_replace_body_create(struct request_replace_body *body,
 	_(BLOOM_FILTER, 7)						\
 	/** Number of statements of each type (map). */			\
 	_(STMT_STAT, 8)							\
+	/** Time of the last dump included in the run. */		\
+	_(DUMP_TIME, 9)							\
+	/** Bloom filter encoded in format version 2. */		\
+	_(BLOOM_FILTER_V2, 10)						\
 
 #define VY_RUN_INFO_KEY_MEMBER(s, v) VY_RUN_INFO_ ## s = v,
 
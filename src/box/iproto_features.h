@@ -59,6 +59,37 @@ extern "C" {
 	_(SPACE_AND_INDEX_NAMES,  5)					\
 	/** IPROTO_WATCH_ONCE request support. */			\
 	_(WATCH_ONCE,  6)						\
+	/**
+	 * Server-side SQL cursors: IPROTO_SQL_FETCH command,
+	 * IPROTO_SQL_FETCH_SIZE and IPROTO_SQL_CURSOR_ID fields.
+	 */								\
+	_(SQL_CURSORS,  7)						\
+	/**
+	 * Compression of the replication stream sent in reply to
+	 * IPROTO_SUBSCRIBE with IPROTO_COMPRESSION.
+	 */								\
+	_(REPLICATION_COMPRESSION,  8)					\
+	/**
+	 * Initial join by checkpoint file: IPROTO_CHECKPOINT_JOIN flag
+	 * of IPROTO_JOIN and IPROTO_JOIN_FILE response.
+	 */								\
+	_(CHECKPOINT_JOIN,  9)						\
+	/**
+	 * Anti-entropy resync of a lagging replica: IPROTO_RESYNC,
+	 * IPROTO_RESYNC_HASH and IPROTO_RESYNC_FETCH requests.
+	 */								\
+	_(RESYNC,  10)							\
+	/**
+	 * Subscription to a part of the user spaces: IPROTO_SPACE_FILTER
+	 * of IPROTO_SUBSCRIBE.
+	 */								\
+	_(SPACE_FILTER,  11)						\
+	/**
+	 * Waiting for a vclock before executing a request:
+	 * IPROTO_WAIT_VCLOCK and IPROTO_WAIT_VCLOCK_TIMEOUT request header
+	 * keys.
+	 */								\
+	_(WAIT_VCLOCK,  12)						\
 
 #define IPROTO_FEATURE_MEMBER(s, v) IPROTO_FEATURE_ ## s = v,
 
@@ -83,7 +114,7 @@ struct iproto_features {
  * `box.iproto.protocol_version` needs to be updated correspondingly.
  */
 enum {
-	IPROTO_CURRENT_VERSION = 6,
+	IPROTO_CURRENT_VERSION = 12,
 };
 
 /**
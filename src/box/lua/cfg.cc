@@ -81,6 +81,14 @@ lbox_cfg_set_bootstrap_strategy(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_compression(struct lua_State *L)
+{
+	if (box_set_replication_compression() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_replication(struct lua_State *L)
 {
@@ -262,6 +270,17 @@ lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_write_latency_target(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_write_latency_target();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_force_recovery(struct lua_State *L)
 {
@@ -289,6 +308,14 @@ lbox_set_prepared_stmt_cache_size(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_sql_cursor_idle_timeout(struct lua_State *L)
+{
+	if (box_set_sql_cursor_idle_timeout() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_worker_pool_threads(struct lua_State *L)
 {
@@ -322,6 +349,14 @@ lbox_cfg_set_election_fencing_mode(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_election_leader_lease(struct lua_State *L)
+{
+	if (box_set_election_leader_lease() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_replication_timeout(struct lua_State *L)
 {
@@ -488,6 +523,7 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_load", lbox_cfg_load},
 		{"cfg_set_listen", lbox_cfg_set_listen},
 		{"cfg_set_bootstrap_strategy", lbox_cfg_set_bootstrap_strategy},
+		{"cfg_set_replication_compression", lbox_cfg_set_replication_compression},
 		{"cfg_set_replication", lbox_cfg_set_replication},
 		{"cfg_set_worker_pool_threads", lbox_cfg_set_worker_pool_threads},
 		{"cfg_set_readahead", lbox_cfg_set_readahead},
@@ -506,10 +542,12 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_cache", lbox_cfg_set_vinyl_cache},
 		{"cfg_set_vinyl_timeout", lbox_cfg_set_vinyl_timeout},
+		{"cfg_set_vinyl_write_latency_target", lbox_cfg_set_vinyl_write_latency_target},
 		{"cfg_set_force_recovery", lbox_cfg_set_force_recovery},
 		{"cfg_set_election_mode", lbox_cfg_set_election_mode},
 		{"cfg_set_election_timeout", lbox_cfg_set_election_timeout},
 		{"cfg_set_election_fencing_mode", lbox_cfg_set_election_fencing_mode},
+		{"cfg_set_election_leader_lease", lbox_cfg_set_election_leader_lease},
 		{"cfg_set_replication_timeout", lbox_cfg_set_replication_timeout},
 		{"cfg_set_replication_connect_quorum", lbox_cfg_set_replication_connect_quorum},
 		{"cfg_set_replication_connect_timeout", lbox_cfg_set_replication_connect_timeout},
@@ -524,6 +562,8 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_cluster_name", lbox_cfg_set_cluster_name},
 		{"cfg_set_net_msg_max", lbox_cfg_set_net_msg_max},
 		{"cfg_set_sql_cache_size", lbox_set_prepared_stmt_cache_size},
+		{"cfg_set_sql_cursor_idle_timeout",
+		 lbox_cfg_set_sql_cursor_idle_timeout},
 		{"cfg_set_feedback", lbox_cfg_set_feedback},
 		{"cfg_set_txn_timeout", lbox_cfg_set_txn_timeout},
 		{"cfg_set_txn_isolation", lbox_cfg_set_txn_isolation},
@@ -337,7 +337,13 @@ local function apply(config)
         end):tomap()
         box_cfg_nondynamic.log = box_cfg.log
         for k, v in pairs(box_cfg_nondynamic) do
-            if v ~= box.cfg[k] then
+            local is_changed = v ~= box.cfg[k]
+            -- Array options, like replication.spaces, are compared by
+            -- value.
+            if type(v) == 'table' and type(box.cfg[k]) == 'table' then
+                is_changed = not table.equals(v, box.cfg[k])
+            end
+            if is_changed then
                 local warning = 'box_cfg.apply: non-dynamic option '..k..
                     ' will not be set until the instance is restarted'
                 config:_alert({type = 'warn', message = warning})
@@ -677,6 +677,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'sql_cache_size',
             default = 5 * 1024 * 1024,
         }),
+        cursor_idle_timeout = schema.scalar({
+            type = 'number',
+            box_cfg = 'sql_cursor_idle_timeout',
+            default = 60,
+        }),
     }),
     memtx = schema.record({
         memory = schema.scalar({
@@ -785,6 +790,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'vinyl_timeout',
             default = 60,
         }),
+        write_latency_target = schema.scalar({
+            type = 'number',
+            box_cfg = 'vinyl_write_latency_target',
+            default = 0,
+        }),
         write_threads = schema.scalar({
             type = 'integer',
             box_cfg = 'vinyl_write_threads',
@@ -956,6 +966,45 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = 1,
         }),
+        apply_fibers = schema.scalar({
+            type = 'integer',
+            box_cfg = 'replication_apply_fibers',
+            box_cfg_nondynamic = true,
+            default = 1,
+        }),
+        checkpoint_join = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'replication_checkpoint_join',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
+        resync = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'replication_resync',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
+        spaces = schema.array({
+            items = schema.scalar({
+                type = 'string, number',
+            }),
+            box_cfg = 'replication_spaces',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
+        relay_buffer_size = schema.scalar({
+            type = 'integer',
+            box_cfg = 'replication_relay_buffer_size',
+            box_cfg_nondynamic = true,
+            default = 0,
+        }),
+        compression = schema.enum({
+            'none',
+            'zstd',
+        }, {
+            box_cfg = 'replication_compression',
+            default = 'none',
+        }),
         timeout = schema.scalar({
             type = 'number',
             box_cfg = 'replication_timeout',
@@ -1016,6 +1065,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'election_fencing_mode',
             default = 'soft',
         }),
+        election_leader_lease = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'election_leader_lease',
+            default = false,
+        }),
         bootstrap_strategy = schema.enum({
             'auto',
             'config',
@@ -42,6 +42,7 @@
 #include "box/iproto.h"
 #include "box/wal.h"
 #include "box/replication.h"
+#include "box/xrow_io.h"
 #include "info/info.h"
 #include "box/gc.h"
 #include "box/engine.h"
@@ -57,6 +58,7 @@
 #include "lua/utils.h"
 #include "lua/serializer.h" /* luaL_setmaphint */
 #include "fiber.h"
+#include "latency.h"
 #include "sio.h"
 #include "tt_strerror.h"
 #include "tweaks.h"
@@ -96,6 +98,49 @@ lbox_push_replication_error_message(struct lua_State *L, struct error *e,
 	lua_settable(L, idx - 2);
 }
 
+/**
+ * Push the compression of a replication stream and the ratio of
+ * the stream size before compression to the size after it.
+ */
+static void
+lbox_push_replication_compression(lua_State *L, uint32_t compression,
+				  uint64_t raw_bytes, uint64_t compressed_bytes)
+{
+	lua_pushstring(L, "compression");
+	lua_pushstring(L, replication_compression_strs[compression]);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "compression_ratio");
+	lua_pushnumber(L, compressed_bytes > 0 ?
+		       (double)raw_bytes / compressed_bytes : 1);
+	lua_settable(L, -3);
+}
+
+/**
+ * Push the median, 90th and 99th percentiles of the latency of the
+ * replicated transaction stages, in seconds.
+ */
+static void
+lbox_push_replication_latency(lua_State *L, struct latency *latency,
+			      const char **stage_strs, int stage_count)
+{
+	lua_pushstring(L, "latency");
+	lua_createtable(L, 0, stage_count);
+	for (int i = 0; i < stage_count; i++) {
+		lua_createtable(L, 0, 4);
+		lua_pushnumber(L, latency_count(&latency[i]));
+		lua_setfield(L, -2, "count");
+		lua_pushnumber(L, latency_get(&latency[i], 50));
+		lua_setfield(L, -2, "p50");
+		lua_pushnumber(L, latency_get(&latency[i], 90));
+		lua_setfield(L, -2, "p90");
+		lua_pushnumber(L, latency_get(&latency[i], 99));
+		lua_setfield(L, -2, "p99");
+		lua_setfield(L, -2, stage_strs[i]);
+	}
+	lua_settable(L, -3);
+}
+
 static void
 lbox_pushapplier(lua_State *L, struct applier *applier)
 {
@@ -133,6 +178,18 @@ lbox_pushapplier(lua_State *L, struct applier *applier)
 		lua_pushlstring(L, name, total);
 		lua_settable(L, -3);
 
+		if (applier->compression != REPLICATION_COMPRESSION_NONE) {
+			const struct xrow_decompressor *d =
+				&applier->thread.decompressor;
+			lbox_push_replication_compression(
+				L, applier->compression, d->raw_bytes,
+				d->compressed_bytes);
+		}
+
+		lbox_push_replication_latency(L, applier->latency,
+					      applier_latency_stage_strs,
+					      applier_latency_stage_MAX);
+
 		struct error *e = diag_last_error(&applier->fiber->diag);
 		if (e != NULL)
 			lbox_push_replication_error_message(L, e, -1);
@@ -159,6 +216,15 @@ lbox_pushrelay(lua_State *L, struct relay *relay)
 		lua_pushstring(L, "lag");
 		lua_pushnumber(L, relay_txn_lag(relay));
 		lua_settable(L, -3);
+		const struct xrow_compressor *c = relay_compressor(relay);
+		if (c != NULL) {
+			lbox_push_replication_compression(
+				L, REPLICATION_COMPRESSION_ZSTD, c->raw_bytes,
+				c->compressed_bytes);
+		}
+		lbox_push_replication_latency(L, relay_latency(relay),
+					      relay_latency_stage_strs,
+					      relay_latency_stage_MAX);
 		break;
 	case RELAY_STOPPED:
 	{
@@ -679,6 +745,10 @@ lbox_info_election(struct lua_State *L)
 		lua_pushnumber(L, raft_leader_idle(raft));
 		lua_setfield(L, -2, "leader_idle");
 	}
+	if (raft_is_enabled(raft) && raft->is_lease_enabled) {
+		lua_pushnumber(L, raft_lease_remaining(raft));
+		lua_setfield(L, -2, "leader_lease");
+	}
 	return 1;
 }
 
@@ -99,6 +99,7 @@ local default_cfg = {
     vinyl_read_threads  = 1,
     vinyl_write_threads = 4,
     vinyl_timeout       = 60,
+    vinyl_write_latency_target = 0,
     vinyl_defer_deletes = false,
     vinyl_run_count_per_level = 2,
     vinyl_run_size_ratio      = 3.5,
@@ -170,6 +171,7 @@ local default_cfg = {
     election_mode       = 'off',
     election_timeout    = 5,
     election_fencing_mode = 'soft',
+    election_leader_lease = false,
     replication_timeout = 1,
     replication_sync_lag = 10,
     replication_sync_timeout = 0,
@@ -180,6 +182,12 @@ local default_cfg = {
     replication_skip_conflict = false,
     replication_anon      = false,
     replication_threads   = 1,
+    replication_apply_fibers = 1,
+    replication_checkpoint_join = false,
+    replication_compression = 'none',
+    replication_resync = false,
+    replication_spaces = nil,
+    replication_relay_buffer_size = 0,
     bootstrap_strategy    = "auto",
     bootstrap_leader      = nil,
     feedback_enabled      = ifdef_feedback(true),
@@ -191,6 +199,7 @@ local default_cfg = {
     feedback_metrics_limit = ifdef_feedback(1024 * 1024),
     net_msg_max           = 768,
     sql_cache_size        = 5 * 1024 * 1024,
+    sql_cursor_idle_timeout = 60,
     txn_timeout           = 365 * 100 * 86400,
     txn_isolation         = "best-effort",
     memtx_sort_threads    = nil,
@@ -294,6 +303,7 @@ local template_cfg = {
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
     vinyl_timeout             = 'number',
+    vinyl_write_latency_target = 'number',
     vinyl_defer_deletes       = 'boolean',
     vinyl_run_count_per_level = 'number',
     vinyl_run_size_ratio      = 'number',
@@ -366,6 +376,7 @@ local template_cfg = {
     election_mode       = 'string',
     election_timeout    = 'number',
     election_fencing_mode = 'string',
+    election_leader_lease = 'boolean',
     replication_timeout = 'number',
     replication_sync_lag = 'number',
     replication_sync_timeout = 'number',
@@ -376,6 +387,12 @@ local template_cfg = {
     replication_skip_conflict = 'boolean',
     replication_anon      = 'boolean',
     replication_threads   = 'number',
+    replication_apply_fibers = 'number',
+    replication_checkpoint_join = 'boolean',
+    replication_compression = 'string',
+    replication_resync = 'boolean',
+    replication_spaces = 'string, number, table',
+    replication_relay_buffer_size = 'number',
     bootstrap_strategy    = 'string',
     bootstrap_leader      = 'string, number',
     feedback_enabled      = ifdef_feedback('boolean'),
@@ -387,6 +404,7 @@ local template_cfg = {
     feedback_metrics_limit = ifdef_feedback('number'),
     net_msg_max           = 'number',
     sql_cache_size        = 'number',
+    sql_cursor_idle_timeout = 'number',
     txn_timeout           = 'number',
     memtx_sort_threads    = 'number',
 
@@ -480,6 +498,8 @@ local dynamic_cfg = {
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
+    vinyl_write_latency_target =
+        private.cfg_set_vinyl_write_latency_target,
     vinyl_defer_deletes     = nop,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
@@ -496,6 +516,7 @@ local dynamic_cfg = {
     election_mode           = private.cfg_set_election_mode,
     election_timeout        = private.cfg_set_election_timeout,
     election_fencing_mode = private.cfg_set_election_fencing_mode,
+    election_leader_lease = private.cfg_set_election_leader_lease,
     replication_timeout     = private.cfg_set_replication_timeout,
     replication_connect_timeout = private.cfg_set_replication_connect_timeout,
     replication_connect_quorum = private.cfg_set_replication_connect_quorum,
@@ -506,6 +527,7 @@ local dynamic_cfg = {
     replication_skip_conflict = private.cfg_set_replication_skip_conflict,
     replication_anon        = private.cfg_set_replication_anon,
     bootstrap_strategy      = private.cfg_set_bootstrap_strategy,
+    replication_compression = private.cfg_set_replication_compression,
     instance_uuid           = check_instance_uuid,
     instance_name           = private.cfg_set_instance_name,
     replicaset_uuid         = check_replicaset_uuid,
@@ -513,6 +535,7 @@ local dynamic_cfg = {
     cluster_name            = private.cfg_set_cluster_name,
     net_msg_max             = private.cfg_set_net_msg_max,
     sql_cache_size          = private.cfg_set_sql_cache_size,
+    sql_cursor_idle_timeout = private.cfg_set_sql_cursor_idle_timeout,
     txn_timeout             = private.cfg_set_txn_timeout,
     txn_isolation           = private.cfg_set_txn_isolation,
     auth_type               = private.cfg_set_auth_type,
@@ -637,6 +660,7 @@ local dynamic_cfg_order = {
     election_mode           = 300,
     election_timeout        = 320,
     election_fencing_mode   = 320,
+    election_leader_lease   = 320,
 }
 
 local function sort_cfg_cb(l, r)
@@ -652,10 +676,12 @@ local dynamic_cfg_skip_at_load = {
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
     vinyl_timeout           = true,
+    vinyl_write_latency_target = true,
     too_long_threshold      = true,
     election_mode           = true,
     election_timeout        = true,
     election_fencing_mode   = true,
+    election_leader_lease   = true,
     replication             = true,
     replication_timeout     = true,
     replication_connect_timeout = true,
@@ -667,6 +693,7 @@ local dynamic_cfg_skip_at_load = {
     replication_skip_conflict = true,
     replication_anon        = true,
     bootstrap_strategy      = true,
+    replication_compression = true,
     wal_dir_rescan_delay    = true,
     custom_proc_title       = true,
     force_recovery          = true,
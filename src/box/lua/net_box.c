@@ -102,6 +102,7 @@ static struct iproto_features NETBOX_IPROTO_FEATURES;
 	_(EXECUTE)							\
 	_(PREPARE)							\
 	_(UNPREPARE)							\
+	_(FETCH)							\
 	_(GET)								\
 	_(MIN)								\
 	_(MAX)								\
@@ -1216,11 +1217,12 @@ static int
 netbox_encode_execute(lua_State *L, int idx, struct mpstream *stream,
 		      uint64_t sync, uint64_t stream_id)
 {
-	/* Lua stack at idx: query, parameters, options */
+	/* Lua stack at idx: query, parameters, options, fetch size */
 	size_t svp = netbox_begin_encode(stream, sync, IPROTO_EXECUTE,
 					 stream_id);
 
-	mpstream_encode_map(stream, 3);
+	bool has_fetch_size = !lua_isnoneornil(L, idx + 3);
+	mpstream_encode_map(stream, has_fetch_size ? 4 : 3);
 
 	if (lua_type(L, idx) == LUA_TNUMBER) {
 		uint32_t query_id = lua_tointeger(L, idx);
@@ -1241,6 +1243,29 @@ netbox_encode_execute(lua_State *L, int idx, struct mpstream *stream,
 	if (luamp_encode_tuple(L, cfg, stream, idx + 2) != 0)
 		return -1;
 
+	if (has_fetch_size) {
+		mpstream_encode_uint(stream, IPROTO_SQL_FETCH_SIZE);
+		mpstream_encode_uint(stream, lua_tointeger(L, idx + 3));
+	}
+
+	netbox_end_encode(stream, svp);
+	return 0;
+}
+
+static int
+netbox_encode_fetch(lua_State *L, int idx, struct mpstream *stream,
+		    uint64_t sync, uint64_t stream_id)
+{
+	/* Lua stack at idx: cursor id, fetch size */
+	size_t svp = netbox_begin_encode(stream, sync, IPROTO_SQL_FETCH,
+					 stream_id);
+
+	mpstream_encode_map(stream, 2);
+	mpstream_encode_uint(stream, IPROTO_SQL_CURSOR_ID);
+	mpstream_encode_uint(stream, lua_tointeger(L, idx));
+	mpstream_encode_uint(stream, IPROTO_SQL_FETCH_SIZE);
+	mpstream_encode_uint(stream, lua_tointeger(L, idx + 1));
+
 	netbox_end_encode(stream, svp);
 	return 0;
 }
@@ -1398,6 +1423,7 @@ netbox_encode_method(struct lua_State *L, int idx, enum netbox_method method,
 		[NETBOX_EXECUTE]	= netbox_encode_execute,
 		[NETBOX_PREPARE]	= netbox_encode_prepare,
 		[NETBOX_UNPREPARE]	= netbox_encode_unprepare,
+		[NETBOX_FETCH]		= netbox_encode_fetch,
 		[NETBOX_GET]		= netbox_encode_select,
 		[NETBOX_MIN]		= netbox_encode_select,
 		[NETBOX_MAX]		= netbox_encode_select,
@@ -1758,6 +1784,7 @@ netbox_decode_execute(struct lua_State *L, const char **data,
 	assert(mp_typeof(**data) == MP_MAP);
 	uint32_t map_size = mp_decode_map(data);
 	int rows_index = 0, meta_index = 0, info_index = 0;
+	uint64_t cursor_id = 0;
 	for (uint32_t i = 0; i < map_size; ++i) {
 		uint32_t key = mp_decode_uint(data);
 		switch(key) {
@@ -1776,6 +1803,9 @@ netbox_decode_execute(struct lua_State *L, const char **data,
 			netbox_decode_metadata(L, data);
 			meta_index = lua_gettop(L);
 			break;
+		case IPROTO_SQL_CURSOR_ID:
+			cursor_id = mp_decode_uint(data);
+			break;
 		default:
 			assert(key == IPROTO_SQL_INFO);
 			netbox_decode_sql_info(L, data);
@@ -1784,13 +1814,19 @@ netbox_decode_execute(struct lua_State *L, const char **data,
 		}
 	}
 	if (info_index == 0) {
-		assert(meta_index != 0);
+		/* A reply to FETCH has no metadata. */
 		assert(rows_index != 0);
-		lua_createtable(L, 0, 2);
-		lua_pushvalue(L, meta_index);
-		lua_setfield(L, -2, "metadata");
+		lua_createtable(L, 0, 3);
+		if (meta_index != 0) {
+			lua_pushvalue(L, meta_index);
+			lua_setfield(L, -2, "metadata");
+		}
 		lua_pushvalue(L, rows_index);
 		lua_setfield(L, -2, "rows");
+		if (cursor_id != 0) {
+			luaL_pushuint64(L, cursor_id);
+			lua_setfield(L, -2, "cursor_id");
+		}
 	} else {
 		assert(meta_index == 0);
 		assert(rows_index == 0);
@@ -1880,6 +1916,7 @@ netbox_decode_method(struct lua_State *L, enum netbox_method method,
 		[NETBOX_EXECUTE]	= netbox_decode_execute,
 		[NETBOX_PREPARE]	= netbox_decode_prepare,
 		[NETBOX_UNPREPARE]	= netbox_decode_nil,
+		[NETBOX_FETCH]		= netbox_decode_execute,
 		[NETBOX_GET]		= netbox_decode_tuple,
 		[NETBOX_MIN]		= netbox_decode_tuple,
 		[NETBOX_MAX]		= netbox_decode_tuple,
@@ -3082,6 +3119,8 @@ luaopen_net_box(struct lua_State *L)
 			    IPROTO_FEATURE_SPACE_AND_INDEX_NAMES);
 	iproto_features_set(&NETBOX_IPROTO_FEATURES,
 			    IPROTO_FEATURE_WATCH_ONCE);
+	iproto_features_set(&NETBOX_IPROTO_FEATURES,
+			    IPROTO_FEATURE_SQL_CURSORS);
 
 	lua_pushcfunction(L, luaT_netbox_request_iterator_next);
 	luaT_netbox_request_iterator_next_ref = luaL_ref(L, LUA_REGISTRYINDEX);
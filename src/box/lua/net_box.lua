@@ -875,14 +875,53 @@ function remote_methods:eval(code, args, opts)
     return unpack(res)
 end
 
-function remote_methods:execute(query, parameters, sql_opts, netbox_opts)
-    check_remote_arg(self, "execute")
-    if sql_opts ~= nil then
+-- Returns the fetch size option of execute() or nil if not set.
+local function check_sql_opts(sql_opts)
+    if sql_opts == nil then
+        return nil
+    end
+    if type(sql_opts) ~= 'table' then
         box.error(box.error.UNSUPPORTED, "execute", "options")
     end
+    for k in pairs(sql_opts) do
+        if k ~= 'fetch_size' then
+            box.error(box.error.UNSUPPORTED, "execute", "options")
+        end
+    end
+    local fetch_size = sql_opts.fetch_size
+    if fetch_size ~= nil and (type(fetch_size) ~= 'number' or
+                              fetch_size <= 0 or
+                              fetch_size ~= math.floor(fetch_size)) then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "fetch_size should be a positive integer")
+    end
+    return fetch_size
+end
+
+function remote_methods:execute(query, parameters, sql_opts, netbox_opts)
+    check_remote_arg(self, "execute")
+    local fetch_size = check_sql_opts(sql_opts)
     check_param_table(netbox_opts, REQUEST_OPTION_TYPES)
     return self:_request('EXECUTE', netbox_opts, nil, self._stream_id,
-                         query, parameters or {}, sql_opts or {})
+                         query, parameters or {}, {}, fetch_size)
+end
+
+-- Fetches at most fetch_size next rows of an SQL cursor opened by
+-- execute() with the fetch_size option. Fetch size 0 closes the cursor.
+function remote_methods:fetch(cursor_id, fetch_size, netbox_opts)
+    check_remote_arg(self, "fetch")
+    if type(cursor_id) ~= 'number' and type(cursor_id) ~= 'cdata' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "cursor id is expected to be numeric")
+    end
+    if type(fetch_size) ~= 'number' or fetch_size < 0 or
+       fetch_size ~= math.floor(fetch_size) then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "fetch_size should be a non-negative integer")
+    end
+    check_param_table(netbox_opts, REQUEST_OPTION_TYPES)
+    return self:_request('FETCH', netbox_opts, nil, self._stream_id,
+                         cursor_id, fetch_size)
 end
 
 function remote_methods:prepare(query, parameters, sql_opts, netbox_opts) -- luacheck: no unused args
@@ -1459,9 +1459,13 @@ local index_options = {
     distance = 'string',
     run_count_per_level = 'number',
     run_size_ratio = 'number',
+    compaction_strategy = 'string',
+    compaction_time_window = 'number',
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
+    bloom_type = 'string',
+    covering = 'boolean',
     func = 'number, string',
     hint = 'boolean',
 }
@@ -1608,7 +1612,11 @@ box.schema.index.create = function(space_id, name, options)
             range_size = options.range_size,
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
+            compaction_strategy = options.compaction_strategy,
+            compaction_time_window = options.compaction_time_window,
             bloom_fpr = options.bloom_fpr,
+            bloom_type = options.bloom_type,
+            covering = options.covering,
             func = options.func,
             hint = options.hint,
     }
@@ -624,9 +624,34 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnumber(L, index_opts->run_size_ratio);
 			lua_setfield(L, -2, "run_size_ratio");
 
+			if (index_opts->compaction_strategy !=
+			    COMPACTION_STRATEGY_TIERED) {
+				lua_pushstring(L, compaction_strategy_strs[
+					index_opts->compaction_strategy]);
+				lua_setfield(L, -2, "compaction_strategy");
+			}
+
+			if (index_opts->compaction_strategy ==
+			    COMPACTION_STRATEGY_TIME_WINDOW) {
+				lua_pushnumber(L,
+					index_opts->compaction_time_window);
+				lua_setfield(L, -2, "compaction_time_window");
+			}
+
 			lua_pushnumber(L, index_opts->bloom_fpr);
 			lua_setfield(L, -2, "bloom_fpr");
 
+			if (index_opts->bloom_type != TUPLE_BLOOM_CLASSIC) {
+				lua_pushstring(L, tuple_bloom_type_strs[
+					index_opts->bloom_type]);
+				lua_setfield(L, -2, "bloom_type");
+			}
+
+			if (index_opts->covering) {
+				lua_pushboolean(L, true);
+				lua_setfield(L, -2, "covering");
+			}
+
 			lua_settable(L, -3);
 		}
 		lua_setfield(L, -2, index_def->name);
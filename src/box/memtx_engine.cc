@@ -235,7 +235,8 @@ enum snapshot_recovery_state {
 };
 
 /**
- * Recovers one xrow from snapshot.
+ * Recovers one xrow from snapshot. Rows of local spaces are skipped
+ * if @a skip_local is set.
  *
  * @retval -1 error, diagnostic set
  * @retval 0 success
@@ -243,7 +244,8 @@ enum snapshot_recovery_state {
 static int
 memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row,
-				  enum snapshot_recovery_state *state);
+				  enum snapshot_recovery_state *state,
+				  bool skip_local);
 
 int
 memtx_engine_recover_snapshot(struct memtx_engine *memtx,
@@ -267,7 +269,8 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
 	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
 		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(memtx, &row, &state);
+		rc = memtx_engine_recover_snapshot_row(memtx, &row, &state,
+						       false);
 		if (state == DONE_RECOVERING_SYSTEM_SPACES)
 			force_recovery = memtx->force_recovery;
 		if (rc < 0) {
@@ -311,6 +314,59 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	return 0;
 }
 
+int
+memtx_engine_recover_join_file(struct memtx_engine *memtx,
+			       const char *filename,
+			       const struct vclock *vclock, uint64_t *row_count)
+{
+	struct xlog_cursor cursor;
+	if (xlog_cursor_open(&cursor, filename) < 0)
+		return -1;
+	int rc = -1;
+	if (strcmp(cursor.meta.filetype, memtx->snap_dir.filetype) != 0) {
+		diag_set(XlogError, "'%s' is not a snapshot", filename);
+		goto out;
+	}
+	if (vclock_compare(&cursor.meta.vclock, vclock) != 0) {
+		diag_set(XlogError, "snapshot vclock %s doesn't match "
+			 "join vclock %s", vclock_to_string(&cursor.meta.vclock),
+			 vclock_to_string(vclock));
+		goto out;
+	}
+	struct xrow_header row;
+	enum snapshot_recovery_state state;
+	state = SNAPSHOT_RECOVERY_NOT_STARTED;
+	*row_count = 0;
+	while ((rc = xlog_cursor_next(&cursor, &row, false)) == 0) {
+		row.lsn = vclock_sum(vclock);
+		rc = memtx_engine_recover_snapshot_row(memtx, &row, &state,
+						       true);
+		if (rc < 0)
+			goto out;
+		if (++*row_count % 100000 == 0) {
+			say_info_ratelimited("%.1fM rows processed",
+					     *row_count / 1e6);
+			fiber_yield_timeout(0);
+		}
+	}
+	if (rc < 0)
+		goto out;
+	rc = -1;
+	if (!xlog_cursor_is_eof(&cursor)) {
+		diag_set(XlogError, "snapshot `%s' has no EOF marker",
+			 cursor.name);
+		goto out;
+	}
+	if (state == SNAPSHOT_RECOVERY_NOT_STARTED) {
+		diag_set(ClientError, ER_MISSING_SYSTEM_SPACES);
+		goto out;
+	}
+	rc = 0;
+out:
+	xlog_cursor_close(&cursor, false);
+	return rc;
+}
+
 static int
 memtx_engine_recover_raft(const struct xrow_header *row)
 {
@@ -364,7 +420,8 @@ snapshot_recovery_state_update(enum snapshot_recovery_state *state,
 static int
 memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row,
-				  enum snapshot_recovery_state *state)
+				  enum snapshot_recovery_state *state,
+				  bool skip_local)
 {
 	assert(row->bodycnt == 1); /* always 1 for read */
 	if (row->type != IPROTO_INSERT) {
@@ -388,6 +445,8 @@ memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 	struct space *space = space_cache_find(request.space_id);
 	if (space == NULL)
 		goto log_request;
+	if (skip_local && space_is_local(space))
+		return 0;
 	/* memtx snapshot must contain only memtx spaces */
 	if (space->engine != (struct engine *)memtx) {
 		diag_set(ClientError, ER_CROSS_ENGINE_TRANSACTION);
@@ -188,7 +188,7 @@ struct memtx_engine {
 	struct tuple_format *func_key_format;
 	/**
 	 * Number of threads used to sort keys of secondary indexes on engine
-	 * start.
+	 * start. Also used by the SQL sorter.
 	 */
 	int sort_threads;
 };
@@ -239,6 +239,17 @@ int
 memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 			      const struct vclock *vclock);
 
+/**
+ * Load a checkpoint snapshot file received from the master on
+ * initial join. Unlike local recovery, rows of local spaces are
+ * skipped and a file without the EOF marker or with a vclock
+ * other than @a vclock is rejected.
+ */
+int
+memtx_engine_recover_join_file(struct memtx_engine *memtx,
+			       const char *filename,
+			       const struct vclock *vclock, uint64_t *row_count);
+
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
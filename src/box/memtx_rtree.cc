@@ -400,6 +400,8 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .get = */ memtx_index_get,
 	/* .replace = */ memtx_rtree_index_replace,
 	/* .create_iterator = */ memtx_rtree_index_create_iterator,
+	/* .create_partial_iterator = */
+		generic_index_create_partial_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
 	/* .stat = */ generic_index_stat,
 	/* .compact = */ generic_index_compact,
@@ -45,19 +45,48 @@
 #include "gc.h"
 #include "iostream.h"
 #include "iproto_constants.h"
+#include "latency.h"
 #include "recovery.h"
+#include "relay_feed.h"
 #include "replication.h"
+#include "schema_def.h"
 #include "trigger.h"
 #include "vclock/vclock.h"
 #include "version.h"
 #include "xrow.h"
 #include "xrow_io.h"
 #include "xstream.h"
+#include "libeio/eio.h"
+#include "msgpuck/msgpuck.h"
 #include "wal.h"
 #include "txn_limbo.h"
 #include "raft.h"
 
 #include <stdlib.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+const char *relay_latency_stage_strs[] = {
+	/* [RELAY_LATENCY_READ] = */ "read",
+	/* [RELAY_LATENCY_SEND] = */ "send",
+	/* [RELAY_LATENCY_ACK] = */ "ack",
+};
+
+enum {
+	/**
+	 * Max number of the latency samples of the replicated
+	 * transactions waiting for delivery to tx thread.
+	 */
+	RELAY_LATENCY_SAMPLES_MAX = 16,
+};
+
+/** Latency of the stages of a sampled replicated transaction. */
+struct relay_latency_sample {
+	/** Stage latencies indexed by enum relay_latency_stage. */
+	double stages[relay_latency_stage_MAX];
+};
 
 /**
  * Cbus message to send status updates from relay to tx thread.
@@ -75,6 +104,15 @@ struct relay_status_msg {
 	double txn_lag;
 	/** Last vclock sync received in replica's response. */
 	uint64_t vclock_sync;
+	/**
+	 * Time when the heartbeat with the vclock sync was sent or 0 if
+	 * unknown.
+	 */
+	double vclock_sync_time;
+	/** Latency samples of the transactions acknowledged by the replica. */
+	struct relay_latency_sample latency_samples[RELAY_LATENCY_SAMPLES_MAX];
+	/** Number of the latency samples. */
+	int latency_sample_count;
 };
 
 /**
@@ -105,6 +143,10 @@ struct relay_raft_msg {
 	struct relay *relay;
 };
 
+enum {
+	/** Number of the latest heartbeat send times remembered by relay. */
+	RELAY_HEARTBEAT_HISTORY = 16,
+};
 
 /** State of a replication relay. */
 struct relay {
@@ -112,6 +154,11 @@ struct relay {
 	struct cord cord;
 	/** Replica connection */
 	struct iostream *io;
+	/**
+	 * Compressor of the stream sent to the replica or NULL if the
+	 * stream isn't compressed.
+	 */
+	struct xrow_compressor *compressor;
 	/** Request sync */
 	uint64_t sync;
 	/** Last ACK sent to the replica. */
@@ -128,6 +175,13 @@ struct relay {
 	struct replica *replica;
 	/** WAL event watcher. */
 	struct wal_watcher wal_watcher;
+	/** Position of the relay in the relay feed. */
+	struct relay_feed_cursor feed_cursor;
+	/**
+	 * Whether the relay sends the rows from the relay feed rather
+	 * than from the xlog files.
+	 */
+	bool is_in_feed;
 	/** Relay reader cond. */
 	struct fiber_cond reader_cond;
 	/** Relay diagnostics. */
@@ -146,6 +200,15 @@ struct relay {
 	 * is passed by the replica on subscribe.
 	 */
 	uint32_t id_filter;
+	/**
+	 * A sorted array of the ids of the user spaces whose rows are
+	 * relayed, or NULL if the rows of all spaces are relayed. The rows
+	 * of the other user spaces are relayed as NOPs so that the replica
+	 * vclock is still promoted. Owned by the caller of relay_subscribe().
+	 */
+	const uint32_t *space_filter;
+	/** Number of elements in the space filter. */
+	uint32_t space_filter_size;
 	/**
 	 * Local vclock at the moment of subscribe, used to check
 	 * dataset on the other side and send missing data rows if any.
@@ -175,6 +238,12 @@ struct relay {
 	double last_row_time;
 	/** Time when last heartbeat was sent to the peer. */
 	double last_heartbeat_time;
+	/**
+	 * Send times of the latest heartbeats indexed by their vclock sync
+	 * modulo the array size. Used to extend the leader lease when the
+	 * replica acknowledges a heartbeat.
+	 */
+	double heartbeat_times[RELAY_HEARTBEAT_HISTORY];
 	/** Time of last communication with the tx thread. */
 	double tx_seen_time;
 	/**
@@ -185,6 +254,32 @@ struct relay {
 	 * received.
 	 */
 	double txn_lag;
+	/**
+	 * The transaction whose latency is traced. Only one transaction is
+	 * traced at a time, the sampled transactions sent while the relay
+	 * waits for the ACK of the traced one are ignored.
+	 */
+	struct {
+		/** LSN of the last transaction row or 0 if none is traced. */
+		int64_t lsn;
+		/** Replica id of the transaction. */
+		uint32_t replica_id;
+		/**
+		 * Monotonic time when the relay read the first row of the
+		 * transaction being sent.
+		 */
+		double read_time;
+		/** RELAY_LATENCY_READ of the transaction being sent. */
+		double read_latency;
+		/** Monotonic time when the last row was sent. */
+		double send_time;
+		/** Latency of the stages passed so far. */
+		struct relay_latency_sample sample;
+	} trace;
+	/** Latency samples not yet delivered to tx thread. */
+	struct relay_latency_sample latency_samples[RELAY_LATENCY_SAMPLES_MAX];
+	/** Number of the latency samples. */
+	int latency_sample_count;
 	/** Relay sync state. */
 	enum relay_state state;
 	/** Whether relay should speed up the next heartbeat dispatch. */
@@ -206,6 +301,11 @@ struct relay {
 		 * from TX thread only.
 		 */
 		double txn_lag;
+		/**
+		 * Latency of the stages of the sampled transactions, see
+		 * enum relay_latency_stage.
+		 */
+		struct latency latency[relay_latency_stage_MAX];
 		/** Known vclock sync received in response from replica. */
 		uint64_t vclock_sync;
 		/**
@@ -263,6 +363,18 @@ relay_txn_lag(const struct relay *relay)
 	return relay->tx.txn_lag;
 }
 
+struct latency *
+relay_latency(struct relay *relay)
+{
+	return relay->tx.latency;
+}
+
+const struct xrow_compressor *
+relay_compressor(const struct relay *relay)
+{
+	return relay->compressor;
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet);
 static void
@@ -297,6 +409,16 @@ relay_new(struct replica *replica)
 	assert(relay != NULL);
 
 	memset(relay, 0, sizeof(struct relay));
+	for (int i = 0; i < relay_latency_stage_MAX; i++) {
+		if (latency_create(&relay->tx.latency[i]) != 0) {
+			for (int j = 0; j < i; j++)
+				latency_destroy(&relay->tx.latency[j]);
+			free(relay);
+			diag_set(OutOfMemory, 0, "histogram_new",
+				 "relay latency");
+			return NULL;
+		}
+	}
 	relay->replica = replica;
 	relay->last_row_time = ev_monotonic_now(loop());
 	fiber_cond_create(&relay->reader_cond);
@@ -344,6 +466,10 @@ relay_start(struct relay *relay, struct iostream *io, uint64_t sync,
 	relay->sent_raft_term = sent_raft_term;
 	relay->need_new_vclock_sync = false;
 	relay->is_sending_tx = false;
+	relay->trace.lsn = 0;
+	relay->latency_sample_count = 0;
+	relay_feed_cursor_create(&relay->feed_cursor);
+	relay->is_in_feed = false;
 	relay->last_row_time = ev_monotonic_now(loop());
 	relay->tx_seen_time = relay->last_row_time;
 	relay->last_heartbeat_time = relay->last_row_time;
@@ -394,6 +520,7 @@ relay_stop(struct relay *relay)
 	}
 	stailq_create(&relay->pending_gc);
 	relay->io = NULL;
+	relay->compressor = NULL;
 	if (relay->r != NULL)
 		recovery_delete(relay->r);
 	relay->r = NULL;
@@ -414,6 +541,8 @@ relay_delete(struct relay *relay)
 		relay_stop(relay);
 	fiber_cond_destroy(&relay->reader_cond);
 	diag_destroy(&relay->diag);
+	for (int i = 0; i < relay_latency_stage_MAX; i++)
+		latency_destroy(&relay->tx.latency[i]);
 	TRASH(relay);
 	free(relay);
 }
@@ -508,6 +637,143 @@ relay_initial_join(struct iostream *io, uint64_t sync, struct vclock *vclock,
 	engine_join_xc(&ctx, &relay->stream);
 }
 
+/** Size of a chunk of a checkpoint file sent to an encrypted stream. */
+enum { RELAY_FILE_CHUNK_SIZE = 1024 * 1024 };
+
+/**
+ * Send @a size bytes of the file @a fd to the replica. A plain
+ * stream gets the data with sendfile(), so it isn't copied to the
+ * user space, an encrypted one is written chunk by chunk.
+ */
+static void
+relay_send_file(struct relay *relay, int fd, size_t size)
+{
+	struct iostream *io = relay->io;
+	off_t offset = 0;
+	if ((io->flags & IOSTREAM_IS_ENCRYPTED) == 0) {
+		while ((size_t)offset < size) {
+			ssize_t n = eio_sendfile_sync(io->fd, fd, offset,
+						      size - offset);
+			if (n > 0) {
+				offset += n;
+				relay->last_row_time = ev_monotonic_now(loop());
+				continue;
+			}
+			if (n == 0) {
+				diag_set(XlogError, "unexpected end of file");
+				diag_raise();
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK &&
+			    errno != EINTR) {
+				diag_set(SocketError, sio_socketname(io->fd),
+					 "sendfile");
+				diag_raise();
+			}
+			coio_wait(io->fd, COIO_WRITE, TIMEOUT_INFINITY);
+			fiber_testcancel();
+		}
+		return;
+	}
+	char *buf = (char *)xmalloc(RELAY_FILE_CHUNK_SIZE);
+	auto buf_guard = make_scoped_guard([=] { free(buf); });
+	while ((size_t)offset < size) {
+		size_t len = MIN(size - offset, (size_t)RELAY_FILE_CHUNK_SIZE);
+		ssize_t n = pread(fd, buf, len, offset);
+		if (n < 0) {
+			diag_set(SystemError, "failed to read checkpoint file");
+			diag_raise();
+		}
+		if (n == 0) {
+			diag_set(XlogError, "unexpected end of file");
+			diag_raise();
+		}
+		if (coio_write_timeout(io, buf, n, TIMEOUT_INFINITY) < 0)
+			diag_raise();
+		offset += n;
+		relay->last_row_time = ev_monotonic_now(loop());
+	}
+}
+
+/** Arguments of the thread sending a checkpoint file. */
+struct relay_checkpoint_join_arg {
+	struct relay *relay;
+	/** Path to the checkpoint snapshot file. */
+	char filename[PATH_MAX];
+	/** Vclock of the checkpoint. */
+	const struct vclock *vclock;
+};
+
+static int
+relay_checkpoint_join_f(va_list ap)
+{
+	struct relay_checkpoint_join_arg *arg =
+		va_arg(ap, struct relay_checkpoint_join_arg *);
+	struct relay *relay = arg->relay;
+
+	coio_enable();
+	relay_set_cord_name(relay->io->fd);
+
+	int fd = open(arg->filename, O_RDONLY);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to open '%s'", arg->filename);
+		diag_raise();
+	}
+	auto fd_guard = make_scoped_guard([=] { close(fd); });
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		diag_set(SystemError, "failed to stat '%s'", arg->filename);
+		diag_raise();
+	}
+
+	/* Respond to the JOIN request with the checkpoint vclock. */
+	struct xrow_header row;
+	RegionGuard region_guard(&fiber()->gc);
+	xrow_encode_vclock(&row, arg->vclock);
+	row.sync = relay->sync;
+	coio_write_xrow(relay->io, &row);
+
+	xrow_encode_join_file(&row, st.st_size);
+	row.sync = relay->sync;
+	coio_write_xrow(relay->io, &row);
+
+	say_info("sending checkpoint file `%s', %lld bytes", arg->filename,
+		 (long long)st.st_size);
+	relay_send_file(relay, fd, st.st_size);
+	return 0;
+}
+
+void
+relay_checkpoint_join(struct iostream *io, uint64_t sync,
+		      struct gc_checkpoint *checkpoint, const char *filename)
+{
+	struct relay *relay = relay_new(NULL);
+	if (relay == NULL)
+		diag_raise();
+
+	relay_start(relay, io, sync, relay_send_initial_join_row, relay_yield,
+		    UINT64_MAX);
+	auto relay_guard = make_scoped_guard([=] {
+		relay_stop(relay);
+		relay_delete(relay);
+	});
+
+	/* Don't let the file be removed while it's being sent. */
+	struct gc_checkpoint_ref gc;
+	gc_ref_checkpoint(checkpoint, &gc, "checkpoint join");
+	auto gc_guard = make_scoped_guard([&] { gc_unref_checkpoint(&gc); });
+
+	struct relay_checkpoint_join_arg arg;
+	arg.relay = relay;
+	strlcpy(arg.filename, filename, sizeof(arg.filename));
+	arg.vclock = &checkpoint->vclock;
+	int rc = cord_costart(&relay->cord, "checkpoint_join",
+			      relay_checkpoint_join_f, &arg);
+	if (rc == 0)
+		rc = cord_cojoin(&relay->cord);
+	if (rc != 0)
+		diag_raise();
+}
+
 int
 relay_final_join_f(va_list ap)
 {
@@ -590,6 +856,14 @@ tx_status_update(struct cmsg *msg)
 	vclock_copy(&relay->tx.vclock, &status->vclock);
 	relay->tx.txn_lag = status->txn_lag;
 	relay->tx.vclock_sync = status->vclock_sync;
+	for (int i = 0; i < status->latency_sample_count; i++) {
+		struct relay_latency_sample *sample =
+			&status->latency_samples[i];
+		for (int j = 0; j < relay_latency_stage_MAX; j++) {
+			latency_collect(&relay->tx.latency[j],
+					sample->stages[j]);
+		}
+	}
 
 	struct replication_ack ack;
 	ack.source = status->relay->replica->id;
@@ -605,6 +879,14 @@ tx_status_update(struct cmsg *msg)
 	 * has no result yet, need a PROMOTE.
 	 */
 	raft_process_term(box_raft(), status->term, ack.source);
+	/*
+	 * The replica has received the heartbeat, so it won't support another
+	 * leader for a while since the heartbeat was sent.
+	 */
+	if (!anon && status->vclock_sync_time != 0) {
+		raft_process_lease_ack(box_raft(), ack.source, status->term,
+				       status->vclock_sync_time);
+	}
 	/*
 	 * Let pending synchronous transactions know, which of
 	 * them were successfully sent to the replica. Acks are
@@ -701,6 +983,60 @@ relay_set_error(struct relay *relay, struct error *e)
 		diag_set_error(&relay->diag, e);
 }
 
+/**
+ * Send the new rows written to WAL from the relay feed. Returns -1 if the
+ * relay can't follow the feed and has to read the xlog files instead.
+ *
+ * Only anonymous replicas follow the feed: the garbage collector consumer
+ * of a registered replica is advanced when the relay closes an xlog file.
+ */
+static int
+relay_send_from_feed(struct relay *relay)
+{
+	if (!relay->replica->anon)
+		return -1;
+	struct relay_feed_batch *batch;
+	while (true) {
+		if (relay_feed_next(&relay->feed_cursor, &relay->r->vclock,
+				    &batch) != 0)
+			return -1;
+		if (batch == NULL)
+			return 0;
+		auto batch_guard = make_scoped_guard([=] {
+			relay_feed_batch_unref(batch);
+		});
+		if (!relay->is_in_feed) {
+			/*
+			 * All the following rows are in the feed, the xlog
+			 * file will be reopened if the relay falls behind.
+			 */
+			if (xlog_cursor_is_open(&relay->r->cursor))
+				xlog_cursor_close(&relay->r->cursor, false);
+			say_info("relay follows the WAL feed");
+			relay->is_in_feed = true;
+		}
+		size_t size;
+		const char *pos = relay_feed_batch_data(batch, &size);
+		const char *end = pos + size;
+		while (pos < end) {
+			uint64_t len = mp_decode_uint(&pos);
+			const char *row_end = pos + len;
+			struct xrow_header row;
+			xrow_header_decode_xc(&row, &pos, row_end, true);
+			pos = row_end;
+			if (++relay->stream.row_count % WAL_ROWS_PER_YIELD == 0)
+				xstream_yield(&relay->stream);
+			/* The row could have been read from the xlog file. */
+			if (row.lsn <= vclock_get(&relay->r->vclock,
+						  row.replica_id))
+				continue;
+			vclock_follow_xrow(&relay->r->vclock, &row);
+			if (xstream_write(&relay->stream, &row) != 0)
+				diag_raise();
+		}
+	}
+}
+
 static void
 relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 {
@@ -718,14 +1054,76 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		return;
 	}
 	try {
+		if (relay_send_from_feed(relay) == 0)
+			return;
+		bool scan_dir = (events & WAL_EVENT_ROTATE) != 0;
+		if (relay->is_in_feed) {
+			say_info("relay fell behind the WAL feed, "
+				 "reading xlog files");
+			relay->is_in_feed = false;
+			/*
+			 * Rotation events aren't tracked while following
+			 * the feed.
+			 */
+			scan_dir = true;
+		}
 		recover_remaining_wals(relay->r, &relay->stream, NULL,
-				       (events & WAL_EVENT_ROTATE) != 0);
+				       scan_dir);
 	} catch (Exception *e) {
 		relay_set_error(relay, e);
 		fiber_cancel(fiber());
 	}
 }
 
+/**
+ * Remember when the relay started sending a transaction in case its
+ * latency is traced.
+ */
+static void
+relay_trace_tx_begin(struct relay *relay, const struct xrow_header *row)
+{
+	relay->trace.read_time = ev_monotonic_time();
+	relay->trace.read_latency = row->tm > 0 ? ev_time() - row->tm : 0;
+}
+
+/**
+ * Start tracing the latency of a sent transaction if it's sampled and
+ * no other transaction is traced.
+ */
+static void
+relay_trace_tx_end(struct relay *relay, const struct xrow_header *row)
+{
+	if (relay->trace.lsn != 0 || !replication_latency_is_sampled(row))
+		return;
+	double now = ev_monotonic_time();
+	relay->trace.lsn = row->lsn;
+	relay->trace.replica_id = row->replica_id;
+	relay->trace.send_time = now;
+	double *stages = relay->trace.sample.stages;
+	stages[RELAY_LATENCY_READ] = MAX(relay->trace.read_latency, 0);
+	stages[RELAY_LATENCY_SEND] = now - relay->trace.read_time;
+}
+
+/**
+ * Finish tracing the latency of a transaction once the replica has
+ * acknowledged it.
+ */
+static void
+relay_trace_tx_ack(struct relay *relay, const struct vclock *vclock)
+{
+	if (relay->trace.lsn == 0 ||
+	    vclock_get(vclock, relay->trace.replica_id) < relay->trace.lsn)
+		return;
+	relay->trace.lsn = 0;
+	struct relay_latency_sample *sample = &relay->trace.sample;
+	sample->stages[RELAY_LATENCY_ACK] =
+		ev_monotonic_time() - relay->trace.send_time;
+	if (relay->latency_sample_count < RELAY_LATENCY_SAMPLES_MAX) {
+		relay->latency_samples[relay->latency_sample_count++] =
+			*sample;
+	}
+}
+
 /*
  * Relay reader fiber function.
  * Read xrow encoded vclocks sent by the replica.
@@ -763,6 +1161,7 @@ relay_reader_f(va_list ap)
 			    vclock_get(&status_msg->vclock, instance_id) <
 			    vclock_get(&last_recv_ack->vclock, instance_id))
 				relay->txn_lag = ev_now(loop()) - xrow.tm;
+			relay_trace_tx_ack(relay, &last_recv_ack->vclock);
 			fiber_cond_signal(&relay->reader_cond);
 		}
 	} catch (Exception *e) {
@@ -796,6 +1195,9 @@ relay_send_heartbeat(struct relay *relay)
 			row.tm = ev_now(loop());
 		row.replica_id = instance_id;
 		relay->last_heartbeat_time = ev_monotonic_now(loop());
+		relay->heartbeat_times[relay->last_sent_ack.vclock_sync %
+				       RELAY_HEARTBEAT_HISTORY] =
+			relay->last_heartbeat_time;
 		relay_send(relay, &row);
 		relay->need_new_vclock_sync = false;
 	} catch (Exception *e) {
@@ -917,6 +1319,20 @@ relay_trigger_vclock_sync(struct relay *relay, uint64_t *vclock_sync,
 	return 0;
 }
 
+/**
+ * Time when the heartbeat with the given vclock sync was sent or 0 if it is too
+ * old to be remembered.
+ */
+static double
+relay_heartbeat_time(const struct relay *relay, uint64_t vclock_sync)
+{
+	uint64_t last = relay->last_sent_ack.vclock_sync;
+	if (vclock_sync == 0 || vclock_sync > last ||
+	    last - vclock_sync >= RELAY_HEARTBEAT_HISTORY)
+		return 0;
+	return relay->heartbeat_times[vclock_sync % RELAY_HEARTBEAT_HISTORY];
+}
+
 static void
 relay_check_status_needs_update(struct relay *relay)
 {
@@ -937,7 +1353,8 @@ relay_check_status_needs_update(struct relay *relay)
 	double tx_idle = ev_monotonic_now(loop()) - relay->tx_seen_time;
 	if (vclock_sum(&status_msg->vclock) ==
 	    vclock_sum(send_vclock) && tx_idle <= replication_timeout &&
-	    status_msg->vclock_sync == last_recv_ack->vclock_sync)
+	    status_msg->vclock_sync == last_recv_ack->vclock_sync &&
+	    relay->latency_sample_count == 0)
 		return;
 	static const struct cmsg_hop route[] = {
 		{tx_status_update, NULL}
@@ -948,6 +1365,12 @@ relay_check_status_needs_update(struct relay *relay)
 	status_msg->relay = relay;
 	status_msg->term = last_recv_ack->term;
 	status_msg->vclock_sync = last_recv_ack->vclock_sync;
+	status_msg->vclock_sync_time =
+		relay_heartbeat_time(relay, last_recv_ack->vclock_sync);
+	memcpy(status_msg->latency_samples, relay->latency_samples,
+	       relay->latency_sample_count * sizeof(relay->latency_samples[0]));
+	status_msg->latency_sample_count = relay->latency_sample_count;
+	relay->latency_sample_count = 0;
 	cpipe_push(&relay->tx_pipe, &status_msg->msg);
 }
 
@@ -988,6 +1411,10 @@ relay_subscribe_f(va_list ap)
 	/* Setup WAL watcher for sending new rows to the replica. */
 	wal_set_watcher(&relay->wal_watcher, relay->wal_endpoint.name,
 			relay_process_wal_event, cbus_process);
+	/* Only anonymous replicas follow the feed. */
+	bool is_feed_attached = relay->replica->anon;
+	if (is_feed_attached)
+		relay_feed_attach();
 
 	/* Start fiber for receiving replica acks. */
 	char name[FIBER_NAME_MAX];
@@ -1043,6 +1470,8 @@ relay_subscribe_f(va_list ap)
 	 */
 	trigger_clear(&on_close_log);
 	wal_clear_watcher(&relay->wal_watcher, cbus_process);
+	if (is_feed_attached)
+		relay_feed_detach();
 
 	/* Join ack reader fiber. */
 	fiber_cancel(reader);
@@ -1072,7 +1501,9 @@ relay_subscribe_f(va_list ap)
 void
 relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 		struct vclock *replica_clock, uint32_t replica_version_id,
-		uint32_t replica_id_filter, uint64_t sent_raft_term)
+		uint32_t replica_id_filter, const uint32_t *space_filter,
+		uint32_t space_filter_size, uint64_t sent_raft_term,
+		struct xrow_compressor *compressor)
 {
 	assert(replica->anon || replica->id != REPLICA_ID_NIL);
 	struct relay *relay = replica->relay;
@@ -1118,6 +1549,9 @@ relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 	relay->version_id = replica_version_id;
 
 	relay->id_filter = replica_id_filter;
+	relay->space_filter = space_filter;
+	relay->space_filter_size = space_filter_size;
+	relay->compressor = compressor;
 
 	int rc = cord_costart(&relay->cord, "subscribe",
 			      relay_subscribe_f, relay);
@@ -1134,7 +1568,10 @@ relay_send(struct relay *relay, struct xrow_header *packet)
 
 	packet->sync = relay->sync;
 	relay->last_row_time = ev_monotonic_now(loop());
-	coio_write_xrow(relay->io, packet);
+	if (relay->compressor != NULL)
+		coio_write_xrow_compressed(relay->io, relay->compressor, packet);
+	else
+		coio_write_xrow(relay->io, packet);
 
 	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
 	if (inj != NULL && inj->dparam > 0)
@@ -1206,6 +1643,51 @@ relay_push_raft(struct relay *relay, const struct raft_request *req)
 	relay_push_raft_msg(relay);
 }
 
+static int
+relay_space_id_cmp(const void *a, const void *b)
+{
+	uint32_t id_a = *(const uint32_t *)a;
+	uint32_t id_b = *(const uint32_t *)b;
+	return id_a < id_b ? -1 : id_a > id_b;
+}
+
+/**
+ * Check if a DML row must not be relayed to the replica because the
+ * space it modifies isn't in the space filter of the subscription.
+ * The rows of the system spaces are never filtered out.
+ */
+static bool
+relay_is_row_filtered(struct relay *relay, const struct xrow_header *packet)
+{
+	if (relay->space_filter == NULL || packet->bodycnt == 0 ||
+	    !iproto_type_is_dml(packet->type))
+		return false;
+	const char *data = (const char *)packet->body[0].iov_base;
+	if (mp_typeof(*data) != MP_MAP)
+		return false;
+	uint32_t size = mp_decode_map(&data);
+	for (uint32_t i = 0; i < size; i++) {
+		if (mp_typeof(*data) != MP_UINT) {
+			mp_next(&data);
+			mp_next(&data);
+			continue;
+		}
+		uint64_t key = mp_decode_uint(&data);
+		if (key != IPROTO_SPACE_ID || mp_typeof(*data) != MP_UINT) {
+			mp_next(&data);
+			continue;
+		}
+		uint64_t space_id = mp_decode_uint(&data);
+		if (space_id < BOX_SYSTEM_ID_MAX || space_id > UINT32_MAX)
+			return false;
+		uint32_t id = space_id;
+		return bsearch(&id, relay->space_filter,
+			       relay->space_filter_size, sizeof(id),
+			       relay_space_id_cmp) == NULL;
+	}
+	return false;
+}
+
 /** Send a single row to the client. */
 static void
 relay_send_row(struct xstream *stream, struct xrow_header *packet)
@@ -1235,6 +1717,15 @@ relay_send_row(struct xstream *stream, struct xrow_header *packet)
 	/* Check if the rows from the instance are filtered. */
 	if ((1 << packet->replica_id & relay->id_filter) != 0)
 		return;
+	/*
+	 * The rows of the spaces the replica isn't subscribed to are
+	 * relayed as NOPs to promote the replica vclock and to keep the
+	 * transaction boundaries.
+	 */
+	if (relay_is_row_filtered(relay, packet)) {
+		packet->type = IPROTO_NOP;
+		packet->bodycnt = 0;
+	}
 	/*
 	 * We're feeding a WAL, thus responding to FINAL JOIN or SUBSCRIBE
 	 * request. If this is FINAL JOIN (i.e. relay->replica is NULL),
@@ -1279,7 +1770,12 @@ relay_send_row(struct xstream *stream, struct xrow_header *packet)
 				fiber_yield();
 			}
 		}
+		bool is_traced = relay->replica != NULL;
+		if (is_traced && !relay->is_sending_tx)
+			relay_trace_tx_begin(relay, packet);
 		relay_send(relay, packet);
 		relay->is_sending_tx = !packet->is_commit;
+		if (is_traced && packet->is_commit)
+			relay_trace_tx_end(relay, packet);
 	}
 }
@@ -37,11 +37,14 @@
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct gc_checkpoint;
 struct iostream;
+struct latency;
 struct relay;
 struct replica;
 struct tt_uuid;
 struct vclock;
+struct xrow_compressor;
 
 enum relay_state {
 	/**
@@ -58,6 +61,32 @@ enum relay_state {
 	RELAY_STOPPED,
 };
 
+/**
+ * Stages of a replicated transaction whose latency is traced by the
+ * relay, see replication_latency_is_sampled().
+ */
+enum relay_latency_stage {
+	/**
+	 * From the write to the local WAL to reading the first
+	 * transaction row by the relay.
+	 */
+	RELAY_LATENCY_READ,
+	/**
+	 * From reading the first transaction row to sending the last
+	 * one to the replica.
+	 */
+	RELAY_LATENCY_SEND,
+	/**
+	 * From sending the last transaction row to receiving an ACK from
+	 * the replica that has written the transaction to its WAL.
+	 */
+	RELAY_LATENCY_ACK,
+	relay_latency_stage_MAX,
+};
+
+/** Stage names by enum relay_latency_stage. */
+extern const char *relay_latency_stage_strs[];
+
 /** Create a relay which is not running. object. */
 struct relay *
 relay_new(struct replica *replica);
@@ -100,6 +129,20 @@ relay_last_row_time(const struct relay *relay);
 double
 relay_txn_lag(const struct relay *relay);
 
+/**
+ * Returns the latency of the stages of the sampled transactions sent to
+ * the replica indexed by enum relay_latency_stage. Tx thread only.
+ */
+struct latency *
+relay_latency(struct relay *relay);
+
+/**
+ * Returns the compressor of the stream sent to the replica or NULL
+ * if the stream isn't compressed.
+ */
+const struct xrow_compressor *
+relay_compressor(const struct relay *relay);
+
 /**
  * Makes the relay issue a new vclock sync request and returns the sync to wait
  * for.
@@ -131,6 +174,19 @@ void
 relay_initial_join(struct iostream *io, uint64_t sync, struct vclock *vclock,
 		   uint32_t replica_version_id);
 
+/**
+ * Send the checkpoint snapshot file to the replica instead of
+ * initial JOIN rows. The file data follows IPROTO_JOIN_FILE.
+ *
+ * @param io        client connection
+ * @param sync      sync from incoming JOIN request
+ * @param checkpoint checkpoint to send, referenced while it's sent
+ * @param filename  path to the checkpoint snapshot file
+ */
+void
+relay_checkpoint_join(struct iostream *io, uint64_t sync,
+		      struct gc_checkpoint *checkpoint, const char *filename);
+
 /**
  * Send final JOIN rows to the replica.
  *
@@ -144,11 +200,20 @@ relay_final_join(struct iostream *io, uint64_t sync,
 /**
  * Subscribe a replica to updates.
  *
+ * If the compressor isn't NULL, the rows are compressed with it.
+ * The compressor is owned by the caller.
+ *
+ * If the space filter isn't NULL, it's a sorted array of the ids of the
+ * user spaces whose rows are relayed. The rows of the other user spaces
+ * are relayed as NOPs. The array is owned by the caller.
+ *
  * @return none.
  */
 void
 relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 		struct vclock *replica_vclock, uint32_t replica_version_id,
-		uint32_t replica_id_filter, uint64_t sent_raft_term);
+		uint32_t replica_id_filter, const uint32_t *space_filter,
+		uint32_t space_filter_size, uint64_t sent_raft_term,
+		struct xrow_compressor *compressor);
 
 #endif /* TARANTOOL_REPLICATION_RELAY_H_INCLUDED */
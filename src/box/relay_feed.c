@@ -0,0 +1,304 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "relay_feed.h"
+
+#include <pmatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fiber.h"
+#include "journal.h"
+#include "say.h"
+#include "trivia/util.h"
+#include "vclock/vclock.h"
+#include "xrow.h"
+#include "msgpuck/msgpuck.h"
+#include "salad/stailq.h"
+#include "small/rlist.h"
+
+struct relay_feed_batch {
+	/** Link in relay_feed::batches. */
+	struct rlist in_feed;
+	/** Sequential number of the batch in the feed. */
+	int64_t id;
+	/**
+	 * Number of references to the batch. The feed holds one while the
+	 * batch is in the feed, relays hold one while sending the batch.
+	 */
+	int refs;
+	/** Size of the encoded rows. */
+	size_t size;
+	/** WAL vclock after the batch was written. */
+	struct vclock vclock;
+	/** Encoded rows. */
+	char data[];
+};
+
+static struct relay_feed {
+	/** Protects the members below. */
+	pthread_mutex_t mutex;
+	/** Max size of the batches kept in the feed, 0 if disabled. */
+	size_t max_size;
+	/** Total size of the batches in the feed. */
+	size_t size;
+	/** Batches ordered by id, the oldest first. */
+	struct rlist batches;
+	/** Id to assign to the next appended batch. */
+	int64_t next_batch_id;
+	/** WAL vclock before the first batch in the feed was written. */
+	struct vclock vclock;
+	/**
+	 * Number of relays that may follow the feed. Updated atomically,
+	 * the WAL thread doesn't fill the feed while it's 0.
+	 */
+	int relay_count;
+} relay_feed;
+
+/** Size of a batch accounted against relay_feed::max_size. */
+static inline size_t
+relay_feed_batch_bsize(struct relay_feed_batch *batch)
+{
+	return sizeof(*batch) + batch->size;
+}
+
+/** Drop a reference to a batch. Must be called under the feed mutex. */
+static void
+relay_feed_batch_unref_locked(struct relay_feed_batch *batch)
+{
+	assert(batch->refs > 0);
+	if (--batch->refs == 0)
+		free(batch);
+}
+
+/** Remove the oldest batch from the feed. */
+static void
+relay_feed_evict(void)
+{
+	assert(!rlist_empty(&relay_feed.batches));
+	struct relay_feed_batch *batch = rlist_first_entry(
+		&relay_feed.batches, struct relay_feed_batch, in_feed);
+	rlist_del_entry(batch, in_feed);
+	relay_feed.size -= relay_feed_batch_bsize(batch);
+	vclock_copy(&relay_feed.vclock, &batch->vclock);
+	relay_feed_batch_unref_locked(batch);
+}
+
+/**
+ * Remove all batches from the feed. The next batch id is skipped so that
+ * the positioned cursors don't continue past the gap.
+ */
+static void
+relay_feed_reset(void)
+{
+	while (!rlist_empty(&relay_feed.batches))
+		relay_feed_evict();
+	assert(relay_feed.size == 0);
+	relay_feed.next_batch_id++;
+}
+
+void
+relay_feed_init(size_t max_size)
+{
+	tt_pthread_mutex_init(&relay_feed.mutex, NULL);
+	relay_feed.max_size = max_size;
+	relay_feed.size = 0;
+	rlist_create(&relay_feed.batches);
+	relay_feed.next_batch_id = 1;
+	vclock_create(&relay_feed.vclock);
+	relay_feed.relay_count = 0;
+}
+
+void
+relay_feed_free(void)
+{
+	tt_pthread_mutex_lock(&relay_feed.mutex);
+	relay_feed_reset();
+	tt_pthread_mutex_unlock(&relay_feed.mutex);
+	tt_pthread_mutex_destroy(&relay_feed.mutex);
+}
+
+void
+relay_feed_attach(void)
+{
+	pm_atomic_fetch_add(&relay_feed.relay_count, 1);
+}
+
+void
+relay_feed_detach(void)
+{
+	int old_count = pm_atomic_fetch_sub(&relay_feed.relay_count, 1);
+	assert(old_count > 0);
+	(void)old_count;
+}
+
+/**
+ * Encode the rows of the journal entries to a new batch. Returns NULL
+ * if the batch doesn't fit in the feed or can't be allocated.
+ */
+static struct relay_feed_batch *
+relay_feed_batch_new(struct stailq *entries, const struct vclock *vclock)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	int row_count = 0;
+	struct journal_entry *entry;
+	stailq_foreach_entry(entry, entries, fifo)
+		row_count += entry->n_rows;
+	if (row_count == 0)
+		return NULL;
+	struct iovec *iov = xregion_alloc_array(region, struct iovec,
+						row_count * XROW_IOVMAX);
+	int *iovcnt = xregion_alloc_array(region, int, row_count);
+	size_t *len = xregion_alloc_array(region, size_t, row_count);
+	size_t size = 0;
+	int row = 0;
+	stailq_foreach_entry(entry, entries, fifo) {
+		for (int i = 0; i < entry->n_rows; i++, row++) {
+			struct iovec *row_iov = iov + row * XROW_IOVMAX;
+			xrow_header_encode(entry->rows[i], /*sync=*/0,
+					   /*fixheader_len=*/0, row_iov,
+					   &iovcnt[row]);
+			len[row] = 0;
+			for (int j = 0; j < iovcnt[row]; j++)
+				len[row] += row_iov[j].iov_len;
+			size += mp_sizeof_uint(len[row]) + len[row];
+		}
+	}
+	struct relay_feed_batch *batch = NULL;
+	if (sizeof(*batch) + size > relay_feed.max_size)
+		goto out;
+	batch = malloc(sizeof(*batch) + size);
+	if (batch == NULL) {
+		say_warn("failed to allocate relay feed batch");
+		goto out;
+	}
+	batch->refs = 1;
+	batch->size = size;
+	vclock_copy(&batch->vclock, vclock);
+	char *data = batch->data;
+	for (row = 0; row < row_count; row++) {
+		struct iovec *row_iov = iov + row * XROW_IOVMAX;
+		data = mp_encode_uint(data, len[row]);
+		for (int j = 0; j < iovcnt[row]; j++) {
+			memcpy(data, row_iov[j].iov_base, row_iov[j].iov_len);
+			data += row_iov[j].iov_len;
+		}
+	}
+	assert(data == batch->data + size);
+out:
+	region_truncate(region, region_svp);
+	return batch;
+}
+
+void
+relay_feed_append(struct stailq *entries, const struct vclock *start,
+		  const struct vclock *end)
+{
+	if (relay_feed.max_size == 0 || stailq_empty(entries))
+		return;
+	if (pm_atomic_load(&relay_feed.relay_count) == 0) {
+		/*
+		 * Nobody follows the feed so don't waste time on encoding
+		 * the rows. Batches are only added and evicted by the WAL
+		 * thread so the list may be checked without the mutex.
+		 */
+		if (!rlist_empty(&relay_feed.batches)) {
+			tt_pthread_mutex_lock(&relay_feed.mutex);
+			relay_feed_reset();
+			tt_pthread_mutex_unlock(&relay_feed.mutex);
+		}
+		return;
+	}
+	struct relay_feed_batch *batch = relay_feed_batch_new(entries, end);
+	tt_pthread_mutex_lock(&relay_feed.mutex);
+	if (batch == NULL) {
+		/*
+		 * The rows are lost for the feed so the relays have to read
+		 * them from the xlog files.
+		 */
+		relay_feed_reset();
+		goto out;
+	}
+	if (rlist_empty(&relay_feed.batches)) {
+		vclock_copy(&relay_feed.vclock, start);
+	} else {
+		struct relay_feed_batch *last = rlist_last_entry(
+			&relay_feed.batches, struct relay_feed_batch, in_feed);
+		if (vclock_compare(&last->vclock, start) != 0) {
+			/* WAL vclock was advanced bypassing the feed. */
+			relay_feed_reset();
+			vclock_copy(&relay_feed.vclock, start);
+		}
+	}
+	batch->id = relay_feed.next_batch_id++;
+	rlist_add_tail_entry(&relay_feed.batches, batch, in_feed);
+	relay_feed.size += relay_feed_batch_bsize(batch);
+	while (relay_feed.size > relay_feed.max_size)
+		relay_feed_evict();
+out:
+	tt_pthread_mutex_unlock(&relay_feed.mutex);
+}
+
+int
+relay_feed_next(struct relay_feed_cursor *cursor, const struct vclock *vclock,
+		struct relay_feed_batch **batch)
+{
+	if (relay_feed.max_size == 0)
+		return -1;
+	int rc = -1;
+	tt_pthread_mutex_lock(&relay_feed.mutex);
+	if (rlist_empty(&relay_feed.batches))
+		goto out;
+	struct relay_feed_batch *first = rlist_first_entry(
+		&relay_feed.batches, struct relay_feed_batch, in_feed);
+	if (cursor->batch_id == 0) {
+		/*
+		 * The relay may start following the feed only if it has
+		 * all the rows preceding the first batch.
+		 */
+		if (vclock_compare_ignore0(&relay_feed.vclock, vclock) > 0)
+			goto out;
+		cursor->batch_id = first->id - 1;
+	}
+	if (cursor->batch_id < first->id - 1) {
+		/* The batches the relay needs were evicted. */
+		goto out;
+	}
+	rc = 0;
+	*batch = NULL;
+	/* Relays are usually close to the tail so look up from there. */
+	struct relay_feed_batch *b;
+	rlist_foreach_entry_reverse(b, &relay_feed.batches, in_feed) {
+		if (b->id == cursor->batch_id + 1) {
+			b->refs++;
+			cursor->batch_id = b->id;
+			*batch = b;
+			break;
+		}
+		if (b->id <= cursor->batch_id)
+			break;
+	}
+out:
+	tt_pthread_mutex_unlock(&relay_feed.mutex);
+	if (rc != 0)
+		relay_feed_cursor_create(cursor);
+	return rc;
+}
+
+void
+relay_feed_batch_unref(struct relay_feed_batch *batch)
+{
+	tt_pthread_mutex_lock(&relay_feed.mutex);
+	relay_feed_batch_unref_locked(batch);
+	tt_pthread_mutex_unlock(&relay_feed.mutex);
+}
+
+const char *
+relay_feed_batch_data(struct relay_feed_batch *batch, size_t *size)
+{
+	*size = batch->size;
+	return batch->data;
+}
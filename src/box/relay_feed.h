@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct stailq;
+struct vclock;
+
+/**
+ * Relay feed is a bounded in-memory queue of the rows written to WAL,
+ * shared by all relays. While there are relays attached to the feed,
+ * the WAL thread encodes the rows of each written batch once and appends
+ * them to the feed, and the relays following the WAL take the rows from
+ * the feed instead of reading the same xlog files each on its own. The
+ * relays still decode the rows and encode them again for sending. A
+ * relay that lags behind the oldest row kept in the feed falls back to
+ * reading the xlog files and returns to the feed once it catches up.
+ *
+ * The feed is accessed from the WAL and relay threads so it's protected
+ * by a mutex, which is only taken to look up and pin a batch.
+ */
+
+/** A batch of rows written to WAL by one write. */
+struct relay_feed_batch;
+
+/** Position of a relay in the feed. */
+struct relay_feed_cursor {
+	/**
+	 * Id of the last batch returned to the relay or 0 if the cursor
+	 * isn't positioned yet.
+	 */
+	int64_t batch_id;
+};
+
+static inline void
+relay_feed_cursor_create(struct relay_feed_cursor *cursor)
+{
+	cursor->batch_id = 0;
+}
+
+/**
+ * Initialize the relay feed that keeps up to max_size bytes of the
+ * latest rows written to WAL. The feed is disabled if max_size is 0.
+ */
+void
+relay_feed_init(size_t max_size);
+
+/** Free the relay feed. */
+void
+relay_feed_free(void);
+
+/**
+ * Attach a relay to the feed. The WAL thread appends rows to the feed
+ * only while at least one relay is attached to it.
+ */
+void
+relay_feed_attach(void);
+
+/** Detach a relay attached with relay_feed_attach(). */
+void
+relay_feed_detach(void);
+
+/**
+ * Append the rows of the journal entries written to WAL to the feed.
+ * The entries move WAL vclock from start to end. Called from the WAL
+ * thread.
+ */
+void
+relay_feed_append(struct stailq *entries, const struct vclock *start,
+		  const struct vclock *end);
+
+/**
+ * Get the next batch of the feed for a relay with the given vclock and
+ * advance the cursor. A not yet positioned cursor is positioned to the
+ * first batch if the feed has all the rows following the vclock. The
+ * returned batch is pinned and must be released with
+ * relay_feed_batch_unref().
+ *
+ * Returns 0 and sets batch to NULL if there are no new rows in the feed.
+ * Returns -1 if the feed is disabled or doesn't have the rows the relay
+ * needs anymore, in which case the cursor is reset.
+ */
+int
+relay_feed_next(struct relay_feed_cursor *cursor, const struct vclock *vclock,
+		struct relay_feed_batch **batch);
+
+/** Release a batch returned by relay_feed_next(). */
+void
+relay_feed_batch_unref(struct relay_feed_batch *batch);
+
+/**
+ * Get the encoded rows of a batch. Each row is an MP_UINT length
+ * followed by the row header and body as they are written to xlog.
+ */
+const char *
+relay_feed_batch_data(struct relay_feed_batch *batch, size_t *size);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
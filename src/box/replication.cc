@@ -61,6 +61,11 @@ double replication_synchro_timeout = 5.0; /* seconds */
 double replication_sync_timeout = 300.0; /* seconds */
 bool replication_skip_conflict = false;
 int replication_threads = 1;
+int replication_apply_fibers = 1;
+bool replication_checkpoint_join = false;
+bool replication_resync = false;
+char *replication_space_filter = NULL;
+char *replication_space_filter_end = NULL;
 
 bool cfg_replication_anon = true;
 struct tt_uuid cfg_bootstrap_leader_uuid;
@@ -78,6 +83,14 @@ struct rlist replicaset_on_quorum_loss =
 
 enum bootstrap_strategy bootstrap_strategy = BOOTSTRAP_STRATEGY_INVALID;
 
+const char *replication_compression_strs[] = {
+	/* [REPLICATION_COMPRESSION_NONE] = */ "none",
+	/* [REPLICATION_COMPRESSION_ZSTD] = */ "zstd",
+};
+
+enum replication_compression replication_compression =
+	REPLICATION_COMPRESSION_NONE;
+
 enum replicaset_state replicaset_state = REPLICASET_BOOTSTRAP;
 
 static int
@@ -242,6 +255,7 @@ replication_free(void)
 	trigger_destroy(&replicaset.on_relay_thread_start);
 
 	applier_free();
+	free(replication_space_filter);
 }
 
 int
@@ -1220,6 +1234,18 @@ replicaset_needs_rejoin(struct replica **master)
 		say_info("can't follow %s at %s: required %s available %s",
 			 uuid_str, addr_str, local_vclock_str, gc_vclock_str);
 
+		if (replication_resync &&
+		    iproto_features_test(&applier->features,
+					 IPROTO_FEATURE_RESYNC)) {
+			/*
+			 * The applier will resync the data with the master
+			 * when it gets an xlog gap error on subscribe.
+			 */
+			say_info("will resync data from %s at %s instead of "
+				 "rebootstrap", uuid_str, addr_str);
+			return false;
+		}
+
 		if (vclock_compare(&replicaset.vclock, &ballot->vclock) > 0) {
 			/*
 			 * Replica has some rows that are not present on
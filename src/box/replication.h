@@ -101,6 +101,8 @@ static const int REPLICATION_CONNECT_QUORUM_ALL = INT_MAX;
 
 enum { REPLICATION_THREADS_MAX = 1000 };
 
+enum { REPLICATION_APPLY_FIBERS_MAX = 1000 };
+
 enum bootstrap_strategy {
 	BOOTSTRAP_STRATEGY_INVALID = -1,
 	BOOTSTRAP_STRATEGY_AUTO,
@@ -112,6 +114,23 @@ enum bootstrap_strategy {
 /** Instance's bootstrap strategy. Controls replication reconfiguration. */
 extern enum bootstrap_strategy bootstrap_strategy;
 
+/**
+ * Compression of the replication stream. The values are sent over the
+ * wire in IPROTO_COMPRESSION, so they mustn't be changed.
+ */
+enum replication_compression {
+	REPLICATION_COMPRESSION_INVALID = -1,
+	REPLICATION_COMPRESSION_NONE = 0,
+	REPLICATION_COMPRESSION_ZSTD = 1,
+	replication_compression_MAX,
+};
+
+/** Compression names by enum replication_compression. */
+extern const char *replication_compression_strs[];
+
+/** Compression of the stream an applier requests from the master. */
+extern enum replication_compression replication_compression;
+
 enum replicaset_state {
 	REPLICASET_BOOTSTRAP,
 	REPLICASET_JOIN,
@@ -211,6 +230,32 @@ extern bool replication_skip_conflict;
 /** How many threads to use for decoding incoming replication stream. */
 extern int replication_threads;
 
+/**
+ * How many fibers each applier may use to apply independent vinyl
+ * transactions concurrently. 1 means the transactions are applied
+ * one by one.
+ */
+extern int replication_apply_fibers;
+
+/**
+ * Whether to ask the master for its last checkpoint file on initial
+ * join instead of a stream of rows read from a read view.
+ */
+extern bool replication_checkpoint_join;
+
+/**
+ * Whether to resync the data with a master that has collected the WALs
+ * the replica needs instead of stopping replication.
+ */
+extern bool replication_resync;
+
+/**
+ * MsgPack array of the ids and names of the user spaces the replica
+ * subscribes to or NULL if it subscribes to all spaces.
+ */
+extern char *replication_space_filter;
+extern char *replication_space_filter_end;
+
 /**
  * A list of triggers fired once quorum of "healthy" connections is acquired.
  */
@@ -231,6 +276,27 @@ replication_reconnect_interval(void)
 	return replication_timeout;
 }
 
+enum {
+	/**
+	 * The latency of the replication stages is traced for one of
+	 * this many transactions.
+	 */
+	REPLICATION_LATENCY_SAMPLE_RATE = 64,
+};
+
+/**
+ * Check if the replication latency of the transaction ending with the
+ * given row is traced. The check depends only on the transaction LSNs,
+ * so the master and its replicas trace the same transactions.
+ */
+static inline bool
+replication_latency_is_sampled(const struct xrow_header *row)
+{
+	return row->is_commit && row->lsn > 0 &&
+	       row->lsn / REPLICATION_LATENCY_SAMPLE_RATE !=
+	       (row->tsn - 1) / REPLICATION_LATENCY_SAMPLE_RATE;
+}
+
 /**
  * Disconnect a replica if no heartbeat message has been
  * received from it within the given period.
@@ -0,0 +1,938 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "resync.h"
+
+#include <PMurHash.h>
+#include <msgpuck.h>
+
+#include "box.h"
+#include "error.h"
+#include "fiber.h"
+#include "index.h"
+#include "iproto_constants.h"
+#include "key_def.h"
+#include "qsort_arg.h"
+#include "read_view.h"
+#include "say.h"
+#include "schema.h"
+#include "scoped_guard.h"
+#include "small/ibuf.h"
+#include "small/region.h"
+#include "salad/stailq.h"
+#include "space.h"
+#include "space_cache.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "tuple_compare.h"
+#include "txn.h"
+#include "xrow.h"
+#include "xrow_io.h"
+
+enum {
+	/** Seed of the tuple hash. */
+	RESYNC_HASH_SEED = 13,
+	/** Max number of subranges the master splits a range into. */
+	RESYNC_FANOUT_MAX = 256,
+	/** Number of tuples read between yields. */
+	RESYNC_YIELD_LOOPS = 1000,
+};
+
+/** Key of the range starting at the first tuple of a space. */
+static const char resync_empty_key[] = { (char)0x90 };
+
+uint64_t
+resync_tuple_hash(const char *data, const char *data_end)
+{
+	uint32_t len = data_end - data;
+	uint32_t lo = PMurHash32(RESYNC_HASH_SEED, data, len);
+	uint32_t hi = PMurHash32(lo, data, len);
+	return (uint64_t)hi << 32 | lo;
+}
+
+/* {{{ Master side */
+
+/** Tuples of a primary key range of a space read view. */
+struct resync_rv_range {
+	/** Iterator over the primary key. */
+	struct index_read_view_iterator it;
+	/** Set if the iterator was created. */
+	bool is_open;
+	/** Set if the end of the range was reached. */
+	bool is_done;
+	/** Primary key definition. */
+	struct key_def *key_def;
+	/** Exclusive upper bound of the range or NULL. */
+	const char *upper;
+	/** Number of parts in the upper bound. */
+	uint32_t upper_part_count;
+	/** Number of tuples read, used to yield. */
+	uint64_t loops;
+};
+
+/**
+ * Return the primary key of a space in the read view or NULL if the
+ * space isn't in the read view.
+ */
+static struct index_read_view *
+resync_rv_pk(struct read_view *rv, uint32_t space_id)
+{
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, rv) {
+		if (space_rv->id == space_id)
+			return space_read_view_index(space_rv, 0);
+	}
+	return NULL;
+}
+
+/**
+ * Open an iterator over the key range of a request. A space missing
+ * from the read view is treated as empty. A primary key that isn't a
+ * tree isn't ordered, so the whole space is iterated.
+ */
+static void
+resync_rv_range_create(struct resync_rv_range *range,
+		       struct index_read_view *pk,
+		       const struct resync_range_request *req)
+{
+	memset(range, 0, sizeof(*range));
+	if (pk == NULL) {
+		range->is_done = true;
+		return;
+	}
+	range->key_def = pk->def->key_def;
+	enum iterator_type type = ITER_ALL;
+	const char *key = req->key;
+	uint32_t part_count = mp_decode_array(&key);
+	if (pk->def->type != TREE) {
+		part_count = 0;
+	} else {
+		if (part_count > 0) {
+			type = ITER_GE;
+			if (key_validate(pk->def, type, key, part_count) != 0)
+				diag_raise();
+		}
+		if (req->upper != NULL) {
+			range->upper = req->upper;
+			range->upper_part_count =
+				mp_decode_array(&range->upper);
+			if (key_validate(pk->def, ITER_GE, range->upper,
+					 range->upper_part_count) != 0)
+				diag_raise();
+		}
+	}
+	if (index_read_view_create_iterator(pk, type, key, part_count,
+					    &range->it) != 0)
+		diag_raise();
+	range->is_open = true;
+}
+
+static void
+resync_rv_range_destroy(struct resync_rv_range *range)
+{
+	if (range->is_open)
+		index_read_view_iterator_destroy(&range->it);
+}
+
+/**
+ * Read the next tuple of a range. Returns false at the end of the
+ * range. Uses the fiber region for the tuple data and the key.
+ */
+static bool
+resync_rv_range_next(struct resync_rv_range *range,
+		     struct read_view_tuple *result)
+{
+	if (range->is_done)
+		return false;
+	if (++range->loops % RESYNC_YIELD_LOOPS == 0)
+		fiber_sleep(0);
+	if (index_read_view_iterator_next_raw(&range->it, result) != 0)
+		diag_raise();
+	if (result->data == NULL) {
+		range->is_done = true;
+		return false;
+	}
+	if (range->upper == NULL)
+		return true;
+	uint32_t key_size;
+	const char *key = tuple_extract_key_raw(result->data,
+						result->data + result->size,
+						range->key_def, MULTIKEY_NONE,
+						&key_size);
+	if (key == NULL)
+		diag_raise();
+	uint32_t part_count = mp_decode_array(&key);
+	if (key_compare(key, part_count, HINT_NONE, range->upper,
+			range->upper_part_count, HINT_NONE,
+			range->key_def) >= 0) {
+		range->is_done = true;
+		return false;
+	}
+	return true;
+}
+
+/** Lower bound, number of tuples and hash of a key subrange. */
+struct resync_entry {
+	const char *key;
+	const char *key_end;
+	uint64_t count;
+	uint64_t hash;
+};
+
+/**
+ * Split the range of a RESYNC_HASH request into subranges having the
+ * same number of tuples and encode their bounds, sizes and hashes to
+ * @a out as an array of [key, count, hash].
+ */
+static void
+resync_encode_hash(struct ibuf *out, struct read_view *rv,
+		   const struct resync_range_request *req)
+{
+	struct region *region = &fiber()->gc;
+	struct index_read_view *pk = resync_rv_pk(rv, req->space_id);
+	uint32_t limit = MIN(MAX(req->limit, 1), RESYNC_FANOUT_MAX);
+	if (pk == NULL || pk->def->type != TREE)
+		limit = 1;
+	struct resync_rv_range range;
+	struct read_view_tuple tuple;
+	uint64_t chunk = UINT64_MAX;
+	if (limit > 1) {
+		/* Count the tuples to split the range evenly. */
+		uint64_t count = 0;
+		resync_rv_range_create(&range, pk, req);
+		auto range_guard = make_scoped_guard([&] {
+			resync_rv_range_destroy(&range);
+		});
+		while (true) {
+			size_t svp = region_used(region);
+			bool has_next = resync_rv_range_next(&range, &tuple);
+			region_truncate(region, svp);
+			if (!has_next)
+				break;
+			count++;
+		}
+		chunk = MAX(DIV_ROUND_UP(count, limit), 1);
+	}
+	struct resync_entry *entries =
+		xregion_alloc_array(region, struct resync_entry, limit);
+	uint32_t entry_count = 1;
+	entries[0].key = req->key;
+	entries[0].key_end = req->key_end;
+	entries[0].count = 0;
+	entries[0].hash = 0;
+	resync_rv_range_create(&range, pk, req);
+	auto range_guard = make_scoped_guard([&] {
+		resync_rv_range_destroy(&range);
+	});
+	for (uint64_t i = 0; ; i++) {
+		size_t svp = region_used(region);
+		if (!resync_rv_range_next(&range, &tuple)) {
+			region_truncate(region, svp);
+			break;
+		}
+		bool is_bound = i > 0 && i % chunk == 0 &&
+				entry_count < limit;
+		if (is_bound) {
+			/* Keep the key of the first tuple of a subrange. */
+			uint32_t key_size;
+			const char *key = tuple_extract_key_raw(
+				tuple.data, tuple.data + tuple.size,
+				range.key_def, MULTIKEY_NONE, &key_size);
+			if (key == NULL)
+				diag_raise();
+			struct resync_entry *entry = &entries[entry_count++];
+			entry->key = key;
+			entry->key_end = key + key_size;
+			entry->count = 0;
+			entry->hash = 0;
+		}
+		struct resync_entry *entry = &entries[entry_count - 1];
+		entry->count++;
+		entry->hash += resync_tuple_hash(tuple.data,
+						 tuple.data + tuple.size);
+		if (!is_bound)
+			region_truncate(region, svp);
+	}
+	size_t size = mp_sizeof_array(entry_count);
+	for (uint32_t i = 0; i < entry_count; i++) {
+		size += mp_sizeof_array(3) +
+			entries[i].key_end - entries[i].key +
+			mp_sizeof_uint(entries[i].count) +
+			mp_sizeof_uint(entries[i].hash);
+	}
+	char *data = (char *)xibuf_alloc(out, size);
+	data = mp_encode_array(data, entry_count);
+	for (uint32_t i = 0; i < entry_count; i++) {
+		data = mp_encode_array(data, 3);
+		memcpy(data, entries[i].key,
+		       entries[i].key_end - entries[i].key);
+		data += entries[i].key_end - entries[i].key;
+		data = mp_encode_uint(data, entries[i].count);
+		data = mp_encode_uint(data, entries[i].hash);
+	}
+	assert(data == out->wpos);
+}
+
+/**
+ * Encode the tuples of the range of a RESYNC_FETCH request to @a out
+ * as an array. Returns the number of tuples.
+ */
+static uint32_t
+resync_encode_fetch(struct ibuf *out, struct read_view *rv,
+		    const struct resync_range_request *req)
+{
+	struct region *region = &fiber()->gc;
+	/* The array header is filled when the tuples are counted. */
+	size_t header_size = mp_sizeof_array(UINT32_MAX);
+	xibuf_alloc(out, header_size);
+	struct resync_rv_range range;
+	resync_rv_range_create(&range, resync_rv_pk(rv, req->space_id), req);
+	auto range_guard = make_scoped_guard([&] {
+		resync_rv_range_destroy(&range);
+	});
+	uint32_t count = 0;
+	while (true) {
+		size_t svp = region_used(region);
+		struct read_view_tuple tuple;
+		if (!resync_rv_range_next(&range, &tuple)) {
+			region_truncate(region, svp);
+			break;
+		}
+		memcpy(xibuf_alloc(out, tuple.size), tuple.data, tuple.size);
+		region_truncate(region, svp);
+		count++;
+	}
+	char *header = out->rpos;
+	*header = (char)0xdd;
+	mp_store_u32(header + 1, count);
+	return count;
+}
+
+void
+resync_serve(struct iostream *io, struct ibuf *ibuf, struct read_view *rv,
+	     struct xrow_header *row)
+{
+	struct ibuf out;
+	ibuf_create(&out, &cord()->slabc, 16 * 1024);
+	auto out_guard = make_scoped_guard([&] { ibuf_destroy(&out); });
+	int64_t hash_count = 0;
+	int64_t fetch_count = 0;
+	int64_t tuple_count = 0;
+	while (true) {
+		if (ibuf_used(ibuf) == 0)
+			ibuf_reset(ibuf);
+		coio_read_xrow(io, ibuf, row);
+		if (row->type != IPROTO_RESYNC_HASH &&
+		    row->type != IPROTO_RESYNC_FETCH)
+			break;
+		RegionGuard region_guard(&fiber()->gc);
+		struct resync_range_request req;
+		xrow_decode_resync_range_xc(row, &req);
+		ibuf_reset(&out);
+		if (row->type == IPROTO_RESYNC_HASH) {
+			resync_encode_hash(&out, rv, &req);
+			hash_count++;
+		} else {
+			tuple_count += resync_encode_fetch(&out, rv, &req);
+			fetch_count++;
+		}
+		struct xrow_header rsp;
+		xrow_encode_resync_data(&rsp, out.rpos, out.wpos);
+		rsp.sync = row->sync;
+		coio_write_xrow(io, &rsp);
+	}
+	say_info("resync: %lld ranges hashed, %lld ranges fetched, "
+		 "%lld tuples sent", (long long)hash_count,
+		 (long long)fetch_count, (long long)tuple_count);
+}
+
+/* }}} Master side */
+
+/* {{{ Replica side */
+
+/** Replica side state of a resync. */
+struct resync {
+	/** Connection to the master. */
+	struct iostream *io;
+	/** Input buffer of the connection. */
+	struct ibuf *ibuf;
+	/** Memory for the bounds of the key ranges of a space. */
+	struct region region;
+	/** Memory for the postponed deletions. */
+	struct region deferred_region;
+	/**
+	 * Deletions from system spaces postponed till all system
+	 * spaces are resynced, the last one first.
+	 */
+	struct stailq deferred;
+	/** Number of key ranges compared with the master. */
+	int64_t compared_count;
+	/** Number of key ranges fetched from the master. */
+	int64_t fetched_count;
+	/** Number of local tuples replaced. */
+	int64_t replaced_count;
+	/** Number of local tuples deleted. */
+	int64_t deleted_count;
+};
+
+/** Key range compared with the master. */
+struct resync_range {
+	/** Next range to compare. */
+	struct resync_range *next;
+	/** Inclusive lower bound. */
+	const char *key;
+	const char *key_end;
+	/** Exclusive upper bound or NULL. */
+	const char *upper;
+	const char *upper_end;
+	/** Number of tuples in the range on the master. */
+	uint64_t count;
+	/** Hash of the range on the master. */
+	uint64_t hash;
+};
+
+/** Tuple deletion by primary key. */
+struct resync_deletion {
+	/** Link in a list of deletions. */
+	struct stailq_entry in_list;
+	/** Space ID. */
+	uint32_t space_id;
+	/** Primary key. */
+	const char *key;
+	const char *key_end;
+};
+
+/** Tuple data sent by the master. */
+struct resync_tuple {
+	const char *data;
+	const char *data_end;
+};
+
+/**
+ * Send a RESYNC_HASH or RESYNC_FETCH request for a range and return
+ * the array sent in response. The data is valid till the next request.
+ */
+static void
+resync_request(struct resync *r, uint16_t type, uint32_t space_id,
+	       const struct resync_range *range, uint32_t limit,
+	       const char **data, const char **data_end)
+{
+	struct resync_range_request req;
+	req.space_id = space_id;
+	req.key = range->key;
+	req.key_end = range->key_end;
+	req.upper = range->upper;
+	req.upper_end = range->upper_end;
+	req.limit = limit;
+	struct xrow_header row;
+	xrow_encode_resync_range(&row, type, &req);
+	if (ibuf_used(r->ibuf) == 0)
+		ibuf_reset(r->ibuf);
+	coio_write_xrow(r->io, &row);
+	coio_read_xrow(r->io, r->ibuf, &row);
+	if (iproto_type_is_error(row.type)) {
+		xrow_decode_error_xc(&row);
+	} else if (row.type != IPROTO_OK) {
+		tnt_raise(ClientError, ER_PROTOCOL,
+			  "Invalid response to resync request");
+	}
+	xrow_decode_resync_data_xc(&row, data, data_end);
+}
+
+/** Iterator over the local tuples of a key range. */
+struct resync_local_range {
+	/** Iterator over the primary key. */
+	box_iterator_t *it;
+	/** Primary key definition. */
+	struct key_def *key_def;
+	/** Exclusive upper bound of the range or NULL. */
+	const char *upper;
+	/** Number of parts in the upper bound. */
+	uint32_t upper_part_count;
+};
+
+/**
+ * Open an iterator over the local tuples of a range. The whole space
+ * is iterated if the primary key isn't a tree, like on the master.
+ */
+static void
+resync_local_range_create(struct resync_local_range *lr, struct space *space,
+			  const struct resync_range *range)
+{
+	struct index *pk = space_index(space, 0);
+	lr->key_def = pk->def->key_def;
+	lr->upper = NULL;
+	lr->upper_part_count = 0;
+	int type = ITER_ALL;
+	const char *key = resync_empty_key;
+	const char *key_end = resync_empty_key + sizeof(resync_empty_key);
+	if (pk->def->type == TREE) {
+		const char *parts = range->key;
+		if (mp_decode_array(&parts) > 0) {
+			type = ITER_GE;
+			key = range->key;
+			key_end = range->key_end;
+		}
+		if (range->upper != NULL) {
+			lr->upper = range->upper;
+			lr->upper_part_count = mp_decode_array(&lr->upper);
+		}
+	}
+	lr->it = box_index_iterator(space->def->id, 0, type, key, key_end);
+	if (lr->it == NULL)
+		diag_raise();
+}
+
+static void
+resync_local_range_destroy(struct resync_local_range *lr)
+{
+	box_iterator_free(lr->it);
+}
+
+/** Return the next tuple of a range or NULL at the end. */
+static struct tuple *
+resync_local_range_next(struct resync_local_range *lr)
+{
+	struct tuple *tuple;
+	if (box_iterator_next(lr->it, &tuple) != 0)
+		diag_raise();
+	if (tuple != NULL && lr->upper != NULL &&
+	    tuple_compare_with_key(tuple, HINT_NONE, lr->upper,
+				   lr->upper_part_count, HINT_NONE,
+				   lr->key_def) >= 0)
+		return NULL;
+	return tuple;
+}
+
+/** Count and hash the local tuples of a range. */
+static void
+resync_local_summary(struct space *space, const struct resync_range *range,
+		     uint64_t *count, uint64_t *hash)
+{
+	*count = 0;
+	*hash = 0;
+	struct resync_local_range lr;
+	resync_local_range_create(&lr, space, range);
+	auto lr_guard = make_scoped_guard([&] {
+		resync_local_range_destroy(&lr);
+	});
+	struct tuple *tuple;
+	while ((tuple = resync_local_range_next(&lr)) != NULL) {
+		uint32_t size;
+		const char *data = tuple_data_range(tuple, &size);
+		++*count;
+		*hash += resync_tuple_hash(data, data + size);
+		if (*count % RESYNC_YIELD_LOOPS == 0)
+			fiber_sleep(0);
+	}
+}
+
+/** Copy a key to the resync region. */
+static const char *
+resync_copy_key(struct region *region, const char *key, const char *key_end)
+{
+	char *copy = (char *)xregion_alloc(region, key_end - key);
+	memcpy(copy, key, key_end - key);
+	return copy;
+}
+
+/**
+ * Ask the master to split a range into @a limit subranges and push
+ * the subranges to @a stack so that they are popped in the key order.
+ * Returns false and pushes nothing if the master didn't split a range
+ * into more than one subrange although asked to.
+ */
+static bool
+resync_split(struct resync *r, uint32_t space_id,
+	     const struct resync_range *range, uint32_t limit,
+	     struct resync_range **stack)
+{
+	RegionGuard region_guard(&fiber()->gc);
+	const char *data, *data_end;
+	resync_request(r, IPROTO_RESYNC_HASH, space_id, range, limit,
+		       &data, &data_end);
+	uint32_t count = mp_decode_array(&data);
+	if (count == 0 || (limit > 1 && count == 1))
+		return false;
+	struct resync_range *subranges =
+		xregion_alloc_array(&r->region, struct resync_range, count);
+	for (uint32_t i = 0; i < count; i++) {
+		struct resync_range *subrange = &subranges[i];
+		if (mp_typeof(*data) != MP_ARRAY ||
+		    mp_decode_array(&data) != 3 ||
+		    mp_typeof(*data) != MP_ARRAY)
+			goto error;
+		const char *key = data;
+		mp_next(&data);
+		subrange->key = resync_copy_key(&r->region, key, data);
+		subrange->key_end = subrange->key + (data - key);
+		if (mp_typeof(*data) != MP_UINT)
+			goto error;
+		subrange->count = mp_decode_uint(&data);
+		if (mp_typeof(*data) != MP_UINT)
+			goto error;
+		subrange->hash = mp_decode_uint(&data);
+	}
+	for (uint32_t i = count; i-- > 0; ) {
+		struct resync_range *subrange = &subranges[i];
+		if (i + 1 < count) {
+			subrange->upper = subranges[i + 1].key;
+			subrange->upper_end = subranges[i + 1].key_end;
+		} else {
+			subrange->upper = range->upper;
+			subrange->upper_end = range->upper_end;
+		}
+		subrange->next = *stack;
+		*stack = subrange;
+	}
+	return true;
+error:
+	tnt_raise(ClientError, ER_PROTOCOL,
+		  "Invalid response to RESYNC_HASH");
+}
+
+/**
+ * Begin a transaction applying the master data. The changes bring the
+ * replica to a state the master has already replicated, so they don't
+ * wait for a quorum and aren't replicated further.
+ */
+static struct txn *
+resync_txn_begin(void)
+{
+	struct txn *txn = txn_begin();
+	if (txn == NULL)
+		diag_raise();
+	txn_set_flags(txn, TXN_FORCE_ASYNC | TXN_FORCE_LOCAL);
+	return txn;
+}
+
+/** Execute a replace or a delete in the current transaction. */
+static void
+resync_execute(uint16_t type, uint32_t space_id, const char *data,
+	       const char *data_end)
+{
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = type;
+	request.space_id = space_id;
+	if (type == IPROTO_REPLACE) {
+		request.tuple = data;
+		request.tuple_end = data_end;
+	} else {
+		assert(type == IPROTO_DELETE);
+		request.index_id = 0;
+		request.key = data;
+		request.key_end = data_end;
+	}
+	struct space *space = space_cache_find_xc(space_id);
+	if (box_process_rw(&request, space, NULL) != 0)
+		diag_raise();
+}
+
+static int
+resync_key_cmp(const void *a, const void *b, void *arg)
+{
+	const char *key_a = *(const char **)a;
+	const char *key_b = *(const char **)b;
+	uint32_t part_count_a = mp_decode_array(&key_a);
+	uint32_t part_count_b = mp_decode_array(&key_b);
+	return key_compare(key_a, part_count_a, HINT_NONE,
+			   key_b, part_count_b, HINT_NONE,
+			   (struct key_def *)arg);
+}
+
+/** Return true if the key of a tuple is in a sorted array of keys. */
+static bool
+resync_key_is_found(struct tuple *tuple, const char **keys, uint32_t count,
+		    struct key_def *key_def)
+{
+	uint32_t begin = 0, end = count;
+	while (begin < end) {
+		uint32_t mid = begin + (end - begin) / 2;
+		const char *key = keys[mid];
+		uint32_t part_count = mp_decode_array(&key);
+		int rc = tuple_compare_with_key(tuple, HINT_NONE, key,
+						part_count, HINT_NONE,
+						key_def);
+		if (rc == 0)
+			return true;
+		if (rc < 0)
+			end = mid;
+		else
+			begin = mid + 1;
+	}
+	return false;
+}
+
+/**
+ * Fetch the tuples of a range from the master and make the local data
+ * of the range equal to them: replace the tuples that are missing or
+ * differ and delete the tuples the master doesn't have. @a local_count
+ * is the number of local tuples in the range.
+ */
+static void
+resync_fetch(struct resync *r, uint32_t space_id,
+	     const struct resync_range *range, uint64_t local_count)
+{
+	struct region *region = &fiber()->gc;
+	RegionGuard region_guard(region);
+	const char *data, *data_end;
+	resync_request(r, IPROTO_RESYNC_FETCH, space_id, range, 0,
+		       &data, &data_end);
+	r->fetched_count++;
+	struct space *space = space_by_id(space_id);
+	if (space == NULL)
+		return;
+	bool is_system = space_is_system(space);
+	struct key_def *key_def = space_index(space, 0)->def->key_def;
+	uint32_t count = mp_decode_array(&data);
+	const char **keys = NULL;
+	struct resync_tuple *replaces = NULL;
+	if (count > 0) {
+		keys = xregion_alloc_array(region, const char *, count);
+		replaces = xregion_alloc_array(region, struct resync_tuple,
+					       count);
+	}
+	uint32_t replace_count = 0;
+	uint64_t found_count = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		const char *tuple_data = data;
+		if (mp_typeof(*data) != MP_ARRAY) {
+			tnt_raise(ClientError, ER_PROTOCOL,
+				  "Invalid response to RESYNC_FETCH");
+		}
+		mp_next(&data);
+		uint32_t key_size;
+		const char *key = tuple_extract_key_raw(tuple_data, data,
+							key_def, MULTIKEY_NONE,
+							&key_size);
+		if (key == NULL)
+			diag_raise();
+		keys[i] = key;
+		struct tuple *tuple;
+		if (box_index_get(space_id, 0, key, key + key_size,
+				  &tuple) != 0)
+			diag_raise();
+		if (tuple != NULL) {
+			found_count++;
+			uint32_t size;
+			const char *local_data = tuple_data_range(tuple, &size);
+			if (size == (uint32_t)(data - tuple_data) &&
+			    memcmp(local_data, tuple_data, size) == 0)
+				continue;
+		}
+		replaces[replace_count].data = tuple_data;
+		replaces[replace_count].data_end = data;
+		replace_count++;
+	}
+	/*
+	 * The local tuples that aren't found among the master ones
+	 * have to be deleted.
+	 */
+	struct stailq deletions;
+	stailq_create(&deletions);
+	if (local_count > found_count) {
+		qsort_arg(keys, count, sizeof(*keys), resync_key_cmp, key_def);
+		struct resync_local_range lr;
+		resync_local_range_create(&lr, space, range);
+		auto lr_guard = make_scoped_guard([&] {
+			resync_local_range_destroy(&lr);
+		});
+		struct tuple *tuple;
+		while ((tuple = resync_local_range_next(&lr)) != NULL) {
+			if (resync_key_is_found(tuple, keys, count, key_def))
+				continue;
+			struct region *deletion_region = is_system ?
+				&r->deferred_region : region;
+			struct resync_deletion *deletion = xregion_alloc_object(
+				deletion_region, struct resync_deletion);
+			uint32_t key_size;
+			const char *key = tuple_extract_key(tuple, key_def,
+							    MULTIKEY_NONE,
+							    &key_size);
+			if (key == NULL)
+				diag_raise();
+			deletion->space_id = space_id;
+			deletion->key = resync_copy_key(deletion_region, key,
+							key + key_size);
+			deletion->key_end = deletion->key + key_size;
+			if (is_system)
+				stailq_add(&r->deferred, &deletion->in_list);
+			else
+				stailq_add_tail(&deletions,
+						&deletion->in_list);
+		}
+	}
+	/*
+	 * System space changes are committed one by one, so that
+	 * each of them is applied to the schema before the next one.
+	 * Deletions from system spaces are postponed: a space can't
+	 * be dropped before its indexes, privileges and so on.
+	 */
+	uint32_t batch_size = is_system ? 1 : RESYNC_LEAF_SIZE;
+	uint32_t stmt_count = 0;
+	struct txn *txn = NULL;
+	auto txn_guard = make_scoped_guard([&] {
+		if (txn != NULL)
+			txn_abort(txn);
+	});
+	auto commit = [&](bool force) {
+		if (txn == NULL || (!force && ++stmt_count % batch_size != 0))
+			return;
+		struct txn *committed = txn;
+		txn = NULL;
+		if (txn_commit(committed) != 0)
+			diag_raise();
+	};
+	for (uint32_t i = 0; i < replace_count; i++) {
+		if (txn == NULL)
+			txn = resync_txn_begin();
+		resync_execute(IPROTO_REPLACE, space_id, replaces[i].data,
+			       replaces[i].data_end);
+		commit(false);
+	}
+	struct resync_deletion *deletion;
+	stailq_foreach_entry(deletion, &deletions, in_list) {
+		if (txn == NULL)
+			txn = resync_txn_begin();
+		resync_execute(IPROTO_DELETE, space_id, deletion->key,
+			       deletion->key_end);
+		commit(false);
+		r->deleted_count++;
+	}
+	commit(true);
+	r->replaced_count += replace_count;
+}
+
+/** Bring the data of a space in line with the master read view. */
+static void
+resync_space(struct resync *r, uint32_t space_id)
+{
+	RegionGuard region_guard(&r->region);
+	int64_t replaced_count = r->replaced_count;
+	int64_t deleted_count = r->deleted_count;
+	/* Compare the whole space first. */
+	struct resync_range whole;
+	memset(&whole, 0, sizeof(whole));
+	whole.key = resync_empty_key;
+	whole.key_end = resync_empty_key + sizeof(resync_empty_key);
+	struct resync_range *stack = NULL;
+	if (!resync_split(r, space_id, &whole, 1, &stack))
+		return;
+	while (stack != NULL) {
+		struct resync_range *range = stack;
+		stack = stack->next;
+		/* The space may be altered by the changes applied. */
+		struct space *space = space_by_id(space_id);
+		if (space == NULL || space_index(space, 0) == NULL)
+			return;
+		r->compared_count++;
+		uint64_t count, hash;
+		resync_local_summary(space, range, &count, &hash);
+		if (count == range->count && hash == range->hash)
+			continue;
+		if (range->count > RESYNC_LEAF_SIZE &&
+		    space_index(space, 0)->def->type == TREE &&
+		    resync_split(r, space_id, range, RESYNC_FANOUT, &stack))
+			continue;
+		resync_fetch(r, space_id, range, count);
+	}
+	if (r->replaced_count != replaced_count ||
+	    r->deleted_count != deleted_count) {
+		struct space *space = space_by_id(space_id);
+		say_info("resynced space %s: %lld tuples replaced, "
+			 "%lld deleted", space != NULL ? space_name(space) :
+			 int2str(space_id),
+			 (long long)(r->replaced_count - replaced_count),
+			 (long long)(r->deleted_count - deleted_count));
+	}
+}
+
+/** Apply the postponed deletions from system spaces. */
+static void
+resync_apply_deferred(struct resync *r)
+{
+	struct resync_deletion *deletion;
+	stailq_foreach_entry(deletion, &r->deferred, in_list) {
+		if (space_by_id(deletion->space_id) == NULL)
+			continue;
+		struct txn *txn = resync_txn_begin();
+		auto txn_guard = make_scoped_guard([&] { txn_abort(txn); });
+		resync_execute(IPROTO_DELETE, deletion->space_id,
+			       deletion->key, deletion->key_end);
+		txn_guard.is_active = false;
+		if (txn_commit(txn) != 0)
+			diag_raise();
+		r->deleted_count++;
+	}
+	stailq_create(&r->deferred);
+	region_free(&r->deferred_region);
+}
+
+/** IDs of the spaces to resync. */
+struct resync_space_list {
+	/** Collect system spaces if set, user spaces otherwise. */
+	bool is_system;
+	uint32_t *ids;
+	uint32_t count;
+	uint32_t capacity;
+};
+
+static int
+resync_collect_space(struct space *space, void *arg)
+{
+	struct resync_space_list *list = (struct resync_space_list *)arg;
+	if (space_is_system(space) != list->is_system ||
+	    space_is_local(space) || space_is_temporary(space) ||
+	    space_index(space, 0) == NULL ||
+	    (!space_is_memtx(space) && !space_is_vinyl(space)))
+		return 0;
+	if (list->count == list->capacity) {
+		list->capacity = MAX(list->capacity * 2, 16);
+		list->ids = (uint32_t *)xrealloc(list->ids, list->capacity *
+						 sizeof(*list->ids));
+	}
+	list->ids[list->count++] = space->def->id;
+	return 0;
+}
+
+/** Resync all system or all user spaces in the order of IDs. */
+static void
+resync_spaces(struct resync *r, bool is_system)
+{
+	struct resync_space_list list;
+	memset(&list, 0, sizeof(list));
+	list.is_system = is_system;
+	auto list_guard = make_scoped_guard([&] { free(list.ids); });
+	if (space_foreach(resync_collect_space, &list) != 0)
+		diag_raise();
+	for (uint32_t i = 0; i < list.count; i++)
+		resync_space(r, list.ids[i]);
+}
+
+void
+resync_data(struct iostream *io, struct ibuf *ibuf)
+{
+	struct resync r;
+	memset(&r, 0, sizeof(r));
+	r.io = io;
+	r.ibuf = ibuf;
+	region_create(&r.region, &cord()->slabc);
+	region_create(&r.deferred_region, &cord()->slabc);
+	stailq_create(&r.deferred);
+	auto guard = make_scoped_guard([&] {
+		region_destroy(&r.region);
+		region_destroy(&r.deferred_region);
+	});
+	resync_spaces(&r, true);
+	resync_apply_deferred(&r);
+	resync_spaces(&r, false);
+	say_info("resync done: %lld ranges compared, %lld fetched, "
+		 "%lld tuples replaced, %lld deleted",
+		 (long long)r.compared_count, (long long)r.fetched_count,
+		 (long long)r.replaced_count, (long long)r.deleted_count);
+}
+
+/* }}} Replica side */
@@ -0,0 +1,64 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct ibuf;
+struct iostream;
+struct read_view;
+struct xrow_header;
+
+/**
+ * Anti-entropy resync of a replica that can't follow the master
+ * because the WALs it needs have been collected.
+ *
+ * The master opens a read view and the replica walks the primary key
+ * of each space top-down: it asks the master for the number of tuples
+ * and the hash of a key range split into RESYNC_FANOUT subranges,
+ * compares them with its own data and descends only into the
+ * subranges that differ. Small differing ranges are fetched as a whole
+ * and applied as local rows. The hash of a range is the sum of the
+ * hashes of its tuples, so it doesn't depend on the order of tuples
+ * and can be computed in one pass over any primary key.
+ */
+enum {
+	/** Number of subranges a key range is split into. */
+	RESYNC_FANOUT = 16,
+	/** Key ranges with at most this many tuples are fetched. */
+	RESYNC_LEAF_SIZE = 1000,
+};
+
+/** Hash of a tuple used to compare key ranges. */
+uint64_t
+resync_tuple_hash(const char *data, const char *data_end);
+
+/**
+ * Master side: answer the RESYNC_HASH and RESYNC_FETCH requests read
+ * from @a io with the data of @a rv until the replica sends a request
+ * of another type, which is returned in @a row. The row body is stored
+ * in @a ibuf. Throws on error.
+ */
+void
+resync_serve(struct iostream *io, struct ibuf *ibuf, struct read_view *rv,
+	     struct xrow_header *row);
+
+/**
+ * Replica side: bring the data of all replicated spaces in line with
+ * the master read view. System spaces are resynced first, so that user
+ * spaces created or dropped on the master are created or dropped
+ * locally before their data is compared. Throws on error.
+ */
+void
+resync_data(struct iostream *io, struct ibuf *ibuf);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -39,6 +39,7 @@
 #include "error.h"
 #include "tt_static.h"
 #include "sql_stmt_cache.h"
+#include "sql_cursor.h"
 #include "watcher.h"
 #include "on_shutdown.h"
 #include "sql.h"
@@ -259,6 +260,7 @@ session_new(enum session_type type)
 	session->sql_flags = sql_default_session_flags();
 	session->sql_default_engine = SQL_STORAGE_ENGINE_MEMTX;
 	session->sql_stmts = NULL;
+	rlist_create(&session->sql_cursors);
 	session->watchers = NULL;
 	rlist_create(&session->in_shutdown_list);
 
@@ -367,6 +369,7 @@ session_delete(struct session *session)
 	mh_i64ptr_remove(session_registry, &node, NULL);
 	credentials_destroy(&session->credentials);
 	sql_session_stmt_hash_erase(session->sql_stmts);
+	sql_session_cursors_close(&session->sql_cursors);
 	mempool_free(&session_pool, session);
 }
 
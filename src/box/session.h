@@ -128,6 +128,8 @@ struct session {
 	 * This map is allocated on demand.
 	 */
 	struct mh_i32ptr_t *sql_stmts;
+	/** SQL cursors opened in current session. */
+	struct rlist sql_cursors;
 	/** Session user id and global grants */
 	struct credentials credentials;
 	/** Trigger for fiber on_stop to cleanup created on-demand session */
@@ -54,6 +54,7 @@
 #include "iproto_constants.h"
 #include "mpstream/mpstream.h"
 #include "sql_stmt_cache.h"
+#include "sql_cursor.h"
 #include "box/tuple_constraint_def.h"
 #include "mp_util.h"
 #include "tweaks.h"
@@ -97,6 +98,7 @@ sql_init(void)
 		panic("failed to initialize SQL subsystem");
 
 	sql_stmt_cache_init();
+	sql_cursor_init();
 	sql_built_in_functions_cache_init();
 
 	assert(db != NULL);
@@ -897,9 +899,14 @@ cursor_seek(BtCursor *pCur, int *pRes)
 	struct txn_ro_savepoint svp;
 	if (space->def->id != 0 && txn_begin_ro_stmt(space, &txn, &svp) != 0)
 		return -1;
-	struct iterator *it =
-		index_create_iterator(pCur->index, pCur->iter_type, key,
-				      part_count);
+	struct iterator *it;
+	if ((pCur->hints & OPFLAG_KEY_ONLY) != 0) {
+		it = index_create_partial_iterator(pCur->index, pCur->iter_type,
+						   key, part_count);
+	} else {
+		it = index_create_iterator(pCur->index, pCur->iter_type, key,
+					   part_count);
+	}
 	if (txn != NULL)
 		txn_end_ro_stmt(txn, &svp);
 	if (it == NULL) {
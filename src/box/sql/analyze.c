@@ -0,0 +1,412 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+#include "box/index.h"
+#include "box/schema.h"
+#include "box/sql_stmt_cache.h"
+#include "box/tuple.h"
+
+/**
+ * Statistics of an index accumulated while its tuples are scanned in
+ * the index order.
+ *
+ * Rows that have the same first N key parts form a group of N-part
+ * prefixes. A group ends when a row with a different prefix is met,
+ * so the number of distinct prefixes and the number of rows equal to
+ * or less than a sample can be calculated in one pass.
+ */
+struct sql_stat_accum {
+	/**
+	 * Copy of the index key definition. A scan of a vinyl index may
+	 * yield and the index definition may be altered meanwhile.
+	 */
+	struct key_def *key_def;
+	/** Number of parts in the index key. */
+	uint32_t part_count;
+	/** Number of rows scanned so far. */
+	uint32_t row_count;
+	/** Expected number of rows in the index, used to place samples. */
+	uint32_t row_count_est;
+	/** Number of the row after which the next sample is taken. */
+	uint32_t next_sample_row;
+	/** distinct[i] is the number of distinct (i + 1)-part prefixes. */
+	uint32_t *distinct;
+	/** group_start[i] is the row that started the current group. */
+	uint32_t *group_start;
+	/** Samples taken so far. */
+	struct index_sample samples[SQL_STAT4_SAMPLES];
+	/** Number of samples taken so far. */
+	uint32_t sample_count;
+	/** The previous scanned tuple, referenced. */
+	struct tuple *prev;
+};
+
+static void
+sql_stat_accum_create(struct sql_stat_accum *acc, struct index *index)
+{
+	memset(acc, 0, sizeof(*acc));
+	acc->key_def = key_def_dup(index->def->key_def);
+	acc->part_count = acc->key_def->part_count;
+	acc->row_count_est = index_size(index);
+	acc->next_sample_row = acc->row_count_est / (2 * SQL_STAT4_SAMPLES);
+	uint32_t k = acc->part_count;
+	uint32_t *arrays = sql_xmalloc0(sizeof(uint32_t) *
+					(2 * k + 3 * k * SQL_STAT4_SAMPLES));
+	acc->distinct = arrays;
+	acc->group_start = arrays + k;
+	arrays += 2 * k;
+	for (uint32_t i = 0; i < SQL_STAT4_SAMPLES; i++) {
+		acc->samples[i].eq = arrays;
+		acc->samples[i].lt = arrays + k;
+		acc->samples[i].dlt = arrays + 2 * k;
+		arrays += 3 * k;
+	}
+}
+
+static void
+sql_stat_accum_destroy(struct sql_stat_accum *acc)
+{
+	if (acc->prev != NULL)
+		tuple_unref(acc->prev);
+	for (uint32_t i = 0; i < acc->sample_count; i++)
+		sql_xfree(acc->samples[i].sample_key);
+	sql_xfree(acc->distinct);
+	key_def_delete(acc->key_def);
+}
+
+/**
+ * Return the number of the first key part that differs in the two
+ * tuples or the number of key parts if the keys are equal.
+ */
+static uint32_t
+sql_stat_key_diff(struct tuple *a, struct tuple *b, struct key_def *key_def)
+{
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		struct key_part *part = &key_def->parts[i];
+		const char *field_a = tuple_field_by_part(a, part,
+							  MULTIKEY_NONE);
+		const char *field_b = tuple_field_by_part(b, part,
+							  MULTIKEY_NONE);
+		bool a_is_null = field_a == NULL ||
+				 mp_typeof(*field_a) == MP_NIL;
+		bool b_is_null = field_b == NULL ||
+				 mp_typeof(*field_b) == MP_NIL;
+		if (a_is_null || b_is_null) {
+			if (a_is_null != b_is_null)
+				return i;
+			continue;
+		}
+		if (tuple_compare_field(field_a, field_b, part->type,
+					part->coll) != 0)
+			return i;
+	}
+	return key_def->part_count;
+}
+
+/** Account the next tuple of the index scan. */
+static int
+sql_stat_accum_push(struct sql_stat_accum *acc, struct tuple *tuple)
+{
+	uint32_t k = acc->part_count;
+	uint32_t row = acc->row_count++;
+	uint32_t diff = acc->prev == NULL ? 0 :
+			sql_stat_key_diff(acc->prev, tuple, acc->key_def);
+	for (uint32_t i = diff; i < k; i++) {
+		/*
+		 * The group of (i + 1)-part prefixes ends, so all the
+		 * samples taken in it know how many rows are equal to
+		 * them. Groups nest, so only the last samples can be in
+		 * the group.
+		 */
+		for (uint32_t j = acc->sample_count; j > 0; j--) {
+			struct index_sample *sample = &acc->samples[j - 1];
+			if (sample->eq[i] != 0)
+				break;
+			sample->eq[i] = row - sample->lt[i];
+		}
+		acc->group_start[i] = row;
+		acc->distinct[i]++;
+	}
+	if (acc->prev != NULL)
+		tuple_unref(acc->prev);
+	tuple_ref(tuple);
+	acc->prev = tuple;
+
+	if (acc->sample_count == SQL_STAT4_SAMPLES ||
+	    row < acc->next_sample_row)
+		return 0;
+	/* Samples must be distinct, take the next key instead. */
+	if (acc->sample_count > 0 && k > 0 &&
+	    acc->samples[acc->sample_count - 1].lt[k - 1] ==
+	    acc->group_start[k - 1])
+		return 0;
+	struct index_sample *sample = &acc->samples[acc->sample_count];
+	size_t region_svp = region_used(&fiber()->gc);
+	uint32_t key_size;
+	const char *key = tuple_extract_key(tuple, acc->key_def,
+					    MULTIKEY_NONE, &key_size);
+	if (key == NULL)
+		return -1;
+	sample->sample_key = sql_xmalloc(key_size);
+	memcpy(sample->sample_key, key, key_size);
+	sample->key_size = key_size;
+	region_truncate(&fiber()->gc, region_svp);
+	for (uint32_t i = 0; i < k; i++) {
+		sample->lt[i] = acc->group_start[i];
+		sample->dlt[i] = acc->distinct[i] - 1;
+	}
+	acc->sample_count++;
+	acc->next_sample_row = (uint64_t)(2 * acc->sample_count + 1) *
+			       acc->row_count_est / (2 * SQL_STAT4_SAMPLES);
+	return 0;
+}
+
+/** Create index statistics from the accumulated data. */
+static struct index_stat *
+sql_stat_accum_finish(struct sql_stat_accum *acc)
+{
+	uint32_t k = acc->part_count;
+	uint32_t row_count = acc->row_count;
+	struct index_stat *stat = index_stat_new(acc->samples,
+						 acc->sample_count, k);
+	if (stat == NULL)
+		return NULL;
+	stat->tuple_stat1[0] = row_count;
+	stat->tuple_log_est[0] = sqlLogEst(row_count);
+	for (uint32_t i = 0; i < k; i++) {
+		uint32_t distinct = acc->distinct[i];
+		uint32_t avg = distinct == 0 ? 0 :
+			       (row_count + distinct - 1) / distinct;
+		stat->tuple_stat1[i + 1] = avg;
+		stat->tuple_log_est[i + 1] = sqlLogEst(avg);
+		/*
+		 * Average number of rows equal to a prefix which isn't
+		 * in the samples.
+		 */
+		uint64_t sample_rows = 0;
+		uint32_t sample_groups = 0;
+		for (uint32_t j = 0; j < acc->sample_count; j++) {
+			struct index_sample *sample = &acc->samples[j];
+			if (sample->eq[i] == 0)
+				sample->eq[i] = row_count - sample->lt[i];
+			if (j > 0 &&
+			    sample->lt[i] == acc->samples[j - 1].lt[i])
+				continue;
+			sample_rows += sample->eq[i];
+			sample_groups++;
+		}
+		if (distinct > sample_groups && row_count > sample_rows) {
+			avg = (row_count - sample_rows) /
+			      (distinct - sample_groups);
+		}
+		stat->avg_eq[i] = MAX(avg, 1);
+	}
+	for (uint32_t j = 0; j < acc->sample_count; j++) {
+		struct index_sample *src = &acc->samples[j];
+		struct index_sample *dst = &stat->samples[j];
+		memcpy(dst->eq, src->eq, k * sizeof(uint32_t));
+		memcpy(dst->lt, src->lt, k * sizeof(uint32_t));
+		memcpy(dst->dlt, src->dlt, k * sizeof(uint32_t));
+		memcpy(dst->sample_key, src->sample_key, src->key_size);
+	}
+	return stat;
+}
+
+/**
+ * Scan the index and collect its statistics. Only ordered indexes
+ * are analyzed, @a stat is set to NULL for the rest.
+ */
+static int
+sql_analyze_index(struct index *index, struct index_stat **stat)
+{
+	*stat = NULL;
+	struct key_def *key_def = index->def->key_def;
+	if (index->def->type != TREE || key_def->is_multikey ||
+	    key_def->for_func_index)
+		return 0;
+	struct iterator *it = index_create_iterator(index, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		return -1;
+	struct sql_stat_accum acc;
+	sql_stat_accum_create(&acc, index);
+	int rc = -1;
+	while (true) {
+		struct tuple *tuple;
+		if (iterator_next(it, &tuple) != 0)
+			goto out;
+		if (tuple == NULL)
+			break;
+		if (sql_stat_accum_push(&acc, tuple) != 0)
+			goto out;
+	}
+	*stat = sql_stat_accum_finish(&acc);
+	if (*stat != NULL)
+		rc = 0;
+out:
+	sql_stat_accum_destroy(&acc);
+	iterator_delete(it);
+	return rc;
+}
+
+int
+sql_analyze_space(uint32_t space_id)
+{
+	for (uint32_t iid = 0; ; iid++) {
+		/*
+		 * A scan of a vinyl index may yield, so the space
+		 * is looked up anew for each of its indexes.
+		 */
+		struct space *space = space_by_id(space_id);
+		if (space == NULL || space->def->opts.is_view ||
+		    iid > space->index_id_max)
+			return 0;
+		if (!space_is_memtx(space) && !space_is_vinyl(space))
+			return 0;
+		struct index *index = space_index(space, iid);
+		if (index == NULL)
+			continue;
+		uint64_t schema_ver = box_schema_version();
+		struct index_stat *stat;
+		if (sql_analyze_index(index, &stat) != 0)
+			return -1;
+		if (stat == NULL)
+			continue;
+		/*
+		 * The index could be dropped or altered while the
+		 * scan yielded, the statistics are stale then.
+		 */
+		if (box_schema_version() != schema_ver) {
+			free(stat);
+			continue;
+		}
+		free(index->def->opts.stat);
+		index->def->opts.stat = stat;
+		/* Plans of ad-hoc statements may change. */
+		sql_plan_cache_expire();
+	}
+}
+
+/**
+ * Extract a value from a literal expression. Return false if the
+ * expression is not a literal or its value is not supported.
+ */
+static bool
+sql_stat_value_from_expr(struct Expr *expr, struct Mem *mem)
+{
+	bool is_neg = false;
+	if (expr->op == TK_UMINUS) {
+		is_neg = true;
+		expr = expr->pLeft;
+	}
+	switch (expr->op) {
+	case TK_INTEGER: {
+		int64_t value;
+		if ((expr->flags & EP_IntValue) != 0) {
+			value = expr->u.iValue;
+		} else {
+			const char *z = expr->u.zToken;
+			bool unused;
+			if (z[0] == '0' && (z[1] == 'x' || z[1] == 'X'))
+				return false;
+			if (sql_atoi64(z, &value, &unused, strlen(z)) != 0)
+				return false;
+		}
+		if (!is_neg) {
+			mem_set_int(mem, value, false);
+			return true;
+		}
+		if ((uint64_t)value > (uint64_t)INT64_MAX + 1)
+			return false;
+		/* Negation of INT64_MIN is equal to it. */
+		if (value != INT64_MIN)
+			value = -value;
+		mem_set_int(mem, value, value < 0);
+		return true;
+	}
+	case TK_FLOAT: {
+		double value;
+		sqlAtoF(expr->u.zToken, &value, sqlStrlen30(expr->u.zToken));
+		mem_set_double(mem, is_neg ? -value : value);
+		return true;
+	}
+	case TK_STRING:
+		if (is_neg)
+			return false;
+		return mem_copy_str0(mem, expr->u.zToken) == 0;
+	case TK_TRUE:
+	case TK_FALSE:
+		if (is_neg)
+			return false;
+		mem_set_bool(mem, expr->op == TK_TRUE);
+		return true;
+	case TK_NULL:
+		if (is_neg)
+			return false;
+		mem_set_null(mem);
+		return true;
+	default:
+		return false;
+	}
+}
+
+int
+sqlStat4ProbeSetValue(struct Parse *parse, struct index_def *idx_def,
+		      struct UnpackedRecord **rec, struct Expr *expr,
+		      int elem_count, int first, int *extract_count)
+{
+	(void)parse;
+	*extract_count = 0;
+	if (expr != NULL && expr->op == TK_SELECT)
+		return 0;
+	for (int i = 0; i < elem_count; i++) {
+		/* NULL expression stands for "x IS NULL" constraint. */
+		struct Expr *elem = expr == NULL ? NULL :
+				    sqlVectorFieldSubexpr(expr, i);
+		struct Mem mem;
+		mem_create(&mem);
+		if (elem != NULL && !sql_stat_value_from_expr(elem, &mem)) {
+			mem_destroy(&mem);
+			break;
+		}
+		if (*rec == NULL) {
+			*rec = sqlVdbeAllocUnpackedRecord(idx_def->key_def);
+			(*rec)->default_rc = 0;
+		}
+		mem_move(&(*rec)->aMem[first + i], &mem);
+		++*extract_count;
+	}
+	return 0;
+}
+
+int
+sqlStat4ValueFromExpr(struct Parse *parse, struct Expr *expr,
+		      enum field_type type, struct Mem **value)
+{
+	(void)parse;
+	(void)type;
+	*value = NULL;
+	struct Mem mem;
+	mem_create(&mem);
+	if (!sql_stat_value_from_expr(expr, &mem)) {
+		mem_destroy(&mem);
+		return 0;
+	}
+	*value = sql_xmalloc(sizeof(struct Mem));
+	mem_create(*value);
+	mem_move(*value, &mem);
+	return 0;
+}
+
+void
+sqlStat4ProbeFree(struct UnpackedRecord *rec)
+{
+	if (rec == NULL)
+		return;
+	for (uint32_t i = 0; i < rec->key_def->part_count + 1; i++)
+		mem_destroy(&rec->aMem[i]);
+	sql_xfree(rec);
+}
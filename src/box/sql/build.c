@@ -3144,12 +3144,16 @@ struct sql_option_metadata
  * It is IMPORTANT that these options sorted by name.
  */
 static struct sql_option_metadata sql_session_opts[] = {
+	/** SESSION_SETTING_SQL_BATCH_EXECUTION */
+	{FIELD_TYPE_BOOLEAN, SQL_BatchExec},
 	/** SESSION_SETTING_SQL_DEFAULT_ENGINE */
 	{FIELD_TYPE_STRING, 0},
 	/** SESSION_SETTING_SQL_FULL_COLUMN_NAMES */
 	{FIELD_TYPE_BOOLEAN, SQL_FullColNames},
 	/** SESSION_SETTING_SQL_FULL_METADATA */
 	{FIELD_TYPE_BOOLEAN, SQL_FullMetadata},
+	/** SESSION_SETTING_SQL_HASH_JOIN */
+	{FIELD_TYPE_BOOLEAN, SQL_HashJoin},
 	/** SESSION_SETTING_SQL_PARSER_DEBUG */
 	{FIELD_TYPE_BOOLEAN, SQL_SqlTrace | PARSER_TRACE_FLAG},
 	/** SESSION_SETTING_SQL_RECURSIVE_TRIGGERS */
@@ -3369,3 +3373,42 @@ sql_emit_show_create_table_all(struct Parse *parse)
 	sqlVdbeAddOp2(v, OP_Next, cursor, addr2);
 	sqlVdbeJumpHere(v, addr1);
 }
+
+/** Emit VDBE instructions for "ANALYZE table_name;" statement. */
+void
+sql_emit_analyze_one(struct Parse *parse, struct Token *name)
+{
+	char *space_name = sql_name_from_token(name);
+	struct space *space = space_by_name0(space_name);
+	if (space == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_SPACE, space_name);
+		parse->is_aborted = true;
+		sql_xfree(space_name);
+		return;
+	}
+	sql_xfree(space_name);
+	struct Vdbe *v = sqlGetVdbe(parse);
+	int space_id_reg = ++parse->nMem;
+	sqlVdbeAddOp2(v, OP_Integer, space->def->id, space_id_reg);
+	sqlVdbeAddOp1(v, OP_Analyze, space_id_reg);
+}
+
+/** Emit VDBE instructions for "ANALYZE;" statement. */
+void
+sql_emit_analyze_all(struct Parse *parse)
+{
+	struct Vdbe *v = sqlGetVdbe(parse);
+	int cursor = parse->nTab++;
+	int space_reg = ++parse->nMem;
+	int key_reg = ++parse->nMem;
+	sqlVdbeAddOp2(v, OP_OpenSpace, space_reg, BOX_VSPACE_ID);
+	sqlVdbeAddOp3(v, OP_IteratorOpen, cursor, 0, space_reg);
+	sqlVdbeAddOp2(v, OP_Integer, BOX_SYSTEM_ID_MAX, key_reg);
+	int addr1 = sqlVdbeAddOp4Int(v, OP_SeekGT, cursor, 0, key_reg, 1);
+	int space_id_reg = ++parse->nMem;
+	int addr2 = sqlVdbeAddOp3(v, OP_Column, cursor, BOX_SPACE_FIELD_ID,
+				  space_id_reg);
+	sqlVdbeAddOp1(v, OP_Analyze, space_id_reg);
+	sqlVdbeAddOp2(v, OP_Next, cursor, addr2);
+	sqlVdbeJumpHere(v, addr1);
+}
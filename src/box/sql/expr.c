@@ -1182,6 +1182,37 @@ sqlExprFunction(Parse * pParse, ExprList * pList, Token * pToken)
 	return new_expr;
 }
 
+struct Expr *
+sql_expr_new_over(struct Parse *parse, struct ExprList *partition,
+		  struct ExprList *order)
+{
+	struct Expr *over = sql_expr_new_anon(TK_OVER);
+	ExprSetProperty(over, EP_NoReduce);
+	over->iColumn = partition != NULL ? partition->nExpr : 0;
+	struct ExprList *list = partition;
+	for (int i = 0; order != NULL && i < order->nExpr; i++) {
+		list = sql_expr_list_append(list, order->a[i].pExpr);
+		list->a[list->nExpr - 1].sort_order = order->a[i].sort_order;
+		order->a[i].pExpr = NULL;
+	}
+	sql_expr_list_delete(order);
+	over->x.pList = list;
+	sqlExprSetHeightAndFlags(parse, over);
+	return over;
+}
+
+struct Expr *
+sql_expr_new_window(struct Parse *parse, struct Token *name,
+		    struct ExprList *args, struct Expr *over)
+{
+	struct Expr *expr = sqlExprFunction(parse, args, name);
+	expr->op = TK_WINDOW;
+	ExprSetProperty(expr, EP_NoReduce);
+	expr->pRight = over;
+	sqlExprSetHeightAndFlags(parse, expr);
+	return expr;
+}
+
 /*
  * Assign a variable number to an expression that encodes a
  * wildcard in the original SQL statement.
@@ -1980,6 +2011,10 @@ exprNodeIsConstant(Walker * pWalker, Expr * pExpr)
 			pWalker->eCode = 0;
 			return WRC_Abort;
 		}
+	case TK_WINDOW:
+		/* A window function depends on the rows of its window. */
+		pWalker->eCode = 0;
+		return WRC_Abort;
 	case TK_ID:
 	case TK_COLUMN_REF:
 	case TK_AGG_FUNCTION:
@@ -3887,6 +3922,9 @@ sqlExprCodeTarget(Parse * pParse, Expr * pExpr, int target)
 			}
 			break;
 		}
+	case TK_WINDOW:
+		assert(pExpr->pAggInfo != NULL);
+		return pExpr->pAggInfo->aFunc[pExpr->iAgg].iMem;
 	case TK_FUNCTION:{
 			ExprList *pFarg;	/* List of function arguments */
 			int nFarg;	/* Number of function arguments */
@@ -5304,6 +5342,43 @@ analyzeAggregate(Walker * pWalker, Expr * pExpr)
 				return WRC_Continue;
 			}
 		}
+	case TK_WINDOW:{
+			if (pWalker->walkerDepth != pExpr->op2)
+				return WRC_Continue;
+			/*
+			 * Window functions are computed by the
+			 * window pass of the SELECT into the
+			 * accumulator MEM of their aFunc[] entry.
+			 * Only SUM() has a function to call, the
+			 * others are counters maintained by the pass.
+			 */
+			struct AggInfo_func *pItem = pAggInfo->aFunc;
+			for (i = 0; i < pAggInfo->nFunc; i++, pItem++) {
+				if (sqlExprCompare(pItem->pExpr, pExpr, -1) == 0)
+					break;
+			}
+			if (i >= pAggInfo->nFunc) {
+				i = addAggInfoFunc(pAggInfo);
+				pItem = &pAggInfo->aFunc[i];
+				pItem->pExpr = pExpr;
+				pItem->iDistinct = -1;
+				pItem->func = NULL;
+				int n = pExpr->x.pList == NULL ?
+					0 : pExpr->x.pList->nExpr;
+				pParse->nMem += n;
+				pItem->iMem = ++pParse->nMem;
+				if (n > 0) {
+					pItem->func = sql_func_find(pExpr);
+					if (pItem->func == NULL) {
+						pParse->is_aborted = true;
+						return WRC_Abort;
+					}
+				}
+			}
+			pExpr->iAgg = (i16) i;
+			pExpr->pAggInfo = pAggInfo;
+			return WRC_Prune;
+		}
 	}
 	return WRC_Continue;
 }
@@ -1970,6 +1970,15 @@ mem_move(struct Mem *to, struct Mem *from)
 	from->zMalloc = NULL;
 }
 
+int
+mem_make_own(struct Mem *mem)
+{
+	if (!mem_is_bytes(mem) ||
+	    (mem->flags & (MEM_Static | MEM_Ephem)) == 0)
+		return 0;
+	return sqlVdbeMemGrow(mem, mem->n, 1);
+}
+
 int
 mem_append(struct Mem *mem, const char *value, size_t len)
 {
@@ -552,6 +552,13 @@ mem_copy_as_ephemeral(struct Mem *to, const struct Mem *from);
 void
 mem_move(struct Mem *to, struct Mem *from);
 
+/**
+ * Copy STRING, VARBINARY, MAP or ARRAY value with STATIC or EPHEMERAL
+ * allocation type to memory allocated by MEM. Other values are left as is.
+ */
+int
+mem_make_own(struct Mem *mem);
+
 /**
  * Append the given string to the end of the STRING or VARBINARY contained in
  * MEM. In case MEM needs to increase the size of allocated memory, additional
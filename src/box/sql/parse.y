@@ -1146,6 +1146,32 @@ expr(A) ::= id(X) LP STAR RP(E). {
   A.pExpr = sqlExprFunction(pParse, 0, &X);
   spanSet(&A,&X,&E);
 }
+
+expr(A) ::= id(X) LP distinct(D) exprlist(Y) RP OVER LP window(W) RP(E). {
+  if (D == SF_Distinct) {
+    diag_set(ClientError, ER_UNSUPPORTED, "Tarantool",
+             "DISTINCT in window functions");
+    pParse->is_aborted = true;
+  }
+  A.pExpr = sql_expr_new_window(pParse, &X, Y, W);
+  spanSet(&A,&X,&E);
+}
+
+expr(A) ::= ROW_NUMBER|RANK(X) LP RP OVER LP window(W) RP(E). {
+  A.pExpr = sql_expr_new_window(pParse, &X, NULL, W);
+  spanSet(&A,&X,&E);
+}
+
+%type window {struct Expr *}
+%destructor window {sql_expr_delete($$);}
+window(A) ::= partition_opt(P) orderby_opt(O). {
+  A = sql_expr_new_over(pParse, P, O);
+}
+
+%type partition_opt {ExprList*}
+%destructor partition_opt {sql_expr_list_delete($$);}
+partition_opt(A) ::= .                          {A = NULL;}
+partition_opt(A) ::= PARTITION BY nexprlist(X). {A = X;}
 /*
  * term(A) ::= CTIME_KW(OP). {
  *   A.pExpr = sqlExprFunction(pParse, 0, &OP);
@@ -1510,6 +1536,14 @@ cmd ::= SHOW CREATE TABLE. {
   sql_emit_show_create_table_all(pParse);
 }
 
+//////////////////////////// The ANALYZE command /////////////////////////////
+cmd ::= ANALYZE nm(X). {
+  sql_emit_analyze_one(pParse, &X);
+}
+cmd ::= ANALYZE. {
+  sql_emit_analyze_all(pParse);
+}
+
 //////////////////////////// The CREATE TRIGGER command /////////////////////
 
 cmd ::= createkw trigger_decl(A) BEGIN trigger_cmd_list(S) END(Z). {
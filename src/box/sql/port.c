@@ -221,7 +221,17 @@ sql_get_prepare_common_keys(struct Vdbe *stmt, struct obuf *out, int keys)
  * |                                              |
  * |     IPROTO_DATA: [                           |
  * |         tuple, tuple, tuple, ...             |
- * |     ]                                        |
+ * |     ],                                       |
+ * |                                              |
+ * |     IPROTO_SQL_CURSOR_ID: number (optional)  |
+ * | }                                            |
+ * +-------------------- OR ----------------------+
+ * | IPROTO_BODY: {                               |
+ * |     IPROTO_DATA: [                           |
+ * |         tuple, tuple, tuple, ...             |
+ * |     ],                                       |
+ * |                                              |
+ * |     IPROTO_SQL_CURSOR_ID: number (optional)  |
  * | }                                            |
  * +-------------------- OR ----------------------+
  * | IPROTO_BODY: {                               |
@@ -252,8 +262,11 @@ port_sql_dump_msgpack(struct port *port, struct obuf *out)
 	struct port_sql *sql_port = (struct port_sql *)port;
 	struct Vdbe *stmt = sql_port->stmt;
 	switch (sql_port->serialization_format) {
-	case DQL_EXECUTE: {
-		int keys = 2;
+	case DQL_EXECUTE:
+	case DQL_FETCH: {
+		uint32_t cursor_id = sql_port->cursor_id;
+		bool is_fetch = sql_port->serialization_format == DQL_FETCH;
+		int keys = (is_fetch ? 1 : 2) + (cursor_id != 0 ? 1 : 0);
 		int size = mp_sizeof_map(keys);
 		char *pos = obuf_alloc(out, size);
 		if (pos == NULL) {
@@ -261,7 +274,8 @@ port_sql_dump_msgpack(struct port *port, struct obuf *out)
 			return -1;
 		}
 		pos = mp_encode_map(pos, keys);
-		if (sql_get_metadata(stmt, out, sql_column_count(stmt)) != 0)
+		if (!is_fetch &&
+		    sql_get_metadata(stmt, out, sql_column_count(stmt)) != 0)
 			return -1;
 		size = mp_sizeof_uint(IPROTO_DATA);
 		pos = obuf_alloc(out, size);
@@ -272,6 +286,17 @@ port_sql_dump_msgpack(struct port *port, struct obuf *out)
 		pos = mp_encode_uint(pos, IPROTO_DATA);
 		if (port_c_vtab.dump_msgpack(port, out) < 0)
 			return -1;
+		if (cursor_id == 0)
+			break;
+		size = mp_sizeof_uint(IPROTO_SQL_CURSOR_ID) +
+		       mp_sizeof_uint(cursor_id);
+		pos = obuf_alloc(out, size);
+		if (pos == NULL) {
+			diag_set(OutOfMemory, size, "obuf_alloc", "pos");
+			return -1;
+		}
+		pos = mp_encode_uint(pos, IPROTO_SQL_CURSOR_ID);
+		pos = mp_encode_uint(pos, cursor_id);
 		break;
 	}
 	case DML_EXECUTE: {
@@ -386,6 +411,7 @@ port_sql_create(struct port *port, struct Vdbe *stmt,
 	port->vtab = &port_sql_vtab;
 	struct port_sql *port_sql = (struct port_sql *)port;
 	port_sql->stmt = stmt;
+	port_sql->cursor_id = 0;
 	port_sql->serialization_format = format;
 	port_sql->do_finalize = do_finalize;
 }
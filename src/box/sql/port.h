@@ -21,6 +21,8 @@ enum sql_serialization_format {
 	DML_EXECUTE = 1,
 	DQL_PREPARE = 2,
 	DML_PREPARE = 3,
+	/** Rows fetched from an SQL cursor, without metadata. */
+	DQL_FETCH = 4,
 };
 
 /** Methods of struct port_sql. */
@@ -41,6 +43,11 @@ struct port_sql {
 	struct port_c base;
 	/* Prepared SQL statement. */
 	struct Vdbe *stmt;
+	/**
+	 * ID of the SQL cursor holding the rest of the rows of
+	 * a DQL response, 0 if all the rows are in the port.
+	 */
+	uint32_t cursor_id;
 	/**
 	 * Serialization format depends on type of SQL query: DML or
 	 * DQL; and on type of SQL request: execute or prepare.
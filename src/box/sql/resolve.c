@@ -382,6 +382,17 @@ lookupName(Parse * pParse,	/* The parsing context */
 						pParse->is_aborted = true;
 						return WRC_Abort;
 					}
+					if ((pNC->ncFlags & NC_AllowWin) == 0 &&
+					    ExprHasProperty(pOrig, EP_Win)) {
+						diag_set(ClientError,
+							 ER_SQL_PARSER_GENERIC,
+							 tt_sprintf("misuse of "
+								    "aliased window "
+								    "function %s",
+								    zAs));
+						pParse->is_aborted = true;
+						return WRC_Abort;
+					}
 					if (sqlExprVectorSize(pOrig) != 1) {
 						diag_set(ClientError,
 							 ER_SQL_PARSER_GENERIC,
@@ -668,6 +679,63 @@ resolveExprStep(Walker * pWalker, Expr * pExpr)
 				ExprSetProperty(pExpr, EP_ConstFunc);
 			return WRC_Prune;
 		}
+	case TK_WINDOW:{
+			const char *name = pExpr->u.zToken;
+			ExprList *pList = pExpr->x.pList;
+			int n = pList != NULL ? pList->nExpr : 0;
+			if ((pNC->ncFlags & NC_AllowWin) == 0) {
+				const char *err = tt_sprintf("misuse of window "\
+							     "function %s()",
+							     name);
+				diag_set(ClientError, ER_SQL_PARSER_GENERIC, err);
+				pParse->is_aborted = true;
+				pNC->nErr++;
+				return WRC_Abort;
+			}
+			bool is_sum = strcmp(name, "SUM") == 0;
+			if (!is_sum && strcmp(name, "ROW_NUMBER") != 0 &&
+			    strcmp(name, "RANK") != 0) {
+				diag_set(ClientError, ER_UNSUPPORTED, "Tarantool",
+					 tt_sprintf("window function %s()",
+						    name));
+				pParse->is_aborted = true;
+				pNC->nErr++;
+				return WRC_Abort;
+			}
+			/*
+			 * Neither aggregate nor window functions
+			 * may be used in the arguments and the
+			 * window of a window function.
+			 */
+			u16 allowed = pNC->ncFlags & (NC_AllowWin | NC_AllowAgg);
+			pNC->ncFlags &= ~allowed;
+			sqlWalkExprList(pWalker, pList);
+			sqlWalkExprList(pWalker, pExpr->pRight->x.pList);
+			pNC->ncFlags |= allowed;
+			if (pParse->is_aborted)
+				return WRC_Abort;
+			pNC->ncFlags |= NC_HasWin;
+			pExpr->op2 = 0;
+			if (!is_sum && n != 0) {
+				diag_set(ClientError, ER_FUNC_WRONG_ARG_COUNT,
+					 name, "0", n);
+				pParse->is_aborted = true;
+				pNC->nErr++;
+				return WRC_Abort;
+			}
+			if (!is_sum) {
+				pExpr->type = FIELD_TYPE_INTEGER;
+				return WRC_Prune;
+			}
+			struct func *func = sql_func_find(pExpr);
+			if (func == NULL) {
+				pParse->is_aborted = true;
+				pNC->nErr++;
+				return WRC_Abort;
+			}
+			pExpr->type = func->def->returns;
+			return WRC_Prune;
+		}
 	case TK_SELECT:
 	case TK_EXISTS:
 	case TK_IN:{
@@ -1182,7 +1250,7 @@ resolveSelectStep(Walker * pWalker, Select * p)
 		 * resolve the result-set expression list.
 		 */
 		bool is_all_select_agg = true;
-		sNC.ncFlags = NC_AllowAgg;
+		sNC.ncFlags = NC_AllowAgg | NC_AllowWin;
 		sNC.pSrcList = p->pSrc;
 		sNC.pNext = pOuterNC;
 		struct ExprList_item *item = p->pEList->a;
@@ -1209,6 +1277,13 @@ resolveSelectStep(Walker * pWalker, Select * p)
 			if (sqlResolveExprNames(&sNC, item->pExpr) != 0)
 				return WRC_Abort;
 		}
+		/*
+		 * Window functions are allowed only in the
+		 * result set and in the ORDER BY clause.
+		 */
+		if ((sNC.ncFlags & NC_HasWin) != 0)
+			p->selFlags |= SF_Window;
+		sNC.ncFlags &= ~NC_AllowWin;
 
 		/*
 		 * If there are no aggregate functions in the
@@ -1226,6 +1301,14 @@ resolveSelectStep(Walker * pWalker, Select * p)
 		} else {
 			sNC.ncFlags &= ~NC_AllowAgg;
 		}
+		if ((p->selFlags & SF_Window) != 0 &&
+		    (p->selFlags & (SF_Aggregate | SF_Distinct)) != 0) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Tarantool",
+				 "window functions in aggregate or DISTINCT "
+				 "queries");
+			pParse->is_aborted = true;
+			return WRC_Abort;
+		}
 
 		/*
 		 * Add the output column list to the name-context
@@ -1313,11 +1396,14 @@ resolveSelectStep(Walker * pWalker, Select * p)
 		 * is not detected until much later, and so we need to go ahead and
 		 * resolve those symbols on the incorrect ORDER BY for consistency.
 		 */
+		if ((p->selFlags & SF_Window) != 0)
+			sNC.ncFlags |= NC_AllowWin;
 		if (isCompound <= nCompound	/* Defer right-most ORDER BY of a compound */
 		    && resolveOrderGroupBy(&sNC, p, p->pOrderBy, "ORDER")
 		    ) {
 			return WRC_Abort;
 		}
+		sNC.ncFlags &= ~NC_AllowWin;
 
 		/* Resolve the GROUP BY clause.  At the same time, make sure
 		 * the GROUP BY clause does not contain aggregate functions.
@@ -1447,8 +1533,8 @@ sqlResolveExprNames(NameContext * pNC,	/* Namespace to resolve expressions in. *
 		pParse->nHeight += pExpr->nHeight;
 	}
 #endif
-	savedHasAgg = pNC->ncFlags & (NC_HasAgg | NC_MinMaxAgg);
-	pNC->ncFlags &= ~(NC_HasAgg | NC_MinMaxAgg);
+	savedHasAgg = pNC->ncFlags & (NC_HasAgg | NC_MinMaxAgg | NC_HasWin);
+	pNC->ncFlags &= ~(NC_HasAgg | NC_MinMaxAgg | NC_HasWin);
 	w.pParse = pNC->pParse;
 	w.xExprCallback = resolveExprStep;
 	w.xSelectCallback = resolveSelectStep;
@@ -1466,6 +1552,8 @@ sqlResolveExprNames(NameContext * pNC,	/* Namespace to resolve expressions in. *
 	if (pNC->ncFlags & NC_HasAgg) {
 		ExprSetProperty(pExpr, EP_Agg);
 	}
+	if ((pNC->ncFlags & NC_HasWin) != 0)
+		ExprSetProperty(pExpr, EP_Win);
 	pNC->ncFlags |= savedHasAgg;
 	return ExprHasProperty(pExpr, EP_Error);
 }
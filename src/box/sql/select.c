@@ -357,6 +357,24 @@ is_same_sorting_direction(const struct ExprList *expr_list)
 	return true;
 }
 
+/**
+ * Return true if LIMIT and OFFSET of the SELECT are constants and
+ * their sum doesn't exceed SQL_SORTER_TOPN_MAX, so the sorter may
+ * keep the first rows in a heap, see sqlVdbeSorterLimit().
+ */
+static bool
+select_has_small_limit(const struct Select *p)
+{
+	int limit;
+	int offset = 0;
+	if (p->pLimit == NULL || !sqlExprIsInteger(p->pLimit, &limit))
+		return false;
+	if (p->pOffset != NULL && !sqlExprIsInteger(p->pOffset, &offset))
+		return false;
+	return limit > 0 && offset >= 0 &&
+	       (int64_t)limit + offset <= SQL_SORTER_TOPN_MAX;
+}
+
 /*
  * Allocate a new Select structure and return a pointer to that
  * structure.
@@ -1046,8 +1064,12 @@ pushOntoSorter(Parse * pParse,		/* Parser context */
 		sqlVdbeJumpHere(v, addrJmp);
 	}
 	if (pSort->sortFlags & SORTFLAG_UseSorter) {
-		sqlVdbeAddOp2(v, OP_SorterInsert, pSort->iECursor,
-				  regRecord);
+		/*
+		 * Only the first LIMIT+OFFSET rows are read from
+		 * the sorter, so it may keep only them.
+		 */
+		sqlVdbeAddOp3(v, OP_SorterInsert, pSort->iECursor,
+			      regRecord, iLimit);
 		return;
 	}
 	sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, pSort->reg_eph);
@@ -3929,6 +3951,11 @@ substSelect(Parse * pParse,	/* Report errors here */
  *        "SELECT x FROM (SELECT max(y), x FROM t1)" would not necessarily
  *        return the value X for which Y was maximal.)
  *
+ *  (25)  The subquery does not use window functions, and if the outer
+ *        query uses window functions, the subquery is not an aggregate
+ *        and does not use LIMIT. Otherwise the window functions would
+ *        be computed over a different set of rows.
+ *
  *
  * In this routine, the "p" parameter is a pointer to the outer query.
  * The subquery is p->pSrc->a[iFrom].  isAgg is true if the outer query
@@ -4023,6 +4050,10 @@ flattenSubquery(Parse * pParse,		/* Parsing context */
 	if ((p->selFlags & SF_Recursive) && pSub->pPrior) {
 		return 0;	/* Restriction (23) */
 	}
+	if ((pSub->selFlags & SF_Window) != 0 ||
+	    ((p->selFlags & SF_Window) != 0 &&
+	     (subqueryIsAgg || pSub->pLimit != NULL)))
+		return 0;	/* Restriction (25) */
 
 	/* OBSOLETE COMMENT 1:
 	 * Restriction 3:  If the subquery is a join, make sure the subquery is
@@ -4370,6 +4401,9 @@ flattenSubquery(Parse * pParse,		/* Parsing context */
  *   (5) The WHERE clause expression originates in the ON or USING clause
  *       of a LEFT JOIN.
  *
+ *   (6) The inner query uses window functions, which must be computed
+ *       over the rows not filtered by the outer WHERE clause.
+ *
  * Return 0 if no changes are made and non-zero if one or more WHERE clause
  * terms are duplicated into the subquery.
  */
@@ -4388,6 +4422,8 @@ pushDownWhereTerms(Parse * pParse,	/* Parse context (for malloc() and error repo
 		if ((pX->selFlags & (SF_Aggregate | SF_Recursive)) != 0) {
 			return 0;	/* restrictions (1) and (2) */
 		}
+		if ((pX->selFlags & SF_Window) != 0)
+			return 0;	/* restriction (6) */
 	}
 	if (pSubq->pLimit != 0) {
 		return 0;	/* restriction (3) */
@@ -4492,6 +4528,265 @@ is_simple_count(struct Select *select, struct AggInfo *agg_info)
 	return space;
 }
 
+/**
+ * Maximum number of WHERE terms and of aggregate functions of a batch
+ * aggregate query.
+ */
+enum { BATCH_AGGREGATE_TERM_MAX = 16 };
+
+/**
+ * Check if the field can be decoded into a typed array by the batch
+ * execution. Only INTEGER, UNSIGNED and DOUBLE fields are supported.
+ */
+static bool
+batch_field_is_supported(const struct space_def *def, int fieldno,
+			 bool *is_double)
+{
+	assert(fieldno >= 0 && (uint32_t)fieldno < def->field_count);
+	enum field_type type = def->fields[fieldno].type;
+	*is_double = type == FIELD_TYPE_DOUBLE;
+	return type == FIELD_TYPE_INTEGER || type == FIELD_TYPE_UNSIGNED ||
+	       type == FIELD_TYPE_DOUBLE;
+}
+
+/** Check if the field is the first part of any index of the space. */
+static bool
+batch_field_is_indexed(const struct space *space, uint32_t fieldno)
+{
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (space->index[i]->def->key_def->parts[0].fieldno == fieldno)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Split the WHERE clause into terms connected with AND. Return false
+ * if there are too many of them.
+ */
+static bool
+batch_where_split(struct Expr *expr, struct Expr **terms, uint32_t *count)
+{
+	if (expr == NULL)
+		return true;
+	if (expr->op == TK_AND) {
+		return batch_where_split(expr->pLeft, terms, count) &&
+		       batch_where_split(expr->pRight, terms, count);
+	}
+	if (*count == BATCH_AGGREGATE_TERM_MAX)
+		return false;
+	terms[(*count)++] = expr;
+	return true;
+}
+
+/**
+ * Parse a WHERE term of the form "<column> <op> <literal>" or
+ * "<literal> <op> <column>" into a filter. The literal must be an integer
+ * for an INTEGER or UNSIGNED column and an integer or a float for
+ * a DOUBLE column. The number of the column is returned in @a fieldno.
+ */
+static bool
+batch_filter_parse(struct Expr *expr, int cursor, const struct space *space,
+		   struct sql_batch_filter *filter, uint32_t *fieldno)
+{
+	int op = expr->op;
+	if (op != TK_EQ && op != TK_NE && op != TK_LT && op != TK_LE &&
+	    op != TK_GT && op != TK_GE)
+		return false;
+	struct Expr *column = expr->pLeft;
+	struct Expr *value = expr->pRight;
+	if (column->op != TK_COLUMN_REF) {
+		SWAP(column, value);
+		if (op == TK_LT)
+			op = TK_GT;
+		else if (op == TK_LE)
+			op = TK_GE;
+		else if (op == TK_GT)
+			op = TK_LT;
+		else if (op == TK_GE)
+			op = TK_LE;
+	}
+	if (column->op != TK_COLUMN_REF || column->iTable != cursor ||
+	    column->iColumn < 0)
+		return false;
+	bool is_double;
+	if (!batch_field_is_supported(space->def, column->iColumn, &is_double))
+		return false;
+	/* The planner would use an index instead of a full scan. */
+	if (op != TK_NE && batch_field_is_indexed(space, column->iColumn))
+		return false;
+	bool is_neg = false;
+	if (value->op == TK_UMINUS) {
+		is_neg = true;
+		value = value->pLeft;
+	}
+	if (value->op == TK_INTEGER && (value->flags & EP_IntValue) != 0) {
+		int64_t i = is_neg ? -(int64_t)value->u.iValue :
+			    value->u.iValue;
+		if (is_double)
+			filter->d = i;
+		else
+			filter->i = i;
+	} else if (value->op == TK_FLOAT && is_double) {
+		double d;
+		sqlAtoF(value->u.zToken, &d, sqlStrlen30(value->u.zToken));
+		filter->d = is_neg ? -d : d;
+	} else {
+		return false;
+	}
+	filter->op = op;
+	*fieldno = column->iColumn;
+	return true;
+}
+
+/** Return the index of the column with the given field number. */
+static uint32_t
+batch_plan_column(const struct sql_batch_plan *plan, uint32_t fieldno)
+{
+	for (uint32_t i = 0; i < plan->column_count; i++) {
+		if (plan->columns[i].fieldno == fieldno)
+			return i;
+	}
+	unreachable();
+	return 0;
+}
+
+/** Add the field to the columns of the plan keeping them sorted. */
+static void
+batch_plan_add_column(struct sql_batch_plan *plan, uint32_t fieldno,
+		      bool is_double)
+{
+	uint32_t i = plan->column_count;
+	for (; i > 0 && plan->columns[i - 1].fieldno >= fieldno; i--) {
+		if (plan->columns[i - 1].fieldno == fieldno)
+			return;
+	}
+	memmove(&plan->columns[i + 1], &plan->columns[i],
+		(plan->column_count - i) * sizeof(plan->columns[0]));
+	plan->columns[i].fieldno = fieldno;
+	plan->columns[i].is_double = is_double;
+	plan->column_count++;
+}
+
+/**
+ * Check if the aggregate query without GROUP BY can be executed by
+ * OP_BatchAggregate, i.e. it is of the form
+ *
+ *   SELECT <agg>, ... FROM <tbl> [WHERE <column> <op> <literal> AND ...]
+ *
+ * where <tbl> is a memtx space and every <agg> is COUNT(*), or COUNT(),
+ * SUM(), MIN() or MAX() of an INTEGER, UNSIGNED or DOUBLE column. The
+ * query must not be able to use an index, since the batch execution
+ * always scans the whole space.
+ *
+ * @param parse Parsing context.
+ * @param select The select statement in form of aggregate query.
+ * @param agg_info The associated aggregate-info object.
+ * @retval Plan of the batch execution or NULL.
+ */
+static struct sql_batch_plan *
+batch_aggregate_plan(struct Parse *parse, struct Select *select,
+		     struct AggInfo *agg_info)
+{
+	assert(select->pGroupBy == NULL);
+	if ((parse->sql_flags & SQL_BatchExec) == 0 ||
+	    select->pSrc->nSrc != 1 || select->pSrc->a[0].pSelect != NULL ||
+	    select->pSrc->a[0].fg.isIndexedBy)
+		return NULL;
+	struct space *space = select->pSrc->a[0].space;
+	assert(space != NULL && !space->def->opts.is_view);
+	if (!space_is_memtx(space) || space->def->field_count == 0)
+		return NULL;
+	/* Columns used outside of aggregate functions. */
+	if (agg_info->nAccumulator > 0 || agg_info->nFunc == 0 ||
+	    agg_info->nFunc > BATCH_AGGREGATE_TERM_MAX)
+		return NULL;
+	int cursor = select->pSrc->a[0].iCursor;
+
+	struct Expr *terms[BATCH_AGGREGATE_TERM_MAX];
+	uint32_t term_count = 0;
+	if (!batch_where_split(select->pWhere, terms, &term_count))
+		return NULL;
+	struct sql_batch_filter filters[BATCH_AGGREGATE_TERM_MAX];
+	uint32_t filter_fields[BATCH_AGGREGATE_TERM_MAX];
+	for (uint32_t i = 0; i < term_count; i++) {
+		if (!batch_filter_parse(terms[i], cursor, space, &filters[i],
+					&filter_fields[i]))
+			return NULL;
+	}
+
+	enum sql_batch_agg_type types[BATCH_AGGREGATE_TERM_MAX];
+	int agg_fields[BATCH_AGGREGATE_TERM_MAX];
+	for (int i = 0; i < agg_info->nFunc; i++) {
+		struct AggInfo_func *func = &agg_info->aFunc[i];
+		if ((func->pExpr->flags & EP_Distinct) != 0 ||
+		    func->func->def->language != FUNC_LANGUAGE_SQL_BUILTIN)
+			return NULL;
+		const char *name = func->func->def->name;
+		if (strcmp(name, "COUNT") == 0)
+			types[i] = SQL_BATCH_COUNT;
+		else if (strcmp(name, "SUM") == 0)
+			types[i] = SQL_BATCH_SUM;
+		else if (strcmp(name, "MIN") == 0)
+			types[i] = SQL_BATCH_MIN;
+		else if (strcmp(name, "MAX") == 0)
+			types[i] = SQL_BATCH_MAX;
+		else
+			return NULL;
+		struct ExprList *args = func->pExpr->x.pList;
+		agg_fields[i] = -1;
+		if (args == NULL || args->nExpr == 0) {
+			if (types[i] != SQL_BATCH_COUNT)
+				return NULL;
+			continue;
+		}
+		struct Expr *arg = args->a[0].pExpr;
+		bool unused;
+		if (args->nExpr != 1 || arg->op != TK_AGG_COLUMN ||
+		    arg->iTable != cursor || arg->iColumn < 0 ||
+		    !batch_field_is_supported(space->def, arg->iColumn,
+					      &unused))
+			return NULL;
+		agg_fields[i] = arg->iColumn;
+	}
+	/* MIN() or MAX() alone can be read from an index. */
+	if (agg_info->nFunc == 1 && term_count == 0 &&
+	    (types[0] == SQL_BATCH_MIN || types[0] == SQL_BATCH_MAX) &&
+	    batch_field_is_indexed(space, agg_fields[0]))
+		return NULL;
+
+	struct sql_batch_plan *plan =
+		sql_batch_plan_new(term_count + agg_info->nFunc, term_count,
+				   agg_info->nFunc);
+	plan->column_count = 0;
+	for (uint32_t i = 0; i < term_count; i++) {
+		bool is_double;
+		batch_field_is_supported(space->def, filter_fields[i],
+					 &is_double);
+		batch_plan_add_column(plan, filter_fields[i], is_double);
+	}
+	for (int i = 0; i < agg_info->nFunc; i++) {
+		bool is_double;
+		if (agg_fields[i] < 0)
+			continue;
+		batch_field_is_supported(space->def, agg_fields[i], &is_double);
+		batch_plan_add_column(plan, agg_fields[i], is_double);
+	}
+	for (uint32_t i = 0; i < term_count; i++) {
+		plan->filters[i] = filters[i];
+		plan->filters[i].column =
+			batch_plan_column(plan, filter_fields[i]);
+	}
+	for (int i = 0; i < agg_info->nFunc; i++) {
+		struct sql_batch_agg *agg = &plan->aggs[i];
+		agg->type = types[i];
+		agg->column = agg_fields[i] < 0 ? -1 :
+			      (int)batch_plan_column(plan, agg_fields[i]);
+		agg->reg = agg_info->aFunc[i].iMem;
+	}
+	return plan;
+}
+
 /*
  * If the source-list item passed as an argument was augmented with an
  * INDEXED BY clause, then try to locate the specified index. If there
@@ -5514,6 +5809,277 @@ vdbe_code_raise_on_multiple_rows(struct Parse *parser, int limit_reg, int end_ma
 	sqlReleaseTempReg(parser, r1);
 }
 
+/**
+ * Store the values of ROW_NUMBER() and RANK() window functions
+ * of the current row to their accumulator registers.
+ */
+static void
+window_code_counters(struct Vdbe *v, const struct AggInfo *agg, int reg_row,
+		     int reg_rank)
+{
+	for (int i = 0; i < agg->nFunc; i++) {
+		const struct AggInfo_func *f = &agg->aFunc[i];
+		if (f->func != NULL)
+			continue;
+		bool is_rank = strcmp(f->pExpr->u.zToken, "RANK") == 0;
+		sqlVdbeAddOp2(v, OP_Copy, is_rank ? reg_rank : reg_row,
+			      f->iMem);
+	}
+}
+
+/**
+ * Generate code for a SELECT with window functions. The rows of
+ * the FROM clause are pushed into a sorter ordered by the
+ * PARTITION BY and ORDER BY terms of the window, and then all
+ * window functions are computed in one pass over the sorted rows.
+ * ROW_NUMBER() and RANK() are counters. SUM() uses the default
+ * window frame, so its value for a row is the sum over the rows
+ * of the partition up to the last peer of the row. To get it,
+ * the rows of a group of peers are buffered in one more sorter
+ * and returned once the group ends.
+ *
+ * @param parse Parsing context.
+ * @param p SELECT with SF_Window flag.
+ * @param agg Information about window functions to fill.
+ * @param sort ORDER BY of the SELECT.
+ * @param distinct DISTINCT of the SELECT.
+ * @param dest Destination of the result rows.
+ */
+static void
+select_code_window(struct Parse *parse, struct Select *p, struct AggInfo *agg,
+		   struct SortCtx *sort, struct DistinctCtx *distinct,
+		   struct SelectDest *dest)
+{
+	struct Vdbe *v = parse->pVdbe;
+	struct ExprList *list = p->pEList;
+	/*
+	 * Find the window functions and columns used by the
+	 * result set, ORDER BY and arguments of SUM().
+	 */
+	struct NameContext nc;
+	memset(&nc, 0, sizeof(nc));
+	nc.pParse = parse;
+	nc.pSrcList = p->pSrc;
+	nc.pAggInfo = agg;
+	agg->mnReg = parse->nMem + 1;
+	sqlExprAnalyzeAggList(&nc, list);
+	sqlExprAnalyzeAggList(&nc, sort->pOrderBy);
+	if (parse->is_aborted)
+		return;
+	assert(agg->nFunc > 0);
+	struct Expr *over = agg->aFunc[0].pExpr->pRight;
+	struct ExprList *keys = over->x.pList;
+	int part_count = over->iColumn;
+	int key_count = keys != NULL ? keys->nExpr : 0;
+	int order_count = key_count - part_count;
+	/* A sorter needs a key, use a constant if there is none. */
+	int sorter_key_count = MAX(key_count, 1);
+	bool has_sum = false;
+	for (int i = 0; i < agg->nFunc; i++) {
+		struct Expr *expr = agg->aFunc[i].pExpr;
+		if (sqlExprCompare(expr->pRight, over, -1) != 0) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Tarantool",
+				 "different windows in one SELECT");
+			parse->is_aborted = true;
+			return;
+		}
+		has_sum = has_sum || agg->aFunc[i].func != NULL;
+	}
+	for (int i = 0; i < agg->nFunc; i++)
+		sqlExprAnalyzeAggList(&nc, agg->aFunc[i].pExpr->x.pList);
+	agg->mxReg = parse->nMem;
+	if (parse->is_aborted)
+		return;
+	/* The columns are stored in the sorter after the key. */
+	for (int i = 0; i < agg->nColumn; i++)
+		agg->aCol[i].iSorterColumn += sorter_key_count;
+	agg->nSortingColumn += sorter_key_count;
+
+	struct sql_key_info *key_info = key_count > 0 ?
+		sql_expr_list_to_key_info(parse, keys, 0) :
+		sql_key_info_new(1);
+	if (key_info == NULL) {
+		parse->is_aborted = true;
+		return;
+	}
+	int column_count = sorter_key_count + agg->nColumn;
+	int sorter = parse->nTab++;
+	sqlVdbeAddOp4(v, OP_SorterOpen, sorter, column_count, 0,
+		      (char *)key_info, P4_KEYINFO);
+	int buffer = -1;
+	if (has_sum) {
+		buffer = parse->nTab++;
+		sqlVdbeAddOp4(v, OP_SorterOpen, buffer, column_count, 0,
+			      (char *)sql_key_info_ref(key_info), P4_KEYINFO);
+	}
+
+	/* Push all the rows of the FROM clause into the sorter. */
+	struct WhereInfo *winfo = sqlWhereBegin(parse, p->pSrc, p->pWhere,
+						NULL, NULL, 0, 0);
+	if (winfo == NULL)
+		return;
+	explainTempTable(parse, "WINDOW");
+	int reg_base = sqlGetTempRange(parse, column_count);
+	sqlExprCacheClear(parse);
+	if (key_count > 0)
+		sqlExprCodeExprList(parse, keys, reg_base, 0, 0);
+	else
+		sqlVdbeAddOp2(v, OP_Integer, 0, reg_base);
+	for (int i = 0; i < agg->nColumn; i++) {
+		struct AggInfo_col *col = &agg->aCol[i];
+		assert(col->iSorterColumn == sorter_key_count + i);
+		sqlExprCodeGetColumnToReg(parse, col->iColumn, col->iTable,
+					  reg_base + col->iSorterColumn);
+	}
+	int reg_record = sqlGetTempReg(parse);
+	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, column_count, reg_record);
+	sqlVdbeAddOp2(v, OP_SorterInsert, sorter, reg_record);
+	sqlReleaseTempReg(parse, reg_record);
+	sqlReleaseTempRange(parse, reg_base, column_count);
+	sqlWhereEnd(winfo);
+
+	/*
+	 * Sorted rows are decoded with a pseudo-cursor, which is
+	 * also used to decode the buffered rows.
+	 */
+	int pseudo = parse->nTab++;
+	int reg_out = ++parse->nMem;
+	agg->sortingIdx = sorter;
+	agg->sortingIdxPTab = pseudo;
+	agg->useSortingIdx = 1;
+	agg->directMode = 1;
+	sqlVdbeAddOp3(v, OP_OpenPseudo, pseudo, reg_out, column_count);
+	int reg_cur = parse->nMem + 1;
+	parse->nMem += sorter_key_count;
+	int reg_prev = parse->nMem + 1;
+	parse->nMem += sorter_key_count;
+	/* Number of the current row in its partition. */
+	int reg_row = ++parse->nMem;
+	/* Number of the first row of the current group of peers. */
+	int reg_rank = ++parse->nMem;
+	/* Number of the last returned row of the partition. */
+	int reg_emit = ++parse->nMem;
+	int reg_flush = ++parse->nMem;
+	int addr_flush = sqlVdbeMakeLabel(v);
+	int label_end = sqlVdbeMakeLabel(v);
+	int label_part = sqlVdbeMakeLabel(v);
+	int label_peer = sqlVdbeMakeLabel(v);
+	int label_same = sqlVdbeMakeLabel(v);
+	int label_next = sqlVdbeMakeLabel(v);
+	sqlVdbeAddOp2(v, OP_Integer, 0, reg_row);
+	sqlVdbeAddOp2(v, OP_SorterSort, sorter, label_end);
+	VdbeComment((v, "WINDOW sort"));
+	int addr_top = sqlVdbeCurrentAddr(v);
+	sqlVdbeAddOp3(v, OP_SorterData, sorter, reg_out, pseudo);
+	sqlExprCacheClear(parse);
+	for (int i = 0; i < key_count; i++)
+		sqlVdbeAddOp3(v, OP_Column, pseudo, i, reg_cur + i);
+	/* The first row starts a partition. */
+	int addr = sqlVdbeAddOp1(v, OP_IfPos, reg_row);
+	sqlVdbeGoto(v, label_part);
+	sqlVdbeJumpHere(v, addr);
+	if (part_count > 0) {
+		sqlVdbeAddOp4(v, OP_Compare, reg_prev, reg_cur, part_count,
+			      (char *)sql_key_info_ref(key_info), P4_KEYINFO);
+		addr = sqlVdbeCurrentAddr(v);
+		sqlVdbeAddOp3(v, OP_Jump, addr + 1, 0, addr + 1);
+		if (has_sum)
+			sqlVdbeAddOp2(v, OP_Gosub, reg_flush, addr_flush);
+		sqlVdbeGoto(v, label_part);
+		sqlVdbeJumpHere(v, addr);
+	}
+	if (order_count > 0) {
+		struct sql_key_info *order_info =
+			sql_expr_list_to_key_info(parse, keys, part_count);
+		if (order_info == NULL) {
+			parse->is_aborted = true;
+			return;
+		}
+		sqlVdbeAddOp4(v, OP_Compare, reg_prev + part_count,
+			      reg_cur + part_count, order_count,
+			      (char *)order_info, P4_KEYINFO);
+		addr = sqlVdbeCurrentAddr(v);
+		sqlVdbeAddOp3(v, OP_Jump, addr + 1, label_same, addr + 1);
+		if (has_sum)
+			sqlVdbeAddOp2(v, OP_Gosub, reg_flush, addr_flush);
+		sqlVdbeGoto(v, label_peer);
+	} else {
+		sqlVdbeGoto(v, label_same);
+	}
+
+	/* A new partition starts. */
+	sqlVdbeResolveLabel(v, label_part);
+	sqlVdbeAddOp2(v, OP_Integer, 0, reg_row);
+	if (has_sum)
+		sqlVdbeAddOp2(v, OP_Integer, 0, reg_emit);
+	for (int i = 0; i < agg->nFunc; i++) {
+		if (agg->aFunc[i].func != NULL)
+			sqlVdbeAddOp2(v, OP_Null, 0, agg->aFunc[i].iMem);
+	}
+	/* A new group of peers starts. */
+	sqlVdbeResolveLabel(v, label_peer);
+	if (key_count > 0)
+		sqlVdbeAddOp3(v, OP_Copy, reg_cur, reg_prev, key_count - 1);
+	sqlVdbeAddOp2(v, OP_Copy, reg_row, reg_rank);
+	sqlVdbeAddOp2(v, OP_AddImm, reg_rank, 1);
+	sqlVdbeResolveLabel(v, label_same);
+	sqlVdbeAddOp2(v, OP_AddImm, reg_row, 1);
+	if (!has_sum) {
+		window_code_counters(v, agg, reg_row, reg_rank);
+		selectInnerLoop(parse, p, list, -1, sort, distinct, dest,
+				label_next, label_end);
+		sqlVdbeResolveLabel(v, label_next);
+		sqlVdbeAddOp2(v, OP_SorterNext, sorter, addr_top);
+		sqlVdbeResolveLabel(v, label_end);
+		return;
+	}
+	/*
+	 * The flush subroutine could have overwritten the current
+	 * row, so it is read again.
+	 */
+	sqlVdbeAddOp3(v, OP_SorterData, sorter, reg_out, pseudo);
+	sqlExprCacheClear(parse);
+	for (int i = 0; i < agg->nFunc; i++) {
+		struct AggInfo_func *f = &agg->aFunc[i];
+		if (f->func == NULL)
+			continue;
+		assert(f->func->def->language == FUNC_LANGUAGE_SQL_BUILTIN);
+		struct ExprList *args = f->pExpr->x.pList;
+		int reg_arg = f->iMem - args->nExpr;
+		sqlExprCodeExprList(parse, args, reg_arg, 0, SQL_ECEL_DUP);
+		if (sql_emit_args_types(v, reg_arg, f->func,
+					args->nExpr) != 0) {
+			parse->is_aborted = true;
+			return;
+		}
+		struct sql_context *ctx = sql_context_new(f->func, NULL);
+		sqlVdbeAddOp3(v, OP_AggStep, args->nExpr, reg_arg, f->iMem);
+		sqlVdbeAppendP4(v, ctx, P4_FUNCCTX);
+	}
+	sqlExprCacheClear(parse);
+	sqlVdbeAddOp2(v, OP_SorterInsert, buffer, reg_out);
+	sqlVdbeAddOp2(v, OP_SorterNext, sorter, addr_top);
+	sqlVdbeAddOp2(v, OP_Gosub, reg_flush, addr_flush);
+	sqlVdbeGoto(v, label_end);
+
+	/* Return the buffered group of peers. */
+	sqlVdbeResolveLabel(v, addr_flush);
+	addr = sqlVdbeAddOp1(v, OP_SorterSort, buffer);
+	int addr_loop = sqlVdbeCurrentAddr(v);
+	sqlVdbeAddOp3(v, OP_SorterData, buffer, reg_out, pseudo);
+	sqlExprCacheClear(parse);
+	sqlVdbeAddOp2(v, OP_AddImm, reg_emit, 1);
+	window_code_counters(v, agg, reg_emit, reg_rank);
+	selectInnerLoop(parse, p, list, -1, sort, distinct, dest, label_next,
+			label_end);
+	sqlVdbeResolveLabel(v, label_next);
+	sqlVdbeAddOp2(v, OP_SorterNext, buffer, addr_loop);
+	sqlVdbeJumpHere(v, addr);
+	sqlVdbeAddOp1(v, OP_ResetSorter, buffer);
+	sqlVdbeAddOp1(v, OP_Return, reg_flush);
+	sqlVdbeResolveLabel(v, label_end);
+}
+
 /*
  * Generate code for the SELECT statement given in the p argument.
  *
@@ -5896,10 +6462,13 @@ sqlSelect(Parse * pParse,		/* The parser context */
 	/*
 	 * At the moment we don't have iterators where the fields are sorted in
 	 * a different order. Because of this, we have to sort all the data and
-	 * select only the required number of rows.
+	 * select only the required number of rows. The sorter is also used for
+	 * a small constant LIMIT, since it keeps the first rows in a heap,
+	 * which is cheaper than keeping them in an ephemeral space.
 	 */
 	if (sSort.addrSortIndex >= 0 &&
-	    (p->iLimit == 0 || !is_same_sorting_direction(sSort.pOrderBy))) {
+	    (p->iLimit == 0 || !is_same_sorting_direction(sSort.pOrderBy) ||
+	     select_has_small_limit(p))) {
 		struct VdbeOp *op = sqlVdbeGetOp(v, sSort.addrSortIndex);
 		struct sql_key_info *key_info =
 			sql_key_info_new_from_space_info(op->p4.space_info);
@@ -5936,7 +6505,13 @@ sqlSelect(Parse * pParse,		/* The parser context */
 		sDistinct.eTnctType = WHERE_DISTINCT_NOOP;
 	}
 
-	if (!isAgg && pGroupBy == 0) {
+	if ((p->selFlags & SF_Window) != 0) {
+		assert(!isAgg && pGroupBy == NULL);
+		select_code_window(pParse, p, &sAggInfo, &sSort, &sDistinct,
+				   pDest);
+		if (pParse->is_aborted)
+			goto select_end;
+	} else if (!isAgg && pGroupBy == 0) {
 		/* No aggregate functions and no GROUP BY clause */
 		u16 wctrlFlags = (sDistinct.isTnct ? WHERE_WANT_DISTINCT : 0);
 		assert(WHERE_USE_LIMIT == SF_FixedLimit);
@@ -6374,6 +6949,34 @@ sqlSelect(Parse * pParse,		/* The parser context */
 				explain_simple_count(pParse, space->def->name);
 			} else
 			{
+				/*
+				 * If the query is simple enough, compute the
+				 * aggregates in batch and skip the row-at-a-time
+				 * code below. The latter is still generated and
+				 * used as a fallback if a value met during the
+				 * scan can't be processed in batch.
+				 */
+				struct sql_batch_plan *batch_plan =
+					batch_aggregate_plan(pParse, p,
+							     &sAggInfo);
+				int batch_end = 0;
+				if (batch_plan != NULL) {
+					struct space *src_space =
+						p->pSrc->a[0].space;
+					int cursor = pParse->nTab++;
+					int fallback = sqlVdbeMakeLabel(v);
+					batch_end = sqlVdbeMakeLabel(v);
+					vdbe_emit_open_cursor(pParse, cursor, 0,
+							      src_space);
+					sqlVdbeAddOp4(v, OP_BatchAggregate,
+						      cursor, fallback, 0,
+						      (char *)batch_plan,
+						      P4_DYNAMIC);
+					sqlVdbeAddOp1(v, OP_Close, cursor);
+					sqlVdbeGoto(v, batch_end);
+					sqlVdbeResolveLabel(v, fallback);
+					sqlVdbeAddOp1(v, OP_Close, cursor);
+				}
 				/* Check if the query is of one of the following forms:
 				 *
 				 *   SELECT min(x) FROM ...
@@ -6451,6 +7054,8 @@ sqlSelect(Parse * pParse,		/* The parser context */
 				sqlWhereEnd(pWInfo);
 				finalizeAggFunctions(pParse, &sAggInfo);
 				sql_expr_list_delete(pDel);
+				if (batch_plan != NULL)
+					sqlVdbeResolveLabel(v, batch_end);
 			}
 
 			sSort.pOrderBy = 0;
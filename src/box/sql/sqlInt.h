@@ -1001,6 +1001,8 @@ struct sql {
 #define SQL_ReverseOrder   0x00020000	/* Reverse unordered SELECTs */
 #define SQL_RecTriggers    0x00040000	/* Enable recursive triggers */
 #define SQL_AutoIndex      0x00100000	/* Enable automatic indexes */
+#define SQL_HashJoin       0x00200000	/* Enable hash joins */
+#define SQL_BatchExec      0x00400000	/* Enable batch aggregation */
 #define SQL_EnableTrigger  0x01000000	/* True to enable triggers */
 #define SQL_DeferFKs       0x02000000	/* Defer all FK constraints */
 #define SQL_VdbeEQP        0x08000000	/* Debug EXPLAIN QUERY PLAN */
@@ -1011,7 +1013,8 @@ struct sql {
 enum {
 	SQL_SeqScan = 0x00000008,
 	SQL_DEFAULT_FLAGS = SQL_EnableTrigger | SQL_AutoIndex |
-			    SQL_RecTriggers | SQL_SeqScan,
+			    SQL_HashJoin | SQL_BatchExec | SQL_RecTriggers |
+			    SQL_SeqScan,
 };
 
 /* Bits of the sql.dbOptFlags field. */
@@ -1418,6 +1421,7 @@ struct Expr {
 #define EP_DblQuoted 0x000040	/* token.z was originally in "..." */
 #define EP_InfixFunc 0x000080	/* True for an infix function: LIKE, etc */
 #define EP_Collate   0x000100	/* Tree contains a TK_COLLATE operator */
+#define EP_Win       0x000200	/* Contains one or more window functions */
 #define EP_IntValue  0x000400	/* Integer value contained in u.iValue */
 #define EP_xIsSelect 0x000800	/* x.pSelect is valid (otherwise x.pList is) */
 #define EP_Skip      0x001000	/* COLLATE, AS, or UNLIKELY */
@@ -1722,6 +1726,10 @@ struct NameContext {
 #define NC_MinMaxAgg 0x1000	/* min/max aggregates seen.  See note above */
 /** One or more identifiers are out of aggregate function. */
 #define NC_HasUnaggregatedId     0x2000
+/** Window functions are allowed here. */
+#define NC_AllowWin  0x4000
+/** One or more window functions seen. */
+#define NC_HasWin    0x8000
 /*
  * An instance of the following structure contains all information
  * needed to generate code for a single SELECT statement.
@@ -1790,6 +1798,8 @@ struct Select {
 #define SF_Converted      0x10000	/* By convertCompoundSelectToSubquery() */
 /** Abort subquery if its output contains more than one row. */
 #define SF_SingleRow      0x20000
+/** The result set contains window functions. */
+#define SF_Window         0x40000
 
 /*
  * The results of a SELECT can be distributed in several ways, as defined
@@ -2117,6 +2127,9 @@ struct Parse {
 #define OPFLAG_LENGTHARG     0x40	/* OP_Column only used for length() */
 #define OPFLAG_TYPEOFARG     0x80	/* OP_Column only used for typeof() */
 #define OPFLAG_SEEKEQ        0x02	/* OP_Open** cursor uses EQ seek only */
+#define OPFLAG_KEY_ONLY      0x04	/* OP_IteratorOpen: read indexed
+					 * fields only
+					 */
 #define OPFLAG_FORDELETE     0x08	/* OP_Open should use BTREE_FORDELETE */
 #define OPFLAG_P2ISREG       0x10	/* P2 to OP_Open** is a register number */
 #define OPFLAG_PERMUTE       0x01	/* OP_Compare: use the permutation */
@@ -2607,6 +2620,35 @@ struct Expr *
 sql_and_expr_new(struct Expr *left_expr, struct Expr *right_expr);
 
 Expr *sqlExprFunction(Parse *, ExprList *, Token *);
+
+/**
+ * Construct a TK_OVER node describing the window of a window
+ * function. Its list holds the PARTITION BY terms followed by the
+ * ORDER BY terms, and iColumn is the number of PARTITION BY terms.
+ *
+ * @param parse Parsing context.
+ * @param partition PARTITION BY terms, can be NULL.
+ * @param order ORDER BY terms, can be NULL. Consumed.
+ * @retval New expression.
+ */
+struct Expr *
+sql_expr_new_over(struct Parse *parse, struct ExprList *partition,
+		  struct ExprList *order);
+
+/**
+ * Construct a TK_WINDOW node calling the window function @a name
+ * with arguments @a args over the window @a over.
+ *
+ * @param parse Parsing context.
+ * @param name Name of the function.
+ * @param args Arguments of the function, can be NULL.
+ * @param over TK_OVER node created by sql_expr_new_over().
+ * @retval New expression.
+ */
+struct Expr *
+sql_expr_new_window(struct Parse *parse, struct Token *name,
+		    struct ExprList *args, struct Expr *over);
+
 void sqlExprAssignVarNumber(Parse *, Expr *, u32);
 ExprList *sqlExprListAppendVector(Parse *, ExprList *, IdList *, Expr *);
 
@@ -2665,6 +2707,25 @@ sql_emit_show_create_table_one(struct Parse *parse, struct Token *name);
 void
 sql_emit_show_create_table_all(struct Parse *parse);
 
+/** Emit VDBE instructions for "ANALYZE table_name;" statement. */
+void
+sql_emit_analyze_one(struct Parse *parse, struct Token *name);
+
+/** Emit VDBE instructions for "ANALYZE;" statement. */
+void
+sql_emit_analyze_all(struct Parse *parse);
+
+/**
+ * Scan ordered indexes of the space and replace their statistics
+ * used by the query planner with the collected ones.
+ *
+ * @param space_id Space identifier.
+ * @retval 0 Success.
+ * @retval -1 Error.
+ */
+int
+sql_analyze_space(uint32_t space_id);
+
 /** Generate a CREATE TABLE statement for the space with the given ID. */
 void
 sql_show_create_table(uint32_t space_id, struct Mem *ret, struct Mem *err);
@@ -4107,30 +4168,36 @@ sql_expr_new_column(struct SrcList *src_list, int src_idx, int column);
 
 int sqlExprCheckIN(Parse *, Expr *);
 
-/* TODO: Enable this function when stat-tables will be revived. */
-static inline int
-sqlStat4ProbeSetValue(struct Parse *parse, ...)
-{
-	(void)parse;
-	unreachable();
-	return 0;
-}
+/**
+ * Extract values of literal expressions to fields of the probe
+ * record used to look up index samples collected by ANALYZE.
+ *
+ * @param parse Parsing context.
+ * @param idx_def Definition of the index the record is built for.
+ * @param[in, out] rec Probe record, allocated if NULL.
+ * @param expr Expression or vector of expressions to extract.
+ * @param elem_count Number of elements of @a expr to extract.
+ * @param first Number of the first record field to set.
+ * @param[out] extract_count Number of extracted values.
+ * @retval 0 Always.
+ */
+int
+sqlStat4ProbeSetValue(struct Parse *parse, struct index_def *idx_def,
+		      struct UnpackedRecord **rec, struct Expr *expr,
+		      int elem_count, int first, int *extract_count);
 
-/* TODO: Enable this function when stat-tables will be revived. */
-static inline int
-sqlStat4ValueFromExpr(struct Parse *parse, ...)
-{
-	(void)parse;
-	unreachable();
-	return 0;
-}
+/**
+ * Extract a value of a literal expression. @a value is set to
+ * NULL if the expression isn't a literal, otherwise it must be
+ * freed with mem_delete().
+ */
+int
+sqlStat4ValueFromExpr(struct Parse *parse, struct Expr *expr,
+		      enum field_type type, struct Mem **value);
 
-/* TODO: Enable this function when stat-tables will be revived. */
-static inline void
-sqlStat4ProbeFree(struct UnpackedRecord *rec)
-{
-	(void)rec;
-}
+/** Free a probe record built by sqlStat4ProbeSetValue(). */
+void
+sqlStat4ProbeFree(struct UnpackedRecord *rec);
 
 /*
  * The interface to the LEMON-generated parser
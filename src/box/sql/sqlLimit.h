@@ -177,6 +177,71 @@ enum {
 #define SQL_MAX_TRIGGER_DEPTH 1000
 #endif
 
+/*
+ * Maximum amount of memory, in bytes, the build side of a hash join may
+ * use. When the limit is exceeded, the rows are moved to an ephemeral
+ * space and looked up with a TREE index instead.
+ */
+#ifndef SQL_HASH_JOIN_MEMORY_MAX
+#define SQL_HASH_JOIN_MEMORY_MAX (64 * 1024 * 1024)
+#endif
+
+/*
+ * Maximum number of index keys ANALYZE samples to build a histogram
+ * used to estimate the selectivity of equality and range constraints.
+ */
+#ifndef SQL_STAT4_SAMPLES
+#define SQL_STAT4_SAMPLES 24
+#endif
+
+/*
+ * Number of rows decoded and processed at once by the batch execution
+ * of simple aggregate queries.
+ */
+#ifndef SQL_BATCH_SIZE
+#define SQL_BATCH_SIZE 1024
+#endif
+
+/*
+ * Minimum number of rows in a space for the batch execution of simple
+ * aggregate queries to scan it in worker threads.
+ */
+#ifndef SQL_BATCH_PARALLEL_MIN_ROWS
+#define SQL_BATCH_PARALLEL_MIN_ROWS (64 * SQL_BATCH_SIZE)
+#endif
+
+/*
+ * Maximum number of worker threads scanning a space for the batch
+ * execution of simple aggregate queries.
+ */
+#ifndef SQL_BATCH_MAX_WORKERS
+#define SQL_BATCH_MAX_WORKERS 8
+#endif
+
+/*
+ * Number of random keys sampled per worker thread to split the primary
+ * key of a space into ranges scanned by the threads.
+ */
+#ifndef SQL_BATCH_SPLIT_SAMPLES
+#define SQL_BATCH_SPLIT_SAMPLES 16
+#endif
+
+/*
+ * Maximum LIMIT + OFFSET of a SELECT for its sorter to keep only the
+ * first rows in a heap instead of sorting all of them.
+ */
+#ifndef SQL_SORTER_TOPN_MAX
+#define SQL_SORTER_TOPN_MAX 1024
+#endif
+
+/*
+ * Number of executions after which a cached statement is specialized,
+ * see sqlVdbeSpecialize().
+ */
+#ifndef SQL_HOT_STMT_EXECUTIONS
+#define SQL_HOT_STMT_EXECUTIONS 16
+#endif
+
 /*
  * Tarantool: gh-2550: Fiber stack is 64KB by default, so maximum
  * number of entities (in chain of compiling trigger programs) should be less than
@@ -51,6 +51,7 @@
 
 #include "msgpuck/msgpuck.h"
 #include "mpstream/mpstream.h"
+#include "coll/coll.h"
 
 #include "box/schema.h"
 #include "box/space.h"
@@ -230,6 +231,52 @@ vdbe_prepare_null_out(struct Vdbe *v, int n)
 	return out;
 }
 
+/**
+ * Compare two MEMs without the type dispatch of mem_cmp() if both are
+ * INTEGER, UNSIGNED, DOUBLE or STRING values of the same type and none
+ * of them is of a metatype. Return false if mem_cmp() must be used.
+ */
+static inline bool
+vdbe_mem_cmp_fast(const struct Mem *a, const struct Mem *b,
+		  const struct coll *coll, int *result)
+{
+	if (a->type != b->type || mem_is_metatype(a) || mem_is_metatype(b))
+		return false;
+	switch (a->type) {
+	case MEM_TYPE_INT:
+		*result = a->u.i < b->u.i ? -1 : a->u.i > b->u.i;
+		return true;
+	case MEM_TYPE_UINT:
+		*result = a->u.u < b->u.u ? -1 : a->u.u > b->u.u;
+		return true;
+	case MEM_TYPE_DOUBLE:
+		*result = a->u.r < b->u.r ? -1 : a->u.r > b->u.r;
+		return true;
+	case MEM_TYPE_STR:
+		if (coll != NULL) {
+			*result = coll->cmp(a->z, a->n, b->z, b->n, coll);
+			return true;
+		}
+		*result = memcmp(a->z, b->z, MIN(a->n, b->n));
+		if (*result == 0)
+			*result = a->n < b->n ? -1 : a->n > b->n;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Check if both MEMs are integers that can be passed to sql_add_int() and
+ * friends as is, so the arithmetic opcodes may skip the type checks.
+ */
+static inline bool
+vdbe_mem_is_int_pair(const struct Mem *a, const struct Mem *b)
+{
+	return ((a->type | b->type) & ~(MEM_TYPE_INT | MEM_TYPE_UINT)) == 0 &&
+	       !mem_is_metatype(a) && !mem_is_metatype(b);
+}
+
 struct stailq *
 vdbe_autoinc_id_list(struct Vdbe *vdbe)
 {
@@ -1074,6 +1121,66 @@ case OP_Subtract: {           /* same as TK_MINUS, in1, in2, out3 */
 	break;
 }
 
+/* Opcode: AddInt P1 P2 P3 * *
+ * Synopsis: r[P3]=r[P1]+r[P2]
+ *
+ * This works just like the Add opcode, but if both operands are integers
+ * the result is computed without type checks. It replaces OP_Add in
+ * specialized statements, see sqlVdbeSpecialize().
+ */
+/* Opcode: SubtractInt P1 P2 P3 * *
+ * Synopsis: r[P3]=r[P2]-r[P1]
+ *
+ * This works just like the Subtract opcode. See the AddInt opcode for
+ * additional information.
+ */
+/* Opcode: MultiplyInt P1 P2 P3 * *
+ * Synopsis: r[P3]=r[P1]*r[P2]
+ *
+ * This works just like the Multiply opcode. See the AddInt opcode for
+ * additional information.
+ */
+case OP_AddInt:                /* in1, in2, out3 */
+case OP_SubtractInt:           /* in1, in2, out3 */
+case OP_MultiplyInt: {         /* in1, in2, out3 */
+	pIn1 = &aMem[pOp->p1];
+	pIn2 = &aMem[pOp->p2];
+	pOut = &aMem[pOp->p3];
+	if (!vdbe_mem_is_int_pair(pIn1, pIn2)) {
+		int rc_arith;
+		if (pOp->opcode == OP_AddInt)
+			rc_arith = mem_add(pIn2, pIn1, pOut);
+		else if (pOp->opcode == OP_SubtractInt)
+			rc_arith = mem_sub(pIn2, pIn1, pOut);
+		else
+			rc_arith = mem_mul(pIn2, pIn1, pOut);
+		if (rc_arith != 0)
+			goto abort_due_to_error;
+		break;
+	}
+	bool is_lhs_neg = pIn2->type == MEM_TYPE_INT;
+	bool is_rhs_neg = pIn1->type == MEM_TYPE_INT;
+	int64_t res;
+	bool is_neg;
+	int rc_arith;
+	if (pOp->opcode == OP_AddInt) {
+		rc_arith = sql_add_int(pIn2->u.i, is_lhs_neg, pIn1->u.i,
+				       is_rhs_neg, &res, &is_neg);
+	} else if (pOp->opcode == OP_SubtractInt) {
+		rc_arith = sql_sub_int(pIn2->u.i, is_lhs_neg, pIn1->u.i,
+				       is_rhs_neg, &res, &is_neg);
+	} else {
+		rc_arith = sql_mul_int(pIn2->u.i, is_lhs_neg, pIn1->u.i,
+				       is_rhs_neg, &res, &is_neg);
+	}
+	if (rc_arith != 0) {
+		diag_set(ClientError, ER_SQL_EXECUTE, "integer is overflowed");
+		goto abort_due_to_error;
+	}
+	mem_set_int(pOut, res, is_neg);
+	break;
+}
+
 /* Opcode: Divide P1 P2 P3 * *
  * Synopsis: r[P3]=r[P2]/r[P1]
  *
@@ -1446,6 +1553,7 @@ case OP_Getitem: {
  */
 case OP_Eq:               /* same as TK_EQ, jump, in1, in3 */
 case OP_Ne: {             /* same as TK_NE, jump, in1, in3 */
+op_eq_ne:
 	pIn1 = &aMem[pOp->p1];
 	pIn3 = &aMem[pOp->p3];
 	if (mem_is_any_null(pIn1, pIn3) && (pOp->p5 & SQL_NULLEQ) == 0) {
@@ -1511,6 +1619,7 @@ case OP_Lt:               /* same as TK_LT, jump, in1, in3 */
 case OP_Le:               /* same as TK_LE, jump, in1, in3 */
 case OP_Gt:               /* same as TK_GT, jump, in1, in3 */
 case OP_Ge: {             /* same as TK_GE, jump, in1, in3 */
+op_lt_le_gt_ge:
 	pIn1 = &aMem[pOp->p1];
 	pIn3 = &aMem[pOp->p3];
 	if (mem_is_any_null(pIn1, pIn3)) {
@@ -1884,6 +1993,17 @@ case OP_NotNull: {            /* same as TK_NOTNULL, jump, in1 */
  * or typeof() function, respectively.  The loading of large blobs can be
  * skipped for length() and all content loading can be skipped for typeof().
  */
+/* Opcode: ColumnCompare P1 P2 P3 P4 P5
+ * Synopsis: r[P3]=PX
+ *
+ * This works just like the Column opcode, but it must be followed by one of
+ * the comparison opcodes without SQL_STOREP2 in its P5, which is executed
+ * right away. If the operands of the comparison are of the same simple type
+ * (integer, double or string), they are compared without the type checks
+ * of mem_cmp(). It replaces OP_Column in specialized statements, see
+ * sqlVdbeSpecialize().
+ */
+case OP_ColumnCompare:
 case OP_Column: {
 	int p2;            /* column number to retrieve */
 	VdbeCursor *pC;    /* The VDBE cursor */
@@ -1914,6 +2034,11 @@ case OP_Column: {
 			} else {
 				goto op_column_out;
 			}
+		} else if (pC->eCurType == CURTYPE_HASH) {
+			uint32_t size;
+			const char *data =
+				sql_hash_join_data(pC->uc.hash_join, &size);
+			vdbe_field_ref_prepare_data(&pC->field_ref, data, size);
 		} else {
 			pCrsr = pC->uc.pCursor;
 			assert(pC->eCurType==CURTYPE_TARANTOOL);
@@ -1927,7 +2052,8 @@ case OP_Column: {
 		pC->cacheStatus = p->cacheCtr;
 	}
 	assert(pC->eCurType == CURTYPE_TARANTOOL ||
-	       pC->eCurType == CURTYPE_PSEUDO);
+	       pC->eCurType == CURTYPE_PSEUDO ||
+	       pC->eCurType == CURTYPE_HASH);
 	struct Mem *default_val_mem =
 		pOp->p4type == P4_MEM ? pOp->p4.pMem : NULL;
 	if (vdbe_field_ref_fetch(&pC->field_ref, p2, pDest) != 0)
@@ -1944,6 +2070,8 @@ case OP_Column: {
 	/* Currently PSEUDO cursor does not have info about field types. */
 	if (pC->eCurType == CURTYPE_TARANTOOL)
 		field_type = pC->uc.pCursor->space->def->fields[p2].type;
+	else if (pC->eCurType == CURTYPE_HASH)
+		field_type = sql_hash_join_field_type(pC->uc.hash_join, p2);
 	if (field_type == FIELD_TYPE_ANY)
 		pDest->flags |= MEM_Any;
 	else if (field_type == FIELD_TYPE_SCALAR)
@@ -1952,6 +2080,46 @@ case OP_Column: {
 		pDest->flags |= MEM_Number;
 op_column_out:
 	REGISTER_TRACE(p, pOp->p3, pDest);
+	if (pOp->opcode == OP_Column)
+		break;
+	/* Execute the comparison that follows. */
+	pOp++;
+	assert(pOp->opcode == OP_Eq || pOp->opcode == OP_Ne ||
+	       pOp->opcode == OP_Lt || pOp->opcode == OP_Le ||
+	       pOp->opcode == OP_Gt || pOp->opcode == OP_Ge);
+	assert((pOp->p5 & SQL_STOREP2) == 0);
+	int cmp_res;
+	if (!vdbe_mem_cmp_fast(&aMem[pOp->p3], &aMem[pOp->p1], pOp->p4.pColl,
+			       &cmp_res)) {
+		if (pOp->opcode == OP_Eq || pOp->opcode == OP_Ne)
+			goto op_eq_ne;
+		goto op_lt_le_gt_ge;
+	}
+	bool result;
+	switch (pOp->opcode) {
+	case OP_Eq:
+		result = cmp_res == 0;
+		break;
+	case OP_Ne:
+		result = cmp_res != 0;
+		break;
+	case OP_Lt:
+		result = cmp_res < 0;
+		break;
+	case OP_Le:
+		result = cmp_res <= 0;
+		break;
+	case OP_Gt:
+		result = cmp_res > 0;
+		break;
+	case OP_Ge:
+		result = cmp_res >= 0;
+		break;
+	default:
+		unreachable();
+	}
+	if (result)
+		goto jump_to_p2;
 	break;
 }
 
@@ -2136,6 +2304,27 @@ case OP_Count: {         /* out2 */
 	break;
 }
 
+/* Opcode: BatchAggregate P1 P2 * P4 *
+ *
+ * Compute the aggregates described by the plan in P4 over all rows of
+ * the cursor P1 and store the results to the registers listed in the
+ * plan. The rows are filtered and aggregated in blocks rather than one
+ * at a time. If a value that can't be processed in batch is found, jump
+ * to P2 where the row-at-a-time code of the same query begins.
+ */
+case OP_BatchAggregate: {  /* jump */
+	assert(p->apCsr[pOp->p1]->eCurType == CURTYPE_TARANTOOL);
+	assert(pOp->p4type == P4_DYNAMIC);
+	struct BtCursor *cur = p->apCsr[pOp->p1]->uc.pCursor;
+	bool is_supported;
+	if (sql_batch_aggregate(cur, pOp->p4.batch_plan, aMem,
+				&is_supported) != 0)
+		goto abort_due_to_error;
+	if (!is_supported)
+		goto jump_to_p2;
+	break;
+}
+
 /**
  * Opcode: CreateForeignKey P1 * * P4 *
  *
@@ -2369,6 +2558,10 @@ case OP_TTransaction: {
  * id in P2. Give the new cursor an identifier of P1. The P1 values need not be
  * contiguous but all P1 values should be small integers. It is an error for P1
  * to be negative.
+ *
+ * If P5 has the OPFLAG_KEY_ONLY bit set, then only the fields indexed
+ * by the index are read from the cursor, so the engine doesn't need
+ * to fetch full tuples.
  */
 case OP_IteratorOpen: {
 	struct VdbeCursor *cur = p->apCsr[pOp->p1];
@@ -2403,7 +2596,7 @@ case OP_IteratorOpen: {
 	/* Key info still contains sorter order and collation. */
 	cur->key_def = index->def->key_def;
 	cur->nullRow = 1;
-	cur->uc.pCursor->hints = pOp->p5 & OPFLAG_SEEKEQ;
+	cur->uc.pCursor->hints = pOp->p5 & (OPFLAG_SEEKEQ | OPFLAG_KEY_ONLY);
 	break;
 }
 
@@ -2520,6 +2713,111 @@ case OP_OpenPseudo: {
 	break;
 }
 
+/* Opcode: HashOpen P1 P2 * P4 *
+ * Synopsis: key=P2
+ *
+ * Open a new cursor P1 to the build side of a hash join. Records stored
+ * in it are described by the sql_space_info passed in P4, the last field
+ * of which is reserved for rowid. The first P2 fields of a record form
+ * the join key.
+ */
+case OP_HashOpen: {
+	assert(pOp->p1 >= 0 && pOp->p2 > 0);
+	assert(pOp->p4type == P4_DYNAMIC);
+	struct sql_space_info *info = pOp->p4.space_info;
+	struct VdbeCursor *cur = allocateCursor(p, pOp->p1, info->field_count,
+						CURTYPE_HASH);
+	if (cur == NULL)
+		goto abort_due_to_error;
+	cur->nullRow = 1;
+	cur->uc.hash_join = sql_hash_join_new(info, pOp->p2);
+	if (cur->uc.hash_join == NULL)
+		goto abort_due_to_error;
+	break;
+}
+
+/* Opcode: HashInsert P1 P2 * * *
+ * Synopsis: key=r[P2]
+ *
+ * Register P2 holds a record made using the MakeRecord instruction.
+ * This opcode stores the record in the hash join cursor P1.
+ */
+case OP_HashInsert: {      /* in2 */
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->eCurType == CURTYPE_HASH);
+	pIn2 = &aMem[pOp->p2];
+	assert(mem_is_bin(pIn2));
+	if (sql_hash_join_insert(cur->uc.hash_join, pIn2->z, pIn2->n) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
+/* Opcode: HashSeek P1 P2 P3 P4 *
+ * Synopsis: key=r[P3@P4]
+ *
+ * Position the hash join cursor P1 on the first stored row whose join
+ * key is equal to the P4 registers starting at P3. If there's no such
+ * row, jump to P2.
+ */
+case OP_HashSeek: {       /* jump, in3 */
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->eCurType == CURTYPE_HASH);
+	assert(pOp->p4type == P4_INT32);
+	uint32_t len = pOp->p4.i;
+	struct Mem *mems = &aMem[pOp->p3];
+	cur->nullRow = 1;
+	cur->cacheStatus = CACHE_STALE;
+	for (uint32_t i = 0; i < len; ++i) {
+		enum field_type type =
+			sql_hash_join_field_type(cur->uc.hash_join, i);
+		struct Mem *mem = &mems[i];
+		if (mem_is_field_compatible(mem, type))
+			continue;
+		if (!sql_type_is_numeric(type) || !mem_is_num(mem)) {
+			diag_set(ClientError, ER_SQL_TYPE_MISMATCH,
+				 mem_str(mem), field_type_strs[type]);
+			goto abort_due_to_error;
+		}
+		/* Nothing can match if conversion isn't precise. */
+		if (mem_cast_implicit_number(mem, type) != 0)
+			goto jump_to_p2;
+	}
+	bool found;
+	if (sql_hash_join_seek(cur->uc.hash_join, mems, len, &found) != 0)
+		goto abort_due_to_error;
+#ifdef SQL_TEST
+	sql_search_count++;
+#endif
+	if (!found)
+		goto jump_to_p2;
+	cur->nullRow = 0;
+	break;
+}
+
+/* Opcode: HashNext P1 P2 * * *
+ *
+ * Advance the hash join cursor P1 to the next row matching the key
+ * passed to the last HashSeek. If there is such a row, jump to P2.
+ * Otherwise fall through to the next instruction.
+ */
+case OP_HashNext: {       /* jump */
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->eCurType == CURTYPE_HASH);
+	bool found;
+	if (sql_hash_join_next(cur->uc.hash_join, &found) != 0)
+		goto abort_due_to_error;
+	cur->cacheStatus = CACHE_STALE;
+	if (found) {
+		cur->nullRow = 0;
+		goto jump_to_p2;
+	}
+	cur->nullRow = 1;
+	break;
+}
+
 /* Opcode: Close P1 * * * *
  *
  * Close a cursor previously opened as P1.  If P1 is not
@@ -3439,12 +3737,17 @@ case OP_Next:          /* jump */
 	break;
 }
 
-/* Opcode: SorterInsert P1 P2 * * *
+/* Opcode: SorterInsert P1 P2 P3 * *
  * Synopsis: key=r[P2]
  *
  * Register P2 holds an SQL index key made using the
  * MakeRecord instructions.  This opcode writes that key
  * into the sorter P1.  Data for the entry is nil.
+ *
+ * If P3 is not zero, register P3 holds the number of the first
+ * sorted records that are read from the sorter, i.e. LIMIT +
+ * OFFSET. A sorter that has no records yet may use it to keep
+ * only these records, see sqlVdbeSorterLimit().
  */
 case OP_SorterInsert: {      /* in2 */
 	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
@@ -3453,6 +3756,11 @@ case OP_SorterInsert: {      /* in2 */
 	assert(isSorter(cursor));
 	pIn2 = &aMem[pOp->p2];
 	assert(mem_is_bin(pIn2));
+	if (pOp->p3 != 0) {
+		pIn3 = &aMem[pOp->p3];
+		assert(mem_is_uint(pIn3));
+		sqlVdbeSorterLimit(cursor, MIN(pIn3->u.u, INT64_MAX));
+	}
 	if (sqlVdbeSorterWrite(cursor, pIn2) != 0)
 		goto abort_due_to_error;
 	break;
@@ -3914,19 +4222,15 @@ case OP_RenameTable: {
 	break;
 }
 
-/* Opcode: LoadAnalysis P1 * * * *
+/* Opcode: Analyze P1 * * * *
+ * Synopsis: analyze(r[P1])
  *
- * Read the sql_stat1 table for database P1 and load the content
- * of that table into the internal index hash table.  This will cause
- * the analysis to be used when preparing all subsequent queries.
+ * Collect statistics of indexes of the space with ID == r[P1]
+ * so that they are used when preparing all subsequent queries.
  */
-case OP_LoadAnalysis: {
-	assert(pOp->p1==0 );
-	/* TODO: Enable analysis. */
-	/*
-	if (sql_analysis_load(db) != 0)
+case OP_Analyze: {
+	if (sql_analyze_space(aMem[pOp->p1].u.i) != 0)
 		goto abort_due_to_error;
-	*/
 	break;
 }
 
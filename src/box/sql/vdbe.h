@@ -95,6 +95,8 @@ struct VdbeOp {
 		 * Information about ephemeral space field types and key parts.
 		 */
 		struct sql_space_info *space_info;
+		/** Plan of a query executed by OP_BatchAggregate. */
+		struct sql_batch_plan *batch_plan;
 		/** P4 contains address of decimal. */
 		decimal_t *dec;
 	} p4;
@@ -213,6 +215,16 @@ VdbeOp *sqlVdbeGetOp(Vdbe *, int);
 int sqlVdbeMakeLabel(Vdbe *);
 void sqlVdbeRunOnlyOnce(Vdbe *);
 
+/**
+ * Replace common opcode sequences of a statement that is executed
+ * often with the opcodes that avoid the interpreter dispatch and the
+ * type checks for the most frequent operand types: OP_Column followed
+ * by a comparison becomes OP_ColumnCompare, the arithmetic opcodes get
+ * an integer fast path. The statement must not be running.
+ */
+void
+sqlVdbeSpecialize(struct Vdbe *p);
+
 void
 vdbe_metadata_delete(struct Vdbe *v);
 
@@ -56,10 +56,14 @@ typedef unsigned Bool;
 /* Opaque type used by code in vdbesort.c */
 typedef struct VdbeSorter VdbeSorter;
 
+/* Opaque type used by code in vdbehash.c */
+struct sql_hash_join;
+
 /* Types of VDBE cursors */
 #define CURTYPE_TARANTOOL   0
 #define CURTYPE_SORTER      1
 #define CURTYPE_PSEUDO      2
+#define CURTYPE_HASH        3
 
 /*
  * A VdbeCursor is an superclass (a wrapper) for various cursor objects:
@@ -99,6 +103,8 @@ struct VdbeCursor {
 		BtCursor *pCursor;	/* CURTYPE_TARANTOOL */
 		int pseudoTableReg;	/* CURTYPE_PSEUDO. Reg holding content. */
 		VdbeSorter *pSorter;	/* CURTYPE_SORTER. Sorter object */
+		/** CURTYPE_HASH. Build side of a hash join. */
+		struct sql_hash_join *hash_join;
 	} uc;
 	/** Info about keys needed by index cursors. */
 	struct key_def *key_def;
@@ -294,6 +300,10 @@ struct Vdbe {
 	 * does not use external resources other than bind variables.
 	 */
 	bft is_sandboxed : 1;
+	/** True if the program has been specialized, see sqlVdbeSpecialize(). */
+	bft is_specialized : 1;
+	/** Number of executions of the statement taken from a cache. */
+	uint32_t exec_count;
 	char *zSql;		/* Text of the SQL statement that generated this */
 	void *pFree;		/* Free this when deleting the vdbe */
 	VdbeFrame *pFrame;	/* Parent frame */
@@ -375,9 +385,132 @@ int
 sqlVdbeSorterNext(const struct VdbeCursor *pCsr, int *pbEof);
 
 int sqlVdbeSorterRewind(const VdbeCursor *, int *);
+
+/**
+ * Tell the sorter that only the first @a nLimit sorted records are
+ * needed. If it is called before the first record is written and the
+ * limit is small enough, the sorter keeps only the @a nLimit least
+ * records written to it in a heap. Otherwise it is a no-op.
+ */
+void
+sqlVdbeSorterLimit(const struct VdbeCursor *pCsr, i64 nLimit);
+
 int sqlVdbeSorterWrite(const VdbeCursor *, Mem *);
 int sqlVdbeSorterCompare(const VdbeCursor *, Mem *, int, int *);
 
+/**
+ * Create the build side of a hash join. The records stored in it have
+ * info->field_count - 1 fields (the last field of info is reserved for
+ * rowid, which is used only if the rows are spilled to an ephemeral
+ * space), the first part_count of which form the join key.
+ */
+struct sql_hash_join *
+sql_hash_join_new(const struct sql_space_info *info, uint32_t part_count);
+
+/** Free the hash join and all rows stored in it. */
+void
+sql_hash_join_delete(struct sql_hash_join *join);
+
+/**
+ * Store a record made by OP_MakeRecord. Records with NULL in the join key
+ * are silently skipped, because they can't match anything. If the memory
+ * used by the hash table exceeds SQL_HASH_JOIN_MEMORY_MAX, all rows are
+ * moved to an ephemeral space.
+ */
+int
+sql_hash_join_insert(struct sql_hash_join *join, const char *data,
+		     uint32_t size);
+
+/**
+ * Position the hash join on the first row whose join key is equal to
+ * the given array of MEMs. @a found is set to false if there's no such row.
+ */
+int
+sql_hash_join_seek(struct sql_hash_join *join, struct Mem *key,
+		   uint32_t part_count, bool *found);
+
+/** Advance to the next row matching the key passed to seek. */
+int
+sql_hash_join_next(struct sql_hash_join *join, bool *found);
+
+/** Return the record of the current row. */
+const char *
+sql_hash_join_data(struct sql_hash_join *join, uint32_t *size);
+
+/** Return the type of the given field of a stored record. */
+enum field_type
+sql_hash_join_field_type(struct sql_hash_join *join, uint32_t fieldno);
+
+/** Aggregate functions supported by OP_BatchAggregate. */
+enum sql_batch_agg_type {
+	SQL_BATCH_COUNT,
+	SQL_BATCH_SUM,
+	SQL_BATCH_MIN,
+	SQL_BATCH_MAX,
+};
+
+/** A field decoded by OP_BatchAggregate. */
+struct sql_batch_plan_column {
+	/** Number of the field in the tuple. */
+	uint32_t fieldno;
+	/** True for DOUBLE fields, false for INTEGER and UNSIGNED ones. */
+	bool is_double;
+};
+
+/** Comparison of a field with a constant: "<field> <op> <constant>". */
+struct sql_batch_filter {
+	/** Index of the field in sql_batch_plan::columns. */
+	uint32_t column;
+	/** One of TK_EQ, TK_NE, TK_LT, TK_LE, TK_GT, TK_GE. */
+	int op;
+	/** The constant, of the same type as the field. */
+	union {
+		int64_t i;
+		double d;
+	};
+};
+
+struct sql_batch_agg {
+	enum sql_batch_agg_type type;
+	/** Index of the argument in sql_batch_plan::columns, -1 if none. */
+	int column;
+	/** Register to store the result to. */
+	int reg;
+};
+
+/** Description of a query executed by OP_BatchAggregate. */
+struct sql_batch_plan {
+	/** Decoded fields, sorted by fieldno. */
+	struct sql_batch_plan_column *columns;
+	uint32_t column_count;
+	/** Filters, a row is selected if it satisfies all of them. */
+	struct sql_batch_filter *filters;
+	uint32_t filter_count;
+	/** Aggregates computed over the selected rows. */
+	struct sql_batch_agg *aggs;
+	uint32_t agg_count;
+};
+
+/**
+ * Allocate a zeroed plan of OP_BatchAggregate with the given number of
+ * columns, filters and aggregates in a single block of memory.
+ */
+struct sql_batch_plan *
+sql_batch_plan_new(uint32_t column_count, uint32_t filter_count,
+		   uint32_t agg_count);
+
+/**
+ * Compute the aggregates of the plan over all rows of the cursor, reading
+ * them in blocks of SQL_BATCH_SIZE rows, and store the results to the
+ * registers of @a mems. A large space may be scanned by worker threads,
+ * the fiber yields while waiting for them. If a value can't be processed
+ * in batch, @a is_supported is set to false and the registers are left
+ * intact.
+ */
+int
+sql_batch_aggregate(struct BtCursor *cur, const struct sql_batch_plan *plan,
+		    struct Mem *mems, bool *is_supported);
+
 int sqlVdbeMemTranslate(Mem *, u8);
 #ifdef SQL_DEBUG
 void sqlVdbePrintSql(Vdbe *);
@@ -570,6 +570,32 @@ sql_stmt_busy(const struct Vdbe *v)
 	return v->magic == VDBE_MAGIC_RUN && v->pc >= 0;
 }
 
+void
+sql_stmt_count_execution(struct Vdbe *v)
+{
+	assert(!sql_stmt_busy(v));
+	if (v->is_specialized)
+		return;
+	if (++v->exec_count >= SQL_HOT_STMT_EXECUTIONS)
+		sqlVdbeSpecialize(v);
+}
+
+void
+sql_stmt_suspend(struct Vdbe *v)
+{
+	assert(sql_stmt_busy(v));
+	/*
+	 * Row caches of the cursors are already invalidated by
+	 * OP_ResultRow, so only the registers and the bound values,
+	 * which may point to the request and the region memory,
+	 * are to be copied.
+	 */
+	for (int i = 0; i < v->nVar; i++)
+		mem_make_own(&v->aVar[i]);
+	for (int i = 0; i < v->nMem; i++)
+		mem_make_own(&v->aMem[i]);
+}
+
 const char *
 sql_sql(struct Vdbe *p)
 {
@@ -656,6 +656,59 @@ sqlVdbeDeletePriorOpcode(Vdbe * p, u8 op)
 	}
 }
 
+/**
+ * Replace common opcode sequences of a program with the fused and
+ * specialized opcodes.
+ */
+static void
+vdbe_specialize_program(struct VdbeOp *ops, int op_count)
+{
+	for (int i = 0; i < op_count; i++) {
+		struct VdbeOp *op = &ops[i];
+		switch (op->opcode) {
+		case OP_Column: {
+			if (i + 1 == op_count)
+				break;
+			const struct VdbeOp *next = &ops[i + 1];
+			if (next->opcode != OP_Eq && next->opcode != OP_Ne &&
+			    next->opcode != OP_Lt && next->opcode != OP_Le &&
+			    next->opcode != OP_Gt && next->opcode != OP_Ge)
+				break;
+			if ((next->p5 & SQL_STOREP2) != 0)
+				break;
+			if (next->p1 != op->p3 && next->p3 != op->p3)
+				break;
+			op->opcode = OP_ColumnCompare;
+			break;
+		}
+		case OP_Add:
+			op->opcode = OP_AddInt;
+			break;
+		case OP_Subtract:
+			op->opcode = OP_SubtractInt;
+			break;
+		case OP_Multiply:
+			op->opcode = OP_MultiplyInt;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void
+sqlVdbeSpecialize(struct Vdbe *p)
+{
+	assert(!sql_stmt_busy(p));
+	if (p->is_specialized)
+		return;
+	vdbe_specialize_program(p->aOp, p->nOp);
+	for (struct SubProgram *sub = p->pProgram; sub != NULL;
+	     sub = sub->pNext)
+		vdbe_specialize_program(sub->aOp, sub->nOp);
+	p->is_specialized = true;
+}
+
 /*
  * Change the value of the P4 operand for a specific instruction.
  *
@@ -1482,6 +1535,10 @@ sqlVdbeFreeCursor(struct VdbeCursor *pCx)
 		sql_cursor_close(pCx->uc.pCursor);
 			break;
 		}
+	case CURTYPE_HASH:
+		if (pCx->uc.hash_join != NULL)
+			sql_hash_join_delete(pCx->uc.hash_join);
+		break;
 	}
 }
 
@@ -0,0 +1,848 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/*
+ * This file contains the batch execution of simple aggregate queries
+ * like
+ *
+ *   SELECT COUNT(*), SUM(a), MAX(b) FROM t WHERE c > 10 AND d <> 0;
+ *
+ * Instead of moving one row at a time through OP_Column, the comparison
+ * opcodes and OP_AggStep, the rows are read in blocks of SQL_BATCH_SIZE.
+ * The fields used by the query are decoded into typed arrays, then each
+ * filter clears the entries of a selection vector for the rows it rejects
+ * and each aggregate is computed over the selected rows. The kernels are
+ * plain loops without branches over restrict-qualified arrays of a fixed
+ * size, which the compiler turns into SIMD code (with SSE4.2 or AVX2
+ * enabled on x86_64). A short block is padded with unselected rows.
+ *
+ * The results are exactly the same as the row-at-a-time ones. If a value
+ * can't be processed this way (e.g. an UNSIGNED greater than INT64_MAX or
+ * an integer stored in a DOUBLE field), the caller falls back to the
+ * row-at-a-time code.
+ *
+ * A large space is scanned by worker threads (see box.cfg.memtx_sort_threads)
+ * if the statement isn't run in a transaction. The primary key is split
+ * into ranges by sampling random keys, each worker computes the aggregates
+ * over its range of a read view of the space and the partial results are
+ * merged in the order of the ranges, so the TX thread keeps serving other
+ * requests meanwhile. SUM() of DOUBLE values, whose result depends on the
+ * order of additions, is always computed by the TX thread.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+#include "vdbeInt.h"
+#include "tarantoolInt.h"
+#include "box/index.h"
+#include "box/memtx_engine.h"
+#include "box/read_view.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "box/txn.h"
+#include "coio_task.h"
+#include "fiber.h"
+#include "msgpuck/msgpuck.h"
+#include "qsort_arg.h"
+
+#include <math.h>
+
+/** Decoded values of a field for a block of rows. */
+struct sql_batch_column {
+	/** Values of an INTEGER or UNSIGNED field. */
+	int64_t *i;
+	/** Values of a DOUBLE field, share the memory with the above. */
+	double *d;
+	/** 1 if the value is NULL, 0 otherwise. */
+	uint8_t *is_null;
+};
+
+/** Accumulated state of an aggregate. */
+struct sql_batch_acc {
+	/** Number of the values accumulated so far. */
+	uint64_t count;
+	union {
+		/** Sum of integers, wide enough to never overflow. */
+		__int128 i;
+		/** Sum, minimum or maximum of doubles. */
+		double d;
+		/** Minimum or maximum of integers. */
+		int64_t m;
+	};
+	/**
+	 * Minimum and maximum of the intermediate sums of integers,
+	 * including the initial zero. Like the row-at-a-time SUM(), the
+	 * query fails if any of them doesn't fit in [INT64_MIN, UINT64_MAX].
+	 */
+	__int128 sum_min;
+	__int128 sum_max;
+};
+
+/** Buffers to decode and filter a block of rows. */
+struct sql_batch_block {
+	/** Decoded fields, see sql_batch_plan::columns. */
+	struct sql_batch_column *columns;
+	/** Selection vector, 1 if the row is selected, 0 otherwise. */
+	uint8_t *sel;
+};
+
+struct sql_batch_plan *
+sql_batch_plan_new(uint32_t column_count, uint32_t filter_count,
+		   uint32_t agg_count)
+{
+	size_t size = sizeof(struct sql_batch_plan) +
+		      column_count * sizeof(struct sql_batch_plan_column) +
+		      filter_count * sizeof(struct sql_batch_filter) +
+		      agg_count * sizeof(struct sql_batch_agg);
+	struct sql_batch_plan *plan = sql_xmalloc0(size);
+	plan->columns = (struct sql_batch_plan_column *)(plan + 1);
+	plan->filters = (struct sql_batch_filter *)
+			(plan->columns + column_count);
+	plan->aggs = (struct sql_batch_agg *)(plan->filters + filter_count);
+	plan->column_count = column_count;
+	plan->filter_count = filter_count;
+	plan->agg_count = agg_count;
+	return plan;
+}
+
+/**
+ * Decode the fields of a tuple used by the plan into the row @a row of
+ * the columns. Return false if a value can't be processed in batch.
+ */
+static bool
+sql_batch_decode(const struct sql_batch_plan *plan,
+		 struct sql_batch_column *columns, uint32_t row,
+		 const char *data)
+{
+	uint32_t field_count = mp_decode_array(&data);
+	uint32_t fieldno = 0;
+	for (uint32_t i = 0; i < plan->column_count; i++) {
+		struct sql_batch_column *column = &columns[i];
+		bool is_double = plan->columns[i].is_double;
+		uint32_t next = plan->columns[i].fieldno;
+		column->i[row] = 0;
+		column->is_null[row] = 1;
+		if (next >= field_count)
+			continue;
+		for (; fieldno < next; fieldno++)
+			mp_next(&data);
+		fieldno++;
+		switch (mp_typeof(*data)) {
+		case MP_NIL:
+			mp_decode_nil(&data);
+			continue;
+		case MP_UINT: {
+			uint64_t value = mp_decode_uint(&data);
+			if (is_double || value > INT64_MAX)
+				return false;
+			column->i[row] = value;
+			break;
+		}
+		case MP_INT:
+			if (is_double)
+				return false;
+			column->i[row] = mp_decode_int(&data);
+			break;
+		case MP_FLOAT:
+			if (!is_double)
+				return false;
+			column->d[row] = mp_decode_float(&data);
+			break;
+		case MP_DOUBLE:
+			if (!is_double)
+				return false;
+			column->d[row] = mp_decode_double(&data);
+			break;
+		default:
+			return false;
+		}
+		if (is_double && isnan(column->d[row]))
+			return false;
+		column->is_null[row] = 0;
+	}
+	return true;
+}
+
+/**
+ * Clear the entries of the selection vector for the rows whose value
+ * is NULL or doesn't satisfy the comparison.
+ */
+#define SQL_BATCH_FILTER(values, op, c) do {				\
+	for (uint32_t i = 0; i < SQL_BATCH_SIZE; i++)			\
+		sel[i] &= (uint8_t)(values[i] op c) & (is_null[i] ^ 1);	\
+} while (0)
+
+#define SQL_BATCH_FILTER_OP(values, op, c) do {				\
+	switch (op) {							\
+	case TK_EQ: SQL_BATCH_FILTER(values, ==, c); break;		\
+	case TK_NE: SQL_BATCH_FILTER(values, !=, c); break;		\
+	case TK_LT: SQL_BATCH_FILTER(values, <, c); break;		\
+	case TK_LE: SQL_BATCH_FILTER(values, <=, c); break;		\
+	case TK_GT: SQL_BATCH_FILTER(values, >, c); break;		\
+	case TK_GE: SQL_BATCH_FILTER(values, >=, c); break;		\
+	default: unreachable();						\
+	}								\
+} while (0)
+
+static void
+sql_batch_filter_int(const int64_t *restrict values,
+		     const uint8_t *restrict is_null, int op, int64_t c,
+		     uint8_t *restrict sel)
+{
+	SQL_BATCH_FILTER_OP(values, op, c);
+}
+
+static void
+sql_batch_filter_double(const double *restrict values,
+			const uint8_t *restrict is_null, int op, double c,
+			uint8_t *restrict sel)
+{
+	SQL_BATCH_FILTER_OP(values, op, c);
+}
+
+#undef SQL_BATCH_FILTER_OP
+#undef SQL_BATCH_FILTER
+
+/** Return the number of the selected rows with a non-NULL value. */
+static uint64_t
+sql_batch_count(const uint8_t *restrict is_null,
+		const uint8_t *restrict sel)
+{
+	uint32_t count = 0;
+	if (is_null == NULL) {
+		for (uint32_t i = 0; i < SQL_BATCH_SIZE; i++)
+			count += sel[i];
+	} else {
+		for (uint32_t i = 0; i < SQL_BATCH_SIZE; i++)
+			count += sel[i] & (is_null[i] ^ 1);
+	}
+	return count;
+}
+
+/**
+ * Add the selected integers to the sum and update the bounds of the
+ * intermediate sums.
+ */
+static void
+sql_batch_sum_int(struct sql_batch_acc *acc, const int64_t *restrict values,
+		  const uint8_t *restrict is_null, const uint8_t *restrict sel)
+{
+	__int128 sum = acc->i;
+	__int128 min = acc->sum_min;
+	__int128 max = acc->sum_max;
+	for (uint32_t i = 0; i < SQL_BATCH_SIZE; i++) {
+		int64_t mask = -(int64_t)(sel[i] & (is_null[i] ^ 1));
+		sum += values[i] & mask;
+		min = sum < min ? sum : min;
+		max = sum > max ? sum : max;
+	}
+	acc->i = sum;
+	acc->sum_min = min;
+	acc->sum_max = max;
+	acc->count += sql_batch_count(is_null, sel);
+}
+
+/**
+ * Add the selected doubles to the sum in the order of the rows. Skipped
+ * rows add -0.0, which doesn't change any sum, including -0.0 itself.
+ */
+static void
+sql_batch_sum_double(struct sql_batch_acc *acc,
+		     const double *restrict values,
+		     const uint8_t *restrict is_null,
+		     const uint8_t *restrict sel)
+{
+	double sum = acc->count == 0 ? -0.0 : acc->d;
+	for (uint32_t i = 0; i < SQL_BATCH_SIZE; i++) {
+		bool is_selected = (sel[i] & (is_null[i] ^ 1)) != 0;
+		sum += is_selected ? values[i] : -0.0;
+	}
+	acc->d = sum;
+	acc->count += sql_batch_count(is_null, sel);
+}
+
+/**
+ * Update the minimum or maximum with the selected values. Skipped rows
+ * are replaced with the identity element of the operation. The first of
+ * equal values wins, like in the row-at-a-time MIN() and MAX().
+ */
+#define SQL_BATCH_MINMAX(type, m, values, is_max, identity) do {	\
+	for (uint32_t i = 0; i < SQL_BATCH_SIZE; i++) {			\
+		bool is_selected = (sel[i] & (is_null[i] ^ 1)) != 0;	\
+		type v = is_selected ? values[i] : identity;		\
+		if (is_max)						\
+			m = v > m ? v : m;				\
+		else							\
+			m = v < m ? v : m;				\
+	}								\
+} while (0)
+
+static void
+sql_batch_minmax_int(struct sql_batch_acc *acc, bool is_max,
+		     const int64_t *restrict values,
+		     const uint8_t *restrict is_null,
+		     const uint8_t *restrict sel)
+{
+	int64_t identity = is_max ? INT64_MIN : INT64_MAX;
+	int64_t m = acc->count == 0 ? identity : acc->m;
+	SQL_BATCH_MINMAX(int64_t, m, values, is_max, identity);
+	acc->m = m;
+	acc->count += sql_batch_count(is_null, sel);
+}
+
+static void
+sql_batch_minmax_double(struct sql_batch_acc *acc, bool is_max,
+			const double *restrict values,
+			const uint8_t *restrict is_null,
+			const uint8_t *restrict sel)
+{
+	double identity = is_max ? -INFINITY : INFINITY;
+	double m = acc->count == 0 ? identity : acc->d;
+	SQL_BATCH_MINMAX(double, m, values, is_max, identity);
+	acc->d = m;
+	acc->count += sql_batch_count(is_null, sel);
+}
+
+#undef SQL_BATCH_MINMAX
+
+/**
+ * Apply the filters and update the aggregates with a block of @a size
+ * rows. The rest of the block is not selected.
+ */
+static void
+sql_batch_process(const struct sql_batch_plan *plan,
+		  const struct sql_batch_column *columns,
+		  struct sql_batch_acc *accs, uint8_t *sel, uint32_t size)
+{
+	memset(sel, 1, size);
+	memset(sel + size, 0, SQL_BATCH_SIZE - size);
+	for (uint32_t i = 0; i < plan->filter_count; i++) {
+		const struct sql_batch_filter *filter = &plan->filters[i];
+		const struct sql_batch_column *column =
+			&columns[filter->column];
+		if (plan->columns[filter->column].is_double) {
+			sql_batch_filter_double(column->d, column->is_null,
+						filter->op, filter->d, sel);
+		} else {
+			sql_batch_filter_int(column->i, column->is_null,
+					     filter->op, filter->i, sel);
+		}
+	}
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		const struct sql_batch_agg *agg = &plan->aggs[i];
+		struct sql_batch_acc *acc = &accs[i];
+		if (agg->column < 0) {
+			acc->count += sql_batch_count(NULL, sel);
+			continue;
+		}
+		const struct sql_batch_column *column = &columns[agg->column];
+		bool is_double = plan->columns[agg->column].is_double;
+		switch (agg->type) {
+		case SQL_BATCH_COUNT:
+			acc->count += sql_batch_count(column->is_null, sel);
+			break;
+		case SQL_BATCH_SUM:
+			if (is_double) {
+				sql_batch_sum_double(acc, column->d,
+						     column->is_null, sel);
+			} else {
+				sql_batch_sum_int(acc, column->i,
+						  column->is_null, sel);
+			}
+			break;
+		case SQL_BATCH_MIN:
+		case SQL_BATCH_MAX: {
+			bool is_max = agg->type == SQL_BATCH_MAX;
+			if (is_double) {
+				sql_batch_minmax_double(acc, is_max, column->d,
+							column->is_null, sel);
+			} else {
+				sql_batch_minmax_int(acc, is_max, column->i,
+						     column->is_null, sel);
+			}
+			break;
+		}
+		default:
+			unreachable();
+		}
+	}
+}
+
+/** Store the final value of an aggregate to the MEM. */
+static void
+sql_batch_result(const struct sql_batch_plan *plan,
+		 const struct sql_batch_agg *agg,
+		 const struct sql_batch_acc *acc, struct Mem *mem)
+{
+	if (agg->type == SQL_BATCH_COUNT) {
+		mem_set_uint(mem, acc->count);
+		return;
+	}
+	if (acc->count == 0) {
+		mem_set_null(mem);
+		return;
+	}
+	if (plan->columns[agg->column].is_double) {
+		mem_set_double(mem, acc->d);
+	} else if (agg->type == SQL_BATCH_SUM) {
+		if (acc->i < 0)
+			mem_set_int(mem, (int64_t)acc->i, true);
+		else
+			mem_set_uint(mem, (uint64_t)acc->i);
+	} else {
+		mem_set_int(mem, acc->m, acc->m < 0);
+	}
+}
+
+
+/**
+ * Allocate the buffers of a block. The memory is zeroed, so the padding
+ * of the first short block is initialized.
+ */
+static void
+sql_batch_block_create(struct sql_batch_block *block,
+		       const struct sql_batch_plan *plan)
+{
+	uint32_t column_count = plan->column_count;
+	size_t column_size = SQL_BATCH_SIZE * (sizeof(int64_t) + 1);
+	char *buf = sql_xmalloc0(column_count * column_size + SQL_BATCH_SIZE +
+				 column_count * sizeof(struct sql_batch_column));
+	struct sql_batch_column *columns = (struct sql_batch_column *)buf;
+	char *data = (char *)(columns + column_count);
+	for (uint32_t i = 0; i < column_count; i++) {
+		columns[i].i = (int64_t *)data;
+		columns[i].d = (double *)data;
+		columns[i].is_null = (uint8_t *)data +
+				     SQL_BATCH_SIZE * sizeof(int64_t);
+		data += column_size;
+	}
+	block->columns = columns;
+	block->sel = (uint8_t *)data;
+}
+
+static void
+sql_batch_block_destroy(struct sql_batch_block *block)
+{
+	sql_xfree(block->columns);
+}
+
+/**
+ * Compute the aggregates over all rows of the cursor in the TX thread.
+ * If a value can't be processed in batch, @a is_supported is set to false.
+ */
+static int
+sql_batch_scan(struct BtCursor *cur, const struct sql_batch_plan *plan,
+	       struct sql_batch_acc *accs, bool *is_supported)
+{
+	struct sql_batch_block block;
+	sql_batch_block_create(&block, plan);
+	int rc = -1;
+	int is_eof;
+	if (tarantoolsqlFirst(cur, &is_eof) != 0)
+		goto out;
+	while (is_eof == 0) {
+		uint32_t size = 0;
+		do {
+			if (!sql_batch_decode(plan, block.columns, size,
+					      tuple_data(cur->last_tuple))) {
+				*is_supported = false;
+				rc = 0;
+				goto out;
+			}
+			++size;
+			if (tarantoolsqlNext(cur, &is_eof) != 0)
+				goto out;
+		} while (is_eof == 0 && size < SQL_BATCH_SIZE);
+		sql_batch_process(plan, block.columns, accs, block.sel, size);
+	}
+	rc = 0;
+out:
+	sql_batch_block_destroy(&block);
+	return rc;
+}
+
+/**
+ * Merge the aggregates computed over a range of rows into the aggregates
+ * computed over the preceding rows.
+ */
+static void
+sql_batch_merge(const struct sql_batch_plan *plan, struct sql_batch_acc *accs,
+		const struct sql_batch_acc *part)
+{
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		const struct sql_batch_agg *agg = &plan->aggs[i];
+		struct sql_batch_acc *acc = &accs[i];
+		const struct sql_batch_acc *p = &part[i];
+		if (agg->type == SQL_BATCH_COUNT || p->count == 0) {
+			acc->count += p->count;
+			continue;
+		}
+		bool is_double = plan->columns[agg->column].is_double;
+		bool is_max = agg->type == SQL_BATCH_MAX;
+		switch (agg->type) {
+		case SQL_BATCH_SUM:
+			/* SUM() of doubles is never computed in parts. */
+			assert(!is_double);
+			acc->sum_min = MIN(acc->sum_min, acc->i + p->sum_min);
+			acc->sum_max = MAX(acc->sum_max, acc->i + p->sum_max);
+			acc->i += p->i;
+			break;
+		case SQL_BATCH_MIN:
+		case SQL_BATCH_MAX:
+			/* The value of the preceding rows wins a tie. */
+			if (is_double) {
+				if (acc->count == 0 ||
+				    (is_max ? p->d > acc->d : p->d < acc->d))
+					acc->d = p->d;
+			} else if (acc->count == 0 ||
+				   (is_max ? p->m > acc->m : p->m < acc->m)) {
+				acc->m = p->m;
+			}
+			break;
+		default:
+			unreachable();
+		}
+		acc->count += p->count;
+	}
+}
+
+/** A range of the primary key scanned by a worker thread. */
+struct sql_batch_task {
+	const struct sql_batch_plan *plan;
+	/** Read view of the primary index. */
+	struct index_read_view *index;
+	/** The first key of the range or NULL if it's unbounded. */
+	const char *begin;
+	/** The key following the range or NULL if it's unbounded. */
+	const char *end;
+	/** Buffers of the task. */
+	struct sql_batch_block block;
+	/** Aggregates computed over the range. */
+	struct sql_batch_acc *accs;
+	/** Set to false if a value can't be processed in batch. */
+	bool is_supported;
+	/** Fiber waiting for the worker thread. */
+	struct fiber *fiber;
+};
+
+/**
+ * Set @a data to the next tuple of the task's range or to NULL if the
+ * range is over. The key of the tuple is extracted on the region.
+ */
+static int
+sql_batch_task_next(struct sql_batch_task *task,
+		    struct index_read_view_iterator *it, const char **data)
+{
+	struct read_view_tuple tuple;
+	if (index_read_view_iterator_next_raw(it, &tuple) != 0)
+		return -1;
+	*data = tuple.data;
+	if (tuple.data == NULL || task->end == NULL)
+		return 0;
+	struct key_def *key_def = task->index->def->key_def;
+	uint32_t key_size;
+	const char *key = tuple_extract_key_raw_to_region(
+		tuple.data, tuple.data + tuple.size, key_def, MULTIKEY_NONE,
+		&key_size, &fiber()->gc);
+	if (key == NULL)
+		return -1;
+	mp_decode_array(&key);
+	if (key_compare(key, key_def->part_count, HINT_NONE, task->end,
+			key_def->part_count, HINT_NONE, key_def) >= 0)
+		*data = NULL;
+	return 0;
+}
+
+/** Compute the aggregates over a range of keys, run by a worker thread. */
+static ssize_t
+sql_batch_task_f(va_list ap)
+{
+	struct sql_batch_task *task = va_arg(ap, struct sql_batch_task *);
+	const struct sql_batch_plan *plan = task->plan;
+	struct sql_batch_block *block = &task->block;
+	struct region *region = &fiber()->gc;
+	uint32_t part_count = task->index->def->key_def->part_count;
+	struct index_read_view_iterator it;
+	if (index_read_view_create_iterator(
+			task->index, task->begin == NULL ? ITER_ALL : ITER_GE,
+			task->begin, task->begin == NULL ? 0 : part_count,
+			&it) != 0)
+		return -1;
+	int rc = -1;
+	bool is_eof = false;
+	while (!is_eof) {
+		uint32_t size = 0;
+		while (size < SQL_BATCH_SIZE) {
+			size_t used = region_used(region);
+			const char *data;
+			if (sql_batch_task_next(task, &it, &data) != 0)
+				goto out;
+			if (data == NULL) {
+				is_eof = true;
+				region_truncate(region, used);
+				break;
+			}
+			bool is_supported = sql_batch_decode(plan,
+							     block->columns,
+							     size, data);
+			region_truncate(region, used);
+			if (!is_supported) {
+				task->is_supported = false;
+				rc = 0;
+				goto out;
+			}
+			++size;
+		}
+		if (size > 0) {
+			sql_batch_process(plan, block->columns, task->accs,
+					  block->sel, size);
+		}
+	}
+	rc = 0;
+out:
+	index_read_view_iterator_destroy(&it);
+	return rc;
+}
+
+/** The main function of a fiber waiting for a worker thread. */
+static int
+sql_batch_task_fiber_f(va_list ap)
+{
+	struct sql_batch_task *task = va_arg(ap, struct sql_batch_task *);
+	return coio_call(sql_batch_task_f, task) == 0 ? 0 : -1;
+}
+
+/**
+ * Return the number of worker threads the cursor may be scanned by or 0
+ * if it must be scanned by the TX thread. The threads are the same as
+ * the threads of the SQL sorter.
+ */
+static int
+sql_batch_worker_count(struct BtCursor *cur, const struct sql_batch_plan *plan)
+{
+	struct memtx_engine *memtx =
+		(struct memtx_engine *)engine_by_name("memtx");
+	if (memtx == NULL || memtx->sort_threads <= 1)
+		return 0;
+	/*
+	 * A read view doesn't see the changes of the transaction, and
+	 * the fiber can't wait for the threads if it can't yield.
+	 */
+	if (!cord_is_main() || in_txn() != NULL)
+		return 0;
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		const struct sql_batch_agg *agg = &plan->aggs[i];
+		if (agg->type == SQL_BATCH_SUM &&
+		    plan->columns[agg->column].is_double)
+			return 0;
+	}
+	struct space *space = cur->space;
+	struct index *index = cur->index;
+	if (!space_is_memtx(space) || space->upgrade != NULL ||
+	    index->def->iid != 0 || index->def->type != TREE ||
+	    index_size(index) < SQL_BATCH_PARALLEL_MIN_ROWS)
+		return 0;
+	return MIN(memtx->sort_threads, SQL_BATCH_MAX_WORKERS);
+}
+
+static int
+sql_batch_key_cmp(const void *a, const void *b, void *arg)
+{
+	struct key_def *key_def = arg;
+	const char *key_a = *(const char **)a;
+	const char *key_b = *(const char **)b;
+	return key_compare(key_a, key_def->part_count, HINT_NONE,
+			   key_b, key_def->part_count, HINT_NONE, key_def);
+}
+
+/**
+ * Split the primary key into at most @a count ranges of roughly the same
+ * size by sampling random keys. The first keys of all ranges but the first
+ * one are stored to @a keys, without the MsgPack array header, and their
+ * number is returned. The keys are allocated on the region.
+ */
+static int
+sql_batch_split(struct index *index, int count, const char **keys,
+		struct region *region)
+{
+	struct key_def *key_def = index->def->key_def;
+	int sample_count = count * SQL_BATCH_SPLIT_SAMPLES;
+	const char **samples = xregion_alloc_array(region, const char *,
+						   sample_count);
+	for (int i = 0; i < sample_count; i++) {
+		struct tuple *tuple;
+		if (index_random(index, rand(), &tuple) != 0)
+			return -1;
+		if (tuple == NULL)
+			return 0;
+		uint32_t key_size;
+		const char *key = tuple_extract_key_to_region(
+			tuple, key_def, MULTIKEY_NONE, &key_size, region);
+		if (key == NULL)
+			return -1;
+		mp_decode_array(&key);
+		samples[i] = key;
+	}
+	qsort_arg(samples, sample_count, sizeof(*samples), sql_batch_key_cmp,
+		  key_def);
+	int key_count = 0;
+	for (int i = 1; i < count; i++) {
+		const char *key = samples[i * SQL_BATCH_SPLIT_SAMPLES];
+		if (key_count > 0 &&
+		    sql_batch_key_cmp(&keys[key_count - 1], &key, key_def) == 0)
+			continue;
+		keys[key_count++] = key;
+	}
+	return key_count;
+}
+
+static bool
+sql_batch_space_filter(struct space *space, void *arg)
+{
+	return space == arg;
+}
+
+static bool
+sql_batch_index_filter(struct space *space, struct index *index, void *arg)
+{
+	(void)space;
+	(void)arg;
+	return index->def->iid == 0;
+}
+
+/**
+ * Compute the aggregates over a read view of the cursor's space split
+ * into ranges scanned by @a worker_count worker threads.
+ */
+static int
+sql_batch_scan_parallel(struct BtCursor *cur,
+			const struct sql_batch_plan *plan,
+			struct sql_batch_acc *accs, int worker_count,
+			bool *is_supported)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char **keys = xregion_alloc_array(region, const char *,
+						worker_count);
+	int key_count = sql_batch_split(cur->index, worker_count, keys,
+					region);
+	if (key_count <= 0) {
+		region_truncate(region, region_svp);
+		if (key_count < 0)
+			return -1;
+		return sql_batch_scan(cur, plan, accs, is_supported);
+	}
+	/* No yields between the sampling and the read view creation. */
+	struct read_view rv;
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = "sql";
+	opts.is_system = true;
+	opts.filter_space = sql_batch_space_filter;
+	opts.filter_index = sql_batch_index_filter;
+	opts.filter_arg = cur->space;
+	opts.enable_temporary_spaces = true;
+	if (read_view_open(&rv, &opts) != 0) {
+		region_truncate(region, region_svp);
+		return -1;
+	}
+	struct space_read_view *space_rv =
+		rlist_first_entry(&rv.spaces, struct space_read_view, link);
+	struct index_read_view *index_rv = space_read_view_index(space_rv, 0);
+	assert(index_rv != NULL);
+
+	int task_count = key_count + 1;
+	struct sql_batch_task *tasks =
+		sql_xmalloc0(task_count * sizeof(*tasks));
+	struct sql_batch_acc *task_accs =
+		sql_xmalloc0(task_count * plan->agg_count * sizeof(*accs));
+	int rc = 0;
+	for (int i = 0; i < task_count; i++) {
+		struct sql_batch_task *task = &tasks[i];
+		task->plan = plan;
+		task->index = index_rv;
+		task->begin = i == 0 ? NULL : keys[i - 1];
+		task->end = i == key_count ? NULL : keys[i];
+		task->accs = task_accs + i * plan->agg_count;
+		task->is_supported = true;
+		sql_batch_block_create(&task->block, plan);
+		task->fiber = fiber_new("sql.aggregate",
+					sql_batch_task_fiber_f);
+		if (task->fiber == NULL) {
+			rc = -1;
+			continue;
+		}
+		fiber_set_joinable(task->fiber, true);
+		fiber_start(task->fiber, task);
+	}
+	for (int i = 0; i < task_count; i++) {
+		struct sql_batch_task *task = &tasks[i];
+		if (task->fiber != NULL && fiber_join(task->fiber) != 0)
+			rc = -1;
+		if (!task->is_supported)
+			*is_supported = false;
+		sql_batch_block_destroy(&task->block);
+		if (rc == 0 && *is_supported)
+			sql_batch_merge(plan, accs, task->accs);
+	}
+	sql_xfree(task_accs);
+	sql_xfree(tasks);
+	read_view_close(&rv);
+	region_truncate(region, region_svp);
+	return rc;
+}
+
+/**
+ * Check that the intermediate sums of integers fit in the range of
+ * SUM() results.
+ */
+static int
+sql_batch_check(const struct sql_batch_plan *plan,
+		const struct sql_batch_acc *accs)
+{
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		const struct sql_batch_agg *agg = &plan->aggs[i];
+		const struct sql_batch_acc *acc = &accs[i];
+		if (agg->type != SQL_BATCH_SUM ||
+		    plan->columns[agg->column].is_double)
+			continue;
+		if (acc->sum_min < INT64_MIN ||
+		    acc->sum_max > (__int128)UINT64_MAX) {
+			diag_set(ClientError, ER_SQL_EXECUTE,
+				 "integer is overflowed");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int
+sql_batch_aggregate(struct BtCursor *cur, const struct sql_batch_plan *plan,
+		    struct Mem *mems, bool *is_supported)
+{
+	*is_supported = true;
+	struct sql_batch_acc *accs =
+		sql_xmalloc0(plan->agg_count * sizeof(struct sql_batch_acc));
+	int worker_count = sql_batch_worker_count(cur, plan);
+	int rc;
+	if (worker_count > 1) {
+		rc = sql_batch_scan_parallel(cur, plan, accs, worker_count,
+					     is_supported);
+	} else {
+		rc = sql_batch_scan(cur, plan, accs, is_supported);
+	}
+	if (rc != 0 || !*is_supported)
+		goto out;
+	rc = sql_batch_check(plan, accs);
+	if (rc != 0)
+		goto out;
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		const struct sql_batch_agg *agg = &plan->aggs[i];
+		sql_batch_result(plan, agg, &accs[i], &mems[agg->reg]);
+	}
+out:
+	sql_xfree(accs);
+	return rc;
+}
@@ -0,0 +1,396 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/*
+ * This file contains the build side of the hash join. Rows of the inner
+ * table of a join are collected in an in-memory hash table keyed by the
+ * columns used in the join condition. Then for each row of the outer table
+ * the matching rows are looked up in O(1) instead of building a sorted
+ * ephemeral index or scanning the inner table.
+ *
+ * Each stored row is an OP_MakeRecord record whose first key_part_count
+ * fields form the join key. If the hash table grows beyond
+ * SQL_HASH_JOIN_MEMORY_MAX bytes, all rows are moved to an ephemeral space
+ * with a TREE index over the join key and the following lookups are served
+ * by the index.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+#include "vdbeInt.h"
+#include "tarantoolInt.h"
+#include "box/index.h"
+#include "box/key_def.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "errinj.h"
+#include "msgpuck/msgpuck.h"
+
+/** A row stored in the hash table. */
+struct sql_hash_join_entry {
+	/** Next entry in the same bucket. */
+	struct sql_hash_join_entry *next;
+	/** Hash of the join key. */
+	uint32_t hash;
+	/** Size of the record. */
+	uint32_t size;
+	/** MsgPack array with the record. */
+	char data[0];
+};
+
+struct sql_hash_join {
+	/** Definition of the join key, fields [0, part_count) of a record. */
+	struct key_def *key_def;
+	/** Field types of a record, used to set MEM flags. */
+	enum field_type *types;
+	/** Collation ids of the fields of a record. */
+	uint32_t *coll_ids;
+	/** Number of fields in a record, not counting rowid. */
+	uint32_t field_count;
+	/** Hash table buckets, the number of buckets is a power of 2. */
+	struct sql_hash_join_entry **buckets;
+	/** Number of buckets. */
+	uint32_t bucket_count;
+	/** Number of rows in the hash table. */
+	uint32_t entry_count;
+	/** Memory used by the hash table, in bytes. */
+	size_t used;
+	/**
+	 * Ephemeral space the rows were spilled to or NULL if all rows
+	 * fit in memory.
+	 */
+	struct space *space;
+	/** Rowid of the next row inserted into the ephemeral space. */
+	uint64_t rowid;
+	/** Iterator over the ephemeral space, used after a spill. */
+	struct iterator *iter;
+	/** Current tuple of the ephemeral space iterator. */
+	struct tuple *tuple;
+	/** Current entry of the hash table. */
+	struct sql_hash_join_entry *entry;
+	/** Hash of the current lookup key. */
+	uint32_t key_hash;
+	/** Current lookup key, without MsgPack array header. */
+	char *key;
+	/** Size of the buffer allocated for the lookup key. */
+	uint32_t key_capacity;
+};
+
+enum {
+	/** Initial number of hash table buckets. */
+	SQL_HASH_JOIN_BUCKETS_MIN = 1024,
+};
+
+struct sql_hash_join *
+sql_hash_join_new(const struct sql_space_info *info, uint32_t part_count)
+{
+	assert(info->field_count > part_count && part_count > 0);
+	/* The last field of the ephemeral space is reserved for rowid. */
+	uint32_t field_count = info->field_count - 1;
+	struct region *region = &fiber()->gc;
+	size_t svp = region_used(region);
+	struct key_part_def *parts =
+		xregion_alloc_array(region, typeof(parts[0]), part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		parts[i] = key_part_def_default;
+		parts[i].fieldno = i;
+		parts[i].type = info->types[i];
+		parts[i].coll_id = info->coll_ids[i];
+		parts[i].is_nullable = true;
+	}
+	struct key_def *key_def = key_def_new(parts, part_count, false);
+	region_truncate(region, svp);
+	if (key_def == NULL)
+		return NULL;
+	struct sql_hash_join *join = sql_xmalloc0(sizeof(*join));
+	join->key_def = key_def;
+	join->field_count = field_count;
+	join->types = xmalloc(field_count * sizeof(join->types[0]));
+	memcpy(join->types, info->types, field_count * sizeof(join->types[0]));
+	join->coll_ids = xmalloc(field_count * sizeof(join->coll_ids[0]));
+	memcpy(join->coll_ids, info->coll_ids,
+	       field_count * sizeof(join->coll_ids[0]));
+	join->bucket_count = SQL_HASH_JOIN_BUCKETS_MIN;
+	join->buckets = xcalloc(join->bucket_count, sizeof(join->buckets[0]));
+	join->used = join->bucket_count * sizeof(join->buckets[0]);
+	return join;
+}
+
+/** Free all rows stored in the hash table. */
+static void
+sql_hash_join_clear(struct sql_hash_join *join)
+{
+	for (uint32_t i = 0; i < join->bucket_count; i++) {
+		struct sql_hash_join_entry *entry = join->buckets[i];
+		while (entry != NULL) {
+			struct sql_hash_join_entry *next = entry->next;
+			free(entry);
+			entry = next;
+		}
+	}
+	free(join->buckets);
+	join->buckets = NULL;
+	join->bucket_count = 0;
+	join->entry_count = 0;
+	join->entry = NULL;
+}
+
+/** Forget the current row of the ephemeral space iterator. */
+static void
+sql_hash_join_reset_iterator(struct sql_hash_join *join)
+{
+	if (join->iter != NULL) {
+		iterator_delete(join->iter);
+		join->iter = NULL;
+	}
+	if (join->tuple != NULL) {
+		tuple_unref(join->tuple);
+		join->tuple = NULL;
+	}
+}
+
+void
+sql_hash_join_delete(struct sql_hash_join *join)
+{
+	sql_hash_join_reset_iterator(join);
+	if (join->space != NULL)
+		space_delete(join->space);
+	sql_hash_join_clear(join);
+	key_def_delete(join->key_def);
+	free(join->types);
+	free(join->coll_ids);
+	free(join->key);
+	sql_xfree(join);
+}
+
+/** Return the memory limit of the hash table. */
+static size_t
+sql_hash_join_memory_max(void)
+{
+	size_t limit = SQL_HASH_JOIN_MEMORY_MAX;
+	ERROR_INJECT_INT(ERRINJ_SQL_HASH_JOIN_MEMORY, inj->iparam >= 0,
+			 limit = inj->iparam);
+	return limit;
+}
+
+/**
+ * Insert a record into the ephemeral space. Rowid is appended to the
+ * record to make the primary key unique.
+ */
+static int
+sql_hash_join_spill_record(struct sql_hash_join *join, const char *data,
+			   uint32_t size)
+{
+	struct region *region = &fiber()->gc;
+	size_t svp = region_used(region);
+	const char *body = data;
+	uint32_t field_count = mp_decode_array(&body);
+	uint32_t body_size = size - (body - data);
+	char *tuple = xregion_alloc(region, mp_sizeof_array(field_count + 1) +
+				    body_size + mp_sizeof_uint(join->rowid));
+	char *tuple_end = mp_encode_array(tuple, field_count + 1);
+	memcpy(tuple_end, body, body_size);
+	tuple_end = mp_encode_uint(tuple_end + body_size, join->rowid++);
+	int rc = tarantoolsqlEphemeralInsert(join->space, tuple, tuple_end);
+	region_truncate(region, svp);
+	return rc;
+}
+
+/**
+ * Move all rows from the hash table to an ephemeral space indexed by
+ * the join key and rowid.
+ */
+static int
+sql_hash_join_spill(struct sql_hash_join *join)
+{
+	assert(join->space == NULL);
+	uint32_t part_count = join->key_def->part_count;
+	struct sql_space_info *info =
+		sql_space_info_new(join->field_count + 1, part_count + 1);
+	for (uint32_t i = 0; i < join->field_count; i++) {
+		info->types[i] = join->types[i];
+		info->coll_ids[i] = join->coll_ids[i];
+	}
+	info->types[join->field_count] = FIELD_TYPE_UNSIGNED;
+	info->parts[part_count] = join->field_count;
+	join->space = sql_ephemeral_space_new(info);
+	sql_xfree(info);
+	if (join->space == NULL)
+		return -1;
+	for (uint32_t i = 0; i < join->bucket_count; i++) {
+		struct sql_hash_join_entry *entry = join->buckets[i];
+		for (; entry != NULL; entry = entry->next) {
+			if (sql_hash_join_spill_record(join, entry->data,
+						       entry->size) != 0)
+				return -1;
+		}
+	}
+	sql_hash_join_clear(join);
+	join->used = 0;
+	return 0;
+}
+
+/** Double the number of hash table buckets. */
+static void
+sql_hash_join_grow(struct sql_hash_join *join)
+{
+	uint32_t bucket_count = join->bucket_count * 2;
+	struct sql_hash_join_entry **buckets =
+		xcalloc(bucket_count, sizeof(buckets[0]));
+	for (uint32_t i = 0; i < join->bucket_count; i++) {
+		struct sql_hash_join_entry *entry = join->buckets[i];
+		while (entry != NULL) {
+			struct sql_hash_join_entry *next = entry->next;
+			uint32_t j = entry->hash & (bucket_count - 1);
+			entry->next = buckets[j];
+			buckets[j] = entry;
+			entry = next;
+		}
+	}
+	free(join->buckets);
+	join->used += (bucket_count - join->bucket_count) * sizeof(buckets[0]);
+	join->buckets = buckets;
+	join->bucket_count = bucket_count;
+}
+
+int
+sql_hash_join_insert(struct sql_hash_join *join, const char *data,
+		     uint32_t size)
+{
+	assert(join->iter == NULL && join->entry == NULL);
+	const char *key = data;
+	mp_decode_array(&key);
+	/* NULL never matches anything in an equality join. */
+	const char *field = key;
+	for (uint32_t i = 0; i < join->key_def->part_count; i++) {
+		if (mp_typeof(*field) == MP_NIL)
+			return 0;
+		mp_next(&field);
+	}
+	if (join->space != NULL)
+		return sql_hash_join_spill_record(join, data, size);
+	struct sql_hash_join_entry *entry = xmalloc(sizeof(*entry) + size);
+	entry->hash = key_hash(key, join->key_def);
+	entry->size = size;
+	memcpy(entry->data, data, size);
+	uint32_t i = entry->hash & (join->bucket_count - 1);
+	entry->next = join->buckets[i];
+	join->buckets[i] = entry;
+	join->entry_count++;
+	join->used += sizeof(*entry) + size;
+	if (join->entry_count > join->bucket_count)
+		sql_hash_join_grow(join);
+	if (join->used > sql_hash_join_memory_max())
+		return sql_hash_join_spill(join);
+	return 0;
+}
+
+/**
+ * Starting from the given entry, find the first entry of its bucket
+ * whose key matches the current lookup key.
+ */
+static struct sql_hash_join_entry *
+sql_hash_join_find(struct sql_hash_join *join,
+		   struct sql_hash_join_entry *entry)
+{
+	uint32_t part_count = join->key_def->part_count;
+	for (; entry != NULL; entry = entry->next) {
+		if (entry->hash != join->key_hash)
+			continue;
+		const char *key = entry->data;
+		mp_decode_array(&key);
+		if (key_compare(key, part_count, HINT_NONE, join->key,
+				part_count, HINT_NONE, join->key_def) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+/** Advance the ephemeral space iterator. */
+static int
+sql_hash_join_iterator_next(struct sql_hash_join *join, bool *found)
+{
+	struct tuple *tuple;
+	if (iterator_next(join->iter, &tuple) != 0)
+		return -1;
+	if (join->tuple != NULL)
+		tuple_unref(join->tuple);
+	join->tuple = tuple;
+	if (tuple != NULL)
+		tuple_ref(tuple);
+	*found = tuple != NULL;
+	return 0;
+}
+
+int
+sql_hash_join_seek(struct sql_hash_join *join, struct Mem *key,
+		   uint32_t part_count, bool *found)
+{
+	assert(part_count == join->key_def->part_count);
+	struct region *region = &fiber()->gc;
+	size_t svp = region_used(region);
+	uint32_t size;
+	const char *data = mem_encode_array(key, part_count, &size, region);
+	const char *body = data;
+	mp_decode_array(&body);
+	size -= body - data;
+	if (size > join->key_capacity) {
+		free(join->key);
+		join->key = xmalloc(size);
+		join->key_capacity = size;
+	}
+	memcpy(join->key, body, size);
+	region_truncate(region, svp);
+	if (join->space != NULL) {
+		sql_hash_join_reset_iterator(join);
+		join->iter = index_create_iterator(join->space->index[0],
+						   ITER_EQ, join->key,
+						   part_count);
+		if (join->iter == NULL)
+			return -1;
+		return sql_hash_join_iterator_next(join, found);
+	}
+	join->key_hash = key_hash(join->key, join->key_def);
+	uint32_t i = join->key_hash & (join->bucket_count - 1);
+	join->entry = sql_hash_join_find(join, join->buckets[i]);
+	*found = join->entry != NULL;
+	return 0;
+}
+
+int
+sql_hash_join_next(struct sql_hash_join *join, bool *found)
+{
+	if (join->space != NULL) {
+		if (join->iter == NULL) {
+			*found = false;
+			return 0;
+		}
+		return sql_hash_join_iterator_next(join, found);
+	}
+	if (join->entry != NULL)
+		join->entry = sql_hash_join_find(join, join->entry->next);
+	*found = join->entry != NULL;
+	return 0;
+}
+
+const char *
+sql_hash_join_data(struct sql_hash_join *join, uint32_t *size)
+{
+	if (join->space != NULL) {
+		assert(join->tuple != NULL);
+		*size = tuple_bsize(join->tuple);
+		return tuple_data(join->tuple);
+	}
+	assert(join->entry != NULL);
+	*size = join->entry->size;
+	return join->entry->data;
+}
+
+enum field_type
+sql_hash_join_field_type(struct sql_hash_join *join, uint32_t fieldno)
+{
+	assert(fieldno < join->field_count);
+	return join->types[fieldno];
+}
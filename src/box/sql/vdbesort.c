@@ -44,6 +44,10 @@
  *
  *    sqlVdbeSorterInit()       Create a new VdbeSorter object.
  *
+ *    sqlVdbeSorterLimit()      Tell the sorter that only the first N
+ *                                  sorted rows are needed. Called before
+ *                                  Write().
+ *
  *    sqlVdbeSorterWrite()      Add a single new row to the VdbeSorter
  *                                  object.  The row is a binary blob in the
  *                                  OP_MakeRecord format that contains both
@@ -150,10 +154,29 @@
  * one background thread for each temporary file on disk, and one background
  * thread to merge the output of each of the others to a single PMA for
  * the main thread to read from.
+ *
+ * Top-N sorting:
+ *
+ * If Limit() is called before the first Write() with N not greater than
+ * SQL_SORTER_TOPN_MAX, the records are kept in a max-heap of at most N
+ * records instead of the in-memory list. Once the heap is full, a new
+ * record either replaces the greatest record of the heap or, if it is not
+ * less than that record, is dropped. So the memory used by the sorter is
+ * bounded by N records and no PMA is ever written. Of the records with
+ * equal keys, the ones written first are kept. When Rewind() is called,
+ * the heap is drained into the in-memory list in sorted order.
  */
 #include "sqlInt.h"
 #include "mem.h"
 #include "vdbeInt.h"
+#include "msgpuck/msgpuck.h"
+#include "box/txn.h"
+#include "box/memtx_engine.h"
+#include "coio_task.h"
+#include "fiber.h"
+#include "tt_sort.h"
+#define HEAP_FORWARD_DECLARATION
+#include "salad/heap.h"
 
 /*
  * Hard-coded maximum amount of data to accumulate in memory before flushing
@@ -173,6 +196,7 @@ typedef struct SortSubtask SortSubtask;	/* A sub-task in the sort process */
 typedef struct SorterFile SorterFile;	/* Temporary file object wrapper */
 typedef struct SorterList SorterList;	/* In-memory list of records */
 typedef struct IncrMerger IncrMerger;	/* Read & merge multiple PMAs */
+typedef struct SorterTopNEntry SorterTopNEntry;	/* A record in the heap */
 
 /*
  * A container for a temp file handle and the current amount of data
@@ -273,9 +297,13 @@ struct MergeEngine {
  * Exactly VdbeSorter.nTask instances of this object are allocated
  * as part of each VdbeSorter object. Instances are never allocated any
  * other way. VdbeSorter.nTask is set to the number of worker threads allowed
- * (see SQL_CONFIG_WORKER_THREADS) plus one (the main thread).  Thus for
- * single-threaded operation, there is exactly one instance of this object
- * and for multi-threaded operation there are two or more instances.
+ * (see box.cfg.memtx_sort_threads, at most SORTER_MAX_WORKERS) plus one (the
+ * main thread).  Thus for single-threaded operation, there is exactly one
+ * instance of this object and for multi-threaded operation there are two or
+ * more instances.
+ *
+ * A worker thread is a coio thread. The main thread starts a fiber that
+ * yields until the worker thread is done, see vdbeSorterCreateThread().
  *
  * Essentially, this structure contains all those fields of the VdbeSorter
  * structure for which each thread requires a separate instance. For example,
@@ -288,10 +316,12 @@ struct SortSubtask {
 	VdbeSorter *pSorter;	/* Sorter that owns this sub-task */
 	UnpackedRecord *pUnpacked;	/* Space to unpack a record */
 	SorterList list;	/* List for thread to write to a PMA */
+	int nMemory;		/* Size of list.aMemory allocation in bytes */
 	int nPMA;		/* Number of PMAs currently in file */
 	SorterCompare xCompare;	/* Compare function to use */
 	SorterFile file;	/* Temp file for level-0 PMAs */
 	SorterFile file2;	/* Space for other PMAs */
+	struct fiber *pThread;	/* Fiber waiting for the worker thread */
 };
 
 /*
@@ -316,7 +346,13 @@ struct VdbeSorter {
 	int iMemory;		/* Offset of free space in list.aMemory */
 	int nMemory;		/* Size of list.aMemory allocation in bytes */
 	u8 bUsePMA;		/* True if one or more PMAs created */
-	SortSubtask aTask;	/* A single subtask */
+	u8 iPrev;		/* Previous thread used to flush PMA */
+	int nSortThread;	/* Number of threads to sort a list in */
+	int nTopN;		/* Max records in topN, 0 if not a top-N sort */
+	i64 nWrite;		/* Records written since Init() or Reset() */
+	heap_t topN;		/* Max-heap of records of a top-N sort */
+	int nTask;		/* Size of aTask[] array */
+	SortSubtask aTask[1];	/* One or more subtasks */
 };
 
 /*
@@ -436,9 +472,31 @@ struct SorterRecord {
  */
 #define SRVAL(p) ((void*)((SorterRecord*)(p) + 1))
 
+/*
+ * A record kept in the heap of a top-N sorter. The data for the record
+ * immediately follows this header, see TOPNVAL().
+ */
+struct SorterTopNEntry {
+	struct heap_node in_topN;	/* Link in VdbeSorter.topN */
+	i64 iSeq;		/* Number of records written before this one */
+	int nVal;		/* Size of the record in bytes */
+};
+
+#define TOPNVAL(p) ((void*)((SorterTopNEntry*)(p) + 1))
+
 /* Maximum number of PMAs that a single MergeEngine can merge */
 #define SORTER_MAX_MERGE_COUNT 16
 
+/* Maximum number of worker threads used by a single sorter */
+#define SORTER_MAX_WORKERS 8
+
+/*
+ * Minimum number of records in an in-memory list to sort it with tt_sort()
+ * in multiple threads. Smaller lists are sorted faster than the threads are
+ * started.
+ */
+#define SORTER_PARALLEL_SORT_MIN 16384
+
 static int vdbeIncrSwap(IncrMerger *);
 static void vdbeIncrFree(IncrMerger *);
 
@@ -775,22 +833,84 @@ vdbeSorterCompare(struct SortSubtask *task, bool *key2_cached,
 	return sqlVdbeRecordCompareMsgpack(key1, r2);
 }
 
+/*
+ * Return true if record a is closer to the top of the heap of a top-N
+ * sorter than record b, i.e. it is either greater than b or equal to b
+ * and written after it.
+ */
+static bool
+vdbeSorterTopNLess(struct heap_core_structure *pHeap, SorterTopNEntry *a,
+		   SorterTopNEntry *b)
+{
+	VdbeSorter *pSorter = container_of(pHeap, VdbeSorter, topN);
+	bool bCached = false;
+	int c = vdbeSorterCompare(&pSorter->aTask[0], &bCached, TOPNVAL(a),
+				  TOPNVAL(b));
+	return c > 0 || (c == 0 && a->iSeq > b->iSeq);
+}
+
+#define HEAP_NAME vdbe_sorter_topn
+#define HEAP_LESS(h, a, b) vdbeSorterTopNLess(h, a, b)
+#define heap_value_t SorterTopNEntry
+#define heap_value_attr in_topN
+#include "salad/heap.h"
+
+/*
+ * Return the number of threads the sorter may use. It is the same as the
+ * number of threads used to sort memtx secondary keys on recovery.
+ */
+static int
+vdbeSorterThreadCount(void)
+{
+	struct memtx_engine *memtx =
+		(struct memtx_engine *)engine_by_name("memtx");
+	if (memtx == NULL)
+		return 1;
+	return MAX(memtx->sort_threads, 1);
+}
+
+/*
+ * Return true if the main thread may wait for worker threads. It waits by
+ * yielding the current fiber, which is only allowed in a transaction that
+ * may yield (for example, not in a memtx transaction without MVCC). A
+ * statement executed outside of a transaction doesn't yield, because
+ * concurrent changes would then be visible to it.
+ */
+static bool
+vdbeSorterCanYield(void)
+{
+	if (!cord_is_main())
+		return false;
+	struct txn *txn = in_txn();
+	return txn != NULL && txn_has_flag(txn, TXN_CAN_YIELD);
+}
+
 int
 sqlVdbeSorterInit(struct VdbeCursor *pCsr)
 {
 	int pgsz;		/* Page size of main database */
 	VdbeSorter *pSorter;	/* The new sorter */
 	int rc = 0;
+	int nWorker;		/* Number of worker threads */
+	int i;
 
 	assert(pCsr->key_def != NULL);
 	assert(pCsr->eCurType == CURTYPE_SORTER);
 
-	pSorter = sql_xmalloc0(sizeof(VdbeSorter));
+	int nSortThread = vdbeSorterThreadCount();
+	nWorker = nSortThread > 1 ? MIN(nSortThread, SORTER_MAX_WORKERS) : 0;
+	pSorter = sql_xmalloc0(sizeof(VdbeSorter) +
+			       nWorker * sizeof(SortSubtask));
 	pCsr->uc.pSorter = pSorter;
 
 	pSorter->key_def = pCsr->key_def;
 	pSorter->pgsz = pgsz = 1024;
-	pSorter->aTask.pSorter = pSorter;
+	pSorter->nSortThread = nSortThread;
+	vdbe_sorter_topn_create(&pSorter->topN);
+	pSorter->nTask = nWorker + 1;
+	pSorter->iPrev = (u8)(nWorker - 1);
+	for (i = 0; i < pSorter->nTask; i++)
+		pSorter->aTask[i].pSorter = pSorter;
 
 	/* Cache size in bytes */
 	i64 mxCache;
@@ -829,10 +949,13 @@ vdbeSorterRecordFree(struct SorterRecord *pRecord)
 static void
 vdbeSortSubtaskCleanup(struct SortSubtask *pTask)
 {
+	assert(pTask->pThread == NULL);
 	sql_xfree(pTask->pUnpacked);
 
-	assert(pTask->list.aMemory == 0);
-	vdbeSorterRecordFree(pTask->list.pList);
+	if (pTask->list.aMemory != NULL)
+		free(pTask->list.aMemory);
+	else
+		vdbeSorterRecordFree(pTask->list.pList);
 
 	if (pTask->file.pFd) {
 		sqlOsCloseFree(pTask->file.pFd);
@@ -843,7 +966,72 @@ vdbeSortSubtaskCleanup(struct SortSubtask *pTask)
 	memset(pTask, 0, sizeof(SortSubtask));
 }
 
-#define vdbeSorterJoinAll(x,rcin) (rcin)
+/* A routine run by a worker thread, see coio_call() */
+typedef ssize_t (*SorterThreadTask) (va_list);
+
+/*
+ * The main function of a fiber started by vdbeSorterCreateThread(). It
+ * runs the task on a worker thread and yields until the task is done.
+ */
+static int
+vdbeSorterThreadMain(va_list ap)
+{
+	SorterThreadTask xTask = va_arg(ap, SorterThreadTask);
+	void *pIn = va_arg(ap, void *);
+	return coio_call(xTask, pIn) == 0 ? 0 : -1;
+}
+
+/*
+ * Launch a worker thread to run xTask(pIn). The thread may be waited for
+ * with vdbeSorterJoinThread(). Return 0 if successful, or -1 otherwise.
+ */
+static int
+vdbeSorterCreateThread(SortSubtask * pTask,	/* Thread will use this task object */
+		       SorterThreadTask xTask,	/* Routine to run in a separate thread */
+		       void *pIn	/* Argument passed into xTask() */
+    )
+{
+	assert(pTask->pThread == NULL);
+	struct fiber *f = fiber_new("sql.sorter", vdbeSorterThreadMain);
+	if (f == NULL)
+		return -1;
+	fiber_set_joinable(f, true);
+	pTask->pThread = f;
+	fiber_start(f, xTask, pIn);
+	return 0;
+}
+
+/*
+ * Wait for the worker thread of the task, if any, to finish. Return the
+ * result of the thread: 0 if successful, or -1 otherwise.
+ */
+static int
+vdbeSorterJoinThread(SortSubtask * pTask)
+{
+	int rc = 0;
+	if (pTask->pThread != NULL) {
+		rc = fiber_join(pTask->pThread);
+		pTask->pThread = NULL;
+	}
+	return rc;
+}
+
+/*
+ * Join all worker threads. If rcin is 0, return the first error reported
+ * by a thread, if any. Otherwise, return rcin.
+ */
+static int
+vdbeSorterJoinAll(VdbeSorter * pSorter, int rcin)
+{
+	int rc = rcin;
+	int i;
+	for (i = pSorter->nTask - 1; i >= 0; i--) {
+		int rc2 = vdbeSorterJoinThread(&pSorter->aTask[i]);
+		if (rc == 0)
+			rc = rc2;
+	}
+	return rc;
+}
 
 /*
  * Allocate a new MergeEngine object capable of handling up to
@@ -896,6 +1084,13 @@ static void
 vdbeIncrFree(IncrMerger * pIncr)
 {
 	if (pIncr) {
+		if (pIncr->bUseThread) {
+			(void)vdbeSorterJoinThread(pIncr->pTask);
+			if (pIncr->aFile[0].pFd)
+				sqlOsCloseFree(pIncr->aFile[0].pFd);
+			if (pIncr->aFile[1].pFd)
+				sqlOsCloseFree(pIncr->aFile[1].pFd);
+		}
 		vdbeMergeEngineFree(pIncr->pMerger);
 		free(pIncr);
 	}
@@ -908,8 +1103,11 @@ sqlVdbeSorterReset(struct VdbeSorter *pSorter)
 	assert(pSorter->pReader == 0);
 	vdbeMergeEngineFree(pSorter->pMerger);
 	pSorter->pMerger = 0;
-	vdbeSortSubtaskCleanup(&pSorter->aTask);
-	pSorter->aTask.pSorter = pSorter;
+	for (int i = 0; i < pSorter->nTask; i++) {
+		SortSubtask *pTask = &pSorter->aTask[i];
+		vdbeSortSubtaskCleanup(pTask);
+		pTask->pSorter = pSorter;
+	}
 	if (pSorter->list.aMemory == 0)
 		vdbeSorterRecordFree(pSorter->list.pList);
 	pSorter->list.pList = 0;
@@ -917,6 +1115,11 @@ sqlVdbeSorterReset(struct VdbeSorter *pSorter)
 	pSorter->bUsePMA = 0;
 	pSorter->iMemory = 0;
 	pSorter->mxKeysize = 0;
+	SorterTopNEntry *pEntry;
+	while ((pEntry = vdbe_sorter_topn_pop(&pSorter->topN)) != NULL)
+		free(pEntry);
+	pSorter->nTopN = 0;
+	pSorter->nWrite = 0;
 	sql_xfree(pSorter->pUnpacked);
 	pSorter->pUnpacked = 0;
 }
@@ -929,6 +1132,7 @@ sqlVdbeSorterClose(struct VdbeCursor *pCsr)
 	pSorter = pCsr->uc.pSorter;
 	if (pSorter) {
 		sqlVdbeSorterReset(pSorter);
+		vdbe_sorter_topn_destroy(&pSorter->topN);
 		free(pSorter->list.aMemory);
 		sql_xfree(pSorter);
 		pCsr->uc.pSorter = 0;
@@ -1055,10 +1259,97 @@ vdbeSorterGetCompare(VdbeSorter * p)
 	return vdbeSorterCompare;
 }
 
+/*
+ * Return the record following p in the unsorted list pList.
+ */
+static SorterRecord *
+vdbeSorterListNext(SorterList * pList, SorterRecord * p)
+{
+	if (pList->aMemory == NULL)
+		return p->u.pNext;
+	if ((u8 *) p == pList->aMemory)
+		return NULL;
+	return (SorterRecord *) & pList->aMemory[p->u.iNext];
+}
+
+/*
+ * An element of the array sorted by vdbeSorterSortParallel().
+ */
+struct SorterEntry {
+	SorterRecord *pRecord;	/* Record to sort */
+	int iSeq;		/* Number of the record in order of insertion */
+};
+
+/*
+ * Compare the records of two SorterEntry objects. Unlike
+ * vdbeSorterCompare(), it keeps no state between calls, so it can be
+ * called from several threads at once. Records with equal keys are
+ * ordered the same way as vdbeSorterMerge() orders them: the record that
+ * was inserted first goes first.
+ */
+static int
+vdbeSorterEntryCompare(const void *a, const void *b, void *arg)
+{
+	const struct SorterEntry *e1 = a;
+	const struct SorterEntry *e2 = b;
+	struct key_def *key_def = arg;
+	const char *key1 = SRVAL(e1->pRecord);
+	const char *key2 = SRVAL(e2->pRecord);
+	uint32_t n1 = mp_decode_array(&key1);
+	uint32_t n2 = mp_decode_array(&key2);
+	uint32_t n = MIN(MIN(n1, n2), key_def->part_count);
+	for (uint32_t i = 0; i < n; i++) {
+		struct key_part *part = &key_def->parts[i];
+		struct Mem mem;
+		uint32_t len = 0;
+		int rc = 0;
+		mem_create(&mem);
+		mem_from_mp_ephemeral(&mem, key2, &len);
+		key2 += len;
+		if (mem_cmp_msgpack(&mem, &key1, &rc, part->coll) != 0)
+			rc = 0;
+		if (rc != 0)
+			return part->sort_order != SORT_ORDER_ASC ? rc : -rc;
+	}
+	if (e1->iSeq == e2->iSeq)
+		return 0;
+	return e1->iSeq < e2->iSeq ? -1 : 1;
+}
+
+/*
+ * Sort nRecord records of the list pList with tt_sort() in several threads.
+ * The current fiber yields until the threads are done.
+ */
+static void
+vdbeSorterSortParallel(SortSubtask * pTask, SorterList * pList, int nRecord)
+{
+	struct SorterEntry *aEntry = xmalloc(nRecord * sizeof(*aEntry));
+	SorterRecord *p = pList->pList;
+	int i;
+	/* The list starts with the record that was inserted last. */
+	for (i = nRecord - 1; i >= 0; i--) {
+		assert(p != NULL);
+		aEntry[i].pRecord = p;
+		aEntry[i].iSeq = i;
+		p = vdbeSorterListNext(pList, p);
+	}
+	assert(p == NULL);
+	tt_sort(aEntry, nRecord, sizeof(*aEntry), vdbeSorterEntryCompare,
+		pTask->pSorter->key_def, pTask->pSorter->nSortThread);
+	for (i = 0; i < nRecord - 1; i++)
+		aEntry[i].pRecord->u.pNext = aEntry[i + 1].pRecord;
+	aEntry[nRecord - 1].pRecord->u.pNext = NULL;
+	pList->pList = aEntry[0].pRecord;
+	free(aEntry);
+}
+
 /*
  * Sort the linked list of records headed at pTask->pList. Return
  * 0 if successful, or an sql error code (i.e. -1) if
  * an error occurs.
+ *
+ * A large list is sorted in several threads if the main thread is allowed
+ * to wait for them.
  */
 static int
 vdbeSorterSort(SortSubtask * pTask, SorterList * pList)
@@ -1075,21 +1366,21 @@ vdbeSorterSort(SortSubtask * pTask, SorterList * pList)
 	p = pList->pList;
 	pTask->xCompare = vdbeSorterGetCompare(pTask->pSorter);
 
+	if (pTask->pSorter->nSortThread > 1 && vdbeSorterCanYield()) {
+		int nRecord = 0;
+		for (; p != NULL; p = vdbeSorterListNext(pList, p))
+			nRecord++;
+		if (nRecord >= SORTER_PARALLEL_SORT_MIN) {
+			vdbeSorterSortParallel(pTask, pList, nRecord);
+			return 0;
+		}
+		p = pList->pList;
+	}
+
 	aSlot = xcalloc(64, sizeof(SorterRecord *));
 
 	while (p) {
-		SorterRecord *pNext;
-		if (pList->aMemory) {
-			if ((u8 *) p == pList->aMemory) {
-				pNext = 0;
-			} else {
-				pNext =
-				    (SorterRecord *) & pList->aMemory[p->u.
-								      iNext];
-			}
-		} else {
-			pNext = p->u.pNext;
-		}
+		SorterRecord *pNext = vdbeSorterListNext(pList, p);
 
 		p->u.pNext = 0;
 		for (i = 0; aSlot[i]; i++) {
@@ -1357,6 +1648,16 @@ vdbeMergeEngineStep(MergeEngine * pMerger,	/* The merge engine to advance to the
 	return rc;
 }
 
+/*
+ * The main routine for background threads that write level-0 PMAs.
+ */
+static ssize_t
+vdbeSorterFlushThread(va_list ap)
+{
+	SortSubtask *pTask = va_arg(ap, SortSubtask *);
+	return vdbeSorterListToPMA(pTask, &pTask->list);
+}
+
 /*
  * Flush the current contents of VdbeSorter.list to a new PMA, possibly
  * using a background thread.
@@ -1364,8 +1665,144 @@ vdbeMergeEngineStep(MergeEngine * pMerger,	/* The merge engine to advance to the
 static int
 vdbeSorterFlushPMA(VdbeSorter * pSorter)
 {
+	int rc = 0;
+	int i;
+	SortSubtask *pTask = 0;	/* Thread context used to create new PMA */
+	int nWorker = (pSorter->nTask - 1);
+
 	pSorter->bUsePMA = 1;
-	return vdbeSorterListToPMA(&pSorter->aTask, &pSorter->list);
+
+	/* Select a sub-task to sort and flush the current list of in-memory
+	 * records to disk. If the sorter is running in multi-threaded mode,
+	 * round-robin between the first (pSorter->nTask-1) tasks. Except, if
+	 * the background thread from a sub-tasks previous turn is still running,
+	 * skip it. If the first (pSorter->nTask-1) sub-tasks are all still busy
+	 * or the main thread may not wait for them, fall back to using the final
+	 * sub-task. The first (pSorter->nTask-1) sub-tasks are only ever used by
+	 * background threads.
+	 */
+	if (!vdbeSorterCanYield())
+		nWorker = 0;
+	for (i = 0; i < nWorker; i++) {
+		int iTest = (pSorter->iPrev + i + 1) % nWorker;
+		pTask = &pSorter->aTask[iTest];
+		if (pTask->pThread != NULL && fiber_is_dead(pTask->pThread))
+			rc = vdbeSorterJoinThread(pTask);
+		if (rc != 0 || pTask->pThread == NULL)
+			break;
+	}
+	if (rc != 0)
+		return rc;
+
+	if (i == nWorker) {
+		/* Use the foreground thread for this operation */
+		return vdbeSorterListToPMA(&pSorter->aTask[pSorter->nTask - 1],
+					   &pSorter->list);
+	}
+
+	/* Launch a background thread for this operation. The temp file and
+	 * the unpacked record are allocated here, because the routines that
+	 * allocate them are not thread-safe.
+	 */
+	u8 *aMem = pTask->list.aMemory;
+	int nMem = pTask->nMemory;
+	assert(pTask->pThread == NULL);
+	assert(pTask->list.pList == NULL);
+	if (pTask->file.pFd == NULL) {
+		rc = vdbeSorterOpenTempFile(0, &pTask->file.pFd);
+		if (rc != 0)
+			return rc;
+	}
+	rc = vdbeSortAllocUnpacked(pTask);
+	if (rc != 0)
+		return rc;
+	pSorter->iPrev = (u8)(pTask - pSorter->aTask);
+	pTask->list = pSorter->list;
+	pTask->nMemory = pSorter->nMemory;
+	pSorter->list.pList = NULL;
+	pSorter->list.szPMA = 0;
+	if (aMem != NULL) {
+		pSorter->list.aMemory = aMem;
+		pSorter->nMemory = nMem;
+	} else {
+		pSorter->list.aMemory = xmalloc(pSorter->nMemory);
+	}
+	return vdbeSorterCreateThread(pTask, vdbeSorterFlushThread, pTask);
+}
+
+void
+sqlVdbeSorterLimit(const VdbeCursor *pCsr, i64 nLimit)
+{
+	assert(pCsr->eCurType == CURTYPE_SORTER);
+	VdbeSorter *pSorter = pCsr->uc.pSorter;
+	if (pSorter->nWrite > 0 || nLimit <= 0 || nLimit > SQL_SORTER_TOPN_MAX)
+		return;
+	pSorter->nTopN = nLimit;
+	vdbeSortAllocUnpacked(&pSorter->aTask[0]);
+}
+
+/*
+ * Add a record to the heap of a top-N sorter. If the heap is full, the
+ * record replaces the greatest record of the heap if it is less than
+ * that record, and it is dropped otherwise.
+ */
+static int
+vdbeSorterTopNWrite(VdbeSorter *pSorter, Mem *pVal)
+{
+	SorterTopNEntry *pTop = vdbe_sorter_topn_top(&pSorter->topN);
+	if ((int)pSorter->topN.size == pSorter->nTopN) {
+		bool bCached = false;
+		if (vdbeSorterCompare(&pSorter->aTask[0], &bCached, pVal->z,
+				      TOPNVAL(pTop)) >= 0)
+			return 0;
+		vdbe_sorter_topn_delete(&pSorter->topN, pTop);
+		free(pTop);
+	}
+	SorterTopNEntry *pNew = xmalloc(sizeof(*pNew) + pVal->n);
+	memcpy(TOPNVAL(pNew), pVal->z, pVal->n);
+	pNew->nVal = pVal->n;
+	pNew->iSeq = pSorter->nWrite - 1;
+	if (vdbe_sorter_topn_insert(&pSorter->topN, pNew) != 0) {
+		free(pNew);
+		diag_set(OutOfMemory, 0, "realloc", "topN");
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Move the records of a top-N sorter from the heap to the in-memory list
+ * in sorted order. The records are copied to the list.aMemory buffer and
+ * linked with SorterRecord.u.pNext, as if the list was sorted by
+ * vdbeSorterSort().
+ */
+static void
+vdbeSorterTopNToList(VdbeSorter *pSorter)
+{
+	assert(pSorter->list.pList == NULL && pSorter->list.aMemory != NULL);
+	int nByte = 0;
+	struct heap_iterator it;
+	vdbe_sorter_topn_iterator_init(&pSorter->topN, &it);
+	SorterTopNEntry *pEntry;
+	while ((pEntry = vdbe_sorter_topn_iterator_next(&it)) != NULL)
+		nByte += ROUND8(sizeof(SorterRecord) + pEntry->nVal);
+	if (nByte > pSorter->nMemory) {
+		free(pSorter->list.aMemory);
+		pSorter->list.aMemory = xmalloc(nByte);
+		pSorter->nMemory = nByte;
+	}
+	/* The greatest record is popped first, so it ends up last. */
+	int iOff = 0;
+	while ((pEntry = vdbe_sorter_topn_pop(&pSorter->topN)) != NULL) {
+		SorterRecord *pRecord =
+			(SorterRecord *)&pSorter->list.aMemory[iOff];
+		iOff += ROUND8(sizeof(SorterRecord) + pEntry->nVal);
+		memcpy(SRVAL(pRecord), TOPNVAL(pEntry), pEntry->nVal);
+		pRecord->nVal = pEntry->nVal;
+		pRecord->u.pNext = pSorter->list.pList;
+		pSorter->list.pList = pRecord;
+		free(pEntry);
+	}
 }
 
 /*
@@ -1387,6 +1824,10 @@ sqlVdbeSorterWrite(const VdbeCursor * pCsr,	/* Sorter cursor */
 	pSorter = pCsr->uc.pSorter;
 	assert(pSorter);
 
+	pSorter->nWrite++;
+	if (pSorter->nTopN > 0)
+		return vdbeSorterTopNWrite(pSorter, pVal);
+
 	/* Figure out whether or not the current contents of memory should be
 	 * flushed to a PMA before continuing. If so, do so.
 	 *
@@ -1510,6 +1951,36 @@ vdbeIncrPopulate(IncrMerger * pIncr)
 	return rc;
 }
 
+static int vdbeMergeEngineInit(SortSubtask *, MergeEngine *);
+
+/*
+ * The main routine for background threads that populate aFile[1] of
+ * multi-threaded IncrMerger objects. The first call also initializes the
+ * MergeEngine of the IncrMerger, so that the first keys of the PMAs are
+ * read by the background thread as well.
+ */
+static ssize_t
+vdbeIncrPopulateThread(va_list ap)
+{
+	IncrMerger *pIncr = va_arg(ap, IncrMerger *);
+	int rc = 0;
+	if (pIncr->pMerger->pTask == NULL)
+		rc = vdbeMergeEngineInit(pIncr->pTask, pIncr->pMerger);
+	if (rc == 0)
+		rc = vdbeIncrPopulate(pIncr);
+	return rc;
+}
+
+/*
+ * Launch a background thread to populate aFile[1] of pIncr.
+ */
+static int
+vdbeIncrBgPopulate(IncrMerger * pIncr)
+{
+	return vdbeSorterCreateThread(pIncr->pTask, vdbeIncrPopulateThread,
+				      pIncr);
+}
+
 /*
  * This function is called when the PmaReader corresponding to pIncr has
  * finished reading the contents of aFile[0]. Its purpose is to "refill"
@@ -1530,10 +2001,25 @@ vdbeIncrPopulate(IncrMerger * pIncr)
 static int
 vdbeIncrSwap(IncrMerger * pIncr)
 {
-	int rc = vdbeIncrPopulate(pIncr);
-	pIncr->aFile[0] = pIncr->aFile[1];
-	if (pIncr->aFile[0].iEof == pIncr->iStartOff) {
-		pIncr->bEof = 1;
+	int rc = 0;
+
+	if (pIncr->bUseThread) {
+		rc = vdbeSorterJoinThread(pIncr->pTask);
+		if (rc == 0) {
+			SorterFile f0 = pIncr->aFile[0];
+			pIncr->aFile[0] = pIncr->aFile[1];
+			pIncr->aFile[1] = f0;
+			if (pIncr->aFile[0].iEof == pIncr->iStartOff)
+				pIncr->bEof = 1;
+			else
+				rc = vdbeIncrBgPopulate(pIncr);
+		}
+	} else {
+		rc = vdbeIncrPopulate(pIncr);
+		pIncr->aFile[0] = pIncr->aFile[1];
+		if (pIncr->aFile[0].iEof == pIncr->iStartOff) {
+			pIncr->bEof = 1;
+		}
 	}
 
 	return rc;
@@ -1562,6 +2048,17 @@ vdbeIncrMergerNew(SortSubtask * pTask,	/* The thread that will be using the new
 	return rc;
 }
 
+/*
+ * Set the "use-threads" flag on object pIncr. A multi-threaded IncrMerger
+ * uses two temp files of its own instead of a region of pTask->file2.
+ */
+static void
+vdbeIncrMergerSetThreads(IncrMerger * pIncr)
+{
+	pIncr->bUseThread = 1;
+	pIncr->pTask->file2.iEof -= pIncr->mxSz;
+}
+
 /*
  * Recompute pMerger->aTree[iOut] by comparing the next keys on the
  * two PmaReaders that feed that entry.  Neither of the PmaReaders
@@ -1650,12 +2147,42 @@ vdbeMergeEngineInit(SortSubtask * pTask,	/* Thread that will run pMerger */
 			return rc;
 	}
 
+	/* The PmaReaders of multi-threaded IncrMerger objects are pointed to
+	 * their first keys only after all the background threads are launched
+	 * by the loop above, so that the threads run in parallel.
+	 */
+	for (i = 0; i < nTree; i++) {
+		PmaReader *pReadr = &pMerger->aReadr[i];
+		if (pReadr->pIncr == NULL || !pReadr->pIncr->bUseThread)
+			continue;
+		rc = vdbePmaReaderNext(pReadr);
+		if (rc != 0)
+			return rc;
+	}
+
 	for (i = pMerger->nTree - 1; i > 0; i--) {
 		vdbeMergeEngineCompare(pMerger, i);
 	}
 	return 0;
 }
 
+/*
+ * Open pTask->file2, unless it is already open. The file is shared by all
+ * single-threaded IncrMerger objects of the task.
+ */
+static int
+vdbeSorterOpenFile2(SortSubtask * pTask)
+{
+	int rc = 0;
+	if (pTask->file2.pFd == 0) {
+		assert(pTask->file2.iEof > 0);
+		rc = vdbeSorterOpenTempFile(pTask->file2.iEof,
+					    &pTask->file2.pFd);
+		pTask->file2.iEof = 0;
+	}
+	return rc;
+}
+
 /*
  * The PmaReader is guaranteed to be an
  * incremental-reader (pReadr->pIncr!=0). This function serves to open
@@ -1667,6 +2194,11 @@ vdbeMergeEngineInit(SortSubtask * pTask,	/* Thread that will run pMerger */
  * loaded into the buffers belonging to pReadr and it is set to point to
  * the first key in its range.
  *
+ * If the IncrMerger is multi-threaded, this function only opens the temp
+ * files and launches a background thread to initialize the sub-tree and
+ * populate aFile[1]. The caller then points pReadr to the first key with
+ * vdbePmaReaderNext(), which waits for the thread.
+ *
  * 0 is returned if successful, or an sql error code otherwise.
  */
 static int
@@ -1676,20 +2208,30 @@ vdbePmaReaderIncrMergeInit(PmaReader * pReadr)
 	IncrMerger *pIncr = pReadr->pIncr;
 	SortSubtask *pTask = pIncr->pTask;
 
-	rc = vdbeMergeEngineInit(pTask, pIncr->pMerger);
-
 	/* Set up the required files for pIncr. A multi-theaded IncrMerge object
 	 * requires two temp files to itself, whereas a single-threaded object
-	 * only requires a region of pTask->file2.
+	 * only requires a region of pTask->file2. All the files are opened by
+	 * the main thread, because opening a temp file is not thread-safe.
 	 */
-	if (rc == 0) {
+	if (pIncr->bUseThread) {
 		int mxSz = pIncr->mxSz;
-		if (pTask->file2.pFd == 0) {
-			assert(pTask->file2.iEof > 0);
-			rc = vdbeSorterOpenTempFile(pTask->file2.iEof,
-						    &pTask->file2.pFd);
-			pTask->file2.iEof = 0;
+		rc = vdbeSorterOpenTempFile(mxSz, &pIncr->aFile[0].pFd);
+		if (rc == 0) {
+			rc = vdbeSorterOpenTempFile(mxSz,
+						    &pIncr->aFile[1].pFd);
 		}
+		if (rc == 0 && pTask->file2.iEof > 0)
+			rc = vdbeSorterOpenFile2(pTask);
+		if (rc == 0)
+			rc = vdbeIncrBgPopulate(pIncr);
+		return rc;
+	}
+
+	rc = vdbeMergeEngineInit(pTask, pIncr->pMerger);
+
+	if (rc == 0) {
+		int mxSz = pIncr->mxSz;
+		rc = vdbeSorterOpenFile2(pTask);
 		if (rc == 0) {
 			pIncr->aFile[1].pFd = pTask->file2.pFd;
 			pIncr->iStartOff = pTask->file2.iEof;
@@ -1711,8 +2253,8 @@ vdbePmaReaderIncrMergeInit(PmaReader * pReadr)
  * this routine to initialize the incremental merge.
  *
  * If the IncrMerger object is multi-threaded (IncrMerger.bUseThread==1),
- * then a background thread is launched to call vdbePmaReaderIncrMergeInit().
- * Or, if the IncrMerger is single threaded, the same function is called
+ * then vdbePmaReaderIncrMergeInit() launches a background thread to do the
+ * actual work. Or, if the IncrMerger is single threaded, the work is done
  * using the current thread.
  */
 static int
@@ -1866,14 +2408,24 @@ vdbeSorterMergeTreeBuild(VdbeSorter * pSorter,	/* The VDBE cursor that implement
 {
 	MergeEngine *pMain = 0;
 	int rc = 0;
+	int iTask;
+
+	/* If the sorter uses more than one task, then create the top-level
+	 * MergeEngine here. This MergeEngine will read data from exactly
+	 * one PmaReader per sub-task.
+	 */
+	if (pSorter->nTask > 1)
+		pMain = vdbeMergeEngineNew(pSorter->nTask);
 
-	SortSubtask *pTask = &pSorter->aTask;
-	assert(pTask->nPMA > 0);
-	if (pTask->nPMA) {
+	for (iTask = 0; rc == 0 && iTask < pSorter->nTask; iTask++) {
+		SortSubtask *pTask = &pSorter->aTask[iTask];
 		MergeEngine *pRoot = 0;	/* Root node of tree for this task */
-		int nDepth = vdbeSorterTreeDepth(pTask->nPMA);
+		int nDepth;
 		i64 iReadOff = 0;
 
+		if (pTask->nPMA == 0)
+			continue;
+		nDepth = vdbeSorterTreeDepth(pTask->nPMA);
 		if (pTask->nPMA <= SORTER_MAX_MERGE_COUNT) {
 			rc = vdbeMergeEngineLevel0(pTask, pTask->nPMA,
 						   &iReadOff, &pRoot);
@@ -1907,8 +2459,13 @@ vdbeSorterMergeTreeBuild(VdbeSorter * pSorter,	/* The VDBE cursor that implement
 		}
 
 		if (rc == 0) {
-			assert(pMain == 0);
-			pMain = pRoot;
+			if (pMain != 0) {
+				PmaReader *pReadr = &pMain->aReadr[iTask];
+				rc = vdbeIncrMergerNew(pTask, pRoot,
+						       &pReadr->pIncr);
+			} else {
+				pMain = pRoot;
+			}
 		} else {
 			vdbeMergeEngineFree(pRoot);
 		}
@@ -1925,9 +2482,12 @@ vdbeSorterMergeTreeBuild(VdbeSorter * pSorter,	/* The VDBE cursor that implement
 /*
  * This function is called as part of an sqlVdbeSorterRewind() operation
  * on a sorter that has written two or more PMAs to temporary files. It sets
- * up either VdbeSorter.pMerger (for single threaded sorters) or pReader
- * (for multi-threaded sorters) so that it can be used to iterate through
- * all records stored in the sorter.
+ * up VdbeSorter.pMerger so that it can be used to iterate through all
+ * records stored in the sorter.
+ *
+ * For multi-threaded sorters, the PMAs of each of the first
+ * (pSorter->nTask-1) sub-tasks are merged by a background thread of the
+ * sub-task, while the main thread merges the output of the threads.
  *
  * 0 is returned if successful, or an sql error code otherwise.
  */
@@ -1936,10 +2496,24 @@ vdbeSorterSetupMerge(VdbeSorter * pSorter)
 {
 	int rc;			/* Return code */
 	MergeEngine *pMain = 0;
+	SortSubtask *pLast = &pSorter->aTask[pSorter->nTask - 1];
 
 	rc = vdbeSorterMergeTreeBuild(pSorter, &pMain);
+	if (rc == 0 && pSorter->nTask > 1) {
+		int iTask;
+		if (vdbeSorterCanYield()) {
+			for (iTask = 0; iTask < pSorter->nTask - 1; iTask++) {
+				IncrMerger *pIncr = pMain->aReadr[iTask].pIncr;
+				if (pIncr != NULL)
+					vdbeIncrMergerSetThreads(pIncr);
+			}
+		}
+		/* The last task may have no PMAs, but it is used to merge. */
+		rc = vdbeSortAllocUnpacked(pLast);
+		pLast->xCompare = vdbeSorterGetCompare(pSorter);
+	}
 	if (rc == 0) {
-		rc = vdbeMergeEngineInit(&pSorter->aTask, pMain);
+		rc = vdbeMergeEngineInit(pLast, pMain);
 		pSorter->pMerger = pMain;
 		pMain = 0;
 	}
@@ -1968,10 +2542,15 @@ sqlVdbeSorterRewind(const VdbeCursor * pCsr, int *pbEof)
 	 * sort the VdbeSorter.pRecord list. The vdbe layer will read data directly
 	 * from the in-memory list.
 	 */
+	if (pSorter->nTopN > 0) {
+		vdbeSorterTopNToList(pSorter);
+		*pbEof = pSorter->list.pList == NULL;
+		return 0;
+	}
 	if (pSorter->bUsePMA == 0) {
 		if (pSorter->list.pList) {
 			*pbEof = 0;
-			rc = vdbeSorterSort(&pSorter->aTask, &pSorter->list);
+			rc = vdbeSorterSort(&pSorter->aTask[0], &pSorter->list);
 		} else {
 			*pbEof = 1;
 		}
@@ -2015,7 +2594,8 @@ sqlVdbeSorterNext(const struct VdbeCursor *pCsr, int *pbEof)
 	if (pSorter->bUsePMA) {
 		assert(pSorter->pReader == 0 || pSorter->pMerger == 0);
 		assert(pSorter->pMerger);
-		assert(pSorter->pMerger->pTask == &pSorter->aTask);
+		assert(pSorter->pMerger->pTask ==
+		       &pSorter->aTask[pSorter->nTask - 1]);
 		rc = vdbeMergeEngineStep(pSorter->pMerger, pbEof);
 	} else {
 		SorterRecord *pFree = pSorter->list.pList;
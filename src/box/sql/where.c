@@ -712,6 +712,33 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
 	return 1;
 }
 
+/**
+ * Return true if the WHERE clause term can be used as a key of a hash
+ * join. Besides the conditions of termCanDriveIndex(), equal values of
+ * the column must have equal hashes. This isn't true for e.g. integer
+ * and decimal values of a NUMBER column, so such columns are looked up
+ * with an ordinary ephemeral index.
+ */
+static bool
+term_can_drive_hash_join(struct WhereTerm *term, struct SrcList_item *src,
+			 Bitmask not_ready)
+{
+	if (!termCanDriveIndex(term, src, not_ready))
+		return false;
+	switch (src->space->def->fields[term->u.leftColumn].type) {
+	case FIELD_TYPE_BOOLEAN:
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_DOUBLE:
+	case FIELD_TYPE_STRING:
+	case FIELD_TYPE_VARBINARY:
+	case FIELD_TYPE_UUID:
+		return true;
+	default:
+		return false;
+	}
+}
+
 /**
  * Generate a code that will create a tuple, which is supposed to be inserted
  * in the ephemeral index space. The created tuple consists of rowid and
@@ -721,7 +748,8 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
  * @param key_def The index key description.
  * @param cursor Cursor of source space from which values for tuple are fetched.
  * @param reg_out Register to contain the created tuple.
- * @param reg_eph Register holding pointer to ephemeral index.
+ * @param reg_eph Register holding pointer to ephemeral index or 0 if the
+ *        tuple is inserted in a hash join, which doesn't need rowid.
  */
 static void
 vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
@@ -736,8 +764,13 @@ vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
 		uint32_t tabl_col = key_def->parts[j].fieldno;
 		sqlVdbeAddOp3(v, OP_Column, cursor, tabl_col, reg_base + j);
 	}
-	sqlVdbeAddOp2(v, OP_NextIdEphemeral, reg_eph, reg_base + col_cnt);
-	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, col_cnt + 1, reg_out);
+	int field_count = col_cnt;
+	if (reg_eph != 0) {
+		sqlVdbeAddOp2(v, OP_NextIdEphemeral, reg_eph,
+			      reg_base + col_cnt);
+		field_count++;
+	}
+	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, field_count, reg_out);
 	sqlReleaseTempRange(parse, reg_base, col_cnt + 1);
 }
 
@@ -748,6 +781,10 @@ vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
  * an "ephemeral index". The PK definition of ephemeral index contains all of
  * its fields. Also, this functions set up the WhereLevel object pLevel so
  * that the code generator makes use of ephemeral index.
+ *
+ * If the loop is marked with WHERE_HASH_JOIN, the rows are stored in the
+ * hash table of a hash join instead, keyed by the columns used in the
+ * equality constraints.
  */
 static void
 constructAutomaticIndex(Parse * pParse,			/* The parsing context */
@@ -783,9 +820,11 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	nKeyCol = 0;
 	pWCEnd = &pWC->a[pWC->nTerm];
 	pLoop = pLevel->pWLoop;
+	bool is_hash = (pLoop->wsFlags & WHERE_HASH_JOIN) != 0;
 	idxCols = 0;
 	for (pTerm = pWC->a; pTerm < pWCEnd; pTerm++) {
-		if (termCanDriveIndex(pTerm, pSrc, notReady)) {
+		if (is_hash ? term_can_drive_hash_join(pTerm, pSrc, notReady) :
+		    termCanDriveIndex(pTerm, pSrc, notReady)) {
 			int iCol = pTerm->u.leftColumn;
 			Bitmask cMask =
 			    iCol >= BMS ? MASKBIT(BMS - 1) : MASKBIT(iCol);
@@ -800,6 +839,8 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	pLoop->nEq = pLoop->nLTerm = nKeyCol;
 	pLoop->wsFlags = WHERE_COLUMN_EQ | WHERE_IDX_ONLY | WHERE_INDEXED
 	    | WHERE_AUTO_INDEX;
+	if (is_hash)
+		pLoop->wsFlags |= WHERE_HASH_JOIN;
 
 	/* Count the number of additional columns needed to create a
 	 * covering index.  A "covering index" is an index that contains all
@@ -826,7 +867,8 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 							 typeof(parts[0]),
 							 nKeyCol);
 	for (pTerm = pWC->a; pTerm < pWCEnd; pTerm++) {
-		if (termCanDriveIndex(pTerm, pSrc, notReady)) {
+		if (is_hash ? term_can_drive_hash_join(pTerm, pSrc, notReady) :
+		    termCanDriveIndex(pTerm, pSrc, notReady)) {
 			int iCol = pTerm->u.leftColumn;
 			Bitmask cMask =
 			    iCol >= BMS ? MASKBIT(BMS - 1) : MASKBIT(iCol);
@@ -909,10 +951,16 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	pLevel->iIdxCur = pParse->nTab++;
 	struct sql_space_info *info = sql_space_info_new_from_index_def(idx_def,
 									true);
-	int reg_eph = sqlGetTempReg(pParse);
-	sqlVdbeAddOp4(v, OP_OpenTEphemeral, reg_eph, 0, 0, (char *)info,
-		      P4_DYNAMIC);
-	sqlVdbeAddOp3(v, OP_IteratorOpen, pLevel->iIdxCur, 0, reg_eph);
+	int reg_eph = 0;
+	if (is_hash) {
+		sqlVdbeAddOp4(v, OP_HashOpen, pLevel->iIdxCur, pLoop->nEq, 0,
+			      (char *)info, P4_DYNAMIC);
+	} else {
+		reg_eph = sqlGetTempReg(pParse);
+		sqlVdbeAddOp4(v, OP_OpenTEphemeral, reg_eph, 0, 0, (char *)info,
+			      P4_DYNAMIC);
+		sqlVdbeAddOp3(v, OP_IteratorOpen, pLevel->iIdxCur, 0, reg_eph);
+	}
 	VdbeComment((v, "for %s", space->def->name));
 
 	/* Fill the automatic index with content */
@@ -923,12 +971,16 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	regRecord = sqlGetTempReg(pParse);
 	vdbe_emit_ephemeral_index_tuple(pParse, idx_def->key_def, cursor,
 					regRecord, reg_eph);
-	sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, reg_eph);
+	if (is_hash)
+		sqlVdbeAddOp2(v, OP_HashInsert, pLevel->iIdxCur, regRecord);
+	else
+		sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, reg_eph);
 	sqlVdbeAddOp2(v, OP_Next, cursor, addrTop + 1);
 	sqlVdbeChangeP5(v, SQL_STMTSTATUS_AUTOINDEX);
 	sqlVdbeJumpHere(v, addrTop);
 	sqlReleaseTempReg(pParse, regRecord);
-	sqlReleaseTempReg(pParse, reg_eph);
+	if (reg_eph != 0)
+		sqlReleaseTempReg(pParse, reg_eph);
 	sqlExprCachePop(pParse);
 
 	/* Jump here when skipping the initialization */
@@ -1227,8 +1279,6 @@ whereRangeSkipScanEst(Parse * pParse,		/* Parsing & code generating context */
 	struct Mem *p1 = NULL;
 	/* Value extracted from pUpper */
 	struct Mem *p2 = NULL;
-	/* Value extracted from record */
-	struct Mem *pVal = NULL;
 
 	struct coll *coll = p->key_def->parts[nEq].coll;
 	if (pLower) {
@@ -1246,10 +1296,25 @@ whereRangeSkipScanEst(Parse * pParse,		/* Parsing & code generating context */
 		int i;
 		int nDiff;
 		uint32_t sample_count = index->def->opts.stat->sample_count;
+		struct index_sample *samples = index->def->opts.stat->samples;
 		for (i = 0; i < (int)sample_count; i++) {
-			if (p1 != NULL && mem_cmp_scalar(p1, pVal, coll) >= 0)
+			/* Extract the nEq-th field of the sample. */
+			const char *key = samples[i].sample_key;
+			uint32_t field_count = mp_decode_array(&key);
+			assert((uint32_t)nEq < field_count);
+			(void)field_count;
+			for (int j = 0; j < nEq; j++)
+				mp_next(&key);
+			struct Mem val;
+			mem_create(&val);
+			uint32_t unused;
+			if (mem_from_mp_ephemeral(&val, key, &unused) != 0) {
+				rc = -1;
+				break;
+			}
+			if (p1 != NULL && mem_cmp_scalar(p1, &val, coll) >= 0)
 				nLower++;
-			if (p2 != NULL && mem_cmp_scalar(p2, pVal, coll) >= 0)
+			if (p2 != NULL && mem_cmp_scalar(p2, &val, coll) >= 0)
 				nUpper++;
 		}
 		nDiff = (nUpper - nLower);
@@ -1279,7 +1344,6 @@ whereRangeSkipScanEst(Parse * pParse,		/* Parsing & code generating context */
 
 	mem_delete(p1);
 	mem_delete(p2);
-	mem_delete(pVal);
 
 	return rc;
 }
@@ -1552,14 +1616,18 @@ whereEqualScanEst(Parse * pParse,	/* Parsing & code generating context */
 
 	assert(nEq >= 1);
 	assert(nEq <= (int) p->key_def->part_count);
-	assert(pBuilder->nRecValid == (nEq - 1));
+	/*
+	 * If values are not available for all fields of the index
+	 * to the left of this one, no estimate can be made.
+	 */
+	if (pBuilder->nRecValid < nEq - 1)
+		return 0;
 
 	rc = sqlStat4ProbeSetValue(pParse, p, &pRec, pExpr, 1, nEq - 1,
 				       &bOk);
 	pBuilder->pRec = pRec;
-	if (rc != 0)
+	if (rc != 0 || bOk == 0)
 		return rc;
-	assert(bOk != 0);
 	pBuilder->nRecValid = nEq;
 
 	whereKeyStats(p, pRec, 0, a);
@@ -2852,6 +2920,20 @@ tnt_error:
 				pNew->rRun =
 				    sqlLogEstAdd(rLogSize, pNew->nOut);
 				pNew->wsFlags = WHERE_AUTO_INDEX;
+				if ((pWInfo->pParse->sql_flags &
+				     SQL_HashJoin) != 0 &&
+				    term_can_drive_hash_join(pTerm, pSrc, 0)) {
+					/*
+					 * Unlike a sorted ephemeral index,
+					 * a hash table is built in linear
+					 * time and a lookup doesn't depend
+					 * on the number of rows in it.
+					 */
+					assert(10 == sqlLogEst(2));
+					pNew->rSetup = rSize + 10;
+					pNew->rRun = sqlLogEstAdd(0, pNew->nOut);
+					pNew->wsFlags |= WHERE_HASH_JOIN;
+				}
 				pNew->prereq = mPrereq | pTerm->prereqRight;
 				rc = whereLoopInsert(pBuilder, pNew);
 			}
@@ -4090,6 +4172,36 @@ where_loop_builder_shortcut(struct WhereLoopBuilder *builder)
 	return 0;
 }
 
+/**
+ * Check if a SELECT loop reads only the fields indexed by its
+ * index (including the primary key parts), i.e. the index covers
+ * the query. Such an index is opened in the key-only mode, which
+ * lets the engine skip fetching full tuples, e.g. vinyl doesn't
+ * look up the primary index for each entry of a secondary one.
+ */
+static bool
+where_loop_is_key_only(struct WhereInfo *winfo, struct WhereLoop *loop,
+		       struct SrcList_item *item)
+{
+	if ((winfo->wctrlFlags &
+	     (WHERE_ONEPASS_DESIRED | WHERE_OR_SUBCLAUSE)) != 0 ||
+	    (loop->wsFlags & (WHERE_AUTO_INDEX | WHERE_MULTI_OR)) != 0)
+		return false;
+	Bitmask col_used = item->colUsed;
+	if ((col_used & MASKBIT(BMS - 1)) != 0)
+		return false;
+	struct key_def *cmp_def = loop->index_def->cmp_def;
+	if (cmp_def->is_multikey || cmp_def->for_func_index)
+		return false;
+	for (uint32_t i = 0; i < cmp_def->part_count; i++) {
+		struct key_part *part = &cmp_def->parts[i];
+		/* A JSON path part covers only a part of the field. */
+		if (part->path == NULL && part->fieldno < BMS - 1)
+			col_used &= ~MASKBIT(part->fieldno);
+	}
+	return col_used == 0;
+}
+
 /*
  * Generate the beginning of the loop used for WHERE clause processing.
  * The return value is a pointer to an opaque structure that contains
@@ -4568,14 +4680,20 @@ sqlWhereBegin(Parse * pParse,	/* The parser context */
 				struct space *space = space_by_id(space_id);
 				vdbe_emit_open_cursor(pParse, iIndexCur,
 						      idx_def->iid, space);
+				u16 p5 = 0;
 				if ((pLoop->wsFlags & WHERE_CONSTRAINT) != 0
 				    && (pLoop->
 					wsFlags & (WHERE_COLUMN_RANGE |
 						   WHERE_SKIPSCAN)) == 0
 				    && (pWInfo->
 					wctrlFlags & WHERE_ORDERBY_MIN) == 0) {
-					sqlVdbeChangeP5(v, OPFLAG_SEEKEQ);	/* Hint to COMDB2 */
+					p5 |= OPFLAG_SEEKEQ;	/* Hint to COMDB2 */
 				}
+				if (where_loop_is_key_only(pWInfo, pLoop,
+							   pTabItem))
+					p5 |= OPFLAG_KEY_ONLY;
+				if (p5 != 0)
+					sqlVdbeChangeP5(v, p5);
 				VdbeComment((v, "%s", idx_def->name));
 			}
 		}
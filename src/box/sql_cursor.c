@@ -0,0 +1,230 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "sql_cursor.h"
+
+#include "assoc.h"
+#include "diag.h"
+#include "errcode.h"
+#include "error.h"
+#include "execute.h"
+#include "fiber.h"
+#include "info/info.h"
+#include "port.h"
+#include "say.h"
+#include "schema.h"
+#include "session.h"
+#include "small/rlist.h"
+#include "sql/port.h"
+#include "sql/sqlInt.h"
+#include "trivia/util.h"
+
+/**
+ * Server-side cursor of a SELECT statement. The statement is
+ * suspended after each fetch and resumed by the next one, so
+ * neither the client nor the server has to keep the whole
+ * result set in memory.
+ */
+struct sql_cursor {
+	/** Cursor ID, unique among all sessions. */
+	uint32_t id;
+	/** Running statement owned by the cursor. */
+	struct Vdbe *stmt;
+	/**
+	 * Session the cursor was opened in. Set to NULL if the
+	 * session is closed while the cursor is fetching rows.
+	 */
+	struct session *session;
+	/** Link in the list of cursors of the session. */
+	struct rlist in_session;
+	/**
+	 * Link in the list of idle cursors, the least recently
+	 * used first. A cursor fetching rows isn't in the list.
+	 */
+	struct rlist in_idle;
+	/** Monotonic time of the last fetch. */
+	double last_access;
+	/** Set while the cursor is fetching rows. */
+	bool is_busy;
+};
+
+/** Global registry of SQL cursors. */
+static struct {
+	/** Cursor ID -> struct sql_cursor hash. */
+	struct mh_i32ptr_t *hash;
+	/** Idle cursors, the least recently used first. */
+	struct rlist idle;
+	/** ID of the last opened cursor. */
+	uint32_t last_id;
+	/** Time after which an idle cursor is closed. */
+	double idle_timeout;
+	/** Fiber closing idle cursors. */
+	struct fiber *gc_fiber;
+} sql_cursors;
+
+static struct sql_cursor *
+sql_cursor_find(uint32_t cursor_id)
+{
+	mh_int_t i = mh_i32ptr_find(sql_cursors.hash, cursor_id, NULL);
+	if (i == mh_end(sql_cursors.hash))
+		return NULL;
+	return mh_i32ptr_node(sql_cursors.hash, i)->val;
+}
+
+static void
+sql_cursor_delete(struct sql_cursor *cursor)
+{
+	assert(!cursor->is_busy);
+	mh_int_t i = mh_i32ptr_find(sql_cursors.hash, cursor->id, NULL);
+	assert(i != mh_end(sql_cursors.hash));
+	mh_i32ptr_del(sql_cursors.hash, i, NULL);
+	rlist_del_entry(cursor, in_session);
+	rlist_del_entry(cursor, in_idle);
+	sql_stmt_finalize(cursor->stmt);
+	free(cursor);
+}
+
+/** Move a cursor to the tail of the idle list. */
+static void
+sql_cursor_touch(struct sql_cursor *cursor)
+{
+	cursor->last_access = ev_monotonic_now(loop());
+	rlist_move_tail_entry(&sql_cursors.idle, cursor, in_idle);
+}
+
+static int
+sql_cursor_gc_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		double timeout = sql_cursors.idle_timeout;
+		while (!rlist_empty(&sql_cursors.idle)) {
+			struct sql_cursor *cursor =
+				rlist_first_entry(&sql_cursors.idle,
+						  struct sql_cursor, in_idle);
+			double deadline = cursor->last_access +
+					  sql_cursors.idle_timeout;
+			double now = ev_monotonic_now(loop());
+			if (deadline > now) {
+				timeout = deadline - now;
+				break;
+			}
+			sql_cursor_delete(cursor);
+		}
+		fiber_sleep(timeout);
+	}
+	return 0;
+}
+
+void
+sql_cursor_init(void)
+{
+	sql_cursors.hash = mh_i32ptr_new();
+	rlist_create(&sql_cursors.idle);
+	sql_cursors.last_id = 0;
+	sql_cursors.idle_timeout = TIMEOUT_INFINITY;
+	sql_cursors.gc_fiber = fiber_new_system("sql.cursor_gc",
+						sql_cursor_gc_f);
+	if (sql_cursors.gc_fiber == NULL)
+		panic("failed to start SQL cursor gc fiber");
+	fiber_start(sql_cursors.gc_fiber);
+}
+
+void
+sql_cursor_set_idle_timeout(double timeout)
+{
+	sql_cursors.idle_timeout = timeout;
+	fiber_wakeup(sql_cursors.gc_fiber);
+}
+
+uint32_t
+sql_cursor_new(struct Vdbe *stmt)
+{
+	struct session *session = current_session();
+	struct sql_cursor *cursor = xmalloc(sizeof(*cursor));
+	do {
+		cursor->id = ++sql_cursors.last_id;
+	} while (cursor->id == 0 || sql_cursor_find(cursor->id) != NULL);
+	cursor->stmt = stmt;
+	cursor->session = session;
+	cursor->is_busy = false;
+	rlist_add_tail_entry(&session->sql_cursors, cursor, in_session);
+	rlist_create(&cursor->in_idle);
+	sql_cursor_touch(cursor);
+	struct mh_i32ptr_node_t node = {cursor->id, cursor};
+	mh_i32ptr_put(sql_cursors.hash, &node, NULL, NULL);
+	sql_stmt_suspend(stmt);
+	return cursor->id;
+}
+
+int
+sql_cursor_fetch(uint32_t cursor_id, uint32_t fetch_size, struct port *port,
+		 struct region *region)
+{
+	struct sql_cursor *cursor = sql_cursor_find(cursor_id);
+	if (cursor == NULL || cursor->session != current_session()) {
+		diag_set(ClientError, ER_NO_SUCH_SQL_CURSOR, cursor_id);
+		return -1;
+	}
+	if (cursor->is_busy) {
+		diag_set(ClientError, ER_SQL_EXECUTE,
+			 "cursor is used by another request");
+		return -1;
+	}
+	/*
+	 * The statement holds pointers to the spaces and indexes,
+	 * which may have been altered or dropped since the last
+	 * fetch.
+	 */
+	if (sql_stmt_schema_version(cursor->stmt) != box_schema_version()) {
+		sql_cursor_delete(cursor);
+		diag_set(ClientError, ER_SQL_EXECUTE, "cursor has expired");
+		return -1;
+	}
+	port_sql_create(port, NULL, DQL_FETCH, false);
+	if (fetch_size == 0) {
+		sql_cursor_delete(cursor);
+		return 0;
+	}
+	cursor->is_busy = true;
+	rlist_del_entry(cursor, in_idle);
+	int rc = sql_execute_rows(cursor->stmt, fetch_size, port, region);
+	cursor->is_busy = false;
+	if (rc > 0 && cursor->session != NULL) {
+		sql_stmt_suspend(cursor->stmt);
+		sql_cursor_touch(cursor);
+		((struct port_sql *)port)->cursor_id = cursor->id;
+		return 0;
+	}
+	sql_cursor_delete(cursor);
+	if (rc < 0) {
+		port_destroy(port);
+		return -1;
+	}
+	return 0;
+}
+
+void
+sql_session_cursors_close(struct rlist *cursors)
+{
+	struct sql_cursor *cursor, *tmp;
+	rlist_foreach_entry_safe(cursor, cursors, in_session, tmp) {
+		if (cursor->is_busy) {
+			/* Closed by the fetch when it's over. */
+			rlist_del_entry(cursor, in_session);
+			cursor->session = NULL;
+			continue;
+		}
+		sql_cursor_delete(cursor);
+	}
+}
+
+void
+sql_cursor_stat(struct info_handler *h)
+{
+	info_table_begin(h, "cursors");
+	info_append_int(h, "count", mh_size(sql_cursors.hash));
+	info_table_end(h);
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct Vdbe;
+struct port;
+struct region;
+struct rlist;
+struct info_handler;
+
+/**
+ * Initialize the SQL cursor registry and start the fiber closing
+ * idle cursors. Called once during database setup (in sql_init()).
+ */
+void
+sql_cursor_init(void);
+
+/**
+ * Set the time after which a cursor that is not fetched from is
+ * closed (box.cfg.sql_cursor_idle_timeout).
+ */
+void
+sql_cursor_set_idle_timeout(double timeout);
+
+/**
+ * Open a cursor in the current session for a SELECT statement
+ * that has returned some rows and may return more. The cursor
+ * takes the ownership of the statement. Return the cursor ID.
+ */
+uint32_t
+sql_cursor_new(struct Vdbe *stmt);
+
+/**
+ * Append at most @a fetch_size next rows of the cursor with ID
+ * @a cursor_id to the port. The cursor is closed if it has no
+ * more rows, on error or if @a fetch_size is 0. Otherwise the
+ * cursor ID is stored in the port.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error.
+ */
+int
+sql_cursor_fetch(uint32_t cursor_id, uint32_t fetch_size, struct port *port,
+		 struct region *region);
+
+/**
+ * Close all cursors of a session.
+ * @cursors is assumed to be member of struct session @sql_cursors.
+ */
+void
+sql_session_cursors_close(struct rlist *cursors);
+
+/** Store statistics of SQL cursors into info handler @a h. */
+void
+sql_cursor_stat(struct info_handler *h);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -35,6 +35,9 @@
 #include "execute.h"
 #include "diag.h"
 #include "info/info.h"
+#include "schema.h"
+#include "sql_cursor.h"
+#include "sql/sqlInt.h"
 
 static struct sql_stmt_cache sql_stmt_cache;
 
@@ -45,6 +48,12 @@ sql_stmt_cache_init(void)
 	sql_stmt_cache.mem_quota = 0;
 	sql_stmt_cache.mem_used = 0;
 	rlist_create(&sql_stmt_cache.gc_queue);
+	sql_stmt_cache.plan_hash = mh_strnptr_new();
+	rlist_create(&sql_stmt_cache.plan_lru);
+	sql_stmt_cache.plan_mem_used = 0;
+	sql_stmt_cache.plan_generation = 0;
+	sql_stmt_cache.plan_hits = 0;
+	sql_stmt_cache.plan_misses = 0;
 }
 
 void
@@ -59,6 +68,13 @@ sql_stmt_cache_stat(struct info_handler *h)
 		entry_count++;
 	info_append_int(h, "stmt_count", entry_count);
 	info_table_end(h);
+	info_table_begin(h, "plan_cache");
+	info_append_int(h, "size", sql_stmt_cache.plan_mem_used);
+	info_append_int(h, "stmt_count", mh_size(sql_stmt_cache.plan_hash));
+	info_append_int(h, "hits", sql_stmt_cache.plan_hits);
+	info_append_int(h, "misses", sql_stmt_cache.plan_misses);
+	info_table_end(h);
+	sql_cursor_stat(h);
 	info_end(h);
 }
 
@@ -151,7 +167,50 @@ sql_cache_entry_new(struct Vdbe *stmt)
 static bool
 sql_cache_check_new_entry_size(size_t size)
 {
-	return (sql_stmt_cache.mem_used + size <= sql_stmt_cache.mem_quota);
+	return (sql_stmt_cache.mem_used + sql_stmt_cache.plan_mem_used +
+		size <= sql_stmt_cache.mem_quota);
+}
+
+static size_t
+sql_plan_cache_entry_sizeof(struct sql_plan_cache_entry *entry)
+{
+	return sql_stmt_est_size(entry->stmt) + sizeof(*entry) +
+	       entry->sql_len;
+}
+
+/** Remove the plan from the plan cache and release its memory. */
+static void
+sql_plan_cache_delete(struct sql_plan_cache_entry *entry)
+{
+	assert(!sql_stmt_busy(entry->stmt));
+	struct mh_strnptr_t *hash = sql_stmt_cache.plan_hash;
+	mh_int_t i = mh_strnptr_find_str(hash, entry->sql, entry->sql_len);
+	assert(i != mh_end(hash));
+	mh_strnptr_del(hash, i, NULL);
+	rlist_del(&entry->in_lru);
+	sql_stmt_cache.plan_mem_used -= sql_plan_cache_entry_sizeof(entry);
+	sql_stmt_finalize(entry->stmt);
+	TRASH(entry);
+	free(entry);
+}
+
+/**
+ * Evict the least recently used plans until an entry of the
+ * given size fits into the cache. Plans being executed are
+ * skipped. Return true on success.
+ */
+static bool
+sql_plan_cache_reserve(size_t size)
+{
+	struct sql_plan_cache_entry *entry, *tmp;
+	rlist_foreach_entry_safe_reverse(entry, &sql_stmt_cache.plan_lru,
+					 in_lru, tmp) {
+		if (sql_cache_check_new_entry_size(size))
+			return true;
+		if (!sql_stmt_busy(entry->stmt))
+			sql_plan_cache_delete(entry);
+	}
+	return sql_cache_check_new_entry_size(size);
 }
 
 static void
@@ -236,8 +295,10 @@ sql_stmt_cache_insert(struct Vdbe *stmt)
 	struct sql_stmt_cache *cache = &sql_stmt_cache;
 	size_t new_entry_size = sql_cache_entry_sizeof(stmt);
 
-	if (! sql_cache_check_new_entry_size(new_entry_size))
+	if (! sql_cache_check_new_entry_size(new_entry_size)) {
 		sql_stmt_cache_gc();
+		sql_plan_cache_reserve(new_entry_size);
+	}
 	/*
 	 * Test memory limit again. Raise an error if it is
 	 * still overcrowded.
@@ -284,5 +345,67 @@ sql_stmt_cache_set_size(size_t size)
 		return -1;
 	}
 	sql_stmt_cache.mem_quota = size;
+	sql_plan_cache_reserve(0);
+	return 0;
+}
+
+struct Vdbe *
+sql_plan_cache_find(const char *sql, uint32_t len, uint32_t sql_flags)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	mh_int_t i = mh_strnptr_find_str(cache->plan_hash, sql, len);
+	if (i == mh_end(cache->plan_hash))
+		goto miss;
+	struct sql_plan_cache_entry *entry =
+		mh_strnptr_node(cache->plan_hash, i)->val;
+	if (sql_stmt_busy(entry->stmt))
+		goto miss;
+	if (entry->generation != cache->plan_generation ||
+	    entry->sql_flags != sql_flags ||
+	    sql_stmt_schema_version(entry->stmt) != box_schema_version()) {
+		sql_plan_cache_delete(entry);
+		goto miss;
+	}
+	rlist_move_entry(&cache->plan_lru, entry, in_lru);
+	cache->plan_hits++;
+	return entry->stmt;
+miss:
+	cache->plan_misses++;
+	return NULL;
+}
+
+int
+sql_plan_cache_insert(const char *sql, uint32_t len, struct Vdbe *stmt,
+		      uint32_t sql_flags)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	if (mh_strnptr_find_str(cache->plan_hash, sql, len) !=
+	    mh_end(cache->plan_hash))
+		return -1;
+	struct sql_plan_cache_entry *entry = malloc(sizeof(*entry) + len);
+	if (entry == NULL)
+		return -1;
+	entry->stmt = stmt;
+	entry->sql_flags = sql_flags;
+	entry->generation = cache->plan_generation;
+	entry->sql_len = len;
+	memcpy(entry->sql, sql, len);
+	size_t size = sql_plan_cache_entry_sizeof(entry);
+	if (!sql_plan_cache_reserve(size)) {
+		free(entry);
+		return -1;
+	}
+	const struct mh_strnptr_node_t node = {
+		entry->sql, len, mh_strn_hash(entry->sql, len), entry
+	};
+	mh_strnptr_put(cache->plan_hash, &node, NULL, NULL);
+	rlist_add_entry(&cache->plan_lru, entry, in_lru);
+	cache->plan_mem_used += size;
 	return 0;
 }
+
+void
+sql_plan_cache_expire(void)
+{
+	sql_stmt_cache.plan_generation++;
+}
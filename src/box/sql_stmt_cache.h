@@ -40,6 +40,7 @@ extern "C" {
 #endif
 
 struct mh_i64ptr_t;
+struct mh_strnptr_t;
 struct info_handler;
 
 struct stmt_cache_entry {
@@ -57,6 +58,26 @@ struct stmt_cache_entry {
 	uint32_t refs;
 };
 
+/**
+ * Plan of an ad-hoc statement shared by all sessions. Literals
+ * of the statement are replaced with parameters, so queries
+ * which differ only in constants share one plan.
+ */
+struct sql_plan_cache_entry {
+	/** Statement compiled from the parameterized SQL text. */
+	struct Vdbe *stmt;
+	/** SQL flags of the session the statement was compiled in. */
+	uint32_t sql_flags;
+	/** Plan cache generation the statement was compiled in. */
+	uint64_t generation;
+	/** Link in the LRU list of plans. */
+	struct rlist in_lru;
+	/** Length of the parameterized SQL text. */
+	uint32_t sql_len;
+	/** Parameterized SQL text, the key in the plan hash. */
+	char sql[0];
+};
+
 /**
  * Global prepared statements holder.
  */
@@ -81,6 +102,26 @@ struct sql_stmt_cache {
 	 * times.
 	 */
 	struct stmt_cache_entry *last_found;
+	/** Parameterized SQL text -> struct sql_plan_cache_entry hash. */
+	struct mh_strnptr_t *plan_hash;
+	/**
+	 * Cached plans, the most recently used first. Plans
+	 * share the memory quota with prepared statements and
+	 * are evicted from the tail when it is exceeded.
+	 */
+	struct rlist plan_lru;
+	/** Size of memory occupied by cached plans. */
+	size_t plan_mem_used;
+	/**
+	 * Incremented on every schema change, including those
+	 * that don't bump the schema version (functions,
+	 * collations) and rolled back ones.
+	 */
+	uint64_t plan_generation;
+	/** Number of ad-hoc statements that reused a cached plan. */
+	uint64_t plan_hits;
+	/** Number of ad-hoc statements that had to be compiled. */
+	uint64_t plan_misses;
 };
 
 /**
@@ -146,6 +187,34 @@ sql_stmt_cache_find(uint32_t stmt_id);
 int
 sql_stmt_cache_set_size(size_t size);
 
+/**
+ * Find the plan compiled from parameterized SQL text @a sql
+ * with session SQL flags @a sql_flags and move it to the head
+ * of the LRU list. A plan which is outdated or was compiled
+ * with other flags is evicted. Return NULL if there is no such
+ * plan or it is being executed right now.
+ */
+struct Vdbe *
+sql_plan_cache_find(const char *sql, uint32_t len, uint32_t sql_flags);
+
+/**
+ * Save the plan compiled from parameterized SQL text @a sql to
+ * the plan cache, evicting the least recently used plans if the
+ * memory quota is exceeded. Return -1 if the plan can't be
+ * cached, the caller keeps the ownership of the statement then.
+ * No diag is set in this case.
+ */
+int
+sql_plan_cache_insert(const char *sql, uint32_t len, struct Vdbe *stmt,
+		      uint32_t sql_flags);
+
+/**
+ * Expire all cached plans. Called on completion of each
+ * transaction which changed the schema.
+ */
+void
+sql_plan_cache_expire(void);
+
 #if defined(__cplusplus)
 } /* extern "C" { */
 #endif
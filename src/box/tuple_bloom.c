@@ -42,11 +42,17 @@
 #include "key_def.h"
 #include "tuple.h"
 #include "salad/bloom.h"
+#include "salad/ribbon.h"
 #include "trivia/util.h"
+#include "tt_static.h"
 #include <PMurHash.h>
 
 enum { HASH_SEED = 13U };
 
+const char *tuple_bloom_type_strs[] = {
+	"classic", "split_block", "ribbon"
+};
+
 struct tuple_bloom_builder *
 tuple_bloom_builder_new(uint32_t part_count)
 {
@@ -150,12 +156,102 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
 	return 0;
 }
 
+/**
+ * Build a filter of the given type storing the given hashes.
+ * Returns 0 on success, -1 on error (diag is set).
+ */
+static int
+tuple_bloom_part_create(union tuple_bloom_part *part,
+			enum tuple_bloom_type type,
+			const struct tuple_hash_array *hash_arr, double fpr)
+{
+	uint32_t count = hash_arr->count;
+	int rc;
+	switch (type) {
+	case TUPLE_BLOOM_CLASSIC:
+		if (bloom_create(&part->bloom, count, fpr) != 0)
+			break;
+		for (uint32_t k = 0; k < count; k++)
+			bloom_add(&part->bloom, hash_arr->values[k]);
+		return 0;
+	case TUPLE_BLOOM_SPLIT_BLOCK:
+		if (bloom_split_create(&part->bloom, count, fpr) != 0)
+			break;
+		for (uint32_t k = 0; k < count; k++)
+			bloom_split_add(&part->bloom, hash_arr->values[k]);
+		return 0;
+	case TUPLE_BLOOM_RIBBON:
+		rc = ribbon_create(&part->ribbon, hash_arr->values, count, fpr);
+		if (rc == -2) {
+			diag_set(ClientError, ER_RIBBON_BUILD, count);
+			return -1;
+		}
+		if (rc != 0)
+			break;
+		return 0;
+	default:
+		unreachable();
+	}
+	diag_set(OutOfMemory, 0, "bloom_create", "tuple bloom part");
+	return -1;
+}
+
+static void
+tuple_bloom_part_destroy(union tuple_bloom_part *part,
+			 enum tuple_bloom_type type)
+{
+	if (type == TUPLE_BLOOM_RIBBON)
+		ribbon_destroy(&part->ribbon);
+	else
+		bloom_destroy(&part->bloom);
+}
+
+/**
+ * Return the expected false positive rate of a filter storing
+ * the given number of values.
+ */
+static double
+tuple_bloom_part_fpr(const union tuple_bloom_part *part,
+		     enum tuple_bloom_type type, uint32_t count)
+{
+	switch (type) {
+	case TUPLE_BLOOM_CLASSIC:
+		return bloom_fpr(&part->bloom, count);
+	case TUPLE_BLOOM_SPLIT_BLOCK:
+		return bloom_split_fpr(&part->bloom, count);
+	case TUPLE_BLOOM_RIBBON:
+		return ribbon_fpr(&part->ribbon);
+	default:
+		unreachable();
+	}
+	return 1;
+}
+
+static inline bool
+tuple_bloom_part_maybe_has(const union tuple_bloom_part *part,
+			   enum tuple_bloom_type type, uint32_t hash)
+{
+	switch (type) {
+	case TUPLE_BLOOM_CLASSIC:
+		return bloom_maybe_has(&part->bloom, hash);
+	case TUPLE_BLOOM_SPLIT_BLOCK:
+		return bloom_split_maybe_has(&part->bloom, hash);
+	case TUPLE_BLOOM_RIBBON:
+		return ribbon_maybe_has(&part->ribbon, hash);
+	default:
+		unreachable();
+	}
+	return true;
+}
+
 struct tuple_bloom *
-tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
+tuple_bloom_new(struct tuple_bloom_builder *builder,
+		enum tuple_bloom_type type, double fpr)
 {
+	assert(type < tuple_bloom_type_MAX);
 	uint32_t part_count = builder->part_count;
 	size_t size = sizeof(struct tuple_bloom) +
-			part_count * sizeof(struct bloom);
+			part_count * sizeof(union tuple_bloom_part);
 	struct tuple_bloom *bloom = malloc(size);
 	if (bloom == NULL) {
 		diag_set(OutOfMemory, size, "malloc", "tuple bloom");
@@ -163,6 +259,7 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 	}
 
 	bloom->is_legacy = false;
+	bloom->type = type;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
@@ -178,17 +275,15 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 		 */
 		double part_fpr = fpr;
 		for (uint32_t j = 0; j < i; j++)
-			part_fpr /= bloom_fpr(&bloom->parts[j], count);
+			part_fpr /= tuple_bloom_part_fpr(&bloom->parts[j],
+							 type, count);
 		part_fpr = MIN(part_fpr, 0.5);
-		if (bloom_create(&bloom->parts[i], count, part_fpr) != 0) {
-			diag_set(OutOfMemory, 0, "bloom_create",
-				 "tuple bloom part");
+		if (tuple_bloom_part_create(&bloom->parts[i], type,
+					    hash_arr, part_fpr) != 0) {
 			tuple_bloom_delete(bloom);
 			return NULL;
 		}
 		bloom->part_count++;
-		for (uint32_t k = 0; k < count; k++)
-			bloom_add(&bloom->parts[i], hash_arr->values[k]);
 	}
 	return bloom;
 }
@@ -197,7 +292,7 @@ void
 tuple_bloom_delete(struct tuple_bloom *bloom)
 {
 	for (uint32_t i = 0; i < bloom->part_count; i++)
-		bloom_destroy(&bloom->parts[i]);
+		tuple_bloom_part_destroy(&bloom->parts[i], bloom->type);
 	free(bloom);
 }
 
@@ -208,7 +303,7 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 	assert(!key_def->is_multikey || multikey_idx != MULTIKEY_NONE);
 
 	if (bloom->is_legacy) {
-		return bloom_maybe_has(&bloom->parts[0],
+		return bloom_maybe_has(&bloom->parts[0].bloom,
 				       tuple_hash(tuple, key_def));
 	}
 
@@ -223,7 +318,8 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 						  &key_def->parts[i],
 						  multikey_idx);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (!tuple_bloom_part_maybe_has(&bloom->parts[i],
+						bloom->type, hash))
 			return false;
 	}
 	return true;
@@ -237,7 +333,7 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 	if (bloom->is_legacy) {
 		if (part_count < key_def->part_count)
 			return true;
-		return bloom_maybe_has(&bloom->parts[0],
+		return bloom_maybe_has(&bloom->parts[0].bloom,
 				       key_hash(key, key_def));
 	}
 
@@ -253,7 +349,8 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 					       key_def->parts[i].type,
 					       key_def->parts[i].coll);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (!tuple_bloom_part_maybe_has(&bloom->parts[i],
+						bloom->type, hash))
 			return false;
 	}
 	return true;
@@ -300,27 +397,94 @@ tuple_bloom_decode_part(struct bloom *part, const char **data)
 	return 0;
 }
 
+static size_t
+tuple_bloom_sizeof_ribbon_part(const struct ribbon *part)
+{
+	size_t size = 0;
+	size += mp_sizeof_array(4);
+	size += mp_sizeof_uint(part->slot_count);
+	size += mp_sizeof_uint(part->result_bits);
+	size += mp_sizeof_uint(part->seed);
+	size += mp_sizeof_bin(ribbon_store_size(part));
+	return size;
+}
+
+static char *
+tuple_bloom_encode_ribbon_part(const struct ribbon *part, char *buf)
+{
+	buf = mp_encode_array(buf, 4);
+	buf = mp_encode_uint(buf, part->slot_count);
+	buf = mp_encode_uint(buf, part->result_bits);
+	buf = mp_encode_uint(buf, part->seed);
+	buf = mp_encode_binl(buf, ribbon_store_size(part));
+	buf = ribbon_store(part, buf);
+	return buf;
+}
+
+static int
+tuple_bloom_decode_ribbon_part(struct ribbon *part, const char **data)
+{
+	memset(part, 0, sizeof(*part));
+	if (mp_decode_array(data) != 4)
+		unreachable();
+	part->slot_count = mp_decode_uint(data);
+	part->result_bits = mp_decode_uint(data);
+	part->seed = mp_decode_uint(data);
+	size_t store_size = mp_decode_binl(data);
+	assert(store_size == ribbon_store_size(part));
+	if (ribbon_load_table(part, *data) != 0) {
+		diag_set(OutOfMemory, store_size, "ribbon_load_table",
+			 "tuple bloom part");
+		return -1;
+	}
+	*data += store_size;
+	return 0;
+}
+
 size_t
 tuple_bloom_size(const struct tuple_bloom *bloom)
 {
 	size_t size = 0;
+	if (tuple_bloom_encode_version(bloom) > 1) {
+		size += mp_sizeof_array(2);
+		size += mp_sizeof_uint(bloom->type);
+	}
 	size += mp_sizeof_array(bloom->part_count);
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		size += tuple_bloom_sizeof_part(&bloom->parts[i]);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		const union tuple_bloom_part *part = &bloom->parts[i];
+		if (bloom->type == TUPLE_BLOOM_RIBBON)
+			size += tuple_bloom_sizeof_ribbon_part(&part->ribbon);
+		else
+			size += tuple_bloom_sizeof_part(&part->bloom);
+	}
 	return size;
 }
 
 char *
 tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf)
 {
+	if (tuple_bloom_encode_version(bloom) > 1) {
+		buf = mp_encode_array(buf, 2);
+		buf = mp_encode_uint(buf, bloom->type);
+	}
 	buf = mp_encode_array(buf, bloom->part_count);
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		buf = tuple_bloom_encode_part(&bloom->parts[i], buf);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		const union tuple_bloom_part *part = &bloom->parts[i];
+		if (bloom->type == TUPLE_BLOOM_RIBBON)
+			buf = tuple_bloom_encode_ribbon_part(&part->ribbon,
+							     buf);
+		else
+			buf = tuple_bloom_encode_part(&part->bloom, buf);
+	}
 	return buf;
 }
 
-struct tuple_bloom *
-tuple_bloom_decode(const char **data)
+/**
+ * Decode an array of filters of the given type. Used by both
+ * versions of the format.
+ */
+static struct tuple_bloom *
+tuple_bloom_decode_parts(enum tuple_bloom_type type, const char **data)
 {
 	uint32_t part_count = mp_decode_array(data);
 	struct tuple_bloom *bloom = malloc(sizeof(*bloom) +
@@ -333,10 +497,18 @@ tuple_bloom_decode(const char **data)
 	}
 
 	bloom->is_legacy = false;
+	bloom->type = type;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
-		if (tuple_bloom_decode_part(&bloom->parts[i], data) != 0) {
+		union tuple_bloom_part *part = &bloom->parts[i];
+		int rc;
+		if (type == TUPLE_BLOOM_RIBBON)
+			rc = tuple_bloom_decode_ribbon_part(&part->ribbon,
+							    data);
+		else
+			rc = tuple_bloom_decode_part(&part->bloom, data);
+		if (rc != 0) {
 			tuple_bloom_delete(bloom);
 			return NULL;
 		}
@@ -345,6 +517,27 @@ tuple_bloom_decode(const char **data)
 	return bloom;
 }
 
+struct tuple_bloom *
+tuple_bloom_decode(const char **data)
+{
+	return tuple_bloom_decode_parts(TUPLE_BLOOM_CLASSIC, data);
+}
+
+struct tuple_bloom *
+tuple_bloom_decode_v2(const char **data)
+{
+	if (mp_decode_array(data) != 2)
+		unreachable();
+	uint64_t type = mp_decode_uint(data);
+	if (type >= tuple_bloom_type_MAX) {
+		diag_set(ClientError, ER_INVALID_MSGPACK,
+			 tt_sprintf("unknown bloom filter type %llu",
+				    (unsigned long long)type));
+		return NULL;
+	}
+	return tuple_bloom_decode_parts(type, data);
+}
+
 struct tuple_bloom *
 tuple_bloom_decode_legacy(const char **data)
 {
@@ -357,6 +550,7 @@ tuple_bloom_decode_legacy(const char **data)
 	}
 
 	bloom->is_legacy = true;
+	bloom->type = TUPLE_BLOOM_CLASSIC;
 	bloom->part_count = 1;
 
 	if (mp_decode_array(data) != 4)
@@ -364,12 +558,13 @@ tuple_bloom_decode_legacy(const char **data)
 	if (mp_decode_uint(data) != 0) /* version */
 		unreachable();
 
-	bloom->parts[0].table_size = mp_decode_uint(data);
-	bloom->parts[0].hash_count = mp_decode_uint(data);
+	struct bloom *part = &bloom->parts[0].bloom;
+	part->table_size = mp_decode_uint(data);
+	part->hash_count = mp_decode_uint(data);
 
 	size_t store_size = mp_decode_binl(data);
-	assert(store_size == bloom_store_size(&bloom->parts[0]));
-	if (bloom_load_table(&bloom->parts[0], *data) != 0) {
+	assert(store_size == bloom_store_size(part));
+	if (bloom_load_table(part, *data) != 0) {
 		diag_set(OutOfMemory, store_size, "bloom_load_table",
 			 "tuple bloom part");
 		free(bloom);
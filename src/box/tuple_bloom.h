@@ -35,6 +35,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "salad/bloom.h"
+#include "salad/ribbon.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -43,6 +44,35 @@ extern "C" {
 struct tuple;
 struct key_def;
 
+/** Type of filters a tuple bloom filter consists of. */
+enum tuple_bloom_type {
+	/** Classic blocked bloom filter, see salad/bloom.h. */
+	TUPLE_BLOOM_CLASSIC,
+	/**
+	 * Split block bloom filter, see bloom_split_create().
+	 * Takes a bit more memory than the classic one, but is
+	 * faster to check, especially if AVX2 is enabled.
+	 */
+	TUPLE_BLOOM_SPLIT_BLOCK,
+	/**
+	 * Ribbon filter, see salad/ribbon.h. Takes about 25% less
+	 * memory than the classic bloom filter, but is slower to
+	 * build and check.
+	 */
+	TUPLE_BLOOM_RIBBON,
+	tuple_bloom_type_MAX
+};
+
+extern const char *tuple_bloom_type_strs[];
+
+/** Filter storing hashes of a partial key. */
+union tuple_bloom_part {
+	/** TUPLE_BLOOM_CLASSIC and TUPLE_BLOOM_SPLIT_BLOCK. */
+	struct bloom bloom;
+	/** TUPLE_BLOOM_RIBBON. */
+	struct ribbon ribbon;
+};
+
 /**
  * Tuple bloom filter.
  *
@@ -58,10 +88,12 @@ struct tuple_bloom {
 	 * (see tuple_bloom_decode_legacy).
 	 */
 	bool is_legacy;
+	/** Type of the filters. Legacy bloom filters are classic. */
+	enum tuple_bloom_type type;
 	/** Number of key parts. */
 	uint32_t part_count;
-	/** Array of bloom filters, one per each partial key. */
-	struct bloom parts[0];
+	/** Array of filters, one per each partial key. */
+	union tuple_bloom_part parts[0];
 };
 
 /**
@@ -153,11 +185,13 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
 /**
  * Create a new tuple bloom filter.
  * @param builder - bloom filter builder
+ * @param type - type of the filter
  * @param fpr - desired false positive rate
- * @return bloom filter on success or NULL on OOM
+ * @return bloom filter on success or NULL on error (diag is set)
  */
 struct tuple_bloom *
-tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr);
+tuple_bloom_new(struct tuple_bloom_builder *builder,
+		enum tuple_bloom_type type, double fpr);
 
 /**
  * Delete a tuple bloom filter.
@@ -201,6 +235,25 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 size_t
 tuple_bloom_size(const struct tuple_bloom *bloom);
 
+/**
+ * Return the version of the format a tuple bloom filter is encoded
+ * in by tuple_bloom_encode().
+ *
+ * Classic bloom filters are encoded in the original format
+ * (version 1), which can be decoded with tuple_bloom_decode(),
+ * so that they can be read by older versions. Other filters are
+ * encoded in version 2, which stores the filter type and must be
+ * decoded with tuple_bloom_decode_v2().
+ *
+ * @param bloom - bloom filter
+ * @return format version
+ */
+static inline int
+tuple_bloom_encode_version(const struct tuple_bloom *bloom)
+{
+	return bloom->type == TUPLE_BLOOM_CLASSIC ? 1 : 2;
+}
+
 /**
  * Encode a tuple bloom filter in MsgPack.
  * @param bloom - bloom filter
@@ -211,7 +264,7 @@ char *
 tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf);
 
 /**
- * Decode a tuple bloom filter from MsgPack.
+ * Decode a tuple bloom filter from MsgPack (format version 1).
  * @param data - pointer to buffer storing encoded bloom filter;
  *  on success it is advanced by the number of decoded bytes
  * @return the decoded bloom on success or NULL on OOM
@@ -219,6 +272,15 @@ tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf);
 struct tuple_bloom *
 tuple_bloom_decode(const char **data);
 
+/**
+ * Decode a tuple bloom filter from MsgPack (format version 2).
+ * @param data - pointer to buffer storing encoded bloom filter;
+ *  on success it is advanced by the number of decoded bytes
+ * @return the decoded bloom on success or NULL on error
+ */
+struct tuple_bloom *
+tuple_bloom_decode_v2(const char **data);
+
 /**
  * Decode a legacy bloom filter from MsgPack.
  * @param data - pointer to buffer storing encoded bloom filter;
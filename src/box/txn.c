@@ -42,6 +42,7 @@
 #include "session.h"
 #include "wal_ext.h"
 #include "rmean.h"
+#include "sql_stmt_cache.h"
 
 double too_long_threshold;
 
@@ -272,6 +273,8 @@ txn_add_redo(struct txn *txn, struct txn_stmt *stmt, struct request *request)
 	 */
 	struct space *space = stmt->space;
 	row->group_id = space != NULL ? space_group_id(space) : 0;
+	if (txn_has_flag(txn, TXN_FORCE_LOCAL))
+		row->group_id = GROUP_LOCAL;
 	if (space != NULL && space->wal_ext != NULL)
 		space_wal_ext_process_request(space->wal_ext, stmt, request);
 	struct region *txn_region = tx_region_acquire(txn);
@@ -713,6 +716,8 @@ txn_complete_fail(struct txn *txn)
 		/* Commit won't happen after rollback. */
 		trigger_destroy(&txn->on_commit);
 	}
+	if (txn->is_schema_changed)
+		sql_plan_cache_expire();
 	txn_free_or_wakeup(txn);
 	rmean_collect(rmean_box, IPROTO_ROLLBACK, 1);
 }
@@ -742,6 +747,8 @@ txn_complete_success(struct txn *txn)
 		/* Rollback won't happen after commit. */
 		trigger_destroy(&txn->on_rollback);
 	}
+	if (txn->is_schema_changed)
+		sql_plan_cache_expire();
 	txn_free_or_wakeup(txn);
 	rmean_collect(rmean_box, IPROTO_COMMIT, 1);
 }
@@ -106,6 +106,12 @@ enum txn_flag {
 	 * rolled back at commit.
 	 */
 	TXN_IS_ABORTED_BY_TIMEOUT = 0x100,
+	/**
+	 * All rows of the transaction are written to WAL as local
+	 * ones and aren't replicated. Used when a replica resyncs
+	 * its data with the master.
+	 */
+	TXN_FORCE_LOCAL = 0x200,
 };
 
 enum {
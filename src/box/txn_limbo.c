@@ -28,6 +28,8 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <limits.h>
+
 #include "txn.h"
 #include "txn_limbo.h"
 #include "replication.h"
@@ -52,6 +54,7 @@ txn_limbo_create(struct txn_limbo *limbo)
 	limbo->promote_greatest_term = 0;
 	latch_create(&limbo->promote_latch);
 	limbo->confirmed_lsn = 0;
+	limbo->is_in_confirm = false;
 	limbo->rollback_count = 0;
 	limbo->is_in_rollback = false;
 	limbo->svp_confirmed_lsn = -1;
@@ -421,19 +424,6 @@ txn_limbo_write_synchro(struct txn_limbo *limbo, uint16_t type, int64_t lsn,
 	synchro_request_write(&req);
 }
 
-/**
- * Write a confirmation entry to WAL. After it's written all the
- * transactions waiting for confirmation may be finished.
- */
-static void
-txn_limbo_write_confirm(struct txn_limbo *limbo, int64_t lsn)
-{
-	assert(lsn > limbo->confirmed_lsn);
-	assert(!limbo->is_in_rollback);
-	limbo->confirmed_lsn = lsn;
-	txn_limbo_write_synchro(limbo, IPROTO_RAFT_CONFIRM, lsn, 0);
-}
-
 /** Confirm all the entries <= @a lsn. */
 static void
 txn_limbo_read_confirm(struct txn_limbo *limbo, int64_t lsn)
@@ -507,6 +497,91 @@ txn_limbo_read_confirm(struct txn_limbo *limbo, int64_t lsn)
 		limbo->confirmed_lsn = lsn;
 }
 
+enum {
+	/**
+	 * Max number of CONFIRM entries written by the fiber which collected
+	 * a quorum. That's usually an applier or relay fiber delivering acks,
+	 * so it must not be held by the limbo for too long.
+	 */
+	TXN_LIMBO_CONFIRM_WRITES_MAX = 4,
+};
+
+/**
+ * Write CONFIRM entries to WAL until confirmed_lsn stops growing, but no more
+ * than @a max_writes of them, waking up the confirmed transactions after each
+ * write. Returns the LSN covered by the last written CONFIRM.
+ */
+static int64_t
+txn_limbo_write_confirms(struct txn_limbo *limbo, int64_t written_lsn,
+			 int max_writes)
+{
+	assert(limbo->is_in_confirm);
+	for (int i = 0; i < max_writes; i++) {
+		if (limbo->confirmed_lsn <= written_lsn)
+			break;
+		/*
+		 * The limbo could be frozen during the previous write. Then the
+		 * not yet written quorums must be collected again. If the
+		 * ownership was lost, the new owner's PROMOTE has finalized the
+		 * queue already.
+		 */
+		if (txn_limbo_is_ro(limbo)) {
+			if (limbo->owner_id == instance_id)
+				limbo->confirmed_lsn = written_lsn;
+			break;
+		}
+		int64_t lsn = limbo->confirmed_lsn;
+		txn_limbo_write_synchro(limbo, IPROTO_RAFT_CONFIRM, lsn, 0);
+		txn_limbo_read_confirm(limbo, lsn);
+		written_lsn = lsn;
+	}
+	return written_lsn;
+}
+
+/** Write the CONFIRM entries left by txn_limbo_confirm(). */
+static int
+txn_limbo_confirm_f(va_list ap)
+{
+	struct txn_limbo *limbo = va_arg(ap, struct txn_limbo *);
+	int64_t written_lsn = va_arg(ap, int64_t);
+	txn_limbo_write_confirms(limbo, written_lsn, INT_MAX);
+	limbo->is_in_confirm = false;
+	return 0;
+}
+
+/**
+ * Confirm all the entries <= @a lsn which gathered a quorum. If another fiber
+ * is writing a CONFIRM already, only bump confirmed_lsn and let the writer
+ * cover it with its next CONFIRM entry. That batches the confirmations when
+ * acks arrive faster than CONFIRM entries are written. The calling fiber
+ * writes a few CONFIRM entries itself and hands the rest over to a new fiber
+ * if the quorums keep coming.
+ */
+static void
+txn_limbo_confirm(struct txn_limbo *limbo, int64_t lsn)
+{
+	assert(lsn > limbo->confirmed_lsn);
+	assert(!limbo->is_in_rollback);
+	int64_t written_lsn = limbo->confirmed_lsn;
+	limbo->confirmed_lsn = lsn;
+	if (limbo->is_in_confirm)
+		return;
+	limbo->is_in_confirm = true;
+	written_lsn = txn_limbo_write_confirms(limbo, written_lsn,
+					       TXN_LIMBO_CONFIRM_WRITES_MAX);
+	if (limbo->confirmed_lsn > written_lsn && !txn_limbo_is_ro(limbo)) {
+		struct fiber *f = fiber_new_system("txn_limbo_confirm",
+						   txn_limbo_confirm_f);
+		if (f != NULL) {
+			fiber_start(f, limbo, written_lsn);
+			return;
+		}
+		diag_log();
+		txn_limbo_write_confirms(limbo, written_lsn, INT_MAX);
+	}
+	limbo->is_in_confirm = false;
+}
+
 /**
  * Write a rollback message to WAL. After it's written all the
  * transactions following the current one and waiting for
@@ -688,8 +763,7 @@ txn_limbo_ack(struct txn_limbo *limbo, uint32_t replica_id, int64_t lsn)
 	}
 	if (confirm_lsn == -1 || confirm_lsn <= limbo->confirmed_lsn)
 		return;
-	txn_limbo_write_confirm(limbo, confirm_lsn);
-	txn_limbo_read_confirm(limbo, confirm_lsn);
+	txn_limbo_confirm(limbo, confirm_lsn);
 }
 
 /**
@@ -1237,10 +1311,8 @@ txn_limbo_on_parameters_change(struct txn_limbo *limbo)
 			assert(confirm_lsn > 0);
 		}
 	}
-	if (confirm_lsn > limbo->confirmed_lsn && !limbo->is_in_rollback) {
-		txn_limbo_write_confirm(limbo, confirm_lsn);
-		txn_limbo_read_confirm(limbo, confirm_lsn);
-	}
+	if (confirm_lsn > limbo->confirmed_lsn && !limbo->is_in_rollback)
+		txn_limbo_confirm(limbo, confirm_lsn);
 	/*
 	 * Wakeup all the others - timed out will rollback. Also
 	 * there can be non-transactional waiters, such as CONFIRM
@@ -161,6 +161,13 @@ struct txn_limbo {
 	 * illegal.
 	 */
 	int64_t confirmed_lsn;
+	/**
+	 * Whether a fiber is writing CONFIRM entries to WAL. Quorums collected
+	 * meanwhile only move confirmed_lsn forward and the writer covers them
+	 * all with its next CONFIRM. So the more acks arrive during one WAL
+	 * write, the more transactions the next CONFIRM confirms.
+	 */
+	bool is_in_confirm;
 	/**
 	 * Total number of performed rollbacks. It used as a guard
 	 * to do some actions assuming all limbo transactions will
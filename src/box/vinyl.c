@@ -263,6 +263,15 @@ vy_info_append_regulator(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "rate_limit", vy_quota_get_rate_limit(r->quota,
 							VY_QUOTA_CONSUMER_TX));
 	info_append_int(h, "blocked_writers", r->quota->n_blocked);
+	info_append_double(h, "write_latency", r->write_latency);
+	info_append_double(h, "write_latency_target", r->write_latency_target);
+	info_append_double(h, "predicted_stall", r->predicted_stall);
+	info_append_int(h, "throttle_count", r->throttle_count);
+
+	struct vy_scheduler_stat *stat = &env->scheduler.stat;
+	info_append_int(h, "partial_dumps", stat->partial_dump_count);
+	info_append_int(h, "carried_over_trees", stat->carry_over_count);
+	info_append_int(h, "carried_over_bytes", stat->carry_over_size);
 	info_table_end(h); /* regulator */
 }
 
@@ -694,6 +703,18 @@ vinyl_space_check_index_def(struct space *space, struct index_def *index_def)
 			 "functional index");
 		return -1;
 	}
+	if (index_def->opts.covering && index_def->iid == 0) {
+		diag_set(ClientError, ER_MODIFY_INDEX,
+			 index_def->name, space_name(space),
+			 "primary index can't be covering");
+		return -1;
+	}
+	if (index_def->opts.covering && key_def->is_multikey) {
+		diag_set(ClientError, ER_MODIFY_INDEX,
+			 index_def->name, space_name(space),
+			 "multikey index can't be covering");
+		return -1;
+	}
 	return 0;
 }
 
@@ -956,6 +977,8 @@ vinyl_index_def_change_requires_rebuild(struct index *index,
 		return true;
 	if (old_def->opts.func_id != new_def->opts.func_id)
 		return true;
+	if (old_def->opts.covering != new_def->opts.covering)
+		return true;
 
 	assert(index_depends_on_pk(index));
 	const struct key_def *old_cmp_def = old_def->cmp_def;
@@ -998,12 +1021,26 @@ vinyl_index_def_change_requires_rebuild(struct index *index,
 static int
 vinyl_space_prepare_alter(struct space *old_space, struct space *new_space)
 {
-	(void)new_space;
 	struct vy_env *env = vy_env(old_space->engine);
 
 	if (vinyl_check_wal(env, "DDL") != 0)
 		return -1;
-
+	/*
+	 * Covering indexes rely on secondary indexes being updated
+	 * along with the primary index, which isn't the case if
+	 * DELETEs are deferred.
+	 */
+	if (!new_space->def->opts.defer_deletes)
+		return 0;
+	for (uint32_t i = 1; i < new_space->index_count; i++) {
+		if (new_space->index[i]->def->opts.covering) {
+			diag_set(ClientError, ER_ALTER_SPACE,
+				 space_name(new_space),
+				 "covering indexes can't be used with "
+				 "defer_deletes");
+			return -1;
+		}
+	}
 	return 0;
 }
 
@@ -1294,6 +1331,20 @@ vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
 	int rc = 0;
 	assert(lsm->index_id > 0);
 
+	if (lsm->opts.covering) {
+		/*
+		 * A covering index stores full tuples and is updated
+		 * along with the primary index so the tuple read from
+		 * it can be returned as is. The read was tracked in
+		 * the secondary index and any overwrite of the tuple
+		 * is written to it so a conflict will be detected.
+		 */
+		assert(!vy_stmt_is_key(entry.stmt));
+		tuple_ref(entry.stmt);
+		*result = entry;
+		return 0;
+	}
+
 	/*
 	 * Lookup the full tuple by a secondary statement.
 	 * There are two cases: the secondary statement may be
@@ -2587,13 +2638,22 @@ vy_env_dump_complete_cb(struct vy_scheduler *scheduler,
 	size_t mem_used_after = lsregion_used(allocator);
 	assert(mem_used_after <= mem_used_before);
 	size_t mem_dumped = mem_used_before - mem_used_after;
+	/*
+	 * Memory freed by in-memory trees carried over to the next
+	 * generation wasn't written to disk so it shouldn't count
+	 * towards dump bandwidth.
+	 */
+	size_t mem_carried_over = MIN(scheduler->carry_over_size, mem_dumped);
+	scheduler->carry_over_size = 0;
 	/*
 	 * In certain corner cases, vy_quota_release() may need
 	 * to trigger a new dump. Notify the regulator about dump
 	 * completion before releasing quota so that it can start
 	 * a new dump immediately.
 	 */
-	vy_regulator_dump_complete(&env->regulator, mem_dumped, dump_duration);
+	vy_regulator_dump_complete(&env->regulator,
+				   mem_dumped - mem_carried_over,
+				   dump_duration);
 	vy_quota_release(quota, mem_dumped);
 
 	vy_regulator_update_rate_limit(&env->regulator, &scheduler->stat,
@@ -2762,6 +2822,14 @@ vinyl_engine_set_timeout(struct engine *engine, double timeout)
 	env->timeout = timeout;
 }
 
+void
+vinyl_engine_set_write_latency_target(struct engine *engine, double target)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_regulator_set_write_latency_target(&env->regulator, target);
+	env->scheduler.partial_dump = target > 0;
+}
+
 void
 vinyl_engine_set_too_long_threshold(struct engine *engine,
 				    double too_long_threshold)
@@ -3723,6 +3791,120 @@ fail:
 	return -1;
 }
 
+/**
+ * Convert a key statement read from a secondary index to a tuple
+ * that has the indexed fields at their places and nils in place
+ * of the other fields.
+ */
+static struct tuple *
+vinyl_partial_tuple_new(struct key_def *cmp_def, struct tuple *stmt)
+{
+	assert(vy_stmt_is_key(stmt));
+	assert(!cmp_def->has_json_paths);
+	uint32_t field_count = 0;
+	for (uint32_t i = 0; i < cmp_def->part_count; i++)
+		field_count = MAX(field_count, cmp_def->parts[i].fieldno + 1);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	const char **fields = region_alloc_array(region, typeof(fields[0]),
+						 field_count, &size);
+	if (fields == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "fields");
+		return NULL;
+	}
+	memset(fields, 0, size);
+	const char *key = tuple_data(stmt);
+	uint32_t part_count = mp_decode_array(&key);
+	assert(part_count <= cmp_def->part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		fields[cmp_def->parts[i].fieldno] = key;
+		mp_next(&key);
+	}
+	size = mp_sizeof_array(field_count) + tuple_bsize(stmt) +
+	       field_count * mp_sizeof_nil();
+	char *data = region_alloc(region, size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc", "data");
+		return NULL;
+	}
+	char *pos = mp_encode_array(data, field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (fields[i] == NULL) {
+			pos = mp_encode_nil(pos);
+			continue;
+		}
+		const char *end = fields[i];
+		mp_next(&end);
+		memcpy(pos, fields[i], end - fields[i]);
+		pos += end - fields[i];
+	}
+	assert(pos <= data + size);
+	struct tuple *tuple = tuple_new(tuple_format_runtime, data, pos);
+	region_truncate(region, region_svp);
+	return tuple;
+}
+
+/**
+ * Implementation of the iterator::next() method of a partial
+ * iterator over a secondary index (see index_vtab). A secondary
+ * index of a space without deferred DELETEs never holds stale
+ * entries and always has up-to-date indexed fields, so a tuple
+ * read from it is returned without a look-up in the primary index.
+ * The tuple cache isn't populated, because it stores full tuples.
+ */
+static int
+vinyl_iterator_partial_next(struct iterator *base, struct tuple **ret)
+{
+	double start_time = ev_monotonic_now(loop());
+
+	assert(base->next == vinyl_iterator_partial_next);
+	struct vinyl_iterator *it = (struct vinyl_iterator *)base;
+	struct vy_lsm *lsm = it->iterator.lsm;
+	assert(lsm->index_id > 0);
+	/*
+	 * Make sure the LSM tree isn't deleted while we are
+	 * reading from it.
+	 */
+	vy_lsm_ref(lsm);
+
+	if (vinyl_iterator_check_tx(it) != 0)
+		goto fail;
+
+	struct vy_entry partial, entry;
+	if (vy_read_iterator_next(&it->iterator, &partial) != 0)
+		goto fail;
+	if (partial.stmt == NULL) {
+		/* EOF. Close the iterator immediately. */
+		vinyl_iterator_account_read(it, start_time, NULL);
+		vinyl_iterator_close(it);
+		*ret = NULL;
+		goto out;
+	}
+	if (vy_stmt_is_key(partial.stmt)) {
+		entry.stmt = vinyl_partial_tuple_new(lsm->cmp_def,
+						     partial.stmt);
+		if (entry.stmt == NULL)
+			goto fail;
+		entry.hint = partial.hint;
+	} else {
+		entry = partial;
+		tuple_ref(entry.stmt);
+	}
+	vinyl_iterator_account_read(it, start_time, entry.stmt);
+	vinyl_iterator_update_pos(it, entry);
+	*ret = entry.stmt;
+	tuple_bless(*ret);
+	tuple_unref(*ret);
+out:
+	vy_lsm_unref(lsm);
+	return 0;
+fail:
+	vinyl_iterator_close(it);
+	vy_lsm_unref(lsm);
+	return -1;
+}
+
 /** Implementation of the iterator::position() method. */
 static int
 vinyl_iterator_position(struct iterator *base, const char **pos, uint32_t *size)
@@ -3839,6 +4021,32 @@ err_key:
 	return NULL;
 }
 
+static struct iterator *
+vinyl_index_create_partial_iterator(struct index *base,
+				    enum iterator_type type,
+				    const char *key, uint32_t part_count)
+{
+	struct iterator *it = vinyl_index_create_iterator(base, type, key,
+							  part_count, NULL);
+	if (it == NULL)
+		return NULL;
+	struct vy_lsm *lsm = vy_lsm(base);
+	struct key_def *cmp_def = lsm->cmp_def;
+	if (vy_lsm_stores_tuples(lsm) || cmp_def->is_multikey ||
+	    cmp_def->for_func_index || cmp_def->has_json_paths)
+		return it;
+	/*
+	 * A secondary index may hold stale entries if DELETEs
+	 * are deferred so we have to check them against the
+	 * primary index.
+	 */
+	struct space *space = space_by_id(lsm->space_id);
+	if (space == NULL || space->def->opts.defer_deletes)
+		return it;
+	it->next = vinyl_iterator_partial_next;
+	return it;
+}
+
 static int
 vinyl_index_get(struct index *index, const char *key,
 		uint32_t part_count, struct tuple **ret)
@@ -4658,6 +4866,8 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .get = */ vinyl_index_get,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
+	/* .create_partial_iterator = */
+		vinyl_index_create_partial_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
 	/* .stat = */ vinyl_index_stat,
 	/* .compact = */ vinyl_index_compact,
@@ -75,6 +75,13 @@ vinyl_engine_set_max_tuple_size(struct engine *engine, size_t max_size);
 void
 vinyl_engine_set_timeout(struct engine *engine, double timeout);
 
+/**
+ * Update write latency target. A positive value enables
+ * partial dumps and latency-based regulation of writes.
+ */
+void
+vinyl_engine_set_write_latency_target(struct engine *engine, double target);
+
 /**
  * Update too_long_threshold.
  */
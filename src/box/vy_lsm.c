@@ -31,6 +31,7 @@
 #include "vy_lsm.h"
 
 #include "trivia/util.h"
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <sys/stat.h>
@@ -145,11 +146,12 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 
 	lsm->cmp_def = cmp_def;
 	lsm->key_def = key_def;
-	if (index_def->iid == 0) {
+	if (index_def->iid == 0 || index_def->opts.covering) {
 		/*
 		 * Disk tuples can be returned to an user from a
-		 * primary key. And they must have field
-		 * definitions as well as space->format tuples.
+		 * primary key or a covering secondary key. And they
+		 * must have field definitions as well as
+		 * space->format tuples.
 		 */
 		lsm->disk_format = format;
 	} else {
@@ -161,7 +163,8 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 		 * up a full tuple in the primary index.
 		 */
 		lsm->disk_format = lsm_env->key_format;
-
+	}
+	if (index_def->iid > 0) {
 		lsm->pk_in_cmp_def = key_def_find_pk_in_cmp_def(lsm->cmp_def,
 								pk->key_def,
 								&fiber()->gc);
@@ -872,6 +875,73 @@ vy_lsm_delete_mem(struct vy_lsm *lsm, struct vy_mem *mem)
 	lsm->mem_list_version++;
 }
 
+int
+vy_lsm_carry_over_mem(struct vy_lsm *lsm, size_t *copied)
+{
+	struct vy_mem *old_mem = lsm->mem;
+	assert(rlist_empty(&lsm->sealed));
+	assert(old_mem->pin_count == 0);
+
+	struct lsregion *allocator = &old_mem->env->allocator;
+	size_t mem_used_before = lsregion_used(allocator);
+	struct vy_mem *new_mem = vy_mem_new(old_mem->env, lsm->cmp_def,
+					    old_mem->format,
+					    *lsm->env->p_generation,
+					    old_mem->space_cache_version);
+	if (new_mem == NULL) {
+		*copied = 0;
+		return -1;
+	}
+	int rc = vy_mem_copy(new_mem, old_mem);
+	size_t mem_used_after = lsregion_used(allocator);
+	assert(mem_used_after >= mem_used_before);
+	*copied = mem_used_after - mem_used_before;
+	if (rc != 0) {
+		/*
+		 * The memory allocated for the partial copy can't
+		 * be freed until the current generation is dumped.
+		 */
+		vy_mem_delete(new_mem);
+		return -1;
+	}
+
+	vy_stmt_counter_sub(&lsm->stat.memory.count, &old_mem->count);
+	vy_stmt_counter_add(&lsm->stat.memory.count, &new_mem->count);
+	vy_mem_delete(old_mem);
+	lsm->mem = new_mem;
+	lsm->mem_list_version++;
+	lsm->carry_over_count++;
+	return 0;
+}
+
+/**
+ * Time window over which the write rate of an LSM tree is
+ * averaged, in seconds.
+ */
+static const double VY_LSM_WRITE_RATE_AVG_WIN = 5;
+
+/**
+ * Decay the write rate of an LSM tree to the current time.
+ * The rate is updated lazily, on write or read, so that idle
+ * LSM trees don't cost anything.
+ */
+static void
+vy_lsm_decay_write_rate(struct vy_lsm *lsm, double now)
+{
+	double elapsed = now - lsm->write_rate_time;
+	if (elapsed > 0) {
+		lsm->write_rate *= exp(-elapsed / VY_LSM_WRITE_RATE_AVG_WIN);
+		lsm->write_rate_time = now;
+	}
+}
+
+double
+vy_lsm_write_rate(struct vy_lsm *lsm)
+{
+	vy_lsm_decay_write_rate(lsm, ev_monotonic_now(loop()));
+	return lsm->write_rate;
+}
+
 int
 vy_lsm_set(struct vy_lsm *lsm, struct vy_mem *mem,
 	   struct vy_entry entry, struct tuple **region_stmt)
@@ -1001,6 +1071,9 @@ vy_lsm_commit_stmt(struct vy_lsm *lsm, struct vy_mem *mem,
 
 	vy_stmt_counter_acct_tuple(&lsm->stat.put, entry.stmt);
 
+	vy_lsm_decay_write_rate(lsm, ev_monotonic_now(loop()));
+	lsm->write_rate += tuple_size(entry.stmt) / VY_LSM_WRITE_RATE_AVG_WIN;
+
 	/* Invalidate cache element. */
 	vy_cache_on_write(&lsm->cache, entry, NULL);
 }
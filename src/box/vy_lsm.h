@@ -160,6 +160,12 @@ vy_lsm_env_destroy(struct vy_lsm_env *env);
  *   maintain a secondary index, but adds an extra look-up in the
  *   primary key for every fetched tuple.
  *
+ * - a covering secondary index (the 'covering' index option)
+ *   stores full tuples, like the primary index. Since deferred
+ *   DELETEs are disabled for spaces with covering indexes, such
+ *   an index is always in sync with the primary index and reads
+ *   from it skip the primary index look-up.
+ *
  * When a search in a secondary index is made, we first look up
  * the secondary index tuple, containing the primary key, and then
  * use this key to find the original tuple in the primary index.
@@ -301,6 +307,21 @@ struct vy_lsm {
 	int pin_count;
 	/** Set if the LSM tree is currently being dumped. */
 	bool is_dumping;
+	/**
+	 * Number of dump rounds in a row that carried the active
+	 * in-memory tree of this LSM tree over to the next generation
+	 * instead of dumping it, see vy_lsm_carry_over_mem().
+	 */
+	int carry_over_count;
+	/**
+	 * Exponentially decaying average of the rate at which
+	 * statements are committed to this LSM tree, in bytes per
+	 * second, as of @write_rate_time. Use vy_lsm_write_rate()
+	 * to get the current value.
+	 */
+	double write_rate;
+	/** Time of the last update of @write_rate. */
+	double write_rate_time;
 	/** Link in vy_scheduler->dump_heap. */
 	struct heap_node in_dump;
 	/** Link in vy_scheduler->compaction_heap. */
@@ -361,6 +382,16 @@ vy_lsm_is_empty(struct vy_lsm *lsm)
 		lsm->stat.memory.count.rows == 0);
 }
 
+/**
+ * Return true if the LSM tree stores full tuples on disk, i.e.
+ * it is either a primary index or a covering secondary index.
+ */
+static inline bool
+vy_lsm_stores_tuples(struct vy_lsm *lsm)
+{
+	return lsm->index_id == 0 || lsm->opts.covering;
+}
+
 /**
  * Return true if LSM tree is currently being built
  * (i.e. index_commit_create() hasn't been called yet).
@@ -560,6 +591,28 @@ vy_lsm_rotate_mem_if_required(struct vy_lsm *lsm);
 void
 vy_lsm_delete_mem(struct vy_lsm *lsm, struct vy_mem *mem);
 
+/**
+ * Replace the active in-memory tree of an LSM tree with a copy
+ * allocated at the current generation and delete the original.
+ * Used to exclude an LSM tree from a dump round so that the memory
+ * occupied by the original tree can be freed without writing it
+ * to disk. The LSM tree must not have sealed in-memory trees and
+ * the active in-memory tree must not be pinned.
+ *
+ * Returns 0 on success, -1 on memory error, in which case the LSM
+ * tree is left intact. In either case @copied is set to the number
+ * of bytes of memory allocated for the copy.
+ */
+int
+vy_lsm_carry_over_mem(struct vy_lsm *lsm, size_t *copied);
+
+/**
+ * Return the rate at which statements have been committed to
+ * an LSM tree recently, in bytes per second.
+ */
+double
+vy_lsm_write_rate(struct vy_lsm *lsm);
+
 /**
  * Lookup ranges intersecting [min_key, max_key] interval in
  * the given LSM tree.
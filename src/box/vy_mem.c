@@ -271,6 +271,37 @@ vy_mem_rollback_stmt(struct vy_mem *mem, struct vy_entry entry)
 	mem->version++;
 }
 
+int
+vy_mem_copy(struct vy_mem *dst, struct vy_mem *src)
+{
+	assert(src->pin_count == 0);
+	assert(dst->count.rows == 0);
+	assert(dst->format == src->format);
+	struct vy_mem_tree_iterator itr = vy_mem_tree_first(&src->tree);
+	while (!vy_mem_tree_iterator_is_invalid(&itr)) {
+		struct vy_entry entry;
+		entry = *vy_mem_tree_iterator_get_elem(&src->tree, &itr);
+		entry.stmt = vy_stmt_dup_lsregion(entry.stmt,
+						  &dst->env->allocator,
+						  dst->generation);
+		if (entry.stmt == NULL)
+			return -1;
+		if (vy_mem_tree_insert(&dst->tree, entry, NULL, NULL) != 0)
+			return -1;
+		/*
+		 * Unlike vy_mem_insert(), don't account the memory
+		 * wasted by rolled back statements, because those
+		 * aren't copied.
+		 */
+		dst->count.rows++;
+		dst->count.bytes += tuple_size(entry.stmt);
+		vy_mem_tree_iterator_next(&src->tree, &itr);
+	}
+	dst->dump_lsn = MAX(dst->dump_lsn, src->dump_lsn);
+	dst->version++;
+	return 0;
+}
+
 /* }}} vy_mem */
 
 /* {{{ vy_mem_iterator support functions */
@@ -317,6 +317,24 @@ vy_mem_commit_stmt(struct vy_mem *mem, struct vy_entry entry);
 void
 vy_mem_rollback_stmt(struct vy_mem *mem, struct vy_entry entry);
 
+/**
+ * Copy all statements stored in an in-memory level to another,
+ * empty one. The statements are allocated anew, at the generation
+ * of the destination tree, so that the source tree can be deleted
+ * and its memory freed without dumping it to disk.
+ *
+ * The source tree must not be pinned, i.e. there must not be any
+ * prepared statements in it.
+ *
+ * @param dst Mem to copy to.
+ * @param src Mem to copy from.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+vy_mem_copy(struct vy_mem *dst, struct vy_mem *src);
+
 /**
  * Iterator for in-memory level.
  *
@@ -237,6 +237,8 @@ vy_quota_create(struct vy_quota *q, size_t limit,
 		vy_rate_limit_create(&q->rate_limit[i]);
 	ev_timer_init(&q->timer, vy_quota_timer_cb, 0, VY_QUOTA_TIMER_PERIOD);
 	q->timer.data = q;
+	if (latency_create(&q->wait_latency) != 0)
+		panic("failed to allocate vinyl quota wait latency counter");
 }
 
 void
@@ -252,6 +254,7 @@ void
 vy_quota_destroy(struct vy_quota *q)
 {
 	ev_timer_stop(loop(), &q->timer);
+	latency_destroy(&q->wait_latency);
 }
 
 void
@@ -326,6 +329,8 @@ vy_quota_use(struct vy_quota *q, enum vy_quota_consumer_type type,
 	if (rlist_empty(&q->wait_queue[type]) &&
 	    vy_quota_may_use(q, type, size)) {
 		vy_quota_do_use(q, type, size);
+		if (type == VY_QUOTA_CONSUMER_TX)
+			latency_collect(&q->wait_latency, 0);
 		return 0;
 	}
 
@@ -343,11 +348,15 @@ vy_quota_use(struct vy_quota *q, enum vy_quota_consumer_type type,
 	rlist_del_entry(&wait_node, in_wait_queue);
 
 	if (timed_out) {
+		if (type == VY_QUOTA_CONSUMER_TX)
+			latency_collect(&q->wait_latency, timeout);
 		diag_set(ClientError, ER_VY_QUOTA_TIMEOUT);
 		return -1;
 	}
 
 	double wait_time = ev_monotonic_now(loop()) - wait_start;
+	if (type == VY_QUOTA_CONSUMER_TX)
+		latency_collect(&q->wait_latency, wait_time);
 	if (wait_time > q->too_long_threshold) {
 		say_warn_ratelimited("waited for %zu bytes of vinyl memory "
 				     "quota for too long: %.3f sec", size,
@@ -37,6 +37,7 @@
 #include <small/rlist.h>
 #include <tarantool_ev.h>
 
+#include "latency.h"
 #include "trivia/util.h"
 
 #if defined(__cplusplus)
@@ -219,6 +220,12 @@ struct vy_quota {
 	 * limit value.
 	 */
 	ev_timer timer;
+	/**
+	 * Time transactions spent waiting for quota, including
+	 * those that didn't have to wait at all. Reset by the
+	 * regulator periodically.
+	 */
+	struct latency wait_latency;
 };
 
 /**
@@ -280,32 +280,24 @@ vy_range_remove_slice(struct vy_range *range, struct vy_slice *slice)
  * compaction is relatively cheap, because of the level size
  * ratio.
  *
+ * The leveled compaction strategy works in the same way, but never
+ * allows more than one run per level, no matter what
+ * run_count_per_level is, thus bounding read amplification by
+ * the number of levels.
+ *
  * Given a range, this function computes the maximal level that needs
  * to be compacted and sets @compaction_priority to the number of runs
  * in this level and all preceding levels.
  */
-void
-vy_range_update_compaction_priority(struct vy_range *range,
-				    const struct index_opts *opts)
+static void
+vy_range_update_compaction_priority_tiered(struct vy_range *range,
+					   const struct index_opts *opts)
 {
 	assert(opts->run_count_per_level > 0);
 	assert(opts->run_size_ratio > 1);
 
-	range->compaction_priority = 0;
-	vy_disk_stmt_counter_reset(&range->compaction_queue);
-
-	if (range->slice_count <= 1) {
-		/* Nothing to compact. */
-		range->needs_compaction = false;
-		return;
-	}
-
-	if (range->needs_compaction) {
-		range->compaction_priority = range->slice_count;
-		range->compaction_queue = range->count;
-		return;
-	}
-
+	bool is_leveled = (opts->compaction_strategy ==
+			   COMPACTION_STRATEGY_LEVELED);
 	/* Total number of statements in checked runs. */
 	struct vy_disk_stmt_counter total_stmt_count;
 	vy_disk_stmt_counter_reset(&total_stmt_count);
@@ -398,10 +390,16 @@ vy_range_update_compaction_priority(struct vy_range *range,
 		 * this function is called on every memory dump and
 		 * scans all LSM tree levels. Instead we use the
 		 * value of rand() from the slice creation time.
+		 *
+		 * Leveled compaction doesn't do that, because it
+		 * must keep at most one run per level.
 		 */
-		uint32_t max_run_count = opts->run_count_per_level;
-		if (slice->seed < RAND_MAX / 10)
-			max_run_count++;
+		uint32_t max_run_count = 1;
+		if (!is_leveled) {
+			max_run_count = opts->run_count_per_level;
+			if (slice->seed < RAND_MAX / 10)
+				max_run_count++;
+		}
 		if (level_run_count > max_run_count) {
 			/*
 			 * The number of runs at the current level
@@ -425,6 +423,131 @@ vy_range_update_compaction_priority(struct vy_range *range,
 	}
 }
 
+/** Return the time window a slice belongs to. */
+static inline uint64_t
+vy_slice_time_window(struct vy_slice *slice, const struct index_opts *opts)
+{
+	return (uint64_t)(slice->run->info.dump_time /
+			  opts->compaction_time_window);
+}
+
+/**
+ * Schedule compaction of a group of runs that belong to the same
+ * time window unless a bigger group has already been scheduled.
+ *
+ * @param range      The range.
+ * @param opts       Index options.
+ * @param start      Number of runs newer than the group.
+ * @param run_count  Number of runs in the group.
+ * @param stmt_count Number of statements in the group.
+ */
+static void
+vy_range_check_time_window(struct vy_range *range,
+			   const struct index_opts *opts,
+			   int start, int run_count,
+			   const struct vy_disk_stmt_counter *stmt_count)
+{
+	/*
+	 * The newest window may still receive new runs so compact
+	 * it only if there are too many runs in it. Older windows
+	 * are over so each of them is compacted into one run.
+	 */
+	int max_run_count = start == 0 ? opts->run_count_per_level : 1;
+	if (run_count > max_run_count &&
+	    run_count > range->compaction_priority) {
+		range->compaction_skip = start;
+		range->compaction_priority = run_count;
+		range->compaction_queue = *stmt_count;
+	}
+}
+
+/**
+ * The time window compaction strategy splits runs into groups
+ * by the time they were dumped, see vy_run_info::dump_time. Each
+ * group spans compaction_time_window seconds. Runs that belong
+ * to different windows are never compacted together, which
+ * keeps write amplification low for time series workloads,
+ * where old data is rarely overwritten.
+ *
+ * Runs of the most recent window are compacted as soon as their
+ * number exceeds run_count_per_level. A window that is over,
+ * i.e. has a newer window above it, is compacted into a single
+ * run so that the total number of runs is proportional to the
+ * number of windows.
+ *
+ * Since the runs of a window may be older than the newest run,
+ * this function may set @compaction_skip to make the scheduler
+ * leave the newest runs intact.
+ */
+static void
+vy_range_update_compaction_priority_time_window(struct vy_range *range,
+						const struct index_opts *opts)
+{
+	assert(opts->run_count_per_level > 0);
+	assert(opts->compaction_time_window > 0);
+
+	/* Number of checked runs. */
+	int total_run_count = 0;
+	/* Position, size and window of the current group of runs. */
+	int group_start = 0;
+	int group_run_count = 0;
+	uint64_t group_window = 0;
+	struct vy_disk_stmt_counter group_stmt_count;
+	vy_disk_stmt_counter_reset(&group_stmt_count);
+
+	struct vy_slice *slice;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		uint64_t window = vy_slice_time_window(slice, opts);
+		if (group_run_count > 0 && window != group_window) {
+			vy_range_check_time_window(range, opts, group_start,
+						   group_run_count,
+						   &group_stmt_count);
+			group_start = total_run_count;
+			group_run_count = 0;
+			vy_disk_stmt_counter_reset(&group_stmt_count);
+		}
+		group_window = window;
+		group_run_count++;
+		total_run_count++;
+		vy_disk_stmt_counter_add(&group_stmt_count, &slice->count);
+	}
+	vy_range_check_time_window(range, opts, group_start,
+				   group_run_count, &group_stmt_count);
+}
+
+void
+vy_range_update_compaction_priority(struct vy_range *range,
+				    const struct index_opts *opts)
+{
+	range->compaction_priority = 0;
+	range->compaction_skip = 0;
+	vy_disk_stmt_counter_reset(&range->compaction_queue);
+
+	if (range->slice_count <= 1) {
+		/* Nothing to compact. */
+		range->needs_compaction = false;
+		return;
+	}
+
+	if (range->needs_compaction) {
+		range->compaction_priority = range->slice_count;
+		range->compaction_queue = range->count;
+		return;
+	}
+
+	switch (opts->compaction_strategy) {
+	case COMPACTION_STRATEGY_TIERED:
+	case COMPACTION_STRATEGY_LEVELED:
+		vy_range_update_compaction_priority_tiered(range, opts);
+		break;
+	case COMPACTION_STRATEGY_TIME_WINDOW:
+		vy_range_update_compaction_priority_time_window(range, opts);
+		break;
+	default:
+		unreachable();
+	}
+}
+
 void
 vy_range_update_dumps_per_compaction(struct vy_range *range)
 {
@@ -107,6 +107,14 @@ struct vy_range {
 	 * how we  decide how many runs to compact next time.
 	 */
 	int compaction_priority;
+	/**
+	 * Number of the newest runs the next compaction of this
+	 * range will leave intact. Normally, it is 0, i.e. the
+	 * newest runs are always taken in, but the time window
+	 * compaction strategy may need to compact older runs only
+	 * so as not to mix runs from different time windows.
+	 */
+	int compaction_skip;
 	/** Number of statements that need to be compacted. */
 	struct vy_disk_stmt_counter compaction_queue;
 	/**
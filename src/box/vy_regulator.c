@@ -39,6 +39,7 @@
 
 #include "fiber.h"
 #include "histogram.h"
+#include "latency.h"
 #include "say.h"
 #include "trivia/util.h"
 
@@ -83,6 +84,26 @@ static const size_t VY_DUMP_SIZE_ACCT_MIN = 1024 * 1024;
  */
 static const int VY_RECENT_DUMP_COUNT = 100;
 
+/**
+ * Write latency percentile that is compared against the target.
+ */
+static const int VY_WRITE_LATENCY_PCT = 99;
+
+/**
+ * Min value of the dump watermark factor, see the comment to
+ * vy_regulator::dump_watermark_factor.
+ */
+static const double VY_DUMP_WATERMARK_FACTOR_MIN = 0.5;
+
+/**
+ * Steps by which the dump watermark factor is decreased when
+ * write latency exceeds the target and increased when it's well
+ * below the target. We lower the watermark quickly and raise it
+ * back slowly, because long stalls hurt more than extra dumps.
+ */
+static const double VY_DUMP_WATERMARK_FACTOR_DEC = 0.8;
+static const double VY_DUMP_WATERMARK_FACTOR_INC = 1.05;
+
 static void
 vy_regulator_trigger_dump(struct vy_regulator *regulator)
 {
@@ -93,6 +114,8 @@ vy_regulator_trigger_dump(struct vy_regulator *regulator)
 		return;
 
 	regulator->dump_in_progress = true;
+	regulator->dump_eta = ev_monotonic_now(loop()) +
+		(double)regulator->quota->used / (regulator->dump_bandwidth + 1);
 
 	/*
 	 * To avoid unpredictably long stalls, we must limit
@@ -187,6 +210,75 @@ vy_regulator_update_dump_watermark(struct vy_regulator *regulator)
 	 */
 	regulator->dump_watermark = MAX(regulator->dump_watermark,
 					quota->limit / 2);
+	regulator->dump_watermark *= regulator->dump_watermark_factor;
+}
+
+/**
+ * Update the write latency percentile and adjust the dump watermark
+ * factor so as to keep the latency below the target. If the latency
+ * is too high, memory dumps are started earlier, which gives them
+ * more time to complete before the memory limit is hit.
+ */
+static void
+vy_regulator_update_write_latency(struct vy_regulator *regulator)
+{
+	struct latency *wait_latency = &regulator->quota->wait_latency;
+	regulator->write_latency = latency_get(wait_latency,
+					       VY_WRITE_LATENCY_PCT);
+	latency_reset(wait_latency);
+
+	double target = regulator->write_latency_target;
+	if (target == 0)
+		return;
+	double factor = regulator->dump_watermark_factor;
+	if (regulator->write_latency > target)
+		factor *= VY_DUMP_WATERMARK_FACTOR_DEC;
+	else if (regulator->write_latency < target / 2)
+		factor *= VY_DUMP_WATERMARK_FACTOR_INC;
+	factor = MAX(factor, VY_DUMP_WATERMARK_FACTOR_MIN);
+	factor = MIN(factor, 1);
+	regulator->dump_watermark_factor = factor;
+}
+
+/**
+ * Predict how long transactions will be blocked by hitting the
+ * memory limit before the memory dump in progress completes and,
+ * if the predicted stall exceeds the write latency target, lower
+ * the rate limit so that the memory left lasts till the end of the
+ * dump. This way the delay is evenly spread among all transactions
+ * rather than suffered by a few unlucky ones that happened to hit
+ * the limit.
+ */
+static void
+vy_regulator_predict_stall(struct vy_regulator *regulator)
+{
+	regulator->predicted_stall = 0;
+	if (!regulator->dump_in_progress)
+		return;
+	double dump_left = regulator->dump_eta - ev_monotonic_now(loop());
+	if (dump_left <= 0) {
+		/*
+		 * The dump takes longer than expected. There's
+		 * nothing we can predict.
+		 */
+		return;
+	}
+	struct vy_quota *quota = regulator->quota;
+	size_t mem_left = (quota->used < quota->limit ?
+			   quota->limit - quota->used : 0);
+	double time_left = (double)mem_left / (regulator->write_rate + 1);
+	regulator->predicted_stall = MAX(dump_left - time_left, 0);
+
+	double target = regulator->write_latency_target;
+	if (target == 0 || regulator->predicted_stall <= target)
+		return;
+	size_t max_write_rate = mem_left / dump_left;
+	if (max_write_rate < vy_quota_get_rate_limit(quota,
+						     VY_QUOTA_CONSUMER_TX)) {
+		vy_quota_set_rate_limit(quota, VY_QUOTA_RESOURCE_MEMORY,
+					max_write_rate);
+		regulator->throttle_count++;
+	}
 }
 
 static void
@@ -198,8 +290,10 @@ vy_regulator_timer_cb(ev_loop *loop, ev_timer *timer, int events)
 	struct vy_regulator *regulator = timer->data;
 
 	vy_regulator_update_write_rate(regulator);
+	vy_regulator_update_write_latency(regulator);
 	vy_regulator_update_dump_watermark(regulator);
 	vy_regulator_check_dump_watermark(regulator);
+	vy_regulator_predict_stall(regulator);
 }
 
 void
@@ -230,6 +324,7 @@ vy_regulator_create(struct vy_regulator *regulator, struct vy_quota *quota,
 	regulator->timer.data = regulator;
 	regulator->dump_bandwidth = VY_DUMP_BANDWIDTH_DEFAULT;
 	regulator->dump_watermark = SIZE_MAX;
+	regulator->dump_watermark_factor = 1;
 }
 
 void
@@ -305,6 +400,17 @@ vy_regulator_set_memory_limit(struct vy_regulator *regulator, size_t limit)
 	vy_regulator_update_dump_watermark(regulator);
 }
 
+void
+vy_regulator_set_write_latency_target(struct vy_regulator *regulator,
+				      double target)
+{
+	regulator->write_latency_target = target;
+	if (target == 0 && regulator->dump_watermark_factor != 1) {
+		regulator->dump_watermark_factor = 1;
+		vy_regulator_update_dump_watermark(regulator);
+	}
+}
+
 void
 vy_regulator_reset_dump_bandwidth(struct vy_regulator *regulator, size_t max)
 {
@@ -114,6 +114,40 @@ struct vy_regulator {
 	 * but vy_regulator_dump_complete() hasn't been called yet.
 	 */
 	bool dump_in_progress;
+	/**
+	 * Time when the memory dump in progress is expected to
+	 * complete, given the current dump bandwidth estimate.
+	 */
+	double dump_eta;
+	/**
+	 * Target for the 99th percentile of time transactions
+	 * spend waiting for memory quota, in seconds, or 0 if
+	 * write latency isn't regulated.
+	 */
+	double write_latency_target;
+	/**
+	 * 99th percentile of time transactions spent waiting for
+	 * memory quota during the last timer period, in seconds.
+	 */
+	double write_latency;
+	/**
+	 * The dump watermark is multiplied by this factor so as
+	 * to start memory dumps earlier if write latency exceeds
+	 * the target. Always 1 if the target isn't set.
+	 */
+	double dump_watermark_factor;
+	/**
+	 * Time transactions are expected to be blocked by hitting
+	 * the memory limit before the memory dump in progress
+	 * completes, in seconds, as predicted the last time the
+	 * timer was executed.
+	 */
+	double predicted_stall;
+	/**
+	 * Number of times the rate limit was lowered, because the
+	 * predicted stall exceeded the write latency target.
+	 */
+	int64_t throttle_count;
 	/**
 	 * Snapshot of scheduler statistics taken at the time of
 	 * the last rate limit update.
@@ -162,6 +196,14 @@ vy_regulator_dump_complete(struct vy_regulator *regulator,
 void
 vy_regulator_set_memory_limit(struct vy_regulator *regulator, size_t limit);
 
+/**
+ * Set the target for the 99th percentile of write latency,
+ * in seconds. Zero disables latency-based regulation.
+ */
+void
+vy_regulator_set_write_latency_target(struct vy_regulator *regulator,
+				      double target);
+
 /**
  * Reset dump bandwidth histogram and update initial estimate.
  * Called when box.cfg.snap_io_rate_limit is updated.
@@ -38,6 +38,7 @@
 #include "cbus.h"
 #include "memory.h"
 #include "coio_file.h"
+#include "coio_uring.h"
 
 #include "replication.h"
 #include "tuple_bloom.h"
@@ -74,6 +75,9 @@ const char *vy_file_suffix[] = {
 /* sync run and index files very 16 MB */
 #define VY_RUN_SYNC_INTERVAL (1 << 24)
 
+/** Max number of concurrent page reads submitted to io_uring. */
+#define VY_RUN_URING_SIZE 256
+
 /**
  * We read runs in background threads so as not to stall tx.
  * This structure represents such a thread.
@@ -93,6 +97,11 @@ struct vy_page_read_task {
 	struct cbus_call_msg base;
 	/** vinyl page metadata */
 	struct vy_page_info *page_info;
+	/**
+	 * Raw page data if it has already been read from disk
+	 * by tx, NULL if it must be read by the reader thread.
+	 */
+	const char *data;
 	/** vy_run with fd - ref. counted */
 	struct vy_run *run;
 	/** key to lookup within the page */
@@ -191,6 +200,8 @@ vy_run_env_create(struct vy_run_env *env, int read_threads)
 void
 vy_run_env_destroy(struct vy_run_env *env)
 {
+	if (env->uring != NULL)
+		coio_uring_delete(env->uring);
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
 	mempool_destroy(&env->read_task_pool);
@@ -206,6 +217,17 @@ vy_run_env_enable_coio(struct vy_run_env *env)
 	if (env->reader_pool != NULL)
 		return; /* already enabled */
 	vy_run_env_start_readers(env);
+	/*
+	 * If io_uring is available, read pages directly from tx
+	 * and use reader threads only for decompression.
+	 */
+	env->uring = coio_uring_new(VY_RUN_URING_SIZE);
+	if (env->uring == NULL) {
+		say_verbose("vinyl: io_uring is unavailable (%s), "
+			    "reading runs in reader threads",
+			    diag_last_error(diag_get())->errmsg);
+		diag_clear(diag_get());
+	}
 }
 
 /**
@@ -679,9 +701,17 @@ vy_run_info_decode(struct vy_run_info *run_info,
 			if (run_info->bloom == NULL)
 				return -1;
 			break;
+		case VY_RUN_INFO_BLOOM_FILTER_V2:
+			run_info->bloom = tuple_bloom_decode_v2(&pos);
+			if (run_info->bloom == NULL)
+				return -1;
+			break;
 		case VY_RUN_INFO_STMT_STAT:
 			vy_stmt_stat_decode(&run_info->stmt_stat, &pos);
 			break;
+		case VY_RUN_INFO_DUMP_TIME:
+			run_info->dump_time = mp_decode_uint(&pos);
+			break;
 		default:
 			mp_next(&pos); /* unknown key, ignore */
 			break;
@@ -877,38 +907,50 @@ vy_run_filename(struct vy_run *run)
 	return buf;
 }
 
+/** Log an error that occurred while reading a page. */
+static void
+vy_page_log_read_error(struct vy_run *run, const struct vy_page_info *page_info)
+{
+	diag_log();
+	say_error("error reading %s@%llu:%u", vy_run_filename(run),
+		  (unsigned long long)page_info->offset,
+		  (unsigned)page_info->size);
+}
+
 /**
- * Read a page requests from vinyl xlog data file.
+ * Check the number of bytes returned by a page read.
  *
  * @retval 0 on success
  * @retval -1 on error, check diag
  */
 static int
-vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
-	     struct vy_run *run, ZSTD_DStream *zdctx)
+vy_page_check_readen(const struct vy_page_info *page_info, ssize_t readen)
 {
-	/* read xlog tx from xlog file */
-	size_t region_svp = region_used(&fiber()->gc);
-	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
-	if (data == NULL) {
-		diag_set(OutOfMemory, page_info->size, "region gc", "page");
-		return -1;
-	}
-	ssize_t readen = fio_pread(run->fd, data, page_info->size,
-				   page_info->offset);
 	ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
 		readen = -1;
 		errno = EIO;});
 	if (readen < 0) {
 		diag_set(SystemError, "failed to read from file");
-		goto error;
+		return -1;
 	}
 	if (readen != (ssize_t)page_info->size) {
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 "Unexpected end of file");
-		goto error;
+		return -1;
 	}
+	return 0;
+}
 
+/**
+ * Decode a page read from vinyl xlog data file.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_decode(struct vy_page *page, const struct vy_page_info *page_info,
+	       struct vy_run *run, const char *data, ZSTD_DStream *zdctx)
+{
 	struct errinj *inj = errinj(ERRINJ_VY_READ_PAGE_TIMEOUT, ERRINJ_DOUBLE);
 	if (inj != NULL && inj->dparam > 0)
 		thread_sleep(inj->dparam);
@@ -917,7 +959,7 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 
 	/* decode xlog tx */
 	const char *data_pos = data;
-	const char *data_end = data + readen;
+	const char *data_end = data + page_info->size;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
 	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
@@ -937,20 +979,63 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 	}
 	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
 		goto error;
-	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
 		diag_set(ClientError, ER_INJECTION, "vinyl page read");
 		return -1;});
 	return 0;
 error:
-	region_truncate(&fiber()->gc, region_svp);
-	diag_log();
-	say_error("error reading %s@%llu:%u", vy_run_filename(run),
-		  (unsigned long long)page_info->offset,
-		  (unsigned)page_info->size);
+	vy_page_log_read_error(run, page_info);
 	return -1;
 }
 
+/**
+ * Read a page requests from vinyl xlog data file.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
+	     struct vy_run *run, ZSTD_DStream *zdctx)
+{
+	/* read xlog tx from xlog file */
+	size_t region_svp = region_used(&fiber()->gc);
+	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, page_info->size, "region gc", "page");
+		return -1;
+	}
+	ssize_t readen = fio_pread(run->fd, data, page_info->size,
+				   page_info->offset);
+	int rc = vy_page_check_readen(page_info, readen);
+	if (rc != 0)
+		vy_page_log_read_error(run, page_info);
+	else
+		rc = vy_page_decode(page, page_info, run, data, zdctx);
+	region_truncate(&fiber()->gc, region_svp);
+	return rc;
+}
+
+/**
+ * Read raw page data from vinyl xlog data file using io_uring.
+ * Yields the current fiber until the read completes.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_read_uring(struct vy_run_env *env, const struct vy_page_info *page_info,
+		   struct vy_run *run, char *data)
+{
+	ssize_t readen = coio_uring_pread(env->uring, run->fd, data,
+					  page_info->size, page_info->offset);
+	if (vy_page_check_readen(page_info, readen) != 0) {
+		vy_page_log_read_error(run, page_info);
+		return -1;
+	}
+	return 0;
+}
+
 /**
  * Get thread local zstd decompression context
  */
@@ -980,8 +1065,15 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run->env);
 	if (zdctx == NULL)
 		return -1;
-	if (vy_page_read(task->page, task->page_info, task->run, zdctx) != 0)
-		return -1;
+	if (task->data != NULL) {
+		if (vy_page_decode(task->page, task->page_info, task->run,
+				   task->data, zdctx) != 0)
+			return -1;
+	} else {
+		if (vy_page_read(task->page, task->page_info,
+				 task->run, zdctx) != 0)
+			return -1;
+	}
 	if (task->key.stmt != NULL) {
 		task->pos_in_page = vy_page_find_key(task->page, task->key,
 						     task->cmp_def, task->format,
@@ -1042,6 +1134,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	}
 	task->run = slice->run;
 	task->page_info = page_info;
+	task->data = NULL;
 	task->page = page;
 	task->key = key;
 	task->iterator_type = iterator_type;
@@ -1050,11 +1143,31 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	task->pos_in_page = 0;
 	task->equal_found = false;
 
-	int rc = vy_run_env_coio_call(env, &task->base, vy_page_read_cb);
+	/*
+	 * With io_uring, read the page directly from tx, leaving
+	 * only decompression and key lookup to the reader thread.
+	 */
+	int rc = 0;
+	size_t region_svp = region_used(&fiber()->gc);
+	if (env->uring != NULL) {
+		char *data = region_alloc(&fiber()->gc, page_info->size);
+		if (data == NULL) {
+			diag_set(OutOfMemory, page_info->size,
+				 "region", "page");
+			rc = -1;
+		} else {
+			rc = vy_page_read_uring(env, page_info,
+						slice->run, data);
+			task->data = data;
+		}
+	}
+	if (rc == 0)
+		rc = vy_run_env_coio_call(env, &task->base, vy_page_read_cb);
 
 	*pos_in_page = task->pos_in_page;
 	*equal_found = task->equal_found;
 
+	region_truncate(&fiber()->gc, region_svp);
 	mempool_free(&env->read_task_pool, task);
 	if (rc != 0) {
 		vy_page_delete(page);
@@ -1779,14 +1892,14 @@ fail:
 static int
 vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
 		 struct vy_page_info *info, struct key_def *key_def,
-		 bool is_primary)
+		 bool is_primary, bool is_covering)
 {
 	struct xrow_header xrow;
 	int rc = (is_primary ?
 		  vy_stmt_encode_primary(entry.stmt, key_def, 0, &xrow) :
 		  vy_stmt_encode_secondary(entry.stmt, key_def,
 					   vy_entry_multikey_idx(entry, key_def),
-					   &xrow));
+					   is_covering, &xrow));
 	if (rc != 0)
 		return -1;
 
@@ -1961,6 +2074,20 @@ vy_stmt_stat_encode(const struct vy_stmt_stat *stat, char *buf)
 	return buf;
 }
 
+/**
+ * Return the run info key to store a bloom filter under.
+ * Classic bloom filters use the original key so that runs
+ * written with the default options can be read by older
+ * versions. Older versions ignore the new key, so they can
+ * still use runs with other filters, just without a filter.
+ */
+static enum vy_run_info_key
+vy_run_info_bloom_key(const struct tuple_bloom *bloom)
+{
+	return tuple_bloom_encode_version(bloom) == 1 ?
+	       VY_RUN_INFO_BLOOM_FILTER : VY_RUN_INFO_BLOOM_FILTER_V2;
+}
+
 /**
  * Encode vy_run_info as xrow
  * Allocates using region alloc
@@ -1986,6 +2113,8 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	uint32_t key_count = 6;
 	if (run_info->bloom != NULL)
 		key_count++;
+	if (run_info->dump_time != 0)
+		key_count++;
 
 	size_t size = mp_sizeof_map(key_count);
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_KEY) + min_key_size;
@@ -1997,10 +2126,13 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	size += mp_sizeof_uint(VY_RUN_INFO_PAGE_COUNT) +
 		mp_sizeof_uint(run_info->page_count);
 	if (run_info->bloom != NULL)
-		size += mp_sizeof_uint(VY_RUN_INFO_BLOOM_FILTER) +
+		size += mp_sizeof_uint(vy_run_info_bloom_key(run_info->bloom)) +
 			tuple_bloom_size(run_info->bloom);
 	size += mp_sizeof_uint(VY_RUN_INFO_STMT_STAT) +
 		vy_stmt_stat_sizeof(&run_info->stmt_stat);
+	if (run_info->dump_time != 0)
+		size += mp_sizeof_uint(VY_RUN_INFO_DUMP_TIME) +
+			mp_sizeof_uint(run_info->dump_time);
 
 	char *pos = region_alloc(&fiber()->gc, size);
 	if (pos == NULL) {
@@ -2024,11 +2156,16 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	pos = mp_encode_uint(pos, VY_RUN_INFO_PAGE_COUNT);
 	pos = mp_encode_uint(pos, run_info->page_count);
 	if (run_info->bloom != NULL) {
-		pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM_FILTER);
+		pos = mp_encode_uint(pos,
+				     vy_run_info_bloom_key(run_info->bloom));
 		pos = tuple_bloom_encode(run_info->bloom, pos);
 	}
 	pos = mp_encode_uint(pos, VY_RUN_INFO_STMT_STAT);
 	pos = vy_stmt_stat_encode(&run_info->stmt_stat, pos);
+	if (run_info->dump_time != 0) {
+		pos = mp_encode_uint(pos, VY_RUN_INFO_DUMP_TIME);
+		pos = mp_encode_uint(pos, run_info->dump_time);
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 	xrow->type = VY_INDEX_RUN_INFO;
@@ -2108,7 +2245,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression)
+		     bool is_covering, uint64_t page_size, double bloom_fpr,
+		     enum tuple_bloom_type bloom_type, bool no_compression)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->run = run;
@@ -2117,8 +2255,10 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->iid = iid;
 	writer->cmp_def = cmp_def;
 	writer->key_def = key_def;
+	writer->is_covering = is_covering;
 	writer->page_size = page_size;
 	writer->bloom_fpr = bloom_fpr;
+	writer->bloom_type = bloom_type;
 	writer->no_compression = no_compression;
 	if (bloom_fpr < 1) {
 		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
@@ -2227,7 +2367,8 @@ vy_run_writer_write_to_page(struct vy_run_writer *writer, struct vy_entry entry)
 	}
 	*offset = page->unpacked_size;
 	if (vy_run_dump_stmt(entry, &writer->data_xlog, page,
-			     writer->cmp_def, writer->iid == 0) != 0)
+			     writer->cmp_def, writer->iid == 0,
+			     writer->is_covering) != 0)
 		return -1;
 	int64_t lsn = vy_stmt_lsn(entry.stmt);
 	run->info.min_lsn = MIN(run->info.min_lsn, lsn);
@@ -2358,6 +2499,7 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 
 	if (writer->bloom != NULL) {
 		run->info.bloom = tuple_bloom_new(writer->bloom,
+						  writer->bloom_type,
 						  writer->bloom_fpr);
 		if (run->info.bloom == NULL)
 			goto out;
@@ -2506,6 +2648,7 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 
 	if (bloom_builder != NULL) {
 		run->info.bloom = tuple_bloom_new(bloom_builder,
+						  opts->bloom_type,
 						  opts->bloom_fpr);
 		if (run->info.bloom == NULL)
 			goto close_err;
@@ -51,6 +51,7 @@ extern "C" {
 
 struct vy_history;
 struct vy_run_reader;
+struct coio_uring;
 
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
@@ -64,6 +65,13 @@ struct vy_run_env {
 	struct vy_run_reader *reader_pool;
 	/** Number of threads in the reader pool. */
 	int reader_pool_size;
+	/**
+	 * io_uring instance used for reading run files from tx
+	 * or NULL if io_uring isn't available, in which case run
+	 * files are read by reader threads. With io_uring, reader
+	 * threads are only used for decompressing pages.
+	 */
+	struct coio_uring *uring;
 	/**
 	 * Index of the reader thread in the pool to be used for
 	 * processing the next read request.
@@ -94,6 +102,13 @@ struct vy_run_info {
 	struct tuple_bloom *bloom;
 	/** Statement statistics. */
 	struct vy_stmt_stat stmt_stat;
+	/**
+	 * Time of the last dump included in the run, in seconds
+	 * since the Epoch. For a run created by compaction, it is
+	 * the max dump time among the compacted runs. Zero if
+	 * unknown (the run was created by an old version).
+	 */
+	uint64_t dump_time;
 };
 
 /**
@@ -618,6 +633,11 @@ struct vy_run_writer {
 	struct key_def *cmp_def;
 	/** Key definition to calculate bloom. */
 	struct key_def *key_def;
+	/**
+	 * Set if the run belongs to a covering secondary index,
+	 * which stores full tuples rather than extended keys.
+	 */
+	bool is_covering;
 	/**
 	 * Minimal page size. When a page becames bigger, it is
 	 * dumped.
@@ -633,6 +653,8 @@ struct vy_run_writer {
 	struct xlog data_xlog;
 	/** Bloom filter false positive rate. */
 	double bloom_fpr;
+	/** Bloom filter type. */
+	enum tuple_bloom_type bloom_type;
 	/** Bloom filter. */
 	struct tuple_bloom_builder *bloom;
 	/** Buffer of a current page row offsets. */
@@ -649,7 +671,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression);
+		     bool is_covering, uint64_t page_size, double bloom_fpr,
+		     enum tuple_bloom_type bloom_type, bool no_compression);
 
 /**
  * Write a specified statement into a run.
@@ -204,6 +204,7 @@ struct vy_task {
 	 * from another thread.
 	 */
 	double bloom_fpr;
+	enum tuple_bloom_type bloom_type;
 	int64_t page_size;
 	/**
 	 * Deferred DELETE handler passed to the write iterator.
@@ -465,6 +466,7 @@ vy_scheduler_create(struct vy_scheduler *scheduler, int write_threads,
 void
 vy_scheduler_start(struct vy_scheduler *scheduler)
 {
+	scheduler->dump_start = ev_monotonic_now(loop());
 	fiber_start(scheduler->scheduler_fiber, scheduler);
 }
 
@@ -501,6 +503,9 @@ vy_scheduler_reset_stat(struct vy_scheduler *scheduler)
 	stat->compaction_time = 0;
 	stat->compaction_input = 0;
 	stat->compaction_output = 0;
+	stat->partial_dump_count = 0;
+	stat->carry_over_count = 0;
+	stat->carry_over_size = 0;
 }
 
 static int
@@ -585,9 +590,12 @@ vy_scheduler_trigger_dump(struct vy_scheduler *scheduler)
 		scheduler->dump_pending = true;
 		return;
 	}
-	scheduler->dump_start = ev_monotonic_now(loop());
+	double now = ev_monotonic_now(loop());
+	scheduler->dump_interval = now - scheduler->dump_start;
+	scheduler->dump_start = now;
 	scheduler->generation++;
 	scheduler->dump_pending = false;
+	scheduler->carry_over_pending = scheduler->partial_dump;
 	fiber_cond_signal(&scheduler->scheduler_cond);
 }
 
@@ -605,6 +613,8 @@ vy_scheduler_dump(struct vy_scheduler *scheduler)
 	if (!vy_scheduler_dump_in_progress(scheduler))
 		scheduler->dump_start = ev_monotonic_now(loop());
 	scheduler->generation++;
+	/* Forced dump must write all in-memory trees. */
+	scheduler->carry_over_pending = false;
 	fiber_cond_signal(&scheduler->scheduler_cond);
 
 	/* Wait for dump to complete. */
@@ -710,6 +720,8 @@ vy_scheduler_begin_checkpoint(struct vy_scheduler *scheduler, bool is_scheduled)
 	}
 	scheduler->generation++;
 	scheduler->checkpoint_in_progress = true;
+	/* Checkpoint must include all in-memory trees. */
+	scheduler->carry_over_pending = false;
 	fiber_cond_signal(&scheduler->scheduler_cond);
 	say_info("vinyl checkpoint started");
 	return 0;
@@ -1067,8 +1079,9 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 	if (vy_run_writer_create(&writer, task->new_run, lsm->env->path,
 				 lsm->space_id, lsm->index_id,
 				 task->cmp_def, task->key_def,
+				 lsm->opts.covering,
 				 task->page_size, task->bloom_fpr,
-				 no_compression) != 0)
+				 task->bloom_type, no_compression) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
@@ -1373,6 +1386,10 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 
 	new_run->dump_count = 1;
 	new_run->dump_lsn = dump_lsn;
+	new_run->info.dump_time = ev_now(loop());
+	inj = errinj(ERRINJ_VY_DUMP_TIME, ERRINJ_DOUBLE);
+	if (inj != NULL && inj->dparam != 0)
+		new_run->info.dump_time = inj->dparam;
 
 	/*
 	 * Note, since deferred DELETE are generated on tx commit
@@ -1382,7 +1399,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	 */
 	struct vy_stmt_stream *wi;
 	bool is_last_level = (lsm->run_count == 0);
-	wi = vy_write_iterator_new(task->cmp_def, lsm->index_id == 0,
+	wi = vy_write_iterator_new(task->cmp_def, vy_lsm_stores_tuples(lsm),
 				   is_last_level, scheduler->read_views, NULL);
 	if (wi == NULL)
 		goto err_wi;
@@ -1396,6 +1413,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
+	task->bloom_type = lsm->opts.bloom_type;
 	task->page_size = lsm->opts.page_size;
 
 	lsm->is_dumping = true;
@@ -1657,8 +1675,9 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		goto err_run;
 
 	struct vy_stmt_stream *wi;
-	bool is_last_level = (range->compaction_priority == range->slice_count);
-	wi = vy_write_iterator_new(task->cmp_def, lsm->index_id == 0,
+	bool is_last_level = (range->compaction_skip +
+			      range->compaction_priority == range->slice_count);
+	wi = vy_write_iterator_new(task->cmp_def, vy_lsm_stores_tuples(lsm),
 				   is_last_level, scheduler->read_views,
 				   lsm->index_id > 0 ? NULL :
 				   &task->deferred_delete_handler);
@@ -1667,14 +1686,22 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 
 	struct vy_slice *slice;
 	int32_t dump_count = 0;
+	int skip = range->compaction_skip;
 	int n = range->compaction_priority;
 	rlist_foreach_entry(slice, &range->slices, in_range) {
+		/* Leave the newest runs intact if requested. */
+		if (skip > 0) {
+			skip--;
+			continue;
+		}
 		if (vy_write_iterator_new_slice(wi, slice,
 						lsm->disk_format) != 0)
 			goto err_wi_sub;
 		new_run->dump_lsn = MAX(new_run->dump_lsn,
 					slice->run->dump_lsn);
 		dump_count += slice->run->dump_count;
+		new_run->info.dump_time = MAX(new_run->info.dump_time,
+					      slice->run->info.dump_time);
 		/* Remember the slices we are compacting. */
 		if (task->first_slice == NULL)
 			task->first_slice = slice;
@@ -1685,7 +1712,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	}
 	assert(n == 0);
 	assert(new_run->dump_lsn >= 0);
-	if (range->compaction_priority == range->slice_count)
+	if (is_last_level)
 		dump_count -= slice->run->dump_count;
 	/*
 	 * Do not update dumps_per_compaction in case compaction
@@ -1703,6 +1730,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
+	task->bloom_type = lsm->opts.bloom_type;
 	task->page_size = lsm->opts.page_size;
 
 	/*
@@ -1800,6 +1828,163 @@ vy_task_complete_f(struct cmsg *cmsg)
 	fiber_cond_signal(&task->scheduler->scheduler_cond);
 }
 
+/**
+ * Max share of memory that may be carried over to the next
+ * generation by a partial dump round.
+ */
+static const double VY_CARRY_OVER_MAX_SHARE = 0.1;
+
+/**
+ * Max number of dump rounds in a row that may carry over the same
+ * in-memory tree. Makes sure that data of rarely updated LSM trees
+ * gets to disk even if checkpointing is disabled.
+ */
+static const int VY_CARRY_OVER_MAX_COUNT = 8;
+
+/** An LSM tree whose in-memory tree may be carried over. */
+struct vy_carry_over_candidate {
+	/** The LSM tree. */
+	struct vy_lsm *lsm;
+	/**
+	 * Amount of memory the in-memory tree is expected to use
+	 * by the next dump round, given the LSM tree write rate.
+	 */
+	double weight;
+};
+
+static int
+vy_carry_over_candidate_cmp(const void *a, const void *b)
+{
+	const struct vy_carry_over_candidate *c1 = a;
+	const struct vy_carry_over_candidate *c2 = b;
+	if (c1->weight < c2->weight)
+		return -1;
+	if (c1->weight > c2->weight)
+		return 1;
+	return 0;
+}
+
+/**
+ * Carry over an in-memory tree to the next generation, if possible.
+ * Returns true on success.
+ */
+static bool
+vy_scheduler_carry_over_lsm(struct vy_scheduler *scheduler,
+			    struct vy_lsm *lsm)
+{
+	/*
+	 * On local recovery from WAL, the primary index must not be
+	 * ahead of secondary indexes of the same space (see also
+	 * vy_dump_heap_less()) so we may skip dumping a secondary
+	 * index only if the primary index doesn't need to be dumped
+	 * either.
+	 */
+	if (lsm->pk != NULL &&
+	    vy_lsm_generation(lsm->pk) <= scheduler->dump_generation)
+		return false;
+	size_t copied;
+	int rc = vy_lsm_carry_over_mem(lsm, &copied);
+	vy_quota_force_use(scheduler->quota, VY_QUOTA_CONSUMER_COMPACTION,
+			   copied);
+	scheduler->carry_over_size += copied;
+	if (rc != 0) {
+		/* Not a big deal, the tree will just be dumped. */
+		diag_log();
+		return false;
+	}
+	scheduler->stat.carry_over_count++;
+	scheduler->stat.carry_over_size += copied;
+	vy_scheduler_update_lsm(scheduler, lsm);
+	return true;
+}
+
+/**
+ * Called at the beginning of a dump round triggered by the regulator
+ * if partial dumps are enabled, before any dump task is scheduled.
+ *
+ * Since memory can only be freed by generation, a dump round has to
+ * write all in-memory trees to disk, even if the workload is skewed
+ * and most of them store a few statements, which results in lots of
+ * tiny runs that have to be compacted afterwards. To avoid that, we
+ * sort in-memory trees by the amount of memory they are expected to
+ * take by the next dump round, which depends on their size and
+ * write rate, and copy the lightest of them, which are expected to
+ * take no more than VY_CARRY_OVER_MAX_SHARE of memory in total, to
+ * the new generation instead of dumping them.
+ */
+static void
+vy_scheduler_carry_over(struct vy_scheduler *scheduler)
+{
+	assert(!scheduler->checkpoint_in_progress);
+	scheduler->carry_over_size = 0;
+	if (scheduler->dump_generation != scheduler->generation - 1 ||
+	    scheduler->dump_heap.size == 0)
+		return;
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct vy_carry_over_candidate *candidates =
+		xregion_alloc_array(region, typeof(candidates[0]),
+				    scheduler->dump_heap.size);
+	int count = 0;
+	struct heap_iterator it;
+	vy_dump_heap_iterator_init(&scheduler->dump_heap, &it);
+	struct vy_lsm *lsm;
+	while ((lsm = vy_dump_heap_iterator_next(&it)) != NULL) {
+		struct vy_mem *mem = lsm->mem;
+		if (lsm->is_dumping || lsm->pin_count > 0 || lsm->is_dropped ||
+		    !rlist_empty(&lsm->sealed) || mem->pin_count > 0 ||
+		    mem->generation != scheduler->dump_generation ||
+		    mem->count.rows == 0 ||
+		    lsm->carry_over_count >= VY_CARRY_OVER_MAX_COUNT) {
+			lsm->carry_over_count = 0;
+			continue;
+		}
+		struct vy_carry_over_candidate *c = &candidates[count++];
+		c->lsm = lsm;
+		c->weight = mem->count.bytes + mem->tree_extent_size +
+			    vy_lsm_write_rate(lsm) * scheduler->dump_interval;
+	}
+	qsort(candidates, count, sizeof(candidates[0]),
+	      vy_carry_over_candidate_cmp);
+	/*
+	 * Select the lightest trees that fit in the limit, then
+	 * carry over primary indexes first, see the comment in
+	 * vy_scheduler_carry_over_lsm().
+	 */
+	double budget = scheduler->quota->used * VY_CARRY_OVER_MAX_SHARE;
+	double selected_weight = 0;
+	int selected = 0;
+	for (; selected < count; selected++) {
+		struct vy_carry_over_candidate *c = &candidates[selected];
+		if (selected_weight + c->weight > budget)
+			break;
+		selected_weight += c->weight;
+	}
+	int carried = 0;
+	for (int i = 0; i < selected; i++) {
+		lsm = candidates[i].lsm;
+		if (lsm->index_id == 0 &&
+		    vy_scheduler_carry_over_lsm(scheduler, lsm))
+			carried++;
+	}
+	for (int i = 0; i < count; i++) {
+		lsm = candidates[i].lsm;
+		if (i < selected && lsm->index_id != 0 &&
+		    vy_scheduler_carry_over_lsm(scheduler, lsm))
+			carried++;
+		else if (lsm->mem->generation == scheduler->dump_generation)
+			lsm->carry_over_count = 0;
+	}
+	region_truncate(region, region_svp);
+	if (carried > 0) {
+		scheduler->stat.partial_dump_count++;
+		say_info("carried over %d in-memory trees, %zu bytes, "
+			 "to the next dump round", carried,
+			 scheduler->carry_over_size);
+	}
+}
+
 /**
  * Create a task for dumping an LSM tree. The new task is returned
  * in @ptask. If there's no LSM tree that needs to be dumped or all
@@ -1816,6 +2001,10 @@ static int
 vy_scheduler_peek_dump(struct vy_scheduler *scheduler, struct vy_task **ptask)
 {
 	struct vy_worker *worker = NULL;
+	if (scheduler->carry_over_pending) {
+		scheduler->carry_over_pending = false;
+		vy_scheduler_carry_over(scheduler);
+	}
 retry:
 	*ptask = NULL;
 	if (!vy_scheduler_dump_in_progress(scheduler)) {
@@ -139,6 +139,33 @@ struct vy_scheduler {
 	int dump_task_count;
 	/** Time when the current dump round started. */
 	double dump_start;
+	/**
+	 * If set, dump rounds triggered by the regulator write only
+	 * the heaviest in-memory trees to disk while light and cold
+	 * trees are carried over to the next generation, see
+	 * vy_scheduler_carry_over().
+	 */
+	bool partial_dump;
+	/**
+	 * Set if the current dump round may carry over in-memory
+	 * trees. Cleared once the scheduler fiber has made its
+	 * decisions or if a forced dump or checkpoint is started
+	 * before that.
+	 */
+	bool carry_over_pending;
+	/**
+	 * Time between the completion of the previous dump round
+	 * and the start of the current one, in seconds. Used for
+	 * predicting how much memory an in-memory tree will take
+	 * by the next dump round.
+	 */
+	double dump_interval;
+	/**
+	 * Amount of memory allocated for in-memory trees carried
+	 * over during the current dump round. This memory isn't
+	 * freed by the dump so it shouldn't be accounted as dumped.
+	 */
+	size_t carry_over_size;
 	/** Signaled on dump round completion. */
 	struct fiber_cond dump_cond;
 	/** Scheduler statistics. */
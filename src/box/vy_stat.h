@@ -240,6 +240,15 @@ struct vy_scheduler_stat {
 	int64_t compaction_input;
 	/** Number of bytes written by compaction tasks. */
 	int64_t compaction_output;
+	/** Number of dump rounds that carried over in-memory trees. */
+	int32_t partial_dump_count;
+	/**
+	 * Number of in-memory trees carried over to the next
+	 * generation instead of being dumped.
+	 */
+	int32_t carry_over_count;
+	/** Number of bytes carried over to the next generation. */
+	int64_t carry_over_size;
 };
 
 static inline int
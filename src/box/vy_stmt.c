@@ -670,7 +670,8 @@ vy_stmt_encode_primary(struct tuple *value, struct key_def *key_def,
 
 int
 vy_stmt_encode_secondary(struct tuple *value, struct key_def *cmp_def,
-			 int multikey_idx, struct xrow_header *xrow)
+			 int multikey_idx, bool is_covering,
+			 struct xrow_header *xrow)
 {
 	memset(xrow, 0, sizeof(*xrow));
 	enum iproto_type type = vy_stmt_type(value);
@@ -681,7 +682,12 @@ vy_stmt_encode_secondary(struct tuple *value, struct key_def *cmp_def,
 	memset(&request, 0, sizeof(request));
 	request.type = type;
 	uint32_t size;
-	const char *extracted = vy_stmt_is_key(value) ?
+	/*
+	 * A covering index stores full tuples, but DELETE
+	 * statements are still written as keys to save space.
+	 */
+	const char *extracted = vy_stmt_is_key(value) ||
+				(is_covering && type != IPROTO_DELETE) ?
 				tuple_data_range(value, &size) :
 				tuple_extract_key(value, cmp_def,
 						  multikey_idx, &size);
@@ -687,6 +687,7 @@ vy_stmt_encode_primary(struct tuple *value, struct key_def *key_def,
  * @param value statement to encode
  * @param key_def key definition
  * @param multikey_idx multikey index hint
+ * @param is_covering set if the index stores full tuples
  * @param xrow[out] xrow to fill
  *
  * @retval 0 if OK
@@ -694,7 +695,8 @@ vy_stmt_encode_primary(struct tuple *value, struct key_def *key_def,
  */
 int
 vy_stmt_encode_secondary(struct tuple *value, struct key_def *cmp_def,
-			 int multikey_idx, struct xrow_header *xrow);
+			 int multikey_idx, bool is_covering,
+			 struct xrow_header *xrow);
 
 /**
  * Reconstruct vinyl tuple info and data from xrow
@@ -1117,6 +1117,7 @@ vy_tx_set_entry(struct vy_tx *tx, struct vy_lsm *lsm, struct vy_entry entry)
 		v->is_first_insert = true;
 
 	if (lsm->index_id > 0 && old != NULL && !old->is_nop &&
+	    !vy_lsm_stores_tuples(lsm) &&
 	    !vy_lsm_is_being_constructed(lsm)) {
 		/*
 		 * In a secondary index write set, DELETE statement purges
@@ -1139,6 +1140,10 @@ vy_tx_set_entry(struct vy_tx *tx, struct vy_lsm *lsm, struct vy_entry entry)
 		 * vinyl_space_build_index() as featuring bumped lsn).
 		 * Finally, we'll get missing tuple in secondary index after
 		 * it is built.
+		 *
+		 * Nor do we apply it to covering indexes, because they
+		 * store full tuples so REPLACE statements for the same
+		 * key aren't equivalent.
 		 */
 		enum iproto_type type = vy_stmt_type(entry.stmt);
 		enum iproto_type old_type = vy_stmt_type(old->entry.stmt);
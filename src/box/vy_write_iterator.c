@@ -717,7 +717,10 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 			/*
 			 * If a REPLACE stored in a secondary index was
 			 * generated by an update operation, it can be
-			 * turned into an INSERT.
+			 * turned into an INSERT. This doesn't hold for
+			 * covering indexes, because an update that
+			 * doesn't touch the secondary key overwrites
+			 * the old tuple in them.
 			 */
 			*is_first_insert = true;
 		}
@@ -239,7 +239,8 @@ struct vy_deferred_delete_handler {
  * Open an empty write iterator. To add sources to the iterator
  * use vy_write_iterator_add_* functions.
  * @param cmp_def - key definition for tuple compare.
- * @param LSM tree is_primary - set if this iterator is for a primary index.
+ * @param LSM tree is_primary - set if this iterator is for a primary index
+ * or a covering secondary index, i.e. an LSM tree that stores full tuples.
  * @param is_last_level - there is no older level than the one we're writing to.
  * @param read_views - Opened read views.
  * @param handler - Deferred DELETE handler or NULL if no deferred DELETEs is
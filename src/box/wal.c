@@ -42,6 +42,7 @@
 #include "cbus.h"
 #include "coio_task.h"
 #include "replication.h"
+#include "relay_feed.h"
 #include "iproto_constants.h"
 
 enum {
@@ -1040,6 +1041,9 @@ wal_write_to_disk(struct cmsg *msg)
 	 */
 	struct vclock vclock_diff;
 	vclock_create(&vclock_diff);
+	/* WAL vclock before the batch, needed for the relay feed. */
+	struct vclock vclock_start;
+	vclock_copy(&vclock_start, &writer->vclock);
 
 	ERROR_INJECT_SLEEP(ERRINJ_WAL_DELAY);
 
@@ -1176,6 +1180,7 @@ done:
 	} else {
 		assert(err_code == JOURNAL_ENTRY_ERR_UNKNOWN);
 	}
+	relay_feed_append(&wal_msg->commit, &vclock_start, &wal_msg->vclock);
 	wal_notify_watchers(writer, WAL_EVENT_WRITE);
 	ERROR_INJECT_SLEEP(ERRINJ_RELAY_FASTER_THAN_TX);
 }
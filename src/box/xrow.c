@@ -156,6 +156,7 @@ xrow_header_decode(struct xrow_header *header, const char **pos,
 	if (mp_typeof(**pos) != MP_MAP)
 		goto bad_header;
 	bool has_tsn = false;
+	bool has_wait_vclock_timeout = false;
 	uint32_t flags = 0;
 
 	uint32_t size = mp_decode_map(pos);
@@ -199,6 +200,14 @@ xrow_header_decode(struct xrow_header *header, const char **pos,
 		case IPROTO_STREAM_ID:
 			header->stream_id = mp_decode_uint(pos);
 			break;
+		case IPROTO_WAIT_VCLOCK:
+			header->wait_vclock = *pos;
+			mp_next(pos);
+			break;
+		case IPROTO_WAIT_VCLOCK_TIMEOUT:
+			has_wait_vclock_timeout = true;
+			header->wait_vclock_timeout = mp_decode_double(pos);
+			break;
 		default:
 			/* unknown header */
 			mp_next(pos);
@@ -214,6 +223,8 @@ xrow_header_decode(struct xrow_header *header, const char **pos,
 	}
 	/* Restore transaction id from lsn and transaction serial number. */
 	header->tsn = header->lsn - header->tsn;
+	if (header->wait_vclock != NULL && !has_wait_vclock_timeout)
+		header->wait_vclock_timeout = -1;
 
 	/* Nop requests aren't supposed to have a body. */
 	if (*pos < end && header->type != IPROTO_NOP) {
@@ -821,22 +832,61 @@ xrow_decode_sql(const struct xrow_header *row, struct sql_request *request)
 	request->sql_text = NULL;
 	request->bind = NULL;
 	request->stmt_id = NULL;
+	request->fetch_size = NULL;
+	request->cursor_id = NULL;
 	for (uint32_t i = 0; i < map_size; ++i) {
 		uint8_t key = *data;
 		if (key != IPROTO_SQL_BIND && key != IPROTO_SQL_TEXT &&
-		    key != IPROTO_STMT_ID) {
+		    key != IPROTO_STMT_ID && key != IPROTO_SQL_FETCH_SIZE &&
+		    key != IPROTO_SQL_CURSOR_ID) {
 			mp_next(&data);         /* skip the key */
 			mp_next(&data);         /* skip the value */
 			continue;
 		}
 		const char *value = ++data;     /* skip the key */
 		mp_next(&data);                 /* skip the value */
+		if (key == IPROTO_SQL_FETCH_SIZE ||
+		    key == IPROTO_SQL_CURSOR_ID) {
+			const char *p = value;
+			if (mp_typeof(*p) != MP_UINT ||
+			    mp_decode_uint(&p) > UINT32_MAX) {
+				xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+						   iproto_key_name(key));
+				return -1;
+			}
+		}
 		if (key == IPROTO_SQL_BIND)
 			request->bind = value;
 		else if (key == IPROTO_SQL_TEXT)
 			request->sql_text = value;
-		else
+		else if (key == IPROTO_STMT_ID)
 			request->stmt_id = value;
+		else if (key == IPROTO_SQL_FETCH_SIZE)
+			request->fetch_size = value;
+		else
+			request->cursor_id = value;
+	}
+	if (row->type == IPROTO_SQL_FETCH) {
+		if (request->sql_text != NULL || request->stmt_id != NULL ||
+		    request->bind != NULL) {
+			xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+					   "SQL text, statement id and bind "
+					   "are not allowed in fetch request");
+			return -1;
+		}
+		if (request->cursor_id == NULL) {
+			xrow_on_decode_err(row, ER_MISSING_REQUEST_FIELD,
+					   iproto_key_name(
+						IPROTO_SQL_CURSOR_ID));
+			return -1;
+		}
+		if (request->fetch_size == NULL) {
+			xrow_on_decode_err(row, ER_MISSING_REQUEST_FIELD,
+					   iproto_key_name(
+						IPROTO_SQL_FETCH_SIZE));
+			return -1;
+		}
+		return 0;
 	}
 	if (request->sql_text != NULL && request->stmt_id != NULL) {
 		xrow_on_decode_err(row, ER_INVALID_MSGPACK,
@@ -2017,6 +2067,16 @@ struct replication_request {
 	uint32_t *version_id;
 	/** IPROTO_REPLICA_ANON. */
 	bool *is_anon;
+	/** IPROTO_COMPRESSION. */
+	uint32_t *compression;
+	/** IPROTO_CHECKPOINT_JOIN. */
+	bool *is_checkpoint_join;
+	/** IPROTO_FILE_SIZE. */
+	uint64_t *file_size;
+	/** IPROTO_SPACE_FILTER. */
+	const char **space_filter;
+	/** End of IPROTO_SPACE_FILTER. */
+	const char **space_filter_end;
 };
 
 /** Encode a replication request template. */
@@ -2029,6 +2089,8 @@ xrow_encode_replication_request(struct xrow_header *row,
 	size_t size = XROW_BODY_LEN_MAX;
 	if (req->vclock != NULL)
 		size += mp_sizeof_vclock_ignore0(req->vclock);
+	if (req->space_filter != NULL && *req->space_filter != NULL)
+		size += *req->space_filter_end - *req->space_filter;
 	char *buf = xregion_alloc(&fiber()->gc, size);
 	/* Skip one byte for future map header. */
 	char *data = buf + 1;
@@ -2080,6 +2142,28 @@ xrow_encode_replication_request(struct xrow_header *row,
 			data = mp_encode_uint(data, id);
 		}
 	}
+	if (req->compression != NULL && *req->compression != 0) {
+		++map_size;
+		data = mp_encode_uint(data, IPROTO_COMPRESSION);
+		data = mp_encode_uint(data, *req->compression);
+	}
+	if (req->is_checkpoint_join != NULL && *req->is_checkpoint_join) {
+		++map_size;
+		data = mp_encode_uint(data, IPROTO_CHECKPOINT_JOIN);
+		data = mp_encode_bool(data, true);
+	}
+	if (req->file_size != NULL) {
+		++map_size;
+		data = mp_encode_uint(data, IPROTO_FILE_SIZE);
+		data = mp_encode_uint(data, *req->file_size);
+	}
+	if (req->space_filter != NULL && *req->space_filter != NULL) {
+		++map_size;
+		data = mp_encode_uint(data, IPROTO_SPACE_FILTER);
+		size_t len = *req->space_filter_end - *req->space_filter;
+		memcpy(data, *req->space_filter, len);
+		data += len;
+	}
 	assert(data <= buf + size);
 	assert(map_size <= 15);
 	char *map_header_end = mp_encode_map(buf, map_size);
@@ -2200,6 +2284,55 @@ id_filter_decode_err:		xrow_on_decode_err(row, ER_INVALID_MSGPACK,
 				*req->id_filter |= 1 << val;
 			}
 			break;
+		case IPROTO_COMPRESSION:
+			if (req->compression == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_UINT) {
+				xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+						   "invalid COMPRESSION");
+				return -1;
+			}
+			*req->compression = mp_decode_uint(&d);
+			break;
+		case IPROTO_CHECKPOINT_JOIN:
+			if (req->is_checkpoint_join == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_BOOL) {
+				xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+						   "invalid CHECKPOINT_JOIN flag");
+				return -1;
+			}
+			*req->is_checkpoint_join = mp_decode_bool(&d);
+			break;
+		case IPROTO_FILE_SIZE:
+			if (req->file_size == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_UINT) {
+				xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+						   "invalid FILE_SIZE");
+				return -1;
+			}
+			*req->file_size = mp_decode_uint(&d);
+			break;
+		case IPROTO_SPACE_FILTER: {
+			if (req->space_filter == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_ARRAY) {
+space_filter_decode_err:	xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+						   "invalid SPACE_FILTER");
+				return -1;
+			}
+			*req->space_filter = d;
+			uint32_t len = mp_decode_array(&d);
+			for (uint32_t i = 0; i < len; ++i) {
+				if (mp_typeof(*d) != MP_UINT &&
+				    mp_typeof(*d) != MP_STR)
+					goto space_filter_decode_err;
+				mp_next(&d);
+			}
+			*req->space_filter_end = d;
+			break;
+		}
 		default: skip:
 			mp_next(&d); /* value */
 		}
@@ -2247,6 +2380,9 @@ xrow_encode_subscribe(struct xrow_header *row,
 		.is_anon = &cast->is_anon,
 		.id_filter = &cast->id_filter,
 		.version_id = &cast->version_id,
+		.compression = &cast->compression,
+		.space_filter = &cast->space_filter,
+		.space_filter_end = &cast->space_filter_end,
 	};
 	xrow_encode_replication_request(row, &base_req, IPROTO_SUBSCRIBE);
 }
@@ -2265,6 +2401,9 @@ xrow_decode_subscribe(const struct xrow_header *row,
 		.version_id = &req->version_id,
 		.is_anon = &req->is_anon,
 		.id_filter = &req->id_filter,
+		.compression = &req->compression,
+		.space_filter = &req->space_filter,
+		.space_filter_end = &req->space_filter_end,
 	};
 	return xrow_decode_replication_request(row, &base_req);
 }
@@ -2277,6 +2416,7 @@ xrow_encode_join(struct xrow_header *row, const struct join_request *req)
 		.instance_uuid = &cast->instance_uuid,
 		.instance_name = cast->instance_name,
 		.version_id = &cast->version_id,
+		.is_checkpoint_join = &cast->is_checkpoint_join,
 	};
 	xrow_encode_replication_request(row, &base_req, IPROTO_JOIN);
 }
@@ -2289,10 +2429,210 @@ xrow_decode_join(const struct xrow_header *row, struct join_request *req)
 		.instance_uuid = &req->instance_uuid,
 		.instance_name = req->instance_name,
 		.version_id = &req->version_id,
+		.is_checkpoint_join = &req->is_checkpoint_join,
+	};
+	return xrow_decode_replication_request(row, &base_req);
+}
+
+void
+xrow_encode_join_file(struct xrow_header *row, uint64_t size)
+{
+	const struct replication_request base_req = {
+		.file_size = &size,
+	};
+	xrow_encode_replication_request(row, &base_req, IPROTO_JOIN_FILE);
+}
+
+int
+xrow_decode_join_file(const struct xrow_header *row, uint64_t *size)
+{
+	*size = 0;
+	struct replication_request base_req = {
+		.file_size = size,
+	};
+	return xrow_decode_replication_request(row, &base_req);
+}
+
+void
+xrow_encode_resync(struct xrow_header *row, const struct resync_request *req)
+{
+	struct resync_request *cast = (struct resync_request *)req;
+	const struct replication_request base_req = {
+		.replicaset_uuid = &cast->replicaset_uuid,
+		.instance_uuid = &cast->instance_uuid,
+		.vclock = &cast->vclock,
+		.version_id = &cast->version_id,
+	};
+	xrow_encode_replication_request(row, &base_req, IPROTO_RESYNC);
+}
+
+int
+xrow_decode_resync(const struct xrow_header *row, struct resync_request *req)
+{
+	memset(req, 0, sizeof(*req));
+	struct replication_request base_req = {
+		.replicaset_uuid = &req->replicaset_uuid,
+		.instance_uuid = &req->instance_uuid,
+		.vclock = &req->vclock,
+		.version_id = &req->version_id,
 	};
 	return xrow_decode_replication_request(row, &base_req);
 }
 
+void
+xrow_encode_resync_range(struct xrow_header *row, uint16_t type,
+			 const struct resync_range_request *req)
+{
+	assert(type == IPROTO_RESYNC_HASH || type == IPROTO_RESYNC_FETCH);
+	memset(row, 0, sizeof(*row));
+	size_t size = mp_sizeof_map(4) +
+		      mp_sizeof_uint(IPROTO_SPACE_ID) +
+		      mp_sizeof_uint(req->space_id) +
+		      mp_sizeof_uint(IPROTO_KEY) + (req->key_end - req->key) +
+		      mp_sizeof_uint(IPROTO_KEY_END) +
+		      (req->upper_end - req->upper) +
+		      mp_sizeof_uint(IPROTO_LIMIT) +
+		      mp_sizeof_uint(req->limit);
+	char *buf = xregion_alloc(&fiber()->gc, size);
+	char *data = buf;
+	data = mp_encode_map(data, req->upper != NULL ? 4 : 3);
+	data = mp_encode_uint(data, IPROTO_SPACE_ID);
+	data = mp_encode_uint(data, req->space_id);
+	data = mp_encode_uint(data, IPROTO_KEY);
+	memcpy(data, req->key, req->key_end - req->key);
+	data += req->key_end - req->key;
+	if (req->upper != NULL) {
+		data = mp_encode_uint(data, IPROTO_KEY_END);
+		memcpy(data, req->upper, req->upper_end - req->upper);
+		data += req->upper_end - req->upper;
+	}
+	data = mp_encode_uint(data, IPROTO_LIMIT);
+	data = mp_encode_uint(data, req->limit);
+	assert(data <= buf + size);
+	row->body[0].iov_base = buf;
+	row->body[0].iov_len = data - buf;
+	row->bodycnt = 1;
+	row->type = type;
+}
+
+int
+xrow_decode_resync_range(const struct xrow_header *row,
+			 struct resync_range_request *req)
+{
+	if (row->bodycnt == 0) {
+		diag_set(ClientError, ER_INVALID_MSGPACK, "request body");
+		return -1;
+	}
+	assert(row->bodycnt == 1);
+	const char *data = (const char *)row->body[0].iov_base;
+	if (mp_typeof(*data) != MP_MAP) {
+error:
+		xrow_on_decode_err(row, ER_INVALID_MSGPACK, "packet body");
+		return -1;
+	}
+	memset(req, 0, sizeof(*req));
+	bool has_space_id = false;
+	uint32_t map_size = mp_decode_map(&data);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*data) != MP_UINT)
+			goto error;
+		uint64_t key = mp_decode_uint(&data);
+		if (key < iproto_key_MAX &&
+		    iproto_key_type[key] != MP_NIL &&
+		    iproto_key_type[key] != mp_typeof(*data))
+			goto error;
+		switch (key) {
+		case IPROTO_SPACE_ID:
+			req->space_id = mp_decode_uint(&data);
+			has_space_id = true;
+			break;
+		case IPROTO_KEY:
+			req->key = data;
+			mp_next(&data);
+			req->key_end = data;
+			break;
+		case IPROTO_KEY_END:
+			req->upper = data;
+			mp_next(&data);
+			req->upper_end = data;
+			break;
+		case IPROTO_LIMIT:
+			req->limit = mp_decode_uint(&data);
+			break;
+		default:
+			mp_next(&data);
+			break;
+		}
+	}
+	if (!has_space_id) {
+		xrow_on_decode_err(row, ER_MISSING_REQUEST_FIELD,
+				   iproto_key_name(IPROTO_SPACE_ID));
+		return -1;
+	}
+	if (req->key == NULL) {
+		xrow_on_decode_err(row, ER_MISSING_REQUEST_FIELD,
+				   iproto_key_name(IPROTO_KEY));
+		return -1;
+	}
+	return 0;
+}
+
+void
+xrow_encode_resync_data(struct xrow_header *row, const char *data,
+			const char *data_end)
+{
+	memset(row, 0, sizeof(*row));
+	size_t size = mp_sizeof_map(1) + mp_sizeof_uint(IPROTO_DATA);
+	char *buf = xregion_alloc(&fiber()->gc, size);
+	char *pos = mp_encode_map(buf, 1);
+	pos = mp_encode_uint(pos, IPROTO_DATA);
+	row->body[0].iov_base = buf;
+	row->body[0].iov_len = pos - buf;
+	row->body[1].iov_base = (char *)data;
+	row->body[1].iov_len = data_end - data;
+	row->bodycnt = 2;
+	row->type = IPROTO_OK;
+}
+
+int
+xrow_decode_resync_data(const struct xrow_header *row, const char **data,
+			const char **data_end)
+{
+	if (row->bodycnt == 0) {
+		diag_set(ClientError, ER_INVALID_MSGPACK, "response body");
+		return -1;
+	}
+	assert(row->bodycnt == 1);
+	const char *d = (const char *)row->body[0].iov_base;
+	if (mp_typeof(*d) != MP_MAP) {
+error:
+		xrow_on_decode_err(row, ER_INVALID_MSGPACK, "response body");
+		return -1;
+	}
+	*data = NULL;
+	uint32_t map_size = mp_decode_map(&d);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*d) != MP_UINT)
+			goto error;
+		uint64_t key = mp_decode_uint(&d);
+		if (key == IPROTO_DATA) {
+			if (mp_typeof(*d) != MP_ARRAY)
+				goto error;
+			*data = d;
+			mp_next(&d);
+			*data_end = d;
+		} else {
+			mp_next(&d);
+		}
+	}
+	if (*data == NULL) {
+		xrow_on_decode_err(row, ER_MISSING_REQUEST_FIELD,
+				   iproto_key_name(IPROTO_DATA));
+		return -1;
+	}
+	return 0;
+}
+
 void
 xrow_encode_relay_heartbeat(struct xrow_header *row,
 			    const struct relay_heartbeat *req)
@@ -2480,6 +2820,18 @@ xrow_decode_vclock(const struct xrow_header *row, struct vclock *vclock)
 	return xrow_decode_replication_request(row, &base_req);
 }
 
+int
+xrow_decode_wait_vclock(const struct xrow_header *row, struct vclock *vclock)
+{
+	assert(row->wait_vclock != NULL);
+	const char *data = row->wait_vclock;
+	if (mp_decode_vclock_ignore0(&data, vclock) != 0) {
+		diag_set(ClientError, ER_INVALID_MSGPACK, "wait vclock");
+		return -1;
+	}
+	return 0;
+}
+
 void
 xrow_encode_subscribe_response(struct xrow_header *row,
 			       const struct subscribe_response *rsp)
@@ -116,6 +116,16 @@ struct xrow_header {
 	int bodycnt;
 	/* See `IPROTO_SCHEMA_VERSION`. */
 	uint64_t schema_version;
+	/**
+	 * See `IPROTO_WAIT_VCLOCK`. Points to the MsgPack map in the
+	 * request, NULL if the request doesn't wait for a vclock.
+	 */
+	const char *wait_vclock;
+	/**
+	 * See `IPROTO_WAIT_VCLOCK_TIMEOUT`. Negative if not set, in which
+	 * case replication_sync_timeout is used.
+	 */
+	double wait_vclock_timeout;
 	struct iovec body[XROW_BODY_IOVMAX];
 };
 
@@ -597,6 +607,18 @@ struct subscribe_request {
 	uint32_t version_id;
 	/** Flag whether the replica is anon. */
 	bool is_anon;
+	/**
+	 * Compression of the replication stream requested by the
+	 * replica, see enum replication_compression.
+	 */
+	uint32_t compression;
+	/**
+	 * MsgPack array of ids and names of the user spaces the replica
+	 * subscribes to or NULL if it subscribes to all the spaces.
+	 */
+	const char *space_filter;
+	/** End of the space_filter array. */
+	const char *space_filter_end;
 };
 
 /** Encode SUBSCRIBE request. */
@@ -637,6 +659,8 @@ struct join_request {
 	char instance_name[NODE_NAME_SIZE_MAX];
 	/** Replica's version. */
 	uint32_t version_id;
+	/** Replica wants the master checkpoint file, not a row stream. */
+	bool is_checkpoint_join;
 };
 
 /** Encode JOIN request. */
@@ -647,6 +671,80 @@ xrow_encode_join(struct xrow_header *row, const struct join_request *req);
 int
 xrow_decode_join(const struct xrow_header *row, struct join_request *req);
 
+/**
+ * Encode IPROTO_JOIN_FILE announcing @a size bytes of raw checkpoint
+ * file data that follow the row.
+ */
+void
+xrow_encode_join_file(struct xrow_header *row, uint64_t size);
+
+/** Decode IPROTO_JOIN_FILE. */
+int
+xrow_decode_join_file(const struct xrow_header *row, uint64_t *size);
+
+/** RESYNC request from a replica that can't follow the master. */
+struct resync_request {
+	/** Replica's replicaset UUID. */
+	struct tt_uuid replicaset_uuid;
+	/** Replica's instance UUID. */
+	struct tt_uuid instance_uuid;
+	/** Replica's vclock. */
+	struct vclock vclock;
+	/** Replica's version. */
+	uint32_t version_id;
+};
+
+/** Encode RESYNC request. */
+void
+xrow_encode_resync(struct xrow_header *row, const struct resync_request *req);
+
+/** Decode RESYNC request. */
+int
+xrow_decode_resync(const struct xrow_header *row, struct resync_request *req);
+
+/** RESYNC_HASH or RESYNC_FETCH request for a primary key range. */
+struct resync_range_request {
+	/** Space ID. */
+	uint32_t space_id;
+	/** Inclusive lower bound of the range, MP_ARRAY. */
+	const char *key;
+	const char *key_end;
+	/**
+	 * Exclusive upper bound of the range, MP_ARRAY, or NULL if
+	 * the range is unbounded.
+	 */
+	const char *upper;
+	const char *upper_end;
+	/** Number of subranges the range is split into by RESYNC_HASH. */
+	uint32_t limit;
+};
+
+/**
+ * Encode RESYNC_HASH or RESYNC_FETCH request. The body is allocated
+ * on the fiber region.
+ */
+void
+xrow_encode_resync_range(struct xrow_header *row, uint16_t type,
+			 const struct resync_range_request *req);
+
+/** Decode RESYNC_HASH or RESYNC_FETCH request. */
+int
+xrow_decode_resync_range(const struct xrow_header *row,
+			 struct resync_range_request *req);
+
+/**
+ * Encode a response to RESYNC_HASH or RESYNC_FETCH: IPROTO_OK with
+ * the given MP_ARRAY in IPROTO_DATA. The data isn't copied.
+ */
+void
+xrow_encode_resync_data(struct xrow_header *row, const char *data,
+			const char *data_end);
+
+/** Decode a response to RESYNC_HASH or RESYNC_FETCH. */
+int
+xrow_decode_resync_data(const struct xrow_header *row, const char **data,
+			const char **data_end);
+
 /**
  * Heartbeat from relay to applier. Follows the replication stream. Same
  * direction.
@@ -700,6 +798,10 @@ xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock);
 int
 xrow_decode_vclock(const struct xrow_header *row, struct vclock *vclock);
 
+/** Decode IPROTO_WAIT_VCLOCK of a request header. */
+int
+xrow_decode_wait_vclock(const struct xrow_header *row, struct vclock *vclock);
+
 /**
  * Encode any bodyless message.
  * @param row[out] Row to encode into.
@@ -859,10 +961,14 @@ struct sql_request {
 	const char *bind;
 	/** ID of prepared statement. In this case @sql_text == NULL. */
 	const char *stmt_id;
+	/** Max number of rows to return, NULL if not set. */
+	const char *fetch_size;
+	/** ID of the SQL cursor to fetch rows from (SQL_FETCH only). */
+	const char *cursor_id;
 };
 
 /**
- * Parse the EXECUTE request.
+ * Parse the EXECUTE, PREPARE or SQL_FETCH request.
  * @param row Encoded data.
  * @param[out] request Request to decode to.
  *
@@ -1149,6 +1255,41 @@ xrow_decode_join_xc(const struct xrow_header *row, struct join_request *req)
 		diag_raise();
 }
 
+/** @copydoc xrow_decode_join_file. */
+static inline void
+xrow_decode_join_file_xc(const struct xrow_header *row, uint64_t *size)
+{
+	if (xrow_decode_join_file(row, size) != 0)
+		diag_raise();
+}
+
+/** @copydoc xrow_decode_resync. */
+static inline void
+xrow_decode_resync_xc(const struct xrow_header *row,
+		      struct resync_request *req)
+{
+	if (xrow_decode_resync(row, req) != 0)
+		diag_raise();
+}
+
+/** @copydoc xrow_decode_resync_range. */
+static inline void
+xrow_decode_resync_range_xc(const struct xrow_header *row,
+			    struct resync_range_request *req)
+{
+	if (xrow_decode_resync_range(row, req) != 0)
+		diag_raise();
+}
+
+/** @copydoc xrow_decode_resync_data. */
+static inline void
+xrow_decode_resync_data_xc(const struct xrow_header *row, const char **data,
+			   const char **data_end)
+{
+	if (xrow_decode_resync_data(row, data, data_end) != 0)
+		diag_raise();
+}
+
 /** @copydoc xrow_decode_register. */
 static inline void
 xrow_decode_register_xc(const struct xrow_header *row,
@@ -35,6 +35,13 @@
 #include "error.h"
 #include "msgpuck/msgpuck.h"
 
+#include <zstd.h>
+
+enum {
+	/** Compression level of the replication stream. */
+	XROW_COMPRESSION_LEVEL = 3,
+};
+
 void
 coio_read_xrow(struct iostream *io, struct ibuf *in, struct xrow_header *row)
 {
@@ -61,15 +68,111 @@ coio_read_xrow(struct iostream *io, struct ibuf *in, struct xrow_header *row)
 			      true);
 }
 
+int
+xrow_compressor_create(struct xrow_compressor *c)
+{
+	memset(c, 0, sizeof(*c));
+	c->ctx = ZSTD_createCStream();
+	if (c->ctx == NULL) {
+		diag_set(OutOfMemory, sizeof(c->ctx), "ZSTD_createCStream",
+			 "ZSTD_CStream");
+		return -1;
+	}
+	size_t rc = ZSTD_initCStream(c->ctx, XROW_COMPRESSION_LEVEL);
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_COMPRESSION, ZSTD_getErrorName(rc));
+		ZSTD_freeCStream(c->ctx);
+		c->ctx = NULL;
+		return -1;
+	}
+	return 0;
+}
+
 void
-coio_read_xrow_timeout_xc(struct iostream *io, struct ibuf *in,
-			  struct xrow_header *row, ev_tstamp timeout)
+xrow_compressor_destroy(struct xrow_compressor *c)
+{
+	ZSTD_freeCStream(c->ctx);
+	c->ctx = NULL;
+}
+
+int
+xrow_decompressor_create(struct xrow_decompressor *d,
+			 struct slab_cache *slabc)
+{
+	memset(d, 0, sizeof(*d));
+	d->ctx = ZSTD_createDStream();
+	if (d->ctx == NULL) {
+		diag_set(OutOfMemory, sizeof(d->ctx), "ZSTD_createDStream",
+			 "ZSTD_DStream");
+		return -1;
+	}
+	size_t rc = ZSTD_initDStream(d->ctx);
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_DECOMPRESSION, ZSTD_getErrorName(rc));
+		ZSTD_freeDStream(d->ctx);
+		d->ctx = NULL;
+		return -1;
+	}
+	ibuf_create(&d->ibuf, slabc, 1024);
+	return 0;
+}
+
+void
+xrow_decompressor_destroy(struct xrow_decompressor *d)
+{
+	ibuf_destroy(&d->ibuf);
+	ZSTD_freeDStream(d->ctx);
+	d->ctx = NULL;
+}
+
+/**
+ * Read at least sz bytes to the buffer, decompressing the stream if
+ * the decompressor is set. Like coio_breadn_timeout(), may read ahead
+ * more.
+ */
+static void
+xrow_breadn_timeout(struct iostream *io, struct xrow_decompressor *d,
+		    struct ibuf *in, size_t sz, ev_tstamp timeout)
+{
+	if (d == NULL) {
+		coio_breadn_timeout(io, in, sz, timeout);
+		return;
+	}
+	ev_tstamp start, delay;
+	coio_timeout_init(&start, &delay, timeout);
+	size_t used = ibuf_used(in) + sz;
+	while (ibuf_used(in) < used) {
+		if (ibuf_used(&d->ibuf) == 0) {
+			ibuf_reset(&d->ibuf);
+			coio_breadn_timeout(io, &d->ibuf, 1, delay);
+			coio_timeout_update(&start, &delay);
+		}
+		ibuf_reserve_xc(in, MAX(used - ibuf_used(in),
+					ZSTD_DStreamOutSize()));
+		ZSTD_inBuffer input = {d->ibuf.rpos, ibuf_used(&d->ibuf), 0};
+		ZSTD_outBuffer output = {in->wpos, ibuf_unused(in), 0};
+		size_t rc = ZSTD_decompressStream(d->ctx, &output, &input);
+		if (ZSTD_isError(rc)) {
+			tnt_raise(ClientError, ER_DECOMPRESSION,
+				  ZSTD_getErrorName(rc));
+		}
+		d->ibuf.rpos += input.pos;
+		in->wpos += output.pos;
+		d->compressed_bytes += input.pos;
+		d->raw_bytes += output.pos;
+	}
+}
+
+static void
+coio_read_xrow_timeout_impl(struct iostream *io, struct xrow_decompressor *d,
+			    struct ibuf *in, struct xrow_header *row,
+			    ev_tstamp timeout)
 {
 	ev_tstamp start, delay;
 	coio_timeout_init(&start, &delay, timeout);
 	/* Read fixed header */
 	if (ibuf_used(in) < 1)
-		coio_breadn_timeout(io, in, 1, delay);
+		xrow_breadn_timeout(io, d, in, 1, delay);
 	coio_timeout_update(&start, &delay);
 
 	/* Read length */
@@ -79,19 +182,34 @@ coio_read_xrow_timeout_xc(struct iostream *io, struct ibuf *in,
 	}
 	ssize_t to_read = mp_check_uint(in->rpos, in->wpos);
 	if (to_read > 0)
-		coio_breadn_timeout(io, in, to_read, delay);
+		xrow_breadn_timeout(io, d, in, to_read, delay);
 	coio_timeout_update(&start, &delay);
 
 	uint64_t len = mp_decode_uint((const char **)&in->rpos);
 
 	/* Read header and body */
 	if (len > ibuf_used(in))
-		coio_breadn_timeout(io, in, len - ibuf_used(in), delay);
+		xrow_breadn_timeout(io, d, in, len - ibuf_used(in), delay);
 
 	xrow_header_decode_xc(row, (const char **) &in->rpos, in->rpos + len,
 			      true);
 }
 
+void
+coio_read_xrow_timeout_xc(struct iostream *io, struct ibuf *in,
+			  struct xrow_header *row, ev_tstamp timeout)
+{
+	coio_read_xrow_timeout_impl(io, NULL, in, row, timeout);
+}
+
+void
+coio_read_xrow_compressed_timeout_xc(struct iostream *io,
+				     struct xrow_decompressor *d,
+				     struct ibuf *in, struct xrow_header *row,
+				     ev_tstamp timeout)
+{
+	coio_read_xrow_timeout_impl(io, d, in, row, timeout);
+}
 
 void
 coio_write_xrow(struct iostream *io, const struct xrow_header *row)
@@ -104,3 +222,57 @@ coio_write_xrow(struct iostream *io, const struct xrow_header *row)
 		diag_raise();
 }
 
+/** Write the compressor output to the stream. */
+static void
+coio_write_compressed(struct iostream *io, struct xrow_compressor *c,
+		      const ZSTD_outBuffer *output)
+{
+	if (coio_write_timeout(io, output->dst, output->pos,
+			       TIMEOUT_INFINITY) < 0)
+		diag_raise();
+	c->compressed_bytes += output->pos;
+}
+
+void
+coio_write_xrow_compressed(struct iostream *io, struct xrow_compressor *c,
+			   const struct xrow_header *row)
+{
+	RegionGuard region_guard(&fiber()->gc);
+	int iovcnt;
+	struct iovec iov[XROW_IOVMAX];
+	xrow_to_iovec(row, iov, &iovcnt);
+	/*
+	 * The output buffer is allocated on the fiber region rather than
+	 * owned by the compressor, because the compressed data of one row
+	 * must survive a yield in coio_write() while another fiber may be
+	 * compressing the next row.
+	 */
+	size_t size = ZSTD_CStreamOutSize();
+	char *buf = (char *)xregion_alloc(&fiber()->gc, size);
+	ZSTD_outBuffer output = {buf, size, 0};
+	for (int i = 0; i <= iovcnt; i++) {
+		ZSTD_inBuffer input = {NULL, 0, 0};
+		if (i < iovcnt) {
+			input.src = iov[i].iov_base;
+			input.size = iov[i].iov_len;
+			c->raw_bytes += iov[i].iov_len;
+		}
+		size_t rc;
+		do {
+			if (output.pos == output.size) {
+				coio_write_compressed(io, c, &output);
+				output.pos = 0;
+			}
+			if (i < iovcnt)
+				rc = ZSTD_compressStream(c->ctx, &output,
+							 &input);
+			else
+				rc = ZSTD_flushStream(c->ctx, &output);
+			if (ZSTD_isError(rc)) {
+				tnt_raise(ClientError, ER_COMPRESSION,
+					  ZSTD_getErrorName(rc));
+			}
+		} while (i < iovcnt ? input.pos < input.size : rc != 0);
+	}
+	coio_write_compressed(io, c, &output);
+}
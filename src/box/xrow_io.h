@@ -30,13 +30,67 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <stdint.h>
+
+#include "small/ibuf.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
-struct ibuf;
 struct iostream;
 struct xrow_header;
+struct slab_cache;
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+/**
+ * Streaming zstd compressor of a stream of rows. All rows are
+ * compressed as one zstd frame, which is flushed after each row, so
+ * the window built on the previous rows is used to compress the next
+ * ones.
+ */
+struct xrow_compressor {
+	/** Compression context reused for all rows. */
+	struct ZSTD_CCtx_s *ctx;
+	/** Number of bytes fed to the compressor. */
+	uint64_t raw_bytes;
+	/** Number of compressed bytes written to the stream. */
+	uint64_t compressed_bytes;
+};
+
+/** Create a compressor. Returns -1 and sets diag on error. */
+int
+xrow_compressor_create(struct xrow_compressor *c);
+
+void
+xrow_compressor_destroy(struct xrow_compressor *c);
+
+/**
+ * Streaming zstd decompressor, the counterpart of xrow_compressor.
+ */
+struct xrow_decompressor {
+	/** Decompression context reused for all rows. */
+	struct ZSTD_DCtx_s *ctx;
+	/** Compressed data read from the stream but not decompressed yet. */
+	struct ibuf ibuf;
+	/** Number of decompressed bytes. */
+	uint64_t raw_bytes;
+	/** Number of compressed bytes read from the stream. */
+	uint64_t compressed_bytes;
+};
+
+/**
+ * Create a decompressor. The input buffer is allocated from the given
+ * slab cache, so the decompressor may be used only in the thread owning
+ * it. Returns -1 and sets diag on error.
+ */
+int
+xrow_decompressor_create(struct xrow_decompressor *d,
+			 struct slab_cache *slabc);
+
+void
+xrow_decompressor_destroy(struct xrow_decompressor *d);
 
 void
 coio_read_xrow(struct iostream *io, struct ibuf *in, struct xrow_header *row);
@@ -48,6 +102,21 @@ coio_read_xrow_timeout_xc(struct iostream *io, struct ibuf *in,
 void
 coio_write_xrow(struct iostream *io, const struct xrow_header *row);
 
+/**
+ * Same as coio_read_xrow_timeout_xc(), but the stream is compressed
+ * by xrow_compressor. The decompressed data is read to the buffer.
+ */
+void
+coio_read_xrow_compressed_timeout_xc(struct iostream *io,
+				     struct xrow_decompressor *d,
+				     struct ibuf *in, struct xrow_header *row,
+				     double timeout);
+
+/** Compress a row and write it to the stream. */
+void
+coio_write_xrow_compressed(struct iostream *io, struct xrow_compressor *c,
+			   const struct xrow_header *row);
+
 
 #if defined(__cplusplus)
 } /* extern "C" */
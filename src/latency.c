@@ -95,3 +95,11 @@ latency_get(struct latency *latency, int pct)
 	int64_t value_usec = histogram_percentile(latency->histogram, pct);
 	return (double)value_usec / USEC_PER_SEC;
 }
+
+size_t
+latency_count(struct latency *latency)
+{
+	/* Don't count the zero observation added on creation. */
+	assert(latency->histogram->total > 0);
+	return latency->histogram->total - 1;
+}
@@ -31,6 +31,12 @@
  * SUCH DAMAGE.
  */
 
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 struct histogram;
 
 /**
@@ -77,4 +83,15 @@ latency_collect(struct latency *latency, double value);
 double
 latency_get(struct latency *latency, int pct);
 
+/**
+ * Get the number of observations collected since the counter
+ * was created or reset.
+ */
+size_t
+latency_count(struct latency *latency);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif
+
 #endif /* TARANTOOL_LATENCY_H_INCLUDED */
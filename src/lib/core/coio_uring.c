@@ -0,0 +1,332 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "coio_uring.h"
+
+#include "trivia/config.h"
+
+#include <errno.h>
+
+#include "diag.h"
+#include "fiber.h"
+#include "trivia/util.h"
+
+#if defined(HAVE_IO_URING)
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include "fiber_cond.h"
+#include "say.h"
+
+/** Submission queue ring mapped from the kernel. */
+struct coio_uring_sq {
+	unsigned *head;
+	unsigned *tail;
+	unsigned *ring_mask;
+	unsigned *array;
+	struct io_uring_sqe *sqes;
+};
+
+/** Completion queue ring mapped from the kernel. */
+struct coio_uring_cq {
+	unsigned *head;
+	unsigned *tail;
+	unsigned *ring_mask;
+	struct io_uring_cqe *cqes;
+};
+
+struct coio_uring {
+	/** io_uring file descriptor. */
+	int fd;
+	/** Submission queue. */
+	struct coio_uring_sq sq;
+	/** Completion queue. */
+	struct coio_uring_cq cq;
+	/** Mapped memory, for munmap(). */
+	void *sq_ptr;
+	size_t sq_size;
+	void *cq_ptr;
+	size_t cq_size;
+	size_t sqes_size;
+	/**
+	 * Number of requests added to the submission queue but not
+	 * yet passed to the kernel. They are submitted in a batch
+	 * before the event loop blocks, see coio_uring_prepare_cb().
+	 */
+	unsigned to_submit;
+	/** Number of requests passed to the kernel. */
+	unsigned in_flight;
+	/**
+	 * Max number of requests that may be in progress. Limited
+	 * by the size of the queues so that neither the submission
+	 * queue nor the completion queue can overflow.
+	 */
+	unsigned max_in_flight;
+	/** Signalled when a slot for a new request is freed. */
+	struct fiber_cond cond;
+	/** Event loop the ring is attached to. */
+	struct ev_loop *loop;
+	/** Fires when the completion queue isn't empty. */
+	struct ev_io io;
+	/** Submits pending requests before the loop blocks. */
+	struct ev_prepare prepare;
+};
+
+/** A request waiting for completion. */
+struct coio_uring_request {
+	/** Fiber waiting for the request. */
+	struct fiber *fiber;
+	/** Buffer passed to the kernel. */
+	struct iovec iov;
+	/** Result of the request, negative errno on error. */
+	int res;
+	/** Set when the request completes. */
+	bool is_done;
+};
+
+static inline int
+sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int
+sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+		   unsigned flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+/** Pass all pending requests to the kernel. */
+static void
+coio_uring_submit(struct coio_uring *ring)
+{
+	while (ring->to_submit > 0) {
+		int rc = sys_io_uring_enter(ring->fd, ring->to_submit, 0, 0);
+		if (rc >= 0) {
+			assert((unsigned)rc <= ring->to_submit);
+			ring->to_submit -= rc;
+			ring->in_flight += rc;
+			continue;
+		}
+		/*
+		 * EAGAIN means that the kernel is short of memory
+		 * and EBUSY can't happen since the number of
+		 * requests in progress never exceeds the size of
+		 * the completion queue, so just retry. Anything
+		 * else means the ring is broken.
+		 */
+		if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			panic_syserror("io_uring_enter");
+	}
+}
+
+static void
+coio_uring_prepare_cb(struct ev_loop *loop, struct ev_prepare *watcher,
+		      int events)
+{
+	(void)loop;
+	(void)events;
+	struct coio_uring *ring = watcher->data;
+	coio_uring_submit(ring);
+}
+
+/** Reap completed requests and wake up the fibers waiting for them. */
+static void
+coio_uring_io_cb(struct ev_loop *loop, struct ev_io *watcher, int events)
+{
+	(void)loop;
+	(void)events;
+	struct coio_uring *ring = watcher->data;
+	struct coio_uring_cq *cq = &ring->cq;
+	unsigned head = *cq->head;
+	unsigned tail = __atomic_load_n(cq->tail, __ATOMIC_ACQUIRE);
+	unsigned count = tail - head;
+	for (; head != tail; head++) {
+		struct io_uring_cqe *cqe = &cq->cqes[head & *cq->ring_mask];
+		struct coio_uring_request *req =
+			(struct coio_uring_request *)(uintptr_t)cqe->user_data;
+		req->res = cqe->res;
+		req->is_done = true;
+		fiber_wakeup(req->fiber);
+	}
+	__atomic_store_n(cq->head, head, __ATOMIC_RELEASE);
+	assert(ring->in_flight >= count);
+	ring->in_flight -= count;
+	if (count > 0)
+		fiber_cond_broadcast(&ring->cond);
+}
+
+struct coio_uring *
+coio_uring_new(unsigned entries)
+{
+	struct coio_uring *ring = calloc(1, sizeof(*ring));
+	if (ring == NULL) {
+		diag_set(OutOfMemory, sizeof(*ring), "malloc", "coio_uring");
+		return NULL;
+	}
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	ring->fd = sys_io_uring_setup(entries, &params);
+	if (ring->fd < 0) {
+		diag_set(SystemError, "io_uring_setup");
+		free(ring);
+		return NULL;
+	}
+	ring->sq_size = params.sq_off.array +
+			params.sq_entries * sizeof(unsigned);
+	ring->cq_size = params.cq_off.cqes +
+			params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, ring->fd,
+			    IORING_OFF_SQ_RING);
+	ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, ring->fd,
+			    IORING_OFF_CQ_RING);
+	ring->sq.sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			     MAP_SHARED | MAP_POPULATE, ring->fd,
+			     IORING_OFF_SQES);
+	if (ring->sq_ptr == MAP_FAILED || ring->cq_ptr == MAP_FAILED ||
+	    ring->sq.sqes == MAP_FAILED) {
+		diag_set(SystemError, "failed to map io_uring");
+		goto fail;
+	}
+	char *sq_ptr = ring->sq_ptr;
+	ring->sq.head = (unsigned *)(sq_ptr + params.sq_off.head);
+	ring->sq.tail = (unsigned *)(sq_ptr + params.sq_off.tail);
+	ring->sq.ring_mask = (unsigned *)(sq_ptr + params.sq_off.ring_mask);
+	ring->sq.array = (unsigned *)(sq_ptr + params.sq_off.array);
+	char *cq_ptr = ring->cq_ptr;
+	ring->cq.head = (unsigned *)(cq_ptr + params.cq_off.head);
+	ring->cq.tail = (unsigned *)(cq_ptr + params.cq_off.tail);
+	ring->cq.ring_mask = (unsigned *)(cq_ptr + params.cq_off.ring_mask);
+	ring->cq.cqes = (struct io_uring_cqe *)(cq_ptr + params.cq_off.cqes);
+
+	ring->max_in_flight = MIN(params.sq_entries, params.cq_entries);
+	fiber_cond_create(&ring->cond);
+	ring->loop = loop();
+	ev_io_init(&ring->io, coio_uring_io_cb, ring->fd, EV_READ);
+	ring->io.data = ring;
+	ev_io_start(ring->loop, &ring->io);
+	ev_prepare_init(&ring->prepare, coio_uring_prepare_cb);
+	ring->prepare.data = ring;
+	ev_prepare_start(ring->loop, &ring->prepare);
+	return ring;
+fail:
+	if (ring->sq_ptr != MAP_FAILED && ring->sq_ptr != NULL)
+		munmap(ring->sq_ptr, ring->sq_size);
+	if (ring->cq_ptr != MAP_FAILED && ring->cq_ptr != NULL)
+		munmap(ring->cq_ptr, ring->cq_size);
+	if (ring->sq.sqes != MAP_FAILED && ring->sq.sqes != NULL)
+		munmap(ring->sq.sqes, ring->sqes_size);
+	close(ring->fd);
+	free(ring);
+	return NULL;
+}
+
+void
+coio_uring_delete(struct coio_uring *ring)
+{
+	assert(ring->loop == loop());
+	ev_io_stop(ring->loop, &ring->io);
+	ev_prepare_stop(ring->loop, &ring->prepare);
+	fiber_cond_destroy(&ring->cond);
+	munmap(ring->sq.sqes, ring->sqes_size);
+	munmap(ring->cq_ptr, ring->cq_size);
+	munmap(ring->sq_ptr, ring->sq_size);
+	close(ring->fd);
+	free(ring);
+}
+
+ssize_t
+coio_uring_pread(struct coio_uring *ring, int fd, void *buf, size_t count,
+		 off_t offset)
+{
+	assert(ring->loop == loop());
+	while (ring->in_flight + ring->to_submit >= ring->max_in_flight) {
+		if (fiber_cond_wait(&ring->cond) != 0) {
+			errno = ECANCELED;
+			return -1;
+		}
+	}
+	struct coio_uring_request req;
+	req.fiber = fiber();
+	req.iov.iov_base = buf;
+	req.iov.iov_len = count;
+	req.res = 0;
+	req.is_done = false;
+
+	struct coio_uring_sq *sq = &ring->sq;
+	unsigned tail = *sq->tail;
+	unsigned index = tail & *sq->ring_mask;
+	struct io_uring_sqe *sqe = &sq->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)&req.iov;
+	sqe->len = 1;
+	sqe->off = offset;
+	sqe->user_data = (uintptr_t)&req;
+	sq->array[index] = index;
+	__atomic_store_n(sq->tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+	/*
+	 * The request and the buffer are used by the kernel until
+	 * the request completes so we can't return before it even
+	 * if the fiber is woken up or cancelled.
+	 */
+	while (!req.is_done)
+		fiber_yield();
+	if (req.res < 0) {
+		errno = -req.res;
+		return -1;
+	}
+	return req.res;
+}
+
+#else /* !defined(HAVE_IO_URING) */
+
+struct coio_uring *
+coio_uring_new(unsigned entries)
+{
+	(void)entries;
+	errno = ENOSYS;
+	diag_set(SystemError, "io_uring is not supported");
+	return NULL;
+}
+
+void
+coio_uring_delete(struct coio_uring *ring)
+{
+	(void)ring;
+	unreachable();
+}
+
+ssize_t
+coio_uring_pread(struct coio_uring *ring, int fd, void *buf, size_t count,
+		 off_t offset)
+{
+	(void)ring;
+	(void)fd;
+	(void)buf;
+	(void)count;
+	(void)offset;
+	unreachable();
+	errno = ENOSYS;
+	return -1;
+}
+
+#endif /* !defined(HAVE_IO_URING) */
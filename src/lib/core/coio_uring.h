@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Cooperative file I/O based on Linux io_uring.
+ *
+ * Unlike coio_file, which executes blocking system calls in
+ * the coio thread pool, requests are submitted to the kernel
+ * directly from the calling cord, and the calling fiber yields
+ * until the request completes. Requests issued by different
+ * fibers within the same event loop iteration are submitted
+ * with a single system call. Completions are reaped by the
+ * event loop of the cord that created the ring.
+ *
+ * A ring may only be used by fibers of the cord that created it.
+ * Like coio_file, it doesn't support timeouts or cancellation
+ * and follows the error reporting convention of the respective
+ * system calls.
+ */
+struct coio_uring;
+
+/**
+ * Create an io_uring instance and attach it to the event loop of
+ * the current cord.
+ *
+ * @param entries - max number of requests submitted at once
+ * @return the new ring or NULL if io_uring isn't supported by
+ *  the kernel or the build, in which case diag is set
+ */
+struct coio_uring *
+coio_uring_new(unsigned entries);
+
+/**
+ * Destroy an io_uring instance. Requests in progress are aborted
+ * and fibers waiting for them are never woken up so this function
+ * should only be called when there are no such fibers or on
+ * shutdown.
+ */
+void
+coio_uring_delete(struct coio_uring *ring);
+
+/**
+ * Read up to @a count bytes at @a offset from file @a fd.
+ * Yields the current fiber until the read completes.
+ *
+ * @return number of bytes read on success, -1 on error (errno
+ *  is set)
+ */
+ssize_t
+coio_uring_pread(struct coio_uring *ring, int fd, void *buf, size_t count,
+		 off_t offset);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
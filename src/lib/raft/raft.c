@@ -245,6 +245,68 @@ raft_is_leader_seen(const struct raft *raft)
 	return is_seen;
 }
 
+/**
+ * Share of the lease duration reserved for the clock rate difference between
+ * the instances.
+ */
+static const double raft_lease_drift = 0.1;
+
+/**
+ * Time a follower keeps supporting its leader since the last heartbeat. It
+ * can't be longer than the time the follower waits for the leader before giving
+ * up on it, nor than the election timeout.
+ */
+static inline double
+raft_lease_timeout(const struct raft *raft)
+{
+	if (raft->election_timeout < raft->death_timeout)
+		return raft->election_timeout;
+	return raft->death_timeout;
+}
+
+/** Duration of the leader lease counting from a heartbeat send time. */
+static inline double
+raft_lease_duration(const struct raft *raft)
+{
+	return raft_lease_timeout(raft) * (1 - raft_lease_drift);
+}
+
+/** Forget the lease acknowledgements of the given peer. */
+static inline void
+raft_lease_forget(struct raft *raft, uint32_t source)
+{
+	raft->lease_seen[source] = 0;
+	raft->lease_ack[source] = 0;
+}
+
+/** Forget the lease acknowledgements of all the peers. */
+static inline void
+raft_lease_reset(struct raft *raft)
+{
+	memset(raft->lease_seen, 0, sizeof(raft->lease_seen));
+	memset(raft->lease_ack, 0, sizeof(raft->lease_ack));
+}
+
+/**
+ * Check if a newer term coming from the given source must be ignored, because
+ * the leader could count this instance in its lease. The leader itself doesn't
+ * need that - it just loses the lease on a term bump.
+ */
+static bool
+raft_lease_is_term_blocked(const struct raft *raft, uint64_t term,
+			   uint32_t source)
+{
+	if (!raft->is_lease_enabled || !raft->is_enabled ||
+	    term <= raft->volatile_term || raft->state == RAFT_STATE_LEADER)
+		return false;
+	if (raft->leader == 0 || raft->leader == raft->self ||
+	    raft->leader == source)
+		return false;
+	double idle = raft_ev_monotonic_now(raft_loop()) -
+		      raft->leader_last_seen;
+	return idle < raft_lease_timeout(raft);
+}
+
 /** Schedule broadcast of the complete Raft state to all the followers. */
 static void
 raft_schedule_broadcast(struct raft *raft);
@@ -458,9 +520,18 @@ raft_notify_is_leader_seen(struct raft *raft, bool is_leader_seen,
 			   uint32_t source)
 {
 	assert(source > 0 && source < VCLOCK_MAX && source != raft->self);
-	/* Leader doesn't care whether someone sees it or not. */
-	if (raft->state == RAFT_STATE_LEADER)
+	/*
+	 * Leader doesn't care whether someone sees it or not, except for the
+	 * lease which only counts the peers seeing the leader.
+	 */
+	if (raft->state == RAFT_STATE_LEADER) {
+		if (!is_leader_seen)
+			raft_lease_forget(raft, source);
+		else if (raft->lease_seen[source] == 0)
+			raft->lease_seen[source] =
+				raft_ev_monotonic_now(raft_loop());
 		return;
+	}
 
 	if (is_leader_seen)
 		bit_set(&raft->leader_witness_map, source);
@@ -525,6 +596,12 @@ raft_process_msg(struct raft *raft, const struct raft_msg *req, uint32_t source)
 		return 0;
 	}
 
+	if (raft_lease_is_term_blocked(raft, req->term, source)) {
+		say_info("RAFT: the message is ignored - the leader lease may "
+			 "be active");
+		return 0;
+	}
+
 	/* Term bump. */
 	raft_process_term(raft, req->term, source);
 
@@ -696,6 +773,58 @@ raft_process_heartbeat(struct raft *raft, uint32_t source)
 	raft_sm_wait_leader_dead(raft);
 }
 
+void
+raft_process_lease_ack(struct raft *raft, uint32_t source, uint64_t term,
+		       double sent_time)
+{
+	if (source == 0 || raft->state != RAFT_STATE_LEADER ||
+	    term != raft->volatile_term)
+		return;
+	assert(source < VCLOCK_MAX && source != raft->self);
+	/*
+	 * The heartbeat could be sent before the peer saw this instance as the
+	 * leader. Then the peer could support another instance at that time.
+	 */
+	double seen = raft->lease_seen[source];
+	if (seen == 0 || sent_time < seen)
+		return;
+	if (sent_time > raft->lease_ack[source])
+		raft->lease_ack[source] = sent_time;
+}
+
+double
+raft_lease_remaining(const struct raft *raft)
+{
+	if (!raft->is_lease_enabled || !raft->is_enabled ||
+	    raft->state != RAFT_STATE_LEADER)
+		return 0;
+	double now = raft_ev_monotonic_now(raft_loop());
+	double start = now;
+	/* The leader is always a part of the quorum. */
+	int count = raft->election_quorum - 1;
+	if (count > 0) {
+		/*
+		 * The lease starts at the latest send time acknowledged by a
+		 * quorum of the peers.
+		 */
+		start = 0;
+		for (int i = 0; i < VCLOCK_MAX; i++) {
+			double ack = raft->lease_ack[i];
+			if (ack <= start)
+				continue;
+			int newer = 0;
+			for (int j = 0; j < VCLOCK_MAX; j++)
+				newer += raft->lease_ack[j] >= ack;
+			if (newer >= count)
+				start = ack;
+		}
+		if (start == 0)
+			return 0;
+	}
+	double remaining = start + raft_lease_duration(raft) - now;
+	return remaining > 0 ? remaining : 0;
+}
+
 /* Dump Raft state to WAL in a blocking way. */
 static void
 raft_worker_handle_io(struct raft *raft)
@@ -847,6 +976,7 @@ raft_sm_become_leader(struct raft *raft)
 	assert(!raft->is_write_in_progress);
 	raft->state = RAFT_STATE_LEADER;
 	raft->leader = raft->self;
+	raft_lease_reset(raft);
 	raft_ev_timer_stop(raft_loop(), &raft->timer);
 	/* State is visible and it is changed - broadcast. */
 	raft_schedule_broadcast(raft);
@@ -1228,6 +1358,12 @@ raft_restore(struct raft *raft)
 	raft_set_candidate(raft, raft->is_cfg_candidate && raft->is_enabled);
 }
 
+void
+raft_cfg_is_lease_enabled(struct raft *raft, bool is_enabled)
+{
+	raft->is_lease_enabled = is_enabled;
+}
+
 void
 raft_cfg_election_timeout(struct raft *raft, double timeout)
 {
@@ -1331,6 +1467,11 @@ raft_process_term(struct raft *raft, uint64_t term, uint32_t source)
 {
 	if (term <= raft->volatile_term)
 		return;
+	if (raft_lease_is_term_blocked(raft, term, source)) {
+		say_info("RAFT: a newer term from %u is ignored - the leader "
+			 "lease may be active", (unsigned)source);
+		return;
+	}
 	say_info("RAFT: received a newer term from %u", (unsigned)source);
 	raft_sm_schedule_new_term(raft, term);
 }
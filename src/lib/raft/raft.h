@@ -187,6 +187,13 @@ struct raft {
 	bool is_candidate;
 	/** Flag whether the instance is allowed to be a leader. */
 	bool is_cfg_candidate;
+	/**
+	 * Flag whether the leader lease is enabled. When it is, the leader
+	 * considers itself the only leader for a while after a quorum of
+	 * followers acknowledged its heartbeats, and the followers promise not
+	 * to support a newer term during that time. See raft_lease_remaining().
+	 */
+	bool is_lease_enabled;
 	/**
 	 * Flag whether Raft currently tries to write something into WAL. It
 	 * happens asynchronously, not right after Raft state is updated.
@@ -234,6 +241,17 @@ struct raft {
 	struct ev_timer timer;
 	/** The moment of the last communication with the leader. */
 	double leader_last_seen;
+	/**
+	 * The moment when each peer was first known to see this instance as
+	 * the leader of the current term. Zero if the peer doesn't see it.
+	 * Only used in the leader state.
+	 */
+	double lease_seen[VCLOCK_MAX];
+	/**
+	 * Send time of the latest heartbeat acknowledged by each peer after it
+	 * saw this instance as the leader. Only used in the leader state.
+	 */
+	double lease_ack[VCLOCK_MAX];
 	/** Configured election timeout in seconds. */
 	double election_timeout;
 	/**
@@ -291,6 +309,15 @@ raft_leader_idle(const struct raft *raft)
 	return 0;
 }
 
+/**
+ * Number of seconds the leader lease of this instance remains valid. While it
+ * is positive, no other instance can become a leader, so the data of this
+ * instance is up to date. Zero if the instance is not a leader, or the lease is
+ * disabled or expired.
+ */
+double
+raft_lease_remaining(const struct raft *raft);
+
 /** Process a raft entry stored in WAL/snapshot. */
 void
 raft_process_recovery(struct raft *raft, const struct raft_msg *req);
@@ -311,6 +338,15 @@ raft_process_async(struct raft *raft);
 void
 raft_process_heartbeat(struct raft *raft, uint32_t source);
 
+/**
+ * Process an acknowledgement of the leader heartbeat sent at @a sent_time, that
+ * is received from an instance with the given ID in the given term. It extends
+ * the leader lease.
+ */
+void
+raft_process_lease_ack(struct raft *raft, uint32_t source, uint64_t term,
+		       double sent_time);
+
 /** Configure whether Raft is enabled. */
 void
 raft_cfg_is_enabled(struct raft *raft, bool is_enabled);
@@ -359,6 +395,13 @@ raft_resign(struct raft *raft);
 void
 raft_restore(struct raft *raft);
 
+/**
+ * Configure whether the leader lease is enabled. It must be enabled on all the
+ * instances to be safe.
+ */
+void
+raft_cfg_is_lease_enabled(struct raft *raft, bool is_enabled);
+
 /** Configure Raft leader election timeout. */
 void
 raft_cfg_election_timeout(struct raft *raft, double timeout);
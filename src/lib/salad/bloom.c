@@ -58,6 +58,54 @@ bloom_create(struct bloom *bloom, uint32_t number_of_values,
 	return 0;
 }
 
+const uint32_t bloom_split_salt[BLOOM_SPLIT_HASH_COUNT] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+int
+bloom_split_create(struct bloom *bloom, uint32_t number_of_values,
+		   double false_positive_rate)
+{
+	/*
+	 * Each value sets BLOOM_SPLIT_HASH_COUNT bits so the bit
+	 * count is chosen so that the probability of a bit being
+	 * set is false_positive_rate ^ (1 / BLOOM_SPLIT_HASH_COUNT).
+	 * Buckets are not loaded evenly, which increases the false
+	 * positive rate, so reserve some more space on top of it.
+	 */
+	double bit_set_prob = pow(false_positive_rate,
+				  1.0 / BLOOM_SPLIT_HASH_COUNT);
+	double bits_per_value = -BLOOM_SPLIT_HASH_COUNT /
+				log(1 - MIN(bit_set_prob, 0.99));
+	uint64_t bit_count = ceil(number_of_values * bits_per_value * 1.1);
+	uint32_t block_bits = CHAR_BIT * sizeof(struct bloom_block);
+	uint32_t block_count = (bit_count + block_bits - 1) / block_bits;
+	if (block_count == 0)
+		block_count = 1;
+
+	bloom->table = calloc(block_count, sizeof(*bloom->table));
+	if (bloom->table == NULL)
+		return -1;
+
+	bloom->table_size = block_count;
+	bloom->hash_count = BLOOM_SPLIT_HASH_COUNT;
+	return 0;
+}
+
+double
+bloom_split_fpr(const struct bloom *bloom, uint32_t number_of_values)
+{
+	/* Number of hash functions. */
+	uint16_t k = BLOOM_SPLIT_HASH_COUNT;
+	/* Number of bits. */
+	uint64_t m = bloom->table_size * sizeof(struct bloom_block) * CHAR_BIT;
+	/* Number of elements. */
+	uint32_t n = number_of_values;
+	/* False positive rate. */
+	return pow(1 - exp((double) -k * n / m), k);
+}
+
 void
 bloom_destroy(struct bloom *bloom)
 {
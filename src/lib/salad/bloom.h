@@ -49,6 +49,10 @@
 #include <limits.h>
 #include "bit/bit.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif /* defined(__AVX2__) */
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -60,6 +64,16 @@ enum {
 
 typedef uint32_t bloom_hash_t;
 
+enum {
+	/** Number of bits set per value in a split block bloom filter. */
+	BLOOM_SPLIT_HASH_COUNT = 8,
+	/** Size of a split block bloom filter bucket, in bytes. */
+	BLOOM_SPLIT_BUCKET_SIZE = BLOOM_SPLIT_HASH_COUNT * sizeof(uint32_t),
+	/** Number of split block bloom filter buckets per block. */
+	BLOOM_SPLIT_BUCKETS_PER_BLOCK =
+		BLOOM_CACHE_LINE / BLOOM_SPLIT_BUCKET_SIZE,
+};
+
 /**
  * Cache-line-size block of bloom filter
  */
@@ -158,6 +172,65 @@ bloom_store(const struct bloom *bloom, char *table);
 int
 bloom_load_table(struct bloom *bloom, const char *table);
 
+/**
+ * Split block bloom filter.
+ *
+ * A value is mapped to a 256-bit bucket, which is split into
+ * BLOOM_SPLIT_HASH_COUNT 32-bit words, and exactly one bit is set
+ * in each word. For the same false positive rate, it takes a bit
+ * more memory than the classic bloom filter, but checking a value
+ * needs exactly one memory access and, if AVX2 is available, can
+ * be done with a few SIMD instructions instead of a loop.
+ *
+ * The filter uses the same struct bloom: table_size is the number
+ * of cache-line-size blocks, each of which stores
+ * BLOOM_SPLIT_BUCKETS_PER_BLOCK buckets, and hash_count is always
+ * BLOOM_SPLIT_HASH_COUNT. The table is stored and loaded with
+ * bloom_store() and bloom_load_table().
+ *
+ * See also the Apache Parquet split block bloom filter spec:
+ *  https://github.com/apache/parquet-format/blob/master/BloomFilter.md
+ */
+
+/**
+ * Allocate and initialize an instance of split block bloom filter
+ *
+ * @param bloom - structure to initialize
+ * @param number_of_values - estimated number of values to be added
+ * @param false_positive_rate - desired false positive rate
+ * @return 0 - OK, -1 - memory error
+ */
+int
+bloom_split_create(struct bloom *bloom, uint32_t number_of_values,
+		   double false_positive_rate);
+
+/**
+ * Add a value into a split block bloom filter
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ */
+static void
+bloom_split_add(struct bloom *bloom, bloom_hash_t hash);
+
+/**
+ * Query for presence of a value in a split block bloom filter
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ * @return true - the value could be in data set; false - the value is
+ *  definitively not in data set
+ */
+static bool
+bloom_split_maybe_has(const struct bloom *bloom, bloom_hash_t hash);
+
+/**
+ * Return the expected false positive rate of a split block bloom filter.
+ * @param bloom - the bloom filter
+ * @param number_of_values - number of values stored in the filter
+ * @return - expected false positive rate
+ */
+double
+bloom_split_fpr(const struct bloom *bloom, uint32_t number_of_values);
+
 /* }}} API declaration */
 
 /* {{{ API definition */
@@ -204,6 +277,87 @@ bloom_maybe_has(const struct bloom *bloom, bloom_hash_t hash)
 	return true;
 }
 
+/** Odd constants used to derive bit numbers within a bucket. */
+extern const uint32_t bloom_split_salt[BLOOM_SPLIT_HASH_COUNT];
+
+/** Return the bucket a value with the given hash is mapped to. */
+static inline uint32_t *
+bloom_split_bucket(const struct bloom *bloom, bloom_hash_t hash)
+{
+	uint64_t bucket_count = (uint64_t)bloom->table_size *
+				BLOOM_SPLIT_BUCKETS_PER_BLOCK;
+	/*
+	 * Use the upper part of a mixed hash for finding a bucket so
+	 * that it is independent of the bit numbers, which are
+	 * derived from the lower part, and map it to the bucket
+	 * range with multiply-shift instead of costly modulo.
+	 */
+	uint64_t mixed = (uint64_t)hash * 0x9e3779b97f4a7c15ULL;
+	uint64_t pos = ((mixed >> 32) * bucket_count) >> 32;
+	return (uint32_t *)bloom->table + pos * BLOOM_SPLIT_HASH_COUNT;
+}
+
+#if defined(__AVX2__)
+
+/** Return the mask of bits to set in a bucket for a given hash. */
+static inline __m256i
+bloom_split_mask(bloom_hash_t hash)
+{
+	__m256i salt = _mm256_loadu_si256((const __m256i *)bloom_split_salt);
+	__m256i bit_no = _mm256_mullo_epi32(_mm256_set1_epi32(hash), salt);
+	bit_no = _mm256_srli_epi32(bit_no, 27);
+	return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit_no);
+}
+
+static inline void
+bloom_split_add(struct bloom *bloom, bloom_hash_t hash)
+{
+	__m256i *bucket = (__m256i *)bloom_split_bucket(bloom, hash);
+	__m256i bits = _mm256_loadu_si256(bucket);
+	bits = _mm256_or_si256(bits, bloom_split_mask(hash));
+	_mm256_storeu_si256(bucket, bits);
+}
+
+static inline bool
+bloom_split_maybe_has(const struct bloom *bloom, bloom_hash_t hash)
+{
+	const __m256i *bucket =
+		(const __m256i *)bloom_split_bucket(bloom, hash);
+	__m256i bits = _mm256_loadu_si256(bucket);
+	/* Check that all bits of the mask are set in the bucket. */
+	return _mm256_testc_si256(bits, bloom_split_mask(hash)) != 0;
+}
+
+#else /* !defined(__AVX2__) */
+
+static inline void
+bloom_split_add(struct bloom *bloom, bloom_hash_t hash)
+{
+	uint32_t *bucket = bloom_split_bucket(bloom, hash);
+	for (int i = 0; i < BLOOM_SPLIT_HASH_COUNT; i++) {
+		uint32_t bit_no = (hash * bloom_split_salt[i]) >> 27;
+		bucket[i] |= 1U << bit_no;
+	}
+}
+
+static inline bool
+bloom_split_maybe_has(const struct bloom *bloom, bloom_hash_t hash)
+{
+	const uint32_t *bucket = bloom_split_bucket(bloom, hash);
+	/*
+	 * Don't return early so that the compiler can vectorize
+	 * the loop.
+	 */
+	uint32_t missing = 0;
+	for (int i = 0; i < BLOOM_SPLIT_HASH_COUNT; i++) {
+		uint32_t bit_no = (hash * bloom_split_salt[i]) >> 27;
+		missing |= ~bucket[i] & (1U << bit_no);
+	}
+	return missing == 0;
+}
+
+#endif /* !defined(__AVX2__) */
+
 /* }}} API definition */
 
 #if defined(__cplusplus)
@@ -0,0 +1,198 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "ribbon.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trivia/util.h"
+
+enum {
+	/**
+	 * Max number of attempts to build a filter. Every attempt
+	 * uses a new seed and more slots so the last one is
+	 * practically bound to succeed.
+	 */
+	RIBBON_MAX_ATTEMPTS = 16,
+};
+
+/**
+ * Return the number of slots to use for storing the given number
+ * of values on the given attempt. The first attempt reserves about
+ * 10% extra slots, which is enough for the system of equations to
+ * be solvable with high probability. Every failure increases the
+ * overhead.
+ */
+static uint32_t
+ribbon_slot_count(uint32_t count, int attempt)
+{
+	double overhead = 0.1 * (1 + attempt);
+	return count + (uint32_t)ceil(count * overhead) + RIBBON_WIDTH;
+}
+
+/**
+ * Add the equation of a value to the banded system stored in
+ * coeffs and results, eliminating the variables that are already
+ * determined by other equations. Returns false if the equation
+ * contradicts the system, in which case the filter must be rebuilt
+ * with a different seed.
+ */
+static bool
+ribbon_band_add(uint64_t *coeffs, uint32_t *results, uint32_t start,
+		uint64_t coeff, uint32_t result)
+{
+	while (true) {
+		assert((coeff & 1) != 0);
+		if (coeffs[start] == 0) {
+			coeffs[start] = coeff;
+			results[start] = result;
+			return true;
+		}
+		coeff ^= coeffs[start];
+		result ^= results[start];
+		if (coeff == 0) {
+			/*
+			 * The equation is a linear combination of
+			 * the equations that are already in the
+			 * system. It's okay as long as it's the same
+			 * value or a duplicate hash.
+			 */
+			return result == 0;
+		}
+		int shift = bit_ctz_u64(coeff);
+		start += shift;
+		coeff >>= shift;
+	}
+}
+
+/**
+ * Solve the banded system by back substitution and store the
+ * solution in the filter table.
+ */
+static void
+ribbon_solve(struct ribbon *ribbon, const uint64_t *coeffs,
+	     const uint32_t *results)
+{
+	uint32_t column_size = ribbon_column_size(ribbon->slot_count);
+	/*
+	 * For each column, keep the RIBBON_WIDTH most recently
+	 * computed bits, i.e. the bits of Z[i + 1] .. Z[i + 64].
+	 */
+	uint64_t state[RIBBON_MAX_RESULT_BITS];
+	memset(state, 0, sizeof(state));
+	for (uint32_t i = ribbon->slot_count; i-- > 0; ) {
+		uint64_t coeff = coeffs[i];
+		uint32_t result = results[i];
+		if (coeff == 0) {
+			/*
+			 * The row isn't constrained by any value.
+			 * Fill it with pseudo-random bits so as not
+			 * to skew the false positive rate.
+			 */
+			result = ribbon_mix(((uint64_t)ribbon->seed << 32) | i);
+		}
+		uint64_t *column = ribbon->table;
+		for (uint16_t j = 0; j < ribbon->result_bits; j++) {
+			uint64_t tmp = state[j] << 1;
+			uint64_t bit = (bit_count_u64(tmp & coeff) & 1) ^
+				       ((result >> j) & 1);
+			state[j] = tmp | bit;
+			column[i / 64] |= bit << (i % 64);
+			column += column_size;
+		}
+	}
+}
+
+int
+ribbon_create(struct ribbon *ribbon, const uint32_t *hashes, uint32_t count,
+	      double false_positive_rate)
+{
+	memset(ribbon, 0, sizeof(*ribbon));
+	int result_bits = ceil(-log2(false_positive_rate));
+	result_bits = MAX(result_bits, 1);
+	result_bits = MIN(result_bits, (int)RIBBON_MAX_RESULT_BITS);
+	ribbon->result_bits = result_bits;
+
+	uint32_t max_slot_count = ribbon_slot_count(count,
+						    RIBBON_MAX_ATTEMPTS - 1);
+	uint64_t *coeffs = malloc(max_slot_count * sizeof(*coeffs));
+	uint32_t *results = malloc(max_slot_count * sizeof(*results));
+	int rc = -1;
+	if (coeffs == NULL || results == NULL)
+		goto fail;
+
+	for (int attempt = 0; attempt < RIBBON_MAX_ATTEMPTS; attempt++) {
+		ribbon->seed = attempt;
+		ribbon->slot_count = ribbon_slot_count(count, attempt);
+		memset(coeffs, 0, ribbon->slot_count * sizeof(*coeffs));
+		uint32_t i;
+		for (i = 0; i < count; i++) {
+			uint32_t start, result;
+			uint64_t coeff;
+			ribbon_hash(ribbon->slot_count, ribbon->result_bits,
+				    ribbon->seed, hashes[i],
+				    &start, &coeff, &result);
+			if (!ribbon_band_add(coeffs, results, start,
+					     coeff, result))
+				break;
+		}
+		if (i < count)
+			continue;
+		size_t size = ribbon_store_size(ribbon);
+		ribbon->table = calloc(1, size);
+		if (ribbon->table == NULL)
+			goto fail;
+		ribbon_solve(ribbon, coeffs, results);
+		free(coeffs);
+		free(results);
+		return 0;
+	}
+	rc = -2;
+fail:
+	free(coeffs);
+	free(results);
+	return rc;
+}
+
+void
+ribbon_destroy(struct ribbon *ribbon)
+{
+	free(ribbon->table);
+}
+
+double
+ribbon_fpr(const struct ribbon *ribbon)
+{
+	return ldexp(1, -ribbon->result_bits);
+}
+
+size_t
+ribbon_store_size(const struct ribbon *ribbon)
+{
+	return (size_t)ribbon_column_size(ribbon->slot_count) *
+	       ribbon->result_bits * sizeof(*ribbon->table);
+}
+
+char *
+ribbon_store(const struct ribbon *ribbon, char *table)
+{
+	size_t store_size = ribbon_store_size(ribbon);
+	memcpy(table, ribbon->table, store_size);
+	return table + store_size;
+}
+
+int
+ribbon_load_table(struct ribbon *ribbon, const char *table)
+{
+	size_t size = ribbon_store_size(ribbon);
+	ribbon->table = malloc(size);
+	if (ribbon->table == NULL)
+		return -1;
+	memcpy(ribbon->table, table, size);
+	return 0;
+}
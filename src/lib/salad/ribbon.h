@@ -0,0 +1,200 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bit/bit.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/*
+ * Standard ribbon filter:
+ *  Dillinger, P. C.; Walzer, S. (2021)
+ *  "Ribbon filter: practically smaller than Bloom and Xor"
+ *  https://arxiv.org/abs/2103.02515
+ *
+ * A value is mapped to a start slot s, a RIBBON_WIDTH-bit
+ * coefficient vector c, and an r-bit fingerprint f. The filter
+ * stores an r-bit row Z[i] for each slot so that for every value
+ * added to the filter, the XOR of Z[s + k] over all bits k set in
+ * c equals f. The rows are found by Gaussian elimination of the
+ * banded system of equations built from all values, which is why
+ * all values must be known in advance.
+ *
+ * A value that wasn't added to the filter matches with probability
+ * 2^-r, so the filter takes about 1.1 * r bits per value, while
+ * the bloom filter needs about 1.44 * r bits per value for the same
+ * false positive rate.
+ */
+
+enum {
+	/** Width of the coefficient vector, in bits. */
+	RIBBON_WIDTH = 64,
+	/** Max number of fingerprint bits. */
+	RIBBON_MAX_RESULT_BITS = 32,
+};
+
+/**
+ * Ribbon filter data structure
+ */
+struct ribbon {
+	/** Number of slots (rows of the solution). */
+	uint32_t slot_count;
+	/** Number of fingerprint bits. */
+	uint16_t result_bits;
+	/** Seed used to derive slots and fingerprints from hashes. */
+	uint16_t seed;
+	/**
+	 * The solution stored column by column: the i-th bit of
+	 * the j-th column is the j-th bit of Z[i]. Each column takes
+	 * ribbon_column_size() words.
+	 */
+	uint64_t *table;
+};
+
+/* {{{ API declaration */
+
+/**
+ * Build a ribbon filter storing the given set of values
+ *
+ * @param ribbon - structure to initialize
+ * @param hashes - hashes of the values to store
+ * @param count - number of values
+ * @param false_positive_rate - desired false positive rate
+ * @return 0 - OK, -1 - memory error, -2 - the system of equations
+ *         turned out unsolvable on every attempt
+ */
+int
+ribbon_create(struct ribbon *ribbon, const uint32_t *hashes, uint32_t count,
+	      double false_positive_rate);
+
+/**
+ * Free resources of the ribbon filter
+ *
+ * @param ribbon - the ribbon filter
+ */
+void
+ribbon_destroy(struct ribbon *ribbon);
+
+/**
+ * Query for presence of a value in the data set
+ * @param ribbon - the ribbon filter
+ * @param hash - hash of the value
+ * @return true - the value could be in data set; false - the value is
+ *  definitively not in data set
+ */
+static bool
+ribbon_maybe_has(const struct ribbon *ribbon, uint32_t hash);
+
+/**
+ * Return the expected false positive rate of a ribbon filter.
+ * @param ribbon - the ribbon filter
+ * @return - expected false positive rate
+ */
+double
+ribbon_fpr(const struct ribbon *ribbon);
+
+/**
+ * Calculate size of a buffer that is needed for storing ribbon table
+ * @param ribbon - the ribbon filter to store
+ * @return - Exact size
+ */
+size_t
+ribbon_store_size(const struct ribbon *ribbon);
+
+/**
+ * Store ribbon filter table to the given buffer
+ * Other struct ribbon members must be stored manually.
+ * @param ribbon - the ribbon filter to store
+ * @param table - buffer to store to
+ * @return - end of written buffer
+ */
+char *
+ribbon_store(const struct ribbon *ribbon, char *table);
+
+/**
+ * Allocate table and load it from given buffer.
+ * Other struct ribbon members must be loaded manually.
+ *
+ * @param ribbon - structure to load to
+ * @param table - data to load
+ * @return 0 - OK, -1 - memory error
+ */
+int
+ribbon_load_table(struct ribbon *ribbon, const char *table);
+
+/* }}} API declaration */
+
+/* {{{ API definition */
+
+/**
+ * Return the number of 64-bit words in a column of a ribbon filter
+ * table. There's an extra word at the end so that a RIBBON_WIDTH
+ * bit window can be read starting from any slot.
+ */
+static inline uint32_t
+ribbon_column_size(uint32_t slot_count)
+{
+	return slot_count / 64 + 1;
+}
+
+/** Mix bits of a 64-bit value (splitmix64 finalizer). */
+static inline uint64_t
+ribbon_mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/**
+ * Derive the start slot, coefficients, and fingerprint of a value
+ * from its hash.
+ */
+static inline void
+ribbon_hash(uint32_t slot_count, uint16_t result_bits, uint16_t seed,
+	    uint32_t hash, uint32_t *start, uint64_t *coeff, uint32_t *result)
+{
+	uint64_t h = ribbon_mix(((uint64_t)seed << 32) | hash);
+	uint64_t start_count = slot_count - RIBBON_WIDTH + 1;
+	*start = ((h >> 32) * start_count) >> 32;
+	*result = (uint32_t)h & (uint32_t)((1ULL << result_bits) - 1);
+	/* The first coefficient is always 1, see ribbon_create(). */
+	*coeff = ribbon_mix(h) | 1;
+}
+
+static inline bool
+ribbon_maybe_has(const struct ribbon *ribbon, uint32_t hash)
+{
+	uint32_t start, result;
+	uint64_t coeff;
+	ribbon_hash(ribbon->slot_count, ribbon->result_bits, ribbon->seed,
+		    hash, &start, &coeff, &result);
+	uint32_t column_size = ribbon_column_size(ribbon->slot_count);
+	uint32_t word = start / 64;
+	uint32_t shift = start % 64;
+	const uint64_t *column = ribbon->table;
+	for (uint16_t i = 0; i < ribbon->result_bits; i++) {
+		uint64_t bits = column[word] >> shift;
+		if (shift != 0)
+			bits |= column[word + 1] << (64 - shift);
+		if ((bit_count_u64(bits & coeff) & 1) != ((result >> i) & 1))
+			return false;
+		column += column_size;
+	}
+	return true;
+}
+
+/* }}} API definition */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
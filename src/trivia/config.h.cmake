@@ -199,6 +199,7 @@
 #cmakedefine HAVE_SO_NOSIGPIPE 1
 
 #cmakedefine HAVE_PRCTL_H 1
+#cmakedefine HAVE_IO_URING 1
 
 #cmakedefine HAVE_UUIDGEN 1
 #cmakedefine HAVE_CLOCK_GETTIME 1
@@ -35,6 +35,8 @@ local reference_table = {
         TSN = 0x08,
         FLAGS = 0x09,
         STREAM_ID = 0x0a,
+        WAIT_VCLOCK = 0x0b,
+        WAIT_VCLOCK_TIMEOUT = 0x0c,
         SPACE_ID = 0x10,
         INDEX_ID = 0x11,
         LIMIT = 0x12,
@@ -68,6 +70,8 @@ local reference_table = {
         SQL_BIND = 0x41,
         SQL_INFO = 0x42,
         STMT_ID = 0x43,
+        SQL_FETCH_SIZE = 0x44,
+        SQL_CURSOR_ID = 0x45,
         REPLICA_ANON = 0x50,
         ID_FILTER = 0x51,
         ERROR = 0x52,
@@ -84,6 +88,11 @@ local reference_table = {
         INSTANCE_NAME = 0x5d,
         SPACE_NAME = 0x5e,
         INDEX_NAME = 0x5f,
+        COMPRESSION = 0x60,
+        CHECKPOINT_JOIN = 0x61,
+        FILE_SIZE = 0x62,
+        KEY_END = 0x63,
+        SPACE_FILTER = 0x64,
     },
 
     -- `iproto_metadata_key` enumeration.
@@ -148,6 +157,11 @@ local reference_table = {
         UNWATCH = 75,
         EVENT = 76,
         WATCH_ONCE = 77,
+        SQL_FETCH = 78,
+        JOIN_FILE = 79,
+        RESYNC = 80,
+        RESYNC_HASH = 81,
+        RESYNC_FETCH = 82,
         CHUNK = 128,
         TYPE_ERROR = bit.lshift(1, 15),
         UNKNOWN = -1,
@@ -164,7 +178,7 @@ local reference_table = {
     },
 
     -- `IPROTO_CURRENT_VERSION` constant
-    protocol_version = 6,
+    protocol_version = 12,
 
     -- `feature_id` enumeration
     protocol_features = {
@@ -175,6 +189,12 @@ local reference_table = {
         pagination = true,
         space_and_index_names = true,
         watch_once = true,
+        sql_cursors = true,
+        replication_compression = true,
+        checkpoint_join = true,
+        resync = true,
+        space_filter = true,
+        wait_vclock = true,
     },
     feature = {
         streams = 0,
@@ -184,6 +204,12 @@ local reference_table = {
         pagination = 4,
         space_and_index_names = 5,
         watch_once = 6,
+        sql_cursors = 7,
+        replication_compression = 8,
+        checkpoint_join = 9,
+        resync = 10,
+        space_filter = 11,
+        wait_vclock = 12,
     },
 }
 
@@ -150,6 +150,7 @@ g.test_box_iproto_override_errors = function(cg)
             FETCH_SNAPSHOT = box.iproto.type.FETCH_SNAPSHOT,
             REGISTER = box.iproto.type.REGISTER,
             SUBSCRIBE = box.iproto.type.SUBSCRIBE,
+            RESYNC = box.iproto.type.RESYNC,
         }
         for rq_name, rq_type in pairs(unsupported_rq_types) do
             err_msg = ("IPROTO request handler overriding does not " ..
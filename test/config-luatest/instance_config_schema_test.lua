@@ -687,6 +687,7 @@ g.test_sql = function()
     local iconfig = {
         sql = {
             cache_size = 1,
+            cursor_idle_timeout = 1,
         },
     }
     instance_config:validate(iconfig)
@@ -694,6 +695,7 @@ g.test_sql = function()
 
     local exp = {
         cache_size = 5242880,
+        cursor_idle_timeout = 60,
     }
     local res = instance_config:apply_default({}).sql
     t.assert_equals(res, exp)
@@ -741,6 +743,7 @@ g.test_vinyl = function()
             defer_deletes = true,
             memory = 11,
             timeout = 5.5,
+            write_latency_target = 0.1,
         },
     }
     instance_config:validate(iconfig)
@@ -760,6 +763,7 @@ g.test_vinyl = function()
         defer_deletes = false,
         memory = 134217728,
         timeout = 60,
+        write_latency_target = 0,
     }
     local res = instance_config:apply_default({}).vinyl
     t.assert_equals(res, exp)
@@ -864,6 +868,12 @@ g.test_replication = function()
             peers = {'one', 'two'},
             anon = true,
             threads = 1,
+            apply_fibers = 1,
+            checkpoint_join = true,
+            resync = true,
+            spaces = {'one', 512},
+            relay_buffer_size = 1048576,
+            compression = 'zstd',
             timeout = 1,
             synchro_timeout = 1,
             connect_timeout = 1,
@@ -874,6 +884,7 @@ g.test_replication = function()
             election_mode = 'off',
             election_timeout = 1,
             election_fencing_mode = 'off',
+            election_leader_lease = true,
             bootstrap_strategy = 'auto',
         },
     }
@@ -885,6 +896,11 @@ g.test_replication = function()
         failover = 'off',
         anon = false,
         threads = 1,
+        apply_fibers = 1,
+        checkpoint_join = false,
+        resync = false,
+        relay_buffer_size = 0,
+        compression = 'none',
         timeout = 1,
         synchro_timeout = 5,
         connect_timeout = 30,
@@ -895,6 +911,7 @@ g.test_replication = function()
         election_mode = box.NULL,
         election_timeout = 5,
         election_fencing_mode = 'soft',
+        election_leader_lease = false,
         bootstrap_strategy = 'auto',
     }
     local res = instance_config:apply_default({}).replication
@@ -0,0 +1,100 @@
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local l = box.schema.space.create('loc', {is_local = true})
+        l:create_index('pk')
+        for i = 1, 1000 do
+            s:replace{i, string.rep('x', 100)}
+            l:replace{i}
+        end
+        box.snapshot()
+        -- Written after the checkpoint, sent on final join.
+        for i = 1001, 1100 do
+            s:replace{i, string.rep('y', 100)}
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+local function start_replica(cg, alias)
+    local replica = cg.replica_set:build_and_add_server({
+        alias = alias,
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            replication_checkpoint_join = true,
+        },
+    })
+    replica:start()
+    replica:wait_for_vclock_of(cg.master)
+    return replica
+end
+
+--
+-- The replica receives the master checkpoint file, loads it without
+-- the master local spaces and catches up with the rows written after
+-- the checkpoint.
+--
+g.test_checkpoint_join = function(cg)
+    local replica = start_replica(cg, 'replica')
+    t.assert(cg.master:grep_log('sending checkpoint file'))
+    t.assert(replica:grep_log('receiving checkpoint file'))
+    replica:exec(function()
+        t.assert_equals(box.cfg.replication_checkpoint_join, true)
+        t.assert_error_msg_contains(
+            "Can't set option 'replication_checkpoint_join' dynamically",
+            box.cfg, {replication_checkpoint_join = false})
+        t.assert_equals(box.space.test:count(), 1100)
+        t.assert_equals(box.space.test:get(1), {1, string.rep('x', 100)})
+        t.assert_equals(box.space.test:get(1100),
+                        {1100, string.rep('y', 100)})
+        t.assert_equals(box.space.loc:count(), 0)
+        t.assert_equals(box.info.replication[1].upstream.status, 'follow')
+    end)
+    cg.master:exec(function()
+        box.space.test:replace{1101}
+    end)
+    replica:wait_for_vclock_of(cg.master)
+    replica:exec(function()
+        t.assert_equals(box.space.test:get(1101), {1101})
+    end)
+end
+
+--
+-- The checkpoint file doesn't contain vinyl data, so the master joins
+-- the replica by rows if there's any.
+--
+g.test_vinyl_fallback = function(cg)
+    cg.master:exec(function()
+        local s = box.schema.space.create('vy', {engine = 'vinyl'})
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:replace{i}
+        end
+        box.snapshot()
+    end)
+    local replica = start_replica(cg, 'replica_vy')
+    t.assert(cg.master:grep_log('falling back to join by rows'))
+    replica:exec(function()
+        t.assert_equals(box.space.vy:count(), 100)
+        t.assert_equals(box.space.test:count(), 1101)
+        t.assert_equals(box.info.replication[1].upstream.status, 'follow')
+    end)
+end
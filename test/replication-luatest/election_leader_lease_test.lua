@@ -0,0 +1,82 @@
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+local server = require('luatest.server')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    local box_cfg = {
+        replication = {
+            server.build_listen_uri('server1', cg.replica_set.id),
+            server.build_listen_uri('server2', cg.replica_set.id),
+            server.build_listen_uri('server3', cg.replica_set.id),
+        },
+        replication_timeout = 0.1,
+        election_mode = 'voter',
+        election_fencing_mode = 'off',
+        election_leader_lease = true,
+        memtx_use_mvcc_engine = true,
+    }
+    for i = 1, 3 do
+        cg['server' .. i] = cg.replica_set:build_and_add_server({
+            alias = 'server' .. i,
+            box_cfg = box_cfg,
+        })
+    end
+    cg.replica_set:start()
+    cg.replica_set:wait_for_fullmesh()
+    cg.server1:exec(function()
+        box.cfg{election_mode = 'candidate'}
+    end)
+    cg.server1:wait_until_election_leader_found()
+    cg.server1:exec(function()
+        box.schema.space.create('s', {is_sync = true}):create_index('pk')
+        box.space.s:insert{1}
+    end)
+    cg.server2:wait_for_vclock_of(cg.server1)
+    cg.server3:wait_for_vclock_of(cg.server1)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_info = function(cg)
+    cg.server1:exec(function()
+        t.helpers.retrying({}, function()
+            t.assert_gt(box.info.election.leader_lease, 0)
+        end)
+        t.assert_le(box.info.election.leader_lease, 0.1 * 4)
+    end)
+    cg.server2:exec(function()
+        t.assert_equals(box.info.election.leader_lease, 0)
+        box.cfg{election_leader_lease = false}
+        t.assert_equals(box.info.election.leader_lease, nil)
+        box.cfg{election_leader_lease = true}
+    end)
+end
+
+--
+-- Linearizable reads are served by the leader holding the lease and wait
+-- for the quorum once the lease expires.
+--
+g.test_linearizable_read = function(cg)
+    cg.server1:exec(function()
+        box.begin({txn_isolation = 'linearizable', timeout = 0.1})
+        t.assert_equals(box.space.s:get{1}, {1})
+        box.commit()
+    end)
+    cg.server2:stop()
+    cg.server3:stop()
+    cg.server1:exec(function()
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.election.leader_lease, 0)
+        end)
+        t.assert_error_msg_contains('Timed out', box.begin,
+                                    {txn_isolation = 'linearizable',
+                                     timeout = 0.1})
+    end)
+    cg.server2:start()
+    cg.server3:start()
+end
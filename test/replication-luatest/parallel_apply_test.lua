@@ -0,0 +1,131 @@
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            replication_apply_fibers = 8,
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('s', {engine = 'vinyl'})
+        s:create_index('pk')
+        local u = box.schema.space.create('u', {engine = 'vinyl'})
+        u:create_index('pk')
+        u:create_index('sk', {parts = {2, 'unsigned'}})
+        local m = box.schema.space.create('m')
+        m:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.replica:exec(function()
+        t.assert_equals(box.cfg.replication_apply_fibers, 8)
+        t.assert_error_msg_contains(
+            "Can't set option 'replication_apply_fibers' dynamically",
+            box.cfg, {replication_apply_fibers = 1})
+    end)
+end
+
+--
+-- Transactions writing to the same keys, to spaces with a unique
+-- secondary index and to memtx spaces are applied in the master order.
+--
+g.test_apply_order = function(cg)
+    cg.master:exec(function()
+        math.randomseed(os.time())
+        local s, u, m = box.space.s, box.space.u, box.space.m
+        for _ = 1, 2000 do
+            local k = math.random(50)
+            box.begin()
+            local op = math.random(6)
+            if op == 1 then
+                s:replace{k, math.random(1000)}
+            elseif op == 2 then
+                s:upsert({k, 1}, {{'+', 2, 1}})
+            elseif op == 3 then
+                s:delete{k}
+            elseif op == 4 then
+                s:update({k}, {{'=', 2, math.random(1000)}})
+                s:replace{k + 50, k}
+            elseif op == 5 then
+                -- The secondary key is moved between primary keys.
+                u.index.sk:delete{k}
+                u:replace{math.random(50), k}
+            else
+                m:replace{k}
+                m:delete{math.random(50)}
+            end
+            box.commit()
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    local data = cg.master:exec(function()
+        return {box.space.s:select(), box.space.u:select(),
+                box.space.m:select()}
+    end)
+    cg.replica:exec(function(data)
+        t.assert_equals(box.space.s:select(), data[1])
+        t.assert_equals(box.space.u:select(), data[2])
+        t.assert_equals(box.space.m:select(), data[3])
+        t.assert_equals(box.info.replication[1].upstream.status, 'follow')
+    end, {data})
+end
+
+--
+-- A failed transaction stops the applier and the transactions after it
+-- aren't applied even if they don't depend on it.
+--
+g.test_apply_error = function(cg)
+    cg.master:exec(function()
+        box.space.s:truncate()
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        box.space.s:insert{1000}
+    end)
+    cg.master:exec(function()
+        box.space.s:insert{999}
+        box.space.s:insert{1000}
+        for i = 1001, 1100 do
+            box.space.s:insert{i}
+        end
+    end)
+    t.helpers.retrying({}, function()
+        cg.replica:exec(function()
+            local upstream = box.info.replication[1].upstream
+            t.assert_equals(upstream.status, 'stopped')
+            t.assert_str_contains(upstream.message, 'Duplicate key exists')
+        end)
+    end)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.s:select(), {{999}, {1000}})
+        box.space.s:delete{1000}
+        local replication = box.cfg.replication
+        box.cfg{replication = {}}
+        box.cfg{replication = replication}
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.s:count(), 102)
+        t.assert_equals(box.info.replication[1].upstream.status, 'follow')
+    end)
+end
@@ -0,0 +1,118 @@
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+            replication_synchro_timeout = 120,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        box.ctl.promote()
+        box.schema.space.create('s', {is_sync = true}):create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+--
+-- Quorums collected while a CONFIRM is being written are covered by one
+-- next CONFIRM instead of a CONFIRM per transaction.
+--
+g.test_confirm_batch = function(cg)
+    for _, quorum in ipairs({1, 2}) do
+        cg.master:exec(function(quorum)
+            local fiber = require('fiber')
+            box.cfg{replication_synchro_quorum = quorum}
+            local count = 1000
+            local lsn = box.info.lsn
+            local fibers = {}
+            for i = 1, count do
+                fibers[i] = fiber.new(box.space.s.replace, box.space.s, {i})
+                fibers[i]:set_joinable(true)
+            end
+            for i = 1, count do
+                t.assert(fibers[i]:join())
+            end
+            t.assert_equals(box.space.s:count(), count)
+            local confirm_count = box.info.lsn - lsn - count
+            t.assert_gt(confirm_count, 0)
+            t.assert_lt(confirm_count, count / 10)
+            t.assert_equals(box.info.synchro.queue.len, 0)
+        end, {quorum})
+        cg.replica:wait_for_vclock_of(cg.master)
+        cg.replica:exec(function()
+            t.assert_equals(box.space.s:count(), 1000)
+            t.assert_equals(box.info.synchro.queue.len, 0)
+        end)
+    end
+end
+
+--
+-- The acks arriving while a CONFIRM is being written are covered by one next
+-- CONFIRM no matter how many of them there are.
+--
+g.test_confirm_batch_slow_wal = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.replica:exec(function()
+        box.cfg{replication = {}}
+    end)
+    local lsn = cg.master:exec(function()
+        local fiber = require('fiber')
+        box.space.s:truncate()
+        box.cfg{replication_synchro_quorum = 2}
+        local lsn = box.info.lsn
+        rawset(_G, 'test_fibers', {})
+        for i = 1, 1000 do
+            local f = fiber.new(box.space.s.replace, box.space.s, {i})
+            f:set_joinable(true)
+            table.insert(_G.test_fibers, f)
+        end
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.lsn, lsn + 1000)
+        end)
+        t.assert_equals(box.info.synchro.queue.len, 1000)
+        -- The first CONFIRM blocks the WAL until all the acks arrive.
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        return lsn
+    end)
+    cg.replica:exec(function(replication)
+        box.cfg{replication = replication}
+    end, {cg.master.net_box_uri})
+    cg.master:exec(function(lsn, replica_id)
+        t.helpers.retrying({}, function()
+            local vclock = box.info.replication[replica_id].downstream.vclock
+            t.assert_equals(vclock[box.info.id], lsn + 1000)
+        end)
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+        for _, f in ipairs(_G.test_fibers) do
+            t.assert(f:join())
+        end
+        _G.test_fibers = nil
+        t.assert_equals(box.info.synchro.queue.len, 0)
+        local confirm_count = box.info.lsn - lsn - 1000
+        t.assert_gt(confirm_count, 0)
+        t.assert_le(confirm_count, 2)
+    end, {lsn, cg.replica:get_instance_id()})
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.s:count(), 1000)
+        t.assert_equals(box.info.synchro.queue.len, 0)
+    end)
+end
@@ -0,0 +1,97 @@
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            replication_compression = 'zstd',
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.replica:exec(function()
+        t.assert_equals(box.cfg.replication_compression, 'zstd')
+        t.assert_error_msg_contains(
+            "Incorrect value for option 'replication_compression': " ..
+            "the value should be one of the following: 'none', 'zstd'",
+            box.cfg, {replication_compression = 'lz4'})
+    end)
+end
+
+--
+-- The rows are compressed by the relay and decompressed by the applier,
+-- both sides report the compression ratio of the link.
+--
+g.test_compression = function(cg)
+    cg.master:exec(function()
+        for i = 1, 1000 do
+            box.space.test:replace{i, string.rep('x', 1000), i * 2}
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.test:count(), 1000)
+        t.assert_equals(box.space.test:get(500),
+                        {500, string.rep('x', 1000), 1000})
+        local upstream = box.info.replication[1].upstream
+        t.assert_equals(upstream.status, 'follow')
+        t.assert_equals(upstream.compression, 'zstd')
+        t.assert_gt(upstream.compression_ratio, 10)
+    end)
+    local id = cg.replica:get_instance_id()
+    cg.master:exec(function(id)
+        local downstream = box.info.replication[id].downstream
+        t.assert_equals(downstream.status, 'follow')
+        t.assert_equals(downstream.compression, 'zstd')
+        t.assert_gt(downstream.compression_ratio, 10)
+    end, {id})
+end
+
+--
+-- The option takes effect on the next subscribe.
+--
+g.test_reconfigure = function(cg)
+    cg.replica:exec(function()
+        local replication = box.cfg.replication
+        box.cfg{replication_compression = 'none'}
+        t.assert_equals(box.info.replication[1].upstream.compression, 'zstd')
+        box.cfg{replication = {}}
+        box.cfg{replication = replication}
+        t.helpers.retrying({}, function()
+            local upstream = box.info.replication[1].upstream
+            t.assert_equals(upstream.status, 'follow')
+            t.assert_equals(upstream.compression, nil)
+        end)
+    end)
+    cg.master:exec(function()
+        box.space.test:replace{1, 'y'}
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.test:get(1), {1, 'y'})
+        box.cfg{replication_compression = 'zstd'}
+    end)
+end
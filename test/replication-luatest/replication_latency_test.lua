@@ -0,0 +1,85 @@
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group(nil, t.helpers.matrix({apply_fibers = {1, 4}}))
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            replication_apply_fibers = cg.params.apply_fibers,
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function(engine)
+        box.schema.space.create('s', {engine = engine}):create_index('pk')
+    end, {cg.params.apply_fibers > 1 and 'vinyl' or 'memtx'})
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+--
+-- The latency of the stages of a sample of the replicated transactions
+-- is shown in box.info.replication. Transactions applied in parallel
+-- are traced too.
+--
+g.test_latency = function(cg)
+    cg.master:exec(function()
+        for i = 1, 1000 do
+            box.space.s:replace{i}
+        end
+        box.begin()
+        for i = 1, 1000 do
+            box.space.s:replace{i, i}
+        end
+        box.commit()
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.helpers.retrying({}, function()
+            local latency = box.info.replication[1].upstream.latency
+            local stages = {}
+            for stage, l in pairs(latency) do
+                table.insert(stages, stage)
+                t.assert_ge(l.p50, 0)
+                t.assert_ge(l.p90, l.p50)
+                t.assert_ge(l.p99, l.p90)
+            end
+            t.assert_items_equals(stages,
+                                  {'network', 'decode', 'apply', 'wal'})
+            for _, l in pairs(latency) do
+                t.assert_gt(l.count, 0)
+            end
+            t.assert_gt(latency.wal.p99, 0)
+        end)
+    end)
+    cg.master:exec(function()
+        t.helpers.retrying({}, function()
+            local latency = box.info.replication[2].downstream.latency
+            local stages = {}
+            for stage, l in pairs(latency) do
+                table.insert(stages, stage)
+                t.assert_ge(l.p50, 0)
+                t.assert_ge(l.p90, l.p50)
+                t.assert_ge(l.p99, l.p90)
+            end
+            t.assert_items_equals(stages, {'read', 'send', 'ack'})
+            for _, l in pairs(latency) do
+                t.assert_gt(l.count, 0)
+            end
+            t.assert_gt(latency.ack.p99, 0)
+        end)
+    end)
+end
@@ -0,0 +1,144 @@
+local fio = require('fio')
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+            replication_relay_buffer_size = 1024 * 1024,
+        },
+    })
+    for i = 1, 3 do
+        cg['replica' .. i] = cg.replica_set:build_and_add_server({
+            alias = 'replica' .. i,
+            box_cfg = {
+                replication = cg.master.net_box_uri,
+                replication_timeout = 0.1,
+                replication_anon = true,
+                read_only = true,
+            },
+        })
+    end
+    cg.replica_set:start()
+    cg.master:exec(function()
+        box.schema.space.create('s'):create_index('pk')
+    end)
+    for i = 1, 3 do
+        cg['replica' .. i]:wait_for_vclock_of(cg.master)
+    end
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+-- Count the log lines of a server containing the given string.
+local function count_log_lines(server, str)
+    local path = fio.pathjoin(server.workdir, server.alias .. '.log')
+    local count = 0
+    for line in io.lines(path) do
+        if line:find(str, 1, true) then
+            count = count + 1
+        end
+    end
+    return count
+end
+
+g.test_cfg = function(cg)
+    cg.master:exec(function()
+        t.assert_equals(box.cfg.replication_relay_buffer_size, 1024 * 1024)
+        t.assert_error_msg_contains(
+            "Can't set option 'replication_relay_buffer_size' dynamically",
+            box.cfg, {replication_relay_buffer_size = 0})
+    end)
+end
+
+--
+-- Anonymous replicas get the new rows from the relay feed and a replica
+-- lagging behind the feed catches up by reading the xlog files.
+--
+g.test_relay_feed = function(cg)
+    cg.master:exec(function()
+        for i = 1, 1000 do
+            box.space.s:replace{i, i}
+        end
+    end)
+    for i = 1, 3 do
+        cg['replica' .. i]:wait_for_vclock_of(cg.master)
+    end
+    t.assert(cg.master:grep_log('relay follows the WAL feed'))
+    cg.replica3:stop()
+    cg.master:exec(function()
+        local data = string.rep('x', 1024)
+        for i = 1, 2000 do
+            box.space.s:replace{i, data}
+        end
+    end)
+    cg.replica3:start()
+    local data = cg.master:exec(function()
+        return box.space.s:select()
+    end)
+    for i = 1, 3 do
+        local replica = cg['replica' .. i]
+        replica:wait_for_vclock_of(cg.master)
+        replica:exec(function(data)
+            t.assert_equals(box.space.s:select(), data)
+        end, {data})
+    end
+end
+
+--
+-- A connected replica that falls behind the feed reads the xlog files
+-- and returns to the feed once it catches up.
+--
+g.test_relay_feed_lag = function(cg)
+    t.tarantool.skip_if_not_debug()
+    local fell_behind = count_log_lines(cg.master,
+                                        'relay fell behind the WAL feed')
+    local follows = count_log_lines(cg.master, 'relay follows the WAL feed')
+    local exits = count_log_lines(cg.master, 'exiting the relay loop')
+    cg.master:exec(function()
+        box.error.injection.set('ERRINJ_RELAY_SEND_DELAY', true)
+        local data = string.rep('y', 1024)
+        for i = 1, 20 do
+            box.begin()
+            for j = 1, 100 do
+                box.space.s:replace{i * 100 + j, data}
+            end
+            box.commit()
+        end
+        box.error.injection.set('ERRINJ_RELAY_SEND_DELAY', false)
+    end)
+    for i = 1, 3 do
+        cg['replica' .. i]:wait_for_vclock_of(cg.master)
+    end
+    t.assert_ge(count_log_lines(cg.master, 'relay fell behind the WAL feed'),
+                fell_behind + 3)
+    t.helpers.retrying({}, function()
+        cg.master:exec(function()
+            box.space.s:replace{0}
+        end)
+        t.assert_ge(count_log_lines(cg.master, 'relay follows the WAL feed'),
+                    follows + 3)
+    end)
+    -- The replicas stayed connected.
+    t.assert_equals(count_log_lines(cg.master, 'exiting the relay loop'),
+                    exits)
+    local data = cg.master:exec(function()
+        return box.space.s:select()
+    end)
+    for i = 1, 3 do
+        local replica = cg['replica' .. i]
+        replica:wait_for_vclock_of(cg.master)
+        replica:exec(function(data)
+            t.assert_equals(box.info.replication[1].upstream.status,
+                            'follow')
+            t.assert_equals(box.space.s:select(), data)
+        end, {data})
+    end
+end
@@ -0,0 +1,108 @@
+local t = require('luatest')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    })
+    cg.master:start()
+    cg.master:exec(function()
+        box.schema.space.create('a'):create_index('pk')
+        box.schema.space.create('b'):create_index('pk')
+        box.schema.space.create('c'):create_index('pk')
+    end)
+    local c_id = cg.master:exec(function() return box.space.c.id end)
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            replication_anon = true,
+            read_only = true,
+            replication_spaces = {'a', c_id},
+        },
+    })
+    cg.replica:start()
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.replica:exec(function()
+        t.assert_equals(box.cfg.replication_spaces,
+                        {'a', box.space.c.id})
+        t.assert_error_msg_contains(
+            "Can't set option 'replication_spaces' dynamically",
+            box.cfg, {replication_spaces = {'b'}})
+        t.assert_error_msg_contains(
+            "the value may be set to false only when replication_spaces " ..
+            "is not set", box.cfg, {replication_anon = false})
+        t.assert_error_msg_contains(
+            "the value may be set to false only when replication_anon " ..
+            "is false", box.cfg, {read_only = false})
+    end)
+end
+
+--
+-- The rows of the user spaces the replica isn't subscribed to are relayed
+-- as NOPs, so the replica vclock still follows the master one.
+--
+g.test_space_filter = function(cg)
+    cg.master:exec(function()
+        for i = 1, 10 do
+            box.space.a:insert{i}
+            box.space.b:insert{i}
+            box.begin()
+            box.space.b:insert{i + 100}
+            box.space.c:insert{i}
+            box.commit()
+        end
+        box.schema.space.create('d'):create_index('pk')
+        box.space.d:insert{1}
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:assert_follows_upstream(1)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.a:count(), 10)
+        t.assert_equals(box.space.b:count(), 0)
+        t.assert_equals(box.space.c:count(), 10)
+        -- The spaces created after subscribe aren't replicated.
+        t.assert_equals(box.space.d:count(), 0)
+    end)
+    t.assert(cg.master:grep_log('relaying the rows of 2 user spaces'))
+end
+
+--
+-- A replica subscribed to a part of the spaces has NOPs in place of the
+-- rows of the other spaces, so it can't feed other replicas.
+--
+g.test_cascade = function(cg)
+    local cascade = cg.replica_set:build_and_add_server({
+        alias = 'cascade',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            replication_sync_timeout = 0.1,
+            replication_anon = true,
+            read_only = true,
+        },
+    })
+    cascade:start()
+    cascade:exec(function(replication)
+        box.cfg{replication = replication}
+    end, {cg.replica.net_box_uri})
+    t.helpers.retrying({}, function()
+        t.assert(cascade:grep_log('Replica with replication_spaces ' ..
+                                  'does not support followers'))
+    end)
+    cascade:drop()
+end
@@ -0,0 +1,210 @@
+local t = require('luatest')
+local fio = require('fio')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+            wal_cleanup_delay = 0,
+            checkpoint_count = 1,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            replication_sync_timeout = 0.1,
+            replication_resync = true,
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('s')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        local h = box.schema.space.create('h')
+        h:create_index('pk', {type = 'hash'})
+        local d = box.schema.space.create('d')
+        d:create_index('pk')
+        box.begin()
+        for i = 1, 5000 do
+            s:insert{i, i % 10}
+            h:insert{i}
+        end
+        box.commit()
+        d:insert{1}
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.replica:exec(function()
+        t.assert_equals(box.cfg.replication_resync, true)
+        t.assert_error_msg_contains(
+            "Can't set option 'replication_resync' dynamically",
+            box.cfg, {replication_resync = false})
+    end)
+end
+
+--
+-- A replica the master has collected the WALs for resyncs its data by
+-- comparing key range hashes instead of rejoining and then follows the
+-- master as usual.
+--
+g.test_resync = function(cg)
+    cg.replica:stop()
+    -- Restart the master to drop the replica from the gc state.
+    cg.master:restart()
+    cg.master:exec(function()
+        local s, h = box.space.s, box.space.h
+        for i = 1, 5000, 97 do
+            s:replace{i, 100 + i % 3}
+            h:delete{i + 1}
+        end
+        box.snapshot()
+        for i = 5001, 5100 do
+            s:insert{i, i % 10}
+        end
+        for i = 2000, 2100 do
+            s:delete{i}
+        end
+        box.space.d:drop()
+        local n = box.schema.space.create('n')
+        n:create_index('pk')
+        n:insert{1, 'new'}
+        box.snapshot()
+        s:update({3}, {{'=', 2, 42}})
+        box.snapshot()
+        t.helpers.retrying({}, function()
+            local xlogs = fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+            t.assert_equals(#xlogs, 1)
+        end)
+    end)
+    cg.replica:start()
+    t.helpers.retrying({}, function()
+        cg.replica:assert_follows_upstream(1)
+    end)
+    cg.master:exec(function()
+        box.space.s:replace{1, 1000}
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    local data = cg.master:exec(function()
+        return {box.space.s:select(), box.space.h:select(),
+                box.space.n:select()}
+    end)
+    cg.replica:exec(function(data)
+        t.assert_equals(box.space.s:select(), data[1])
+        t.assert_items_equals(box.space.h:select(), data[2])
+        t.assert_equals(box.space.n:select(), data[3])
+        t.assert_equals(box.space.d, nil)
+        t.assert_equals(box.space.s.index.sk:count(1000), 1)
+        t.assert_equals(box.space.s.index.sk:count(42), 1)
+    end, {data})
+    t.assert(cg.replica:grep_log('will resync data'))
+    t.assert(cg.replica:grep_log('data resynced'))
+    t.assert(cg.replica:grep_log('resynced space s'))
+    t.assert_not(cg.replica:grep_log('initiating rebootstrap'))
+end
+
+local g_two_masters = t.group('resync-two-masters')
+
+g_two_masters.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master1 = cg.replica_set:build_and_add_server({
+        alias = 'master1',
+        box_cfg = {
+            replication_timeout = 0.1,
+            wal_cleanup_delay = 0,
+            checkpoint_count = 1,
+        },
+    })
+    cg.master1:start()
+    cg.master2 = cg.replica_set:build_and_add_server({
+        alias = 'master2',
+        box_cfg = {
+            replication = cg.master1.net_box_uri,
+            replication_timeout = 0.1,
+            read_only = false,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master1.net_box_uri,
+            replication_timeout = 0.1,
+            replication_sync_timeout = 0.1,
+            replication_resync = true,
+        },
+    })
+    cg.master2:start()
+    cg.replica:start()
+    cg.master1:exec(function()
+        box.schema.space.create('s1'):create_index('pk')
+        box.space.s1:insert{1}
+    end)
+    cg.master2:wait_for_vclock_of(cg.master1)
+    cg.replica:wait_for_vclock_of(cg.master1)
+    -- The second master stops following the first one.
+    cg.master2:exec(function()
+        box.cfg{replication = {}}
+    end)
+    local replication = {cg.master1.net_box_uri, cg.master2.net_box_uri}
+    cg.replica.box_cfg.replication = replication
+    cg.replica:exec(function(replication)
+        box.cfg{replication = replication}
+    end, {replication})
+end)
+
+g_two_masters.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+--
+-- A replica doesn't resync its data from a master that doesn't have the
+-- rows of another master the replica has applied, because they would be
+-- overwritten with the older data and never restored.
+--
+g_two_masters.test_rows_of_other_master = function(cg)
+    cg.master2:exec(function()
+        box.schema.space.create('s2'):create_index('pk')
+        box.space.s2:insert{1}
+    end)
+    cg.replica:wait_for_vclock_of(cg.master2)
+    cg.replica:stop()
+    cg.master1:restart()
+    cg.master1:exec(function()
+        box.space.s1:replace{1, 'new'}
+        box.snapshot()
+        box.space.s1:replace{2}
+        box.snapshot()
+        t.helpers.retrying({}, function()
+            local xlogs = fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+            t.assert_equals(#xlogs, 1)
+        end)
+    end)
+    cg.replica:start()
+    local id = cg.master1:get_instance_id()
+    cg.replica:exec(function(id)
+        t.helpers.retrying({}, function()
+            local upstream = box.info.replication[id].upstream
+            t.assert_equals(upstream.status, 'stopped')
+            t.assert_str_contains(upstream.message, 'Resync does not ' ..
+                                  'support a replica having rows the ' ..
+                                  "master doesn't have")
+        end)
+        t.assert_equals(box.space.s1:select(), {{1}})
+        t.assert_equals(box.space.s2:select(), {{1}})
+    end, {id})
+    t.assert(cg.replica:grep_log('will resync data'))
+    t.assert_not(cg.replica:grep_log('data resynced'))
+end
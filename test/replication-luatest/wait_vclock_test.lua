@@ -0,0 +1,162 @@
+local t = require('luatest')
+local msgpack = require('msgpack')
+local net = require('net.box')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new()
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+            replication_timeout = 0.1,
+            read_only = true,
+        },
+    })
+    cg.replica_set:start()
+    cg.space_id = cg.master:exec(function()
+        local s = box.schema.space.create('s')
+        s:create_index('pk')
+        return s.id
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+local function inject_select(c, space_id, vclock, timeout, stream_id)
+    local header = msgpack.encode({
+        [box.iproto.key.REQUEST_TYPE] = box.iproto.type.SELECT,
+        [box.iproto.key.SYNC] = c:_next_sync(),
+        [box.iproto.key.STREAM_ID] = stream_id,
+        [box.iproto.key.WAIT_VCLOCK] = setmetatable(vclock,
+                                                    {__serialize = 'map'}),
+        [box.iproto.key.WAIT_VCLOCK_TIMEOUT] = timeout,
+    })
+    local body = msgpack.encode({
+        [box.iproto.key.SPACE_ID] = space_id,
+        [box.iproto.key.KEY] = setmetatable({}, {__serialize = 'array'}),
+    })
+    local size = msgpack.encode(#header + #body)
+    return c:_inject(size .. header .. body)
+end
+
+--
+-- A request with a vclock the replica hasn't reached yet waits until the
+-- rows are replicated and then sees them.
+--
+g.test_wait_vclock = function(cg)
+    local c = net.connect(cg.replica.net_box_uri)
+    t.assert(c.peer_protocol_features.wait_vclock)
+    t.assert_equals(inject_select(c, cg.space_id, {}), {})
+
+    cg.replica:exec(function()
+        box.cfg{replication = {}}
+    end)
+    local vclock = cg.master:exec(function()
+        box.space.s:insert{1}
+        return box.info.vclock
+    end)
+    vclock[0] = nil
+    t.assert_error_msg_contains('Timeout exceeded', inject_select,
+                                c, cg.space_id, table.copy(vclock), 0.1)
+
+    local f = require('fiber').new(inject_select, c, cg.space_id,
+                                   table.copy(vclock))
+    f:set_joinable(true)
+    cg.replica:exec(function(uri)
+        box.cfg{replication = uri}
+    end, {cg.master.net_box_uri})
+    local ok, res = f:join()
+    t.assert(ok)
+    t.assert_equals(res, {{1}})
+    c:close()
+end
+
+--
+-- The wait is limited by replication_sync_timeout unless the request sets
+-- its own timeout.
+--
+g.test_default_timeout = function(cg)
+    local c = net.connect(cg.replica.net_box_uri)
+    cg.replica:exec(function()
+        box.cfg{replication = {}, replication_sync_timeout = 0.1}
+    end)
+    local vclock = cg.master:exec(function()
+        box.space.s:replace{2}
+        return box.info.vclock
+    end)
+    vclock[0] = nil
+    t.assert_error_msg_contains('Timeout exceeded', inject_select,
+                                c, cg.space_id, vclock)
+    cg.replica:exec(function(uri)
+        box.cfg{replication = uri, replication_sync_timeout = 300}
+    end, {cg.master.net_box_uri})
+    cg.replica:wait_for_vclock_of(cg.master)
+    c:close()
+end
+
+--
+-- A request waiting for a vclock stops waiting once the client closes
+-- the connection.
+--
+g.test_disconnect = function(cg)
+    local c = net.connect(cg.replica.net_box_uri)
+    cg.replica:exec(function()
+        box.cfg{replication = {}}
+    end)
+    local vclock = cg.master:exec(function()
+        box.space.s:replace{3}
+        return box.info.vclock
+    end)
+    vclock[0] = nil
+    local f = require('fiber').new(inject_select, c, cg.space_id, vclock)
+    f:set_joinable(true)
+    -- Not counting the request that executes the function.
+    local function requests_in_progress()
+        return cg.replica:exec(function()
+            return box.stat.net().REQUESTS_IN_PROGRESS.current - 1
+        end)
+    end
+    t.helpers.retrying({}, function()
+        t.assert_equals(requests_in_progress(), 1)
+    end)
+    c:close()
+    t.assert_not(f:join())
+    t.helpers.retrying({}, function()
+        t.assert_equals(requests_in_progress(), 0)
+    end)
+    cg.replica:exec(function(uri)
+        box.cfg{replication = uri}
+    end, {cg.master.net_box_uri})
+    cg.replica:wait_for_vclock_of(cg.master)
+end
+
+--
+-- Waiting for a vclock inside a stream transaction is forbidden, because
+-- a yield would abort the transaction.
+--
+g.test_stream_transaction = function(cg)
+    local c = net.connect(cg.replica.net_box_uri)
+    local stream = c:new_stream()
+    stream:begin()
+    local vclock = cg.master:exec(function()
+        return box.info.vclock
+    end)
+    vclock[0] = nil
+    t.assert_error_msg_equals(
+        'Stream transaction does not support waiting for a vclock',
+        inject_select, c, cg.space_id, vclock, nil, stream._stream_id)
+    stream:rollback()
+    c:close()
+end
@@ -0,0 +1,107 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('analyze', t.helpers.matrix{engine = {'memtx', 'vinyl'}})
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function(engine)
+        box.execute([[SET SESSION "sql_default_engine" = ']] .. engine ..
+                     [[';]])
+        box.execute([[CREATE TABLE t(id INT PRIMARY KEY, a INT, b INT,
+                                     c INT);]])
+        box.execute([[CREATE INDEX ia ON t(a);]])
+        box.execute([[CREATE INDEX ib ON t(b);]])
+        box.execute([[CREATE INDEX ic ON t(c);]])
+        box.begin()
+        for i = 1, 1000 do
+            -- Column "a" has two values, "b" is unique and 90% of
+            -- values of "c" are the same.
+            box.space.T:insert({i, i % 2, i, i <= 900 and 1 or i})
+        end
+        box.commit()
+    end, {cg.params.engine})
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+--
+-- Return the number of rows the planner expects the query to return.
+--
+local function row_estimate(sql)
+    local plan = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+    return tonumber(plan[#plan][4]:match('%(~(%d+) rows?%)'))
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local _, err = box.execute([[ANALYZE no_such_table;]])
+        t.assert_equals(err.message, "Space 'NO_SUCH_TABLE' does not exist")
+        t.assert_equals(box.execute([[ANALYZE;]]), {row_count = 0})
+    end)
+end
+
+g.test_row_count = function(cg)
+    cg.server:exec(function()
+        box.execute([[ANALYZE t;]])
+        -- The planner knows that "b" is selective and "a" is not.
+        local plan = box.execute([[EXPLAIN QUERY PLAN
+                                   SELECT * FROM t WHERE a = 0 AND b = 7;]])
+        t.assert_str_contains(plan.rows[1][4], 'USING INDEX IB')
+        plan = box.execute([[EXPLAIN QUERY PLAN
+                             SELECT * FROM t WHERE a = 0 AND b < 7;]])
+        t.assert_str_contains(plan.rows[1][4], 'USING INDEX IB')
+    end)
+    local est = cg.server:exec(row_estimate, {[[SELECT * FROM t;]]})
+    t.assert_ge(est, 900)
+    t.assert_le(est, 1000)
+end
+
+g.test_histogram = function(cg)
+    cg.server:exec(function()
+        box.execute([[ANALYZE;]])
+    end)
+    local function estimate(sql)
+        return cg.server:exec(row_estimate, {sql})
+    end
+    -- The frequent value is in the samples.
+    t.assert_ge(estimate([[SELECT * FROM t WHERE c = 1;]]), 500)
+    t.assert_le(estimate([[SELECT * FROM t WHERE c = 950;]]), 10)
+    -- Both bounds are compared with the samples.
+    t.assert_le(estimate([[SELECT * FROM t WHERE c > 990;]]), 100)
+    t.assert_ge(estimate([[SELECT * FROM t WHERE c < 2;]]), 500)
+end
+
+--
+-- The index may be altered while a vinyl index scan yields.
+--
+g.test_alter_during_scan = function(cg)
+    t.tarantool.skip_if_not_debug()
+    t.skip_if(cg.params.engine ~= 'vinyl', 'Memtx index scan never yields')
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.execute([[CREATE TABLE t2(id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE INDEX i2 ON t2(a);]])
+        box.begin()
+        for i = 1, 1000 do
+            box.space.T2:insert({i, i % 10})
+        end
+        box.commit()
+        box.snapshot()
+        box.error.injection.set('ERRINJ_VY_READ_PAGE_DELAY', true)
+        local f = fiber.new(box.execute, [[ANALYZE t2;]])
+        f:set_joinable(true)
+        fiber.sleep(0.01)
+        t.assert_equals(f:status(), 'suspended')
+        -- Renaming an index replaces its definition.
+        box.space.T2.index[0]:rename('PK2')
+        box.error.injection.set('ERRINJ_VY_READ_PAGE_DELAY', false)
+        local _, res, err = f:join()
+        t.assert_equals(err, nil)
+        t.assert_equals(res, {row_count = 0})
+        box.execute([[DROP TABLE t2;]])
+    end)
+end
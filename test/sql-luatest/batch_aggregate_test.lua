@@ -0,0 +1,171 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function()
+        local ffi = require('ffi')
+        box.execute([[CREATE TABLE t(id INT PRIMARY KEY, a INT, u UNSIGNED,
+                                     d DOUBLE, s STRING);]])
+        box.execute([[CREATE INDEX ts ON t(s);]])
+        box.begin()
+        for i = 1, 50000 do
+            -- Every 7th value of "a" and every 11th value of "d" is NULL.
+            local a = i % 7 == 0 and box.NULL or (i % 3 - 1) * i
+            local d = i % 11 == 0 and box.NULL or ffi.cast('double', i / 4)
+            box.space.T:insert({i, a, i % 100, d, tostring(i)})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_batch_execution" = true;]])
+    end)
+end)
+
+--
+-- Run the query with and without batch execution and check that the
+-- results are the same.
+--
+local function check_query(sql, is_batch)
+    local function has_batch_opcode()
+        for _, row in pairs(box.execute('EXPLAIN ' .. sql).rows) do
+            if row[2] == 'BatchAggregate' then
+                return true
+            end
+        end
+        return false
+    end
+    t.assert_equals(has_batch_opcode(), is_batch ~= false)
+    local res, err = box.execute(sql)
+    box.execute([[SET SESSION "sql_batch_execution" = false;]])
+    t.assert_not(has_batch_opcode())
+    local exp_res, exp_err = box.execute(sql)
+    box.execute([[SET SESSION "sql_batch_execution" = true;]])
+    t.assert_equals(err and err.message, exp_err and exp_err.message)
+    t.assert_equals(res, exp_res)
+    return res, err
+end
+
+g.test_setting = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(
+            box.space._session_settings:get('sql_batch_execution'),
+            {'sql_batch_execution', true})
+    end)
+end
+
+g.test_aggregate = function(cg)
+    local function check(sql)
+        return cg.server:exec(check_query, {sql})
+    end
+    local res = check([[SELECT COUNT(*), COUNT(a), COUNT(d), SUM(a), SUM(u),
+                               SUM(d), MIN(a), MAX(a), MIN(d), MAX(d)
+                        FROM t;]])
+    t.assert_equals(res.rows[1][1], 50000)
+    check([[SELECT SUM(a) + 1, MAX(u) FROM t;]])
+    check([[SELECT COUNT(*) FROM t WHERE a > 0;]])
+    check([[SELECT COUNT(a), SUM(d) FROM t WHERE -100 <= a AND a <> 5
+            AND d < 1000.5 AND u >= 10 AND u != 20;]])
+    check([[SELECT MIN(a), MAX(d) FROM t WHERE d = 100;]])
+    check([[SELECT SUM(a), SUM(d), MIN(u) FROM t WHERE a > 1000000;]])
+    check([[SELECT MAX(d), COUNT(*) FROM t HAVING COUNT(*) > 10;]])
+    -- Filters on an indexed field, DISTINCT and GROUP BY are executed
+    -- row by row.
+    check([[SELECT SUM(a) FROM t WHERE id > 100;]], false)
+    check([[SELECT COUNT(DISTINCT u) FROM t;]], false)
+    check([[SELECT u, SUM(a) FROM t GROUP BY u;]], false)
+    check([[SELECT COUNT(s) FROM t;]], false)
+end
+
+g.test_empty = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE e(id INT PRIMARY KEY, a INT, d DOUBLE);]])
+    end)
+    local res = cg.server:exec(check_query, {[[
+        SELECT COUNT(*), COUNT(a), SUM(a), MIN(d), MAX(a) FROM e;
+    ]]})
+    t.assert_equals(res.rows[1][1], 0)
+    t.assert_equals(res.rows[1][2], 0)
+    for i = 3, 5 do
+        t.assert(res.rows[1][i] == nil)
+    end
+    cg.server:exec(function()
+        box.execute([[DROP TABLE e;]])
+    end)
+end
+
+g.test_fallback = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE f(id INT PRIMARY KEY, a INT, u UNSIGNED,
+                                     d DOUBLE);]])
+        box.space.F:insert({1, -5, 1, 1.5})
+        box.space.F:insert({2, 7, 18446744073709551615ULL, 2.5})
+        -- An integer stored in a DOUBLE field.
+        box.space.F:insert({3, 3, 3, 3})
+        box.space.F:insert({4, box.NULL, box.NULL, box.NULL})
+    end)
+    for _, sql in pairs({
+        [[SELECT SUM(a), MAX(u) FROM f;]],
+        [[SELECT SUM(a), MIN(d), MAX(d) FROM f;]],
+        [[SELECT SUM(a) FROM f WHERE u > 1;]],
+        [[SELECT COUNT(*) FROM f WHERE d < 3;]],
+    }) do
+        cg.server:exec(check_query, {sql})
+    end
+    cg.server:exec(function()
+        box.execute([[DROP TABLE f;]])
+    end)
+end
+
+g.test_overflow = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE o(id INT PRIMARY KEY, a INT);]])
+        box.space.O:insert({1, 9223372036854775807LL})
+        box.space.O:insert({2, 9223372036854775807LL})
+    end)
+    local res = cg.server:exec(check_query, {[[SELECT SUM(a) FROM o;]]})
+    t.assert_equals(res.rows, {{18446744073709551614ULL}})
+    cg.server:exec(function()
+        box.space.O:insert({3, 2})
+    end)
+    local _, err = cg.server:exec(check_query, {[[SELECT SUM(a) FROM o;]]})
+    t.assert_equals(err.message,
+                    'Failed to execute SQL statement: integer is overflowed')
+    cg.server:exec(function()
+        box.execute([[DROP TABLE o;]])
+    end)
+end
+
+--
+-- Compare the batch execution with the row-at-a-time one.
+--
+g.test_speedup = function(cg)
+    cg.server:exec(function()
+        local clock = require('clock')
+        local sql = [[SELECT COUNT(*), SUM(a), MAX(d) FROM t
+                      WHERE u < 50 AND d > 10;]]
+        local function bench()
+            local start = clock.monotonic()
+            for _ = 1, 10 do
+                local _, err = box.execute(sql)
+                t.assert_equals(err, nil)
+            end
+            return clock.monotonic() - start
+        end
+        local batch_time = bench()
+        box.execute([[SET SESSION "sql_batch_execution" = false;]])
+        local row_time = bench()
+        t.log('batch: %.3f s, row at a time: %.3f s', batch_time, row_time)
+        t.assert_lt(batch_time, row_time)
+    end)
+end
@@ -0,0 +1,159 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t1(id INT PRIMARY KEY, a INT, s STRING);]])
+        box.execute([[CREATE TABLE t2(id INT PRIMARY KEY, b INT,
+                                      s STRING COLLATE "unicode_ci");]])
+        box.begin()
+        for i = 1, 10240 do
+            -- Every value of t2.b is repeated twice, some values are NULL.
+            local b = i % 7 == 0 and box.NULL or i % 5120
+            box.space.T1:insert({i, i, 'str' .. i})
+            box.space.T2:insert({i, b, 'STR' .. i % 100})
+        end
+        box.space.T1:insert({10241, box.NULL, 'str'})
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_hash_join" = true;]])
+        if box.error.injection ~= nil then
+            box.error.injection.set('ERRINJ_SQL_HASH_JOIN_MEMORY', -1)
+        end
+    end)
+end)
+
+--
+-- Run the query with and without hash join and check that the results are
+-- the same.
+--
+local function check_query(sql)
+    local function run()
+        local res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        table.sort(res.rows, function(a, b)
+            for i = 1, #res.metadata do
+                local x, y = a[i], b[i]
+                if x == nil or y == nil then
+                    if x ~= nil or y ~= nil then
+                        return x == nil
+                    end
+                elseif x ~= y then
+                    return x < y
+                end
+            end
+            return false
+        end)
+        return res.rows
+    end
+    local plan = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+    t.assert_str_contains(plan[#plan][4], 'USING HASH INDEX')
+    local rows = run()
+    box.execute([[SET SESSION "sql_hash_join" = false;]])
+    plan = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+    t.assert_str_contains(plan[#plan][4], 'USING EPHEMERAL INDEX')
+    t.assert_equals(run(), rows)
+    box.execute([[SET SESSION "sql_hash_join" = true;]])
+    return rows
+end
+
+g.test_setting = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.space._session_settings:get('sql_hash_join'),
+                        {'sql_hash_join', true})
+        local sql = [[EXPLAIN QUERY PLAN
+                      SELECT t1.id, t2.id FROM t1 JOIN t2 ON t2.b = t1.a;]]
+        t.assert_equals(box.execute(sql).rows, {
+            {0, 0, 0, 'SCAN TABLE T1 (~1048576 rows)'},
+            {0, 1, 1, 'SEARCH TABLE T2 USING HASH INDEX (B=?) (~20 rows)'},
+        })
+        box.execute([[SET SESSION "sql_hash_join" = false;]])
+        t.assert_equals(box.execute(sql).rows, {
+            {0, 0, 0, 'SCAN TABLE T1 (~1048576 rows)'},
+            {0, 1, 1,
+             'SEARCH TABLE T2 USING EPHEMERAL INDEX (B=?) (~20 rows)'},
+        })
+    end)
+end
+
+g.test_join = function(cg)
+    cg.server:exec(check_query, {[[
+        SELECT t1.id, t2.id, t2.s FROM t1 JOIN t2 ON t2.b = t1.a;
+    ]]})
+    -- Multi-column key with a collation.
+    cg.server:exec(check_query, {[[
+        SELECT t1.id, t2.id FROM t1 JOIN t2 ON t2.b = t1.a AND t2.s = t1.s;
+    ]]})
+    -- Outer join emits a row even if nothing matches.
+    local rows = cg.server:exec(check_query, {[[
+        SELECT t1.id, t2.id FROM t1 LEFT JOIN t2 ON t2.b = t1.a;
+    ]]})
+    t.assert_equals(rows[#rows][1], 10241)
+    t.assert(rows[#rows][2] == nil)
+    cg.server:exec(function()
+        -- Duplicates are returned, NULLs never match.
+        local rows = box.execute([[
+            SELECT t1.id, t2.id FROM t1 JOIN t2 ON t2.b = t1.a
+            WHERE t1.id IN (1, 7, 5120, 10241);
+        ]]).rows
+        table.sort(rows, function(a, b) return a[2] < b[2] end)
+        t.assert_equals(rows, {{1, 1}, {1, 5121}, {7, 5127}})
+    end)
+end
+
+g.test_spill = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local sql = [[SELECT t1.id, t2.id FROM t1 JOIN t2 ON t2.b = t1.a;]]
+        local expected = box.execute(sql).rows
+        t.assert_equals(#expected, 8776)
+        -- Every inserted row makes the hash table exceed the limit so
+        -- it spills to an ephemeral space on the first row.
+        box.error.injection.set('ERRINJ_SQL_HASH_JOIN_MEMORY', 0)
+        t.assert_items_equals(box.execute(sql).rows, expected)
+        box.error.injection.set('ERRINJ_SQL_HASH_JOIN_MEMORY', 100 * 1024)
+        t.assert_items_equals(box.execute(sql).rows, expected)
+    end)
+end
+
+--
+-- Compare a hash join with a nested loop join over the same data.
+--
+g.test_speedup = function(cg)
+    cg.server:exec(function()
+        local clock = require('clock')
+        local function bench(sql)
+            local start = clock.monotonic()
+            local res, err = box.execute(sql)
+            t.assert_equals(err, nil)
+            return clock.monotonic() - start, res.rows[1][1]
+        end
+        -- The hash join visits each row of both tables once.
+        local hash_time, hash_count = bench([[
+            SELECT count(*) FROM t1 JOIN t2 ON t2.b = t1.a;
+        ]])
+        t.assert_equals(hash_count, 8776)
+        -- The nested loop visits every row of t2 for each of only 1024
+        -- rows of t1.
+        local loop_time, loop_count = bench([[
+            SELECT count(*) FROM t1 JOIN t2 NOT INDEXED ON t2.b = t1.a
+            WHERE t1.id <= 1024;
+        ]])
+        t.assert_equals(loop_count, 1756)
+        t.log('hash join: %.3f s, nested loop over 10%% of rows: %.3f s',
+              hash_time, loop_time)
+        t.assert_lt(hash_time, loop_time)
+    end)
+end
@@ -0,0 +1,116 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function()
+        for _, engine in pairs({'memtx', 'vinyl'}) do
+            local name = engine == 'memtx' and 'M' or 'V'
+            box.execute(([[CREATE TABLE %s(id INT PRIMARY KEY, a INT,
+                                           b STRING) WITH ENGINE = '%s';]]):
+                        format(name, engine))
+            box.execute(([[CREATE INDEX %s_A ON %s(a);]]):format(name, name))
+            for i = 1, 100 do
+                box.space[name]:insert({i, i % 10, 'str' .. i})
+            end
+        end
+        box.snapshot()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+--
+-- The key-only mode is enabled for SELECT loops that read only the
+-- fields indexed by the index.
+--
+g.test_explain = function(cg)
+    cg.server:exec(function()
+        local function is_key_only(sql)
+            for _, row in pairs(box.execute('EXPLAIN ' .. sql).rows) do
+                if row[2] == 'IteratorOpen' and row[4] == 1 then
+                    return bit.band(tonumber(row[7], 16), 4) ~= 0
+                end
+            end
+            error('index is not used')
+        end
+        t.assert(is_key_only([[SELECT id, a FROM m INDEXED BY m_a
+                               WHERE a > 5;]]))
+        t.assert(is_key_only([[SELECT COUNT(*) FROM m INDEXED BY m_a
+                               WHERE a = 5 AND id > 10;]]))
+        t.assert(is_key_only([[SELECT m1.id FROM m AS m1
+                               JOIN m AS m2 INDEXED BY m_a
+                               ON m1.a = m2.a;]]))
+        t.assert_not(is_key_only([[SELECT b FROM m INDEXED BY m_a
+                                   WHERE a > 5;]]))
+        t.assert_not(is_key_only([[SELECT * FROM m INDEXED BY m_a
+                                   WHERE a > 5;]]))
+        t.assert_not(is_key_only([[SELECT id FROM m INDEXED BY m_a
+                                   WHERE a > 5 ORDER BY b;]]))
+        t.assert_not(is_key_only([[DELETE FROM m INDEXED BY m_a
+                                   WHERE a > 5;]]))
+    end)
+end
+
+--
+-- A key-only scan of a vinyl secondary index skips the primary index
+-- look-ups and returns the same results as a full scan.
+--
+g.test_vinyl = function(cg)
+    cg.server:exec(function()
+        local function pk_lookups()
+            return box.space.V.index[0]:stat().lookup
+        end
+        local function query(sql, name, args)
+            return box.execute((sql:gsub('{t}', name)), args)
+        end
+        local function check(sql, args, is_key_only)
+            local lookups = pk_lookups()
+            local res = query(sql, 'v', args)
+            t.assert_equals(pk_lookups() == lookups, is_key_only, sql)
+            t.assert_equals(res, query(sql, 'm', args), sql)
+            t.assert_not_equals(#res.rows, 0, sql)
+        end
+        local covered = [[SELECT id, a FROM {t} INDEXED BY {t}_a
+                          WHERE a >= ? ORDER BY a, id;]]
+        local not_covered = [[SELECT b FROM {t} INDEXED BY {t}_a
+                              WHERE a >= ? ORDER BY a, id;]]
+        check(covered, {5}, true)
+        check(not_covered, {5}, false)
+        -- Non-indexed fields are updated in the primary index only.
+        for _, name in pairs({'m', 'v'}) do
+            query([[UPDATE {t} SET b = 'new' WHERE id < 50;]], name)
+            query([[UPDATE {t} SET a = a + 1 WHERE id > 90;]], name)
+            query([[DELETE FROM {t} WHERE id % 7 = 0;]], name)
+        end
+        check(covered, {5}, true)
+        check(not_covered, {5}, false)
+        -- Uncommitted changes are visible to the transaction.
+        local old = box.space.M:get(1)
+        box.space.M:replace({200, 20, 'tx'})
+        box.space.M:delete(1)
+        local expected = query(covered, 'm', {0})
+        box.space.M:delete(200)
+        box.space.M:insert(old)
+        box.begin()
+        box.space.V:replace({200, 20, 'tx'})
+        box.space.V:delete(1)
+        local lookups = pk_lookups()
+        local res = query(covered, 'v', {0})
+        t.assert_equals(pk_lookups(), lookups)
+        box.rollback()
+        t.assert_equals(res, expected)
+        check(covered, {0}, true)
+        -- A secondary index may have stale entries if DELETEs are
+        -- deferred.
+        box.space.V:alter({defer_deletes = true})
+        check(covered, {5}, false)
+        box.space.V:alter({defer_deletes = false})
+        check(covered, {5}, true)
+    end)
+end
@@ -0,0 +1,137 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.threads = server:new({alias = 'threads',
+                             box_cfg = {memtx_sort_threads = 4}})
+    cg.single = server:new({alias = 'single',
+                            box_cfg = {memtx_sort_threads = 1}})
+    for _, s in pairs({cg.threads, cg.single}) do
+        s:start()
+        s:exec(function()
+            local ffi = require('ffi')
+            box.execute([[CREATE TABLE t(id INT PRIMARY KEY, a INT,
+                                         u UNSIGNED, d DOUBLE);]])
+            box.execute([[CREATE TABLE o(id INT PRIMARY KEY, a INT);]])
+            box.begin()
+            for i = 1, 100000 do
+                local a = i % 7 == 0 and box.NULL or (i % 3 - 1) * i
+                local d = i % 11 == 0 and box.NULL or
+                          ffi.cast('double', i % 1000 / 4)
+                box.space.T:insert({i, a, i % 100, d})
+                box.space.O:insert({i, 0})
+            end
+            box.commit()
+        end)
+    end
+end)
+
+g.after_all(function(cg)
+    cg.threads:drop()
+    cg.single:drop()
+end)
+
+--
+-- Run the query and return the result, the error message and the number
+-- of times another fiber was scheduled during the query.
+--
+local function run(sql)
+    local fiber = require('fiber')
+    local count = 0
+    local f = fiber.new(function()
+        while true do
+            count = count + 1
+            fiber.yield()
+        end
+    end)
+    fiber.yield()
+    count = 0
+    local res, err = box.execute(sql)
+    local yields = count
+    f:cancel()
+    return res, err and err.message, yields
+end
+
+--
+-- The results computed by worker threads are the same as the ones
+-- computed by the TX thread.
+--
+g.test_results = function(cg)
+    for _, sql in pairs({
+        [[SELECT COUNT(*), COUNT(a), SUM(a), SUM(u), MIN(a), MAX(a),
+                 MIN(d), MAX(d) FROM t;]],
+        [[SELECT COUNT(*), SUM(a) FROM t WHERE d > 100 AND u <> 5;]],
+        [[SELECT MIN(u), MAX(u), MAX(d) FROM t WHERE a < 0;]],
+        [[SELECT SUM(a), MIN(d) FROM t WHERE a > 1000000;]],
+    }) do
+        local res, err, yields = cg.threads:exec(run, {sql})
+        t.assert_equals(err, nil, sql)
+        t.assert_gt(yields, 0, sql)
+        local exp_res, _, exp_yields = cg.single:exec(run, {sql})
+        t.assert_equals(exp_yields, 0, sql)
+        t.assert_equals(res, exp_res, sql)
+    end
+    -- SUM() of doubles depends on the order of additions, so it is
+    -- computed by the TX thread.
+    local sql = [[SELECT SUM(d) FROM t;]]
+    local res, _, yields = cg.threads:exec(run, {sql})
+    t.assert_equals(yields, 0)
+    t.assert_equals(res, cg.single:exec(run, {sql}))
+end
+
+--
+-- Worker threads aren't used in a transaction, since a read view doesn't
+-- see its changes.
+--
+g.test_transaction = function(cg)
+    cg.threads:exec(function()
+        local fiber = require('fiber')
+        local count = 0
+        local f = fiber.new(function()
+            while true do
+                count = count + 1
+                fiber.yield()
+            end
+        end)
+        fiber.yield()
+        count = 0
+        box.begin()
+        box.space.T:delete(1)
+        local res, err = box.execute([[SELECT COUNT(*), MAX(a) FROM t;]])
+        box.rollback()
+        f:cancel()
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows[1][1], 99999)
+        t.assert_equals(count, 0)
+    end)
+end
+
+--
+-- An intermediate sum overflows in the same cases as in the TX thread,
+-- even if the overflowing rows are scanned by different threads.
+--
+g.test_overflow = function(cg)
+    local function check(updates, is_overflow)
+        local sql = [[SELECT SUM(a) FROM o;]]
+        local results = {}
+        for _, s in pairs({cg.threads, cg.single}) do
+            s:exec(function(updates)
+                for _, u in pairs(updates) do
+                    box.space.O:replace(u)
+                end
+            end, {updates})
+            local res, err = s:exec(run, {sql})
+            t.assert_equals(err ~= nil, is_overflow)
+            table.insert(results, {res, err})
+        end
+        t.assert_equals(results[1], results[2])
+    end
+    local max = 9223372036854775807LL
+    local min = -9223372036854775807LL - 1
+    check({{1, max}, {2, max}, {3, 10}, {100000, -100}}, true)
+    check({{3, 0}}, false)
+    check({{1, min}, {2, 0}, {99998, max}, {99999, max}, {100000, max}},
+          false)
+end
@@ -0,0 +1,209 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t(id INT PRIMARY KEY, a INT, s STRING,
+                                     d DOUBLE);]])
+        for i = 1, 10 do
+            box.space.T:insert({i, i * 10, 'str' .. i, i / 2})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_hits = function(cg)
+    cg.server:exec(function()
+        -- Return the difference between the plan cache statistics
+        -- before and after the call of the function.
+        local function plan_stat_diff(f)
+            local before = box.info.sql().plan_cache
+            f()
+            local after = box.info.sql().plan_cache
+            return {hits = after.hits - before.hits,
+                    misses = after.misses - before.misses}
+        end
+        local diff = plan_stat_diff(function()
+            for i = 1, 5 do
+                local sql = ('SELECT a, s FROM t WHERE id = %d;'):format(i)
+                t.assert_equals(box.execute(sql).rows, {{i * 10, 'str' .. i}})
+            end
+        end)
+        t.assert_equals(diff, {hits = 4, misses = 1})
+        -- Statements with parameters are cached as is.
+        diff = plan_stat_diff(function()
+            for i = 1, 3 do
+                local res = box.execute([[SELECT a FROM t WHERE id = ?
+                                          AND a > 0;]], {i})
+                t.assert_equals(res.rows, {{i * 10}})
+            end
+        end)
+        t.assert_equals(diff, {hits = 2, misses = 1})
+        -- DDL and other statements are not cached.
+        diff = plan_stat_diff(function()
+            box.execute([[CREATE TABLE u(id INT PRIMARY KEY);]])
+            box.execute([[DROP TABLE u;]])
+            box.execute([[EXPLAIN SELECT a FROM t WHERE id = 1;]])
+        end)
+        t.assert_equals(diff, {hits = 0, misses = 0})
+        local stat = box.info.sql().plan_cache
+        t.assert_gt(stat.stmt_count, 0)
+        t.assert_gt(stat.size, 0)
+    end)
+end
+
+g.test_literals = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE l(id INT PRIMARY KEY, a INT, s STRING,
+                                     d DOUBLE, n NUMBER);]])
+        box.execute([[INSERT INTO l VALUES (1, -5, 'it''s', 1.5, 2e3),
+                                           (2, 0x10, '', -0.25, -1);]])
+        box.execute([[INSERT INTO l VALUES (3, -9223372036854775808,
+                                            'x', 1, 18446744073709551615);]])
+        t.assert_equals(box.space.L:select(), {
+            {1, -5, "it's", 1.5, 2000},
+            {2, 16, '', -0.25, -1},
+            {3, -9223372036854775808LL, 'x', 1, 18446744073709551615ULL},
+        })
+        box.execute([[UPDATE l SET a = - 7, s = 'a' || 'b' WHERE id = 1;]])
+        t.assert_equals(box.space.L:get(1), {1, -7, 'ab', 1.5, 2000})
+        local rows = box.execute([[SELECT id FROM l WHERE a IN (-7, 16)
+                                   AND s <> 'x' ORDER BY 1;]]).rows
+        t.assert_equals(rows, {{1}, {2}})
+        rows = box.execute([[SELECT id FROM l WHERE d < 1.25
+                             OR n = 18446744073709551615;]]).rows
+        t.assert_equals(rows, {{2}, {3}})
+        -- Literals of result columns and ORDER BY terms are kept.
+        local res = box.execute([[SELECT 1, 'a', id FROM l WHERE id = 2
+                                  ORDER BY 3;]])
+        t.assert_equals(res.metadata, {
+            {name = 'COLUMN_1', type = 'integer'},
+            {name = 'COLUMN_2', type = 'string'},
+            {name = 'ID', type = 'integer'},
+        })
+        t.assert_equals(res.rows, {{1, 'a', 2}})
+        -- Errors are reported for the original statement.
+        local _, err = box.execute([[SELECT id FROM l WHERE id = 1 AND
+                                     a = 99999999999999999999;]])
+        t.assert_equals(err.message, 'Integer literal ' ..
+                        '99999999999999999999 exceeds the supported range ' ..
+                        '[-9223372036854775808, 18446744073709551615]')
+        local sql = [[SELECT id FROM l WHERE a = 100 AND s = 'abc'
+                      ORDER BY on;]]
+        _, err = box.execute(sql)
+        t.assert_equals(err.message, ("At line 2 at or near position %d: " ..
+                        "keyword 'on' is reserved. Please use double " ..
+                        "quotes if 'on' is an identifier."):format(
+                        sql:find('on;') - sql:find('\n')))
+        box.execute([[DROP TABLE l;]])
+    end)
+end
+
+g.test_schema_change = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE c(id INT PRIMARY KEY, a INT);]])
+        box.execute([[INSERT INTO c VALUES (1, 1);]])
+        local sql = [[SELECT * FROM c WHERE id = 1;]]
+        t.assert_equals(box.execute(sql).rows, {{1, 1}})
+        box.execute([[DROP TABLE c;]])
+        box.execute([[CREATE TABLE c(id INT PRIMARY KEY, a STRING, b INT);]])
+        box.execute([[INSERT INTO c VALUES (1, 'a', 2);]])
+        t.assert_equals(box.execute(sql).rows, {{1, 'a', 2}})
+        box.execute([[DROP TABLE c;]])
+        -- Functions don't bump the schema version.
+        box.schema.func.create('F', {language = 'Lua', returns = 'integer',
+                                     body = 'function() return 1 end',
+                                     exports = {'LUA', 'SQL'}})
+        sql = [[SELECT F() FROM t WHERE id = 1;]]
+        t.assert_equals(box.execute(sql).metadata[1].type, 'integer')
+        box.schema.func.drop('F')
+        box.schema.func.create('F', {language = 'Lua', returns = 'string',
+                                     body = 'function() return "a" end',
+                                     exports = {'LUA', 'SQL'}})
+        local res = box.execute(sql)
+        t.assert_equals(res.metadata[1].type, 'string')
+        t.assert_equals(res.rows, {{'a'}})
+        box.schema.func.drop('F')
+        -- DDL in a transaction may be rolled back.
+        box.begin()
+        box.execute([[CREATE TABLE r(id INT PRIMARY KEY);]])
+        box.execute([[INSERT INTO r VALUES (1);]])
+        t.assert_equals(box.execute([[SELECT * FROM r WHERE id = 1;]]).rows,
+                        {{1}})
+        box.rollback()
+        local _, err = box.execute([[SELECT * FROM r WHERE id = 1;]])
+        t.assert_equals(err.message, "Space 'R' does not exist")
+    end)
+end
+
+g.test_session_settings = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT * FROM t WHERE a = 10;]]
+        t.assert_equals(#box.execute(sql).rows, 1)
+        box.execute([[SET SESSION "sql_seq_scan" = false;]])
+        local _, err = box.execute(sql)
+        t.assert_equals(err.message, "Scanning is not allowed for 'T'")
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        t.assert_equals(#box.execute(sql).rows, 1)
+    end)
+end
+
+--
+-- Plans share the memory limit with prepared statements.
+--
+g.test_eviction = function(cg)
+    cg.server:exec(function()
+        box.cfg{sql_cache_size = 20000}
+        for i = 1, 50 do
+            local sql = ('SELECT id AS c%d FROM t WHERE id = %d;')
+            t.assert_equals(box.execute(sql:format(i, i)).rows, {{i}})
+            local stat = box.info.sql()
+            t.assert_le(stat.plan_cache.size + stat.cache.size, 20000)
+        end
+        local stat = box.info.sql().plan_cache
+        t.assert_gt(stat.stmt_count, 0)
+        t.assert_lt(stat.stmt_count, 50)
+        -- Prepared statements evict plans.
+        local stmt = box.prepare([[SELECT id, a, s, d FROM t WHERE id = ?;]])
+        t.assert_equals(box.execute(stmt.stmt_id, {1}).rows,
+                        {{1, 10, 'str1', 0.5}})
+        box.unprepare(stmt.stmt_id)
+        box.cfg{sql_cache_size = 0}
+        t.assert_equals(box.info.sql().plan_cache.stmt_count, 0)
+        t.assert_equals(box.info.sql().plan_cache.size, 0)
+        box.cfg{sql_cache_size = 5 * 1024 * 1024}
+    end)
+end
+
+--
+-- A plan executed by one fiber is not used by another one.
+--
+g.test_busy = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.schema.func.create('SLEEP', {language = 'Lua',
+            body = 'function() require("fiber").sleep(0.1) return 1 end',
+            exports = {'LUA', 'SQL'}})
+        local results = {}
+        local fibers = {}
+        for i = 1, 3 do
+            fibers[i] = fiber.new(function()
+                local sql = ('SELECT id, SLEEP() FROM t WHERE id = %d;')
+                results[i] = box.execute(sql:format(i)).rows
+            end)
+            fibers[i]:set_joinable(true)
+        end
+        for i = 1, 3 do
+            fibers[i]:join()
+            t.assert_equals(results[i], {{i, 1}})
+        end
+        box.schema.func.drop('SLEEP')
+    end)
+end
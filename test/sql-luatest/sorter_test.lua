@@ -0,0 +1,134 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.threads = server:new({alias = 'threads',
+                             box_cfg = {memtx_sort_threads = 4}})
+    cg.single = server:new({alias = 'single',
+                            box_cfg = {memtx_sort_threads = 1}})
+    for _, s in pairs({cg.threads, cg.single}) do
+        s:start()
+        s:exec(function()
+            box.execute([[CREATE TABLE t(id INT PRIMARY KEY, a INT,
+                                         s STRING COLLATE "unicode_ci");]])
+            box.begin()
+            -- About 6 MB of sorted data, so it does not fit into the
+            -- memory of the sorter and is written to temporary files.
+            for i = 1, 200000 do
+                local s = (i % 2 == 0 and 'STR' or 'str') .. i * 31 % 5000
+                box.space.T:insert({i, i * 7919 % 1000, s})
+            end
+            box.commit()
+        end)
+    end
+    cg.threads:exec(function()
+        box.execute([[CREATE TABLE tv(id INT PRIMARY KEY, a INT,
+                                      s STRING COLLATE "unicode_ci")
+                      WITH ENGINE = 'vinyl';]])
+        box.execute([[INSERT INTO tv SELECT * FROM t;]])
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.threads:drop()
+    cg.single:drop()
+end)
+
+--
+-- Return the number of rows returned by the query and a hash of them.
+--
+local function digest(sql)
+    local res, err = box.execute(sql)
+    t.assert_equals(err, nil)
+    local hash = 0
+    for _, row in ipairs(res.rows) do
+        for _, v in ipairs(row) do
+            hash = (hash * 31 + (type(v) == 'string' and #v or v)) % 2^31
+        end
+    end
+    return #res.rows, hash
+end
+
+g.test_sort = function(cg)
+    for _, sql in pairs({
+        [[SELECT id, a FROM t ORDER BY a, id;]],
+        [[SELECT id, a FROM t ORDER BY a DESC, id;]],
+        [[SELECT id, s FROM t ORDER BY s, id DESC;]],
+        [[SELECT a, COUNT(*), MAX(id) FROM t GROUP BY a;]],
+        [[SELECT id FROM t WHERE id > 150000 ORDER BY a, s, id;]],
+    }) do
+        local count, hash = cg.threads:exec(digest, {sql})
+        t.assert_equals({cg.single:exec(digest, {sql})}, {count, hash}, sql)
+    end
+    cg.threads:exec(function()
+        local rows = box.execute([[SELECT a, id FROM t ORDER BY a, id;]]).rows
+        t.assert_equals(#rows, 200000)
+        for i = 2, #rows do
+            local prev, cur = rows[i - 1], rows[i]
+            t.assert(prev[1] < cur[1] or
+                     prev[1] == cur[1] and prev[2] < cur[2])
+        end
+    end)
+end
+
+--
+-- The sorter waits for the worker threads without blocking other fibers
+-- in a transaction that may yield.
+--
+g.test_yield = function(cg)
+    cg.threads:exec(function()
+        local fiber = require('fiber')
+        local count = 0
+        local f = fiber.new(function()
+            while true do
+                count = count + 1
+                fiber.sleep(0)
+            end
+        end)
+        box.begin()
+        local _, err = box.execute([[SELECT id FROM tv ORDER BY s, a;]])
+        box.commit()
+        t.assert_equals(err, nil)
+        f:cancel()
+        t.assert_gt(count, 0)
+    end)
+end
+
+--
+-- A statement executed outside of a transaction doesn't yield, so that
+-- it doesn't see concurrent changes.
+--
+g.test_autocommit = function(cg)
+    cg.threads:exec(function()
+        local fiber = require('fiber')
+        local count = 0
+        local f = fiber.new(function()
+            while true do
+                count = count + 1
+                fiber.sleep(0)
+            end
+        end)
+        local _, err = box.execute([[SELECT id FROM t ORDER BY s, a;]])
+        t.assert_equals(err, nil)
+        f:cancel()
+        t.assert_equals(count, 0)
+    end)
+end
+
+--
+-- A memtx transaction is aborted by a yield, so the sorter does not use
+-- the worker threads in it.
+--
+g.test_memtx_transaction = function(cg)
+    cg.threads:exec(function()
+        box.begin()
+        local res, err = box.execute([[SELECT id FROM t
+                                       ORDER BY s, a DESC LIMIT 1;]])
+        t.assert_equals(err, nil)
+        t.assert_equals(#res.rows, 1)
+        box.space.T:replace(box.space.T:get(1))
+        t.assert_equals({pcall(box.commit)}, {true})
+    end)
+end
@@ -0,0 +1,187 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t(id INT PRIMARY KEY, s STRING);]])
+        for i = 1, 100 do
+            box.space.T:insert({i, 'str' .. i})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+    cg.server:exec(function()
+        box.cfg{sql_cursor_idle_timeout = 60}
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.sql().cursors.count, 0)
+        end)
+    end)
+end)
+
+local function fetch_all(conn, res, fetch_size)
+    local rows = table.copy(res.rows)
+    local cursor_id = res.cursor_id
+    while cursor_id ~= nil do
+        res = conn:fetch(cursor_id, fetch_size)
+        t.assert_equals(res.metadata, nil)
+        t.assert_le(#res.rows, fetch_size)
+        for _, row in ipairs(res.rows) do
+            table.insert(rows, row)
+        end
+        cursor_id = res.cursor_id
+    end
+    return rows
+end
+
+--
+-- Rows of a SELECT statement are fetched in portions via a cursor.
+--
+g.test_fetch = function(cg)
+    local conn = cg.conn
+    t.assert(conn.peer_protocol_features.sql_cursors)
+    local sql = [[SELECT id, s FROM t WHERE id > ? ORDER BY s;]]
+    local expected = conn:execute(sql, {10})
+    t.assert_equals(#expected.rows, 90)
+    t.assert_equals(expected.cursor_id, nil)
+    for _, fetch_size in ipairs({1, 7, 30, 90, 1000}) do
+        local res = conn:execute(sql, {10}, {fetch_size = fetch_size})
+        t.assert_equals(res.metadata, expected.metadata)
+        t.assert_equals(#res.rows, math.min(fetch_size, 90))
+        t.assert_equals(res.cursor_id ~= nil, fetch_size <= 90)
+        t.assert_equals(fetch_all(conn, res, fetch_size), expected.rows)
+    end
+    -- Prepared statements and string parameters, which are copied
+    -- by the cursor.
+    local stmt = conn:prepare([[SELECT id FROM t WHERE s > ? AND s < ?;]])
+    local res = conn:execute(stmt.stmt_id, {'str5', 'str6'}, {fetch_size = 2})
+    t.assert_equals(#res.rows, 2)
+    t.assert_equals(fetch_all(conn, res, 3),
+                    conn:execute(stmt.stmt_id, {'str5', 'str6'}).rows)
+    conn:unprepare(stmt.stmt_id)
+    -- The fetch size is ignored by other statements.
+    res = conn:execute([[UPDATE t SET s = s WHERE id < 5;]], {},
+                       {fetch_size = 1})
+    t.assert_equals(res, {row_count = 4})
+end
+
+--
+-- A cursor is closed by a fetch of 0 rows and on disconnect, and it is
+-- not available in other sessions.
+--
+g.test_close = function(cg)
+    local conn = cg.conn
+    local sql = [[SELECT id FROM t;]]
+    local res = conn:execute(sql, {}, {fetch_size = 10})
+    local cursor_id = res.cursor_id
+    t.assert_not_equals(cursor_id, nil)
+    t.assert_equals(cg.server:exec(function()
+        return box.info.sql().cursors.count
+    end), 1)
+    res = conn:fetch(cursor_id, 0)
+    t.assert_equals(res, {rows = {}})
+    local msg = ('SQL cursor with id %d does not exist'):format(cursor_id)
+    t.assert_error_msg_equals(msg, conn.fetch, conn, cursor_id, 10)
+    -- Cursors of other sessions are not available.
+    cursor_id = conn:execute(sql, {}, {fetch_size = 10}).cursor_id
+    local conn2 = net.connect(cg.server.net_box_uri)
+    msg = ('SQL cursor with id %d does not exist'):format(cursor_id)
+    t.assert_error_msg_equals(msg, conn2.fetch, conn2, cursor_id, 10)
+    conn2:close()
+    t.assert_equals(#conn:fetch(cursor_id, 10).rows, 10)
+    -- Cursors are closed on disconnect.
+    conn2 = net.connect(cg.server.net_box_uri)
+    conn2:execute(sql, {}, {fetch_size = 10})
+    conn2:close()
+    t.helpers.retrying({}, function()
+        t.assert_equals(cg.server:exec(function()
+            return box.info.sql().cursors.count
+        end), 1)
+    end)
+end
+
+--
+-- An idle cursor is closed after box.cfg.sql_cursor_idle_timeout.
+--
+g.test_idle_timeout = function(cg)
+    local conn = cg.conn
+    local sql = [[SELECT id FROM t;]]
+    local cursor_id = conn:execute(sql, {}, {fetch_size = 10}).cursor_id
+    cg.server:exec(function()
+        box.cfg{sql_cursor_idle_timeout = 0.1}
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.sql().cursors.count, 0)
+        end)
+    end)
+    local msg = ('SQL cursor with id %d does not exist'):format(cursor_id)
+    t.assert_error_msg_equals(msg, conn.fetch, conn, cursor_id, 10)
+    t.assert_error_msg_equals(
+        "Incorrect value for option 'sql_cursor_idle_timeout': " ..
+        "must be greater than 0",
+        cg.server.exec, cg.server, function()
+            box.cfg{sql_cursor_idle_timeout = 0}
+        end)
+end
+
+--
+-- A cursor expires on a schema change.
+--
+g.test_schema_change = function(cg)
+    local conn = cg.conn
+    local cursor_id = conn:execute([[SELECT id FROM t;]], {},
+                                   {fetch_size = 10}).cursor_id
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE u(id INT PRIMARY KEY);]])
+        box.execute([[DROP TABLE u;]])
+    end)
+    t.assert_error_msg_equals(
+        'Failed to execute SQL statement: cursor has expired',
+        conn.fetch, conn, cursor_id, 10)
+    local msg = ('SQL cursor with id %d does not exist'):format(cursor_id)
+    t.assert_error_msg_equals(msg, conn.fetch, conn, cursor_id, 10)
+end
+
+--
+-- fetch_size is ignored in a transaction.
+--
+g.test_transaction = function(cg)
+    local stream = cg.conn:new_stream()
+    stream:begin()
+    local res = stream:execute([[SELECT id FROM t;]], {}, {fetch_size = 10})
+    t.assert_equals(#res.rows, 100)
+    t.assert_equals(res.cursor_id, nil)
+    stream:commit()
+    -- Without a transaction a cursor is opened in a stream as well.
+    res = stream:execute([[SELECT id FROM t;]], {}, {fetch_size = 60})
+    t.assert_equals(#res.rows, 60)
+    t.assert_equals(#fetch_all(stream, res, 60), 100)
+end
+
+--
+-- Invalid options are rejected.
+--
+g.test_errors = function(cg)
+    local conn = cg.conn
+    t.assert_error_msg_equals('execute does not support options',
+                              conn.execute, conn, 'SELECT 1;', {},
+                              {dry_run = true})
+    t.assert_error_msg_equals('fetch_size should be a positive integer',
+                              conn.execute, conn, 'SELECT 1;', {},
+                              {fetch_size = 0})
+    t.assert_error_msg_equals('fetch_size should be a non-negative integer',
+                              conn.fetch, conn, 1, -1)
+end
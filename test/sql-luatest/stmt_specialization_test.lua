@@ -0,0 +1,132 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t(id INT PRIMARY KEY, a INT, u UNSIGNED,
+                                     d DOUBLE, s STRING,
+                                     c STRING COLLATE "unicode_ci",
+                                     sc SCALAR);]])
+        for i = 1, 100 do
+            local a = i % 10 == 0 and box.NULL or i - 50
+            local s = i % 2 == 0 and 'STR' .. i or 'str' .. i
+            local sc = i % 3 == 0 and tostring(i) or i
+            box.space.T:insert({i, a, i * 3, i / 4, s, s, sc})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+--
+-- The program of a hot statement is shown by EXPLAIN.
+--
+g.test_explain = function(cg)
+    cg.server:exec(function()
+        local stmt = box.prepare([[EXPLAIN SELECT id, a + 1 FROM t
+                                   WHERE a < ? AND d >= 2.5;]])
+        local function opcodes()
+            local res = {}
+            for _, row in pairs(box.execute(stmt.stmt_id, {0}).rows) do
+                res[row[2]] = true
+            end
+            return res
+        end
+        local ops = opcodes()
+        t.assert(ops['Column'])
+        t.assert_not(ops['ColumnCompare'])
+        t.assert_not(ops['AddInt'])
+        for _ = 1, 20 do
+            ops = opcodes()
+        end
+        t.assert(ops['ColumnCompare'])
+        t.assert(ops['AddInt'])
+        t.assert_not(ops['Add'])
+        box.unprepare(stmt.stmt_id)
+    end)
+end
+
+--
+-- Results of a specialized statement are the same as of the original one.
+--
+g.test_results = function(cg)
+    cg.server:exec(function()
+        for _, case in pairs({
+            {[[SELECT id FROM t WHERE a < ? AND u > ?;]], {0, 30}},
+            {[[SELECT id, a * 2 - u FROM t WHERE a <> ?;]], {1}},
+            {[[SELECT id FROM t WHERE d <= ? OR d = ?;]], {2.5, 20}},
+            {[[SELECT id FROM t WHERE s > ? AND s < ?;]], {'STR5', 'str5'}},
+            {[[SELECT id FROM t WHERE c = ?;]], {'str10'}},
+            {[[SELECT id FROM t WHERE sc >= ? AND sc < ?;]], {50, '60'}},
+            {[[SELECT COUNT(*) FROM t WHERE a IS NULL OR a > ?;]], {40}},
+            {[[UPDATE t SET u = u + ? WHERE a = ?;]], {0, 10}},
+        }) do
+            local stmt = box.prepare(case[1])
+            local expected = box.execute(stmt.stmt_id, case[2])
+            for _ = 1, 20 do
+                local res, err = box.execute(stmt.stmt_id, case[2])
+                t.assert_equals(err, nil, case[1])
+                t.assert_equals(res, expected, case[1])
+            end
+            box.unprepare(stmt.stmt_id)
+        end
+    end)
+end
+
+--
+-- Errors of a specialized statement are the same as of the original one.
+--
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        for _, case in pairs({
+            {[[SELECT a + ? FROM t WHERE id = ?;]], {1, 1},
+             {{9223372036854775807LL, 99}, {'a', 1}, {1.5, 1}}},
+            {[[SELECT id FROM t WHERE a < ?;]], {0}, {{'a'}, {0.5}}},
+        }) do
+            local stmt = box.prepare(case[1])
+            local expected = {}
+            for i, args in pairs(case[3]) do
+                expected[i] = {box.execute(stmt.stmt_id, args)}
+            end
+            for _ = 1, 20 do
+                local _, err = box.execute(stmt.stmt_id, case[2])
+                t.assert_equals(err, nil, case[1])
+            end
+            for i, args in pairs(case[3]) do
+                local res, err = box.execute(stmt.stmt_id, args)
+                t.assert_equals(res, expected[i][1], case[1])
+                t.assert_equals(err and err.message,
+                                expected[i][2] and expected[i][2].message,
+                                case[1])
+            end
+            box.unprepare(stmt.stmt_id)
+        end
+    end)
+end
+
+--
+-- A comparison of an ANY value fails with the same error after the
+-- statement becomes hot.
+--
+g.test_any_errors = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t_any(id INT PRIMARY KEY, v ANY);]])
+        box.execute([[INSERT INTO t_any VALUES (1, 1);]])
+        local stmt = box.prepare([[SELECT id FROM t_any WHERE v = ?;]])
+        local _, expected = box.execute(stmt.stmt_id, {1})
+        t.assert_not_equals(expected, nil)
+        for _ = 1, 20 do
+            local res, err = box.execute(stmt.stmt_id, {1})
+            t.assert_equals(res, nil)
+            t.assert_equals(err.message, expected.message)
+        end
+        box.unprepare(stmt.stmt_id)
+        box.execute([[DROP TABLE t_any;]])
+    end)
+end
@@ -0,0 +1,156 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t(id INT PRIMARY KEY, g INT, a INT);]])
+        box.execute([[INSERT INTO t VALUES (1, 1, 10), (2, 1, 20), (3, 1, 20),
+                      (4, 1, 30), (5, 2, 5), (6, 2, NULL), (7, 2, 5);]])
+        box.execute([[CREATE TABLE n(id INT PRIMARY KEY, a INT, b STRING);]])
+        for i = 1, 2000 do
+            box.space.N:insert({i, i * 7919 % 100, 'b' .. i % 13})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+--
+-- ROW_NUMBER(), RANK() and running SUM() are computed over the rows
+-- of a partition sorted by the window, SUM() includes the peers of
+-- the current row.
+--
+g.test_window_functions = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT id, RANK() OVER (PARTITION BY g ORDER BY a),
+                      SUM(a) OVER (PARTITION BY g ORDER BY a)
+                      FROM t ORDER BY id;]]
+        local res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{1, 1, 10}, {2, 2, 50}, {3, 2, 50},
+                                   {4, 4, 80}, {5, 2, 10}, {6, 1, box.NULL},
+                                   {7, 2, 10}})
+
+        sql = [[SELECT id, ROW_NUMBER() OVER (PARTITION BY g
+                                              ORDER BY a DESC, id)
+                FROM t ORDER BY id;]]
+        res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{1, 4}, {2, 2}, {3, 3}, {4, 1}, {5, 1},
+                                   {6, 3}, {7, 2}})
+
+        sql = [[SELECT id, SUM(a) OVER (ORDER BY id), g * 10
+                FROM t WHERE g = 1;]]
+        res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_items_equals(res.rows, {{1, 10, 10}, {2, 30, 10},
+                                         {3, 50, 10}, {4, 80, 10}})
+
+        -- All the rows are peers if there is no ORDER BY.
+        sql = [[SELECT g, RANK() OVER (PARTITION BY g),
+                SUM(a) OVER (PARTITION BY g) FROM t ORDER BY g;]]
+        res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{1, 1, 80}, {1, 1, 80}, {1, 1, 80},
+                                   {1, 1, 80}, {2, 1, 10}, {2, 1, 10},
+                                   {2, 1, 10}})
+
+        sql = [[SELECT ROW_NUMBER() OVER () AS rn FROM t
+                ORDER BY rn DESC LIMIT 3;]]
+        res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{7}, {6}, {5}})
+
+        sql = [[SELECT * FROM (SELECT id, ROW_NUMBER() OVER (ORDER BY id) AS rn
+                               FROM t) WHERE rn % 3 = 0;]]
+        res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{3, 3}, {6, 6}})
+
+        sql = [[SELECT SUM(a) OVER () FROM t WHERE id > 100;]]
+        res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {})
+    end)
+end
+
+g.test_window_function_errors = function(cg)
+    cg.server:exec(function()
+        local function check(sql, msg)
+            local _, err = box.execute(sql)
+            t.assert_equals(err and err.message, msg, sql)
+        end
+        check([[SELECT id FROM t WHERE ROW_NUMBER() OVER () > 1;]],
+              "misuse of window function ROW_NUMBER()")
+        check([[SELECT ROW_NUMBER() OVER () AS rn FROM t WHERE rn > 1;]],
+              "misuse of aliased window function RN")
+        check([[SELECT RANK() OVER (ORDER BY RANK() OVER ()) FROM t;]],
+              "misuse of window function RANK()")
+        check([[SELECT ROW_NUMBER() OVER (ORDER BY SUM(a)) FROM t;]],
+              "misuse of aggregate function SUM()")
+        check([[SELECT COUNT(*), ROW_NUMBER() OVER () FROM t;]],
+              "Tarantool does not support window functions in aggregate "..
+              "or DISTINCT queries")
+        check([[SELECT DISTINCT ROW_NUMBER() OVER () FROM t;]],
+              "Tarantool does not support window functions in aggregate "..
+              "or DISTINCT queries")
+        check([[SELECT ABS(a) OVER () FROM t;]],
+              "Tarantool does not support window function ABS()")
+        check([[SELECT SUM(DISTINCT a) OVER () FROM t;]],
+              "Tarantool does not support DISTINCT in window functions")
+        check([[SELECT RANK() OVER (), SUM(a) OVER (ORDER BY id) FROM t;]],
+              "Tarantool does not support different windows in one SELECT")
+        check([[SELECT SUM(a, a) OVER () FROM t;]],
+              "Wrong number of arguments is passed to SUM(): "..
+              "expected 1, got 2")
+    end)
+end
+
+--
+-- ORDER BY with a small constant LIMIT keeps only the first rows in
+-- the sorter and returns the same rows as the full sort.
+--
+g.test_top_n = function(cg)
+    cg.server:exec(function()
+        local function uses_top_n(sql)
+            for _, row in pairs(box.execute('EXPLAIN ' .. sql).rows) do
+                if row[2] == 'SorterInsert' then
+                    return row[5] ~= 0
+                end
+            end
+            return false
+        end
+        t.assert(uses_top_n([[SELECT id FROM n ORDER BY a LIMIT 10;]]))
+        t.assert(uses_top_n([[SELECT id FROM n ORDER BY a DESC, b
+                              LIMIT 10 OFFSET 1000;]]))
+        t.assert_not(uses_top_n([[SELECT id FROM n ORDER BY a
+                                  LIMIT 10 OFFSET 1015;]]))
+        t.assert_not(uses_top_n([[SELECT id FROM n ORDER BY a LIMIT ?;]]))
+        t.assert_not(uses_top_n([[SELECT id FROM n ORDER BY a;]]))
+
+        for _, order in pairs({'a, id', 'a DESC, id', 'b, a DESC, id',
+                               'b DESC, id DESC'}) do
+            local sql = 'SELECT id, a, b FROM n WHERE id % 5 <> 0 ORDER BY '
+                        .. order
+            local all = box.execute(sql .. ' LIMIT 100000;').rows
+            for _, lim in pairs({{1, 0}, {10, 0}, {10, 7}, {1000, 24},
+                                 {500, 1500}}) do
+                local res = box.execute(sql .. ' LIMIT ? OFFSET ?;', lim).rows
+                local top_n = box.execute(('%s LIMIT %d OFFSET %d;'):
+                                          format(sql, lim[1], lim[2])).rows
+                t.assert_equals(top_n, res, sql)
+                local expected = {}
+                for i = lim[2] + 1, math.min(lim[1] + lim[2], #all) do
+                    table.insert(expected, all[i])
+                end
+                t.assert_equals(top_n, expected, sql)
+            end
+        end
+    end)
+end
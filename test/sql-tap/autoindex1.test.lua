@@ -4,8 +4,10 @@ test:plan(8)
 
 --
 -- This file implements regression tests for sql library. The focus of this
--- script is testing ephemeral index creation logic.
+-- script is testing ephemeral index creation logic. Hash joins use the
+-- same logic and are tested separately, see sql-luatest/hash_join_test.lua.
 --
+test:execsql([[SET SESSION "sql_hash_join" = false;]])
 
 test:execsql([[
     CREATE TABLE t1(a INT, b INT PRIMARY KEY);
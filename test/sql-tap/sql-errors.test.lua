@@ -18,7 +18,7 @@ test:do_catchsql_test(
 		ANALYZE v0;
 	]], {
 		-- <sql-errors-1.1>
-		1,"Syntax error at line 1 near 'ANALYZE'"
+		1,"Space 'V0' does not exist"
 		-- </sql-errors-1.1>
 	})
 
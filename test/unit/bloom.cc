@@ -96,9 +96,55 @@ store_load_test()
 	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
 }
 
+void
+split_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	uint32_t error_count = 0;
+	uint32_t fp_rate_too_big = 0;
+	for (double p = 0.001; p < 0.5; p *= 1.3) {
+		uint64_t tests = 0;
+		uint64_t false_positive = 0;
+		for (uint32_t count = 1000; count <= 10000; count *= 2) {
+			struct bloom bloom;
+			bloom_split_create(&bloom, count, p);
+			unordered_set<uint32_t> check;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t val = rand() % (count * 10);
+				check.insert(val);
+				bloom_split_add(&bloom, h(val));
+			}
+			struct bloom test = bloom;
+			char *buf = (char *)malloc(bloom_store_size(&bloom));
+			bloom_store(&bloom, buf);
+			bloom_destroy(&bloom);
+			bloom_load_table(&test, buf);
+			free(buf);
+			for (uint32_t i = 0; i < count * 10; i++) {
+				bool has = check.find(i) != check.end();
+				bool bloom_possible =
+					bloom_split_maybe_has(&test, h(i));
+				tests++;
+				if (has && !bloom_possible)
+					error_count++;
+				if (!has && bloom_possible)
+					false_positive++;
+			}
+			bloom_destroy(&test);
+		}
+		double fp_rate = (double)false_positive / tests;
+		if (fp_rate > p + 0.001)
+			fp_rate_too_big++;
+	}
+	cout << "error_count = " << error_count << endl;
+	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
+}
+
 int
 main(void)
 {
 	simple_test();
 	store_load_test();
+	split_test();
 }
@@ -0,0 +1,136 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "coio_uring.h"
+#include "diag.h"
+#include "fiber.h"
+#include "memory.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+enum {
+	/** Number of concurrent readers. */
+	READER_COUNT = 100,
+	/** Size of a chunk read by each reader. */
+	CHUNK_SIZE = 1000,
+	/** Number of test cases. */
+	TEST_COUNT = 4,
+};
+
+static struct coio_uring *ring;
+static int fd;
+
+/** Return the byte stored at the given file offset. */
+static char
+pattern(size_t offset)
+{
+	return 'a' + (offset * 7) % 26;
+}
+
+static int
+reader_f(va_list ap)
+{
+	int i = va_arg(ap, int);
+	int *error_count = va_arg(ap, int *);
+	char buf[CHUNK_SIZE];
+	off_t offset = (off_t)i * CHUNK_SIZE;
+	ssize_t rc = coio_uring_pread(ring, fd, buf, sizeof(buf), offset);
+	if (rc != (ssize_t)sizeof(buf)) {
+		(*error_count)++;
+		return 0;
+	}
+	for (size_t j = 0; j < sizeof(buf); j++) {
+		if (buf[j] != pattern(offset + j)) {
+			(*error_count)++;
+			break;
+		}
+	}
+	return 0;
+}
+
+static void
+test_concurrent_reads(void)
+{
+	int error_count = 0;
+	struct fiber *readers[READER_COUNT];
+	for (int i = 0; i < READER_COUNT; i++) {
+		readers[i] = fiber_new("reader", reader_f);
+		fail_if(readers[i] == NULL);
+		fiber_set_joinable(readers[i], true);
+		fiber_start(readers[i], i, &error_count);
+	}
+	for (int i = 0; i < READER_COUNT; i++)
+		fiber_join(readers[i]);
+	is(error_count, 0, "concurrent reads");
+}
+
+static void
+test_short_read(void)
+{
+	char buf[CHUNK_SIZE];
+	off_t offset = (off_t)READER_COUNT * CHUNK_SIZE - 10;
+	ssize_t rc = coio_uring_pread(ring, fd, buf, sizeof(buf), offset);
+	is(rc, 10, "short read at the end of file");
+	rc = coio_uring_pread(ring, fd, buf, sizeof(buf), offset + 10);
+	is(rc, 0, "read past the end of file");
+}
+
+static void
+test_error(void)
+{
+	char buf[CHUNK_SIZE];
+	ssize_t rc = coio_uring_pread(ring, -1, buf, sizeof(buf), 0);
+	ok(rc == -1 && errno == EBADF, "read from invalid fd");
+}
+
+static int
+main_f(va_list ap)
+{
+	(void)ap;
+	ring = coio_uring_new(32);
+	if (ring == NULL) {
+		for (int i = 0; i < TEST_COUNT; i++)
+			ok(true, "# SKIP io_uring is unsupported");
+		goto out;
+	}
+	char path[] = "/tmp/coio_uring.XXXXXX";
+	fd = mkstemp(path);
+	fail_if(fd < 0);
+	unlink(path);
+	char *data = malloc(READER_COUNT * CHUNK_SIZE);
+	fail_if(data == NULL);
+	for (size_t i = 0; i < READER_COUNT * CHUNK_SIZE; i++)
+		data[i] = pattern(i);
+	fail_if(write(fd, data, READER_COUNT * CHUNK_SIZE) !=
+		READER_COUNT * CHUNK_SIZE);
+	free(data);
+
+	test_concurrent_reads();
+	test_short_read();
+	test_error();
+
+	close(fd);
+	coio_uring_delete(ring);
+out:
+	ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+int
+main(void)
+{
+	plan(TEST_COUNT);
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	struct fiber *f = fiber_new("main", main_f);
+	fiber_wakeup(f);
+	ev_run(loop(), 0);
+	fiber_free();
+	memory_free();
+	return check_plan();
+}
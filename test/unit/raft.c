@@ -2439,10 +2439,79 @@ raft_test_candidate_disable_during_wal_write(void)
 	raft_finish_test();
 }
 
+static void
+raft_test_leader_lease(void)
+{
+	raft_start_test(12);
+	struct raft_node node;
+	raft_node_create(&node);
+	raft_node_cfg_is_lease_enabled(&node, true);
+
+	raft_node_cfg_election_quorum(&node, 1);
+	raft_node_promote(&node);
+	raft_node_cfg_election_quorum(&node, 2);
+	ok(raft_lease_remaining(&node.raft) == 0, "no lease without acks");
+
+	raft_node_send_lease_ack(&node, 2, raft_time(), 2);
+	ok(raft_lease_remaining(&node.raft) == 0,
+	   "ack from a node not seeing the leader is ignored");
+
+	is(raft_node_send_is_leader_seen(&node, 2, true, 2), 0, "message is ok");
+	raft_node_send_lease_ack(&node, 2, raft_time() - 1, 2);
+	ok(raft_lease_remaining(&node.raft) == 0,
+	   "ack of a heartbeat sent before the leader was seen is ignored");
+
+	raft_node_send_lease_ack(&node, 2, raft_time(), 2);
+	double remaining = raft_lease_remaining(&node.raft);
+	ok(remaining > 4.4 && remaining < 4.6, "lease is extended by the ack");
+
+	raft_run_for(2);
+	remaining = raft_lease_remaining(&node.raft);
+	ok(remaining > 2.4 && remaining < 2.6, "lease runs down");
+
+	raft_run_for(3);
+	ok(raft_lease_remaining(&node.raft) == 0, "lease is expired");
+
+	raft_node_send_lease_ack(&node, 2, raft_time(), 2);
+	ok(raft_lease_remaining(&node.raft) > 4.4, "lease is renewed");
+
+	is(raft_node_send_vote_request(&node,
+		3 /* Term. */,
+		"{}" /* Vclock. */,
+		3 /* Source. */
+	), 0, "vote request is ok");
+	ok(node.raft.state == RAFT_STATE_FOLLOWER &&
+	   node.raft.volatile_term == 3 &&
+	   raft_lease_remaining(&node.raft) == 0,
+	   "leader gives up the lease on a newer term");
+
+	/*
+	 * A follower doesn't support a newer term while the leader could count
+	 * on it in the lease.
+	 */
+	raft_node_destroy(&node);
+	raft_node_create(&node);
+	raft_node_cfg_is_candidate(&node, false);
+	raft_node_cfg_is_lease_enabled(&node, true);
+	raft_node_send_leader(&node, 2, 2);
+	raft_run_for(4);
+	raft_node_send_vote_request(&node, 3, "{}", 3);
+	ok(node.raft.leader == 2 && node.raft.volatile_term == 2,
+	   "follower ignores a newer term while the leader is alive");
+
+	raft_run_for(2);
+	raft_node_send_vote_request(&node, 3, "{}", 3);
+	ok(node.raft.leader == 0 && node.raft.volatile_term == 3,
+	   "follower accepts a newer term when the leader is dead");
+
+	raft_node_destroy(&node);
+	raft_finish_test();
+}
+
 static int
 main_f(va_list ap)
 {
-	raft_start_test(20);
+	raft_start_test(21);
 
 	(void) ap;
 	fakeev_init();
@@ -2467,6 +2536,7 @@ main_f(va_list ap)
 	raft_test_pre_vote();
 	raft_test_resign();
 	raft_test_candidate_disable_during_wal_write();
+	raft_test_leader_lease();
 
 	fakeev_free();
 
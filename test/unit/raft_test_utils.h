@@ -108,6 +108,7 @@ struct raft_node {
 	int cfg_election_quorum;
 	double cfg_death_timeout;
 	double cfg_max_shift;
+	bool cfg_is_lease_enabled;
 	uint32_t cfg_instance_id;
 	int cfg_cluster_size;
 	struct vclock *cfg_vclock;
@@ -198,6 +199,14 @@ int
 raft_node_send_is_leader_seen(struct raft_node *node, uint64_t term,
 			      bool is_seen, uint32_t source);
 
+/**
+ * Deliver an acknowledgement of the leader heartbeat sent at @a sent_time from
+ * @a source instance in the given @a term.
+ */
+void
+raft_node_send_lease_ack(struct raft_node *node, uint64_t term,
+			 double sent_time, uint32_t source);
+
 /** Restart the node. The same as stop + start. */
 void
 raft_node_restart(struct raft_node *node);
@@ -267,6 +276,9 @@ raft_node_cfg_death_timeout(struct raft_node *node, double value);
 void
 raft_node_cfg_max_shift(struct raft_node *node, double value);
 
+void
+raft_node_cfg_is_lease_enabled(struct raft_node *node, bool value);
+
 /** Check that @a msg message matches the given arguments. */
 bool
 raft_msg_check(const struct raft_msg *msg, enum raft_state state, uint64_t term,
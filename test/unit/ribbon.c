@@ -0,0 +1,140 @@
+#include "salad/ribbon.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+static uint32_t
+h(uint32_t i)
+{
+	return i * 2654435761;
+}
+
+/**
+ * Build a filter for values 0 .. count - 1 and check that it has
+ * no false negatives and that the false positive rate is close to
+ * the expected one.
+ */
+static void
+test_ribbon_one(uint32_t count, double p)
+{
+	plan(3);
+	uint32_t *hashes = malloc(count * sizeof(*hashes));
+	fail_if(hashes == NULL);
+	for (uint32_t i = 0; i < count; i++)
+		hashes[i] = h(i);
+	struct ribbon ribbon;
+	is(ribbon_create(&ribbon, hashes, count, p), 0,
+	   "create count=%u p=%.3f", count, p);
+	free(hashes);
+
+	uint32_t false_negative = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!ribbon_maybe_has(&ribbon, h(i)))
+			false_negative++;
+	}
+	is(false_negative, 0, "no false negatives");
+
+	uint32_t tests = 100000;
+	uint32_t false_positive = 0;
+	for (uint32_t i = count; i < count + tests; i++) {
+		if (ribbon_maybe_has(&ribbon, h(i)))
+			false_positive++;
+	}
+	double fp_rate = (double)false_positive / tests;
+	ok(fp_rate <= p + 0.001 && fp_rate <= ribbon_fpr(&ribbon) * 1.5,
+	   "false positive rate %.4f is not greater than %.4f", fp_rate, p);
+	ribbon_destroy(&ribbon);
+	check_plan();
+}
+
+static void
+test_ribbon(void)
+{
+	header();
+	plan(8);
+	test_ribbon_one(0, 0.05);
+	test_ribbon_one(1, 0.05);
+	test_ribbon_one(100, 0.05);
+	test_ribbon_one(10000, 0.05);
+	test_ribbon_one(10000, 0.01);
+	test_ribbon_one(10000, 0.001);
+	test_ribbon_one(100000, 0.05);
+	test_ribbon_one(100000, 1e-6);
+	check_plan();
+	footer();
+}
+
+/** Check that a filter keeps working after being stored and loaded. */
+static void
+test_ribbon_store_load(void)
+{
+	header();
+	plan(3);
+	uint32_t count = 10000;
+	uint32_t *hashes = malloc(count * sizeof(*hashes));
+	fail_if(hashes == NULL);
+	for (uint32_t i = 0; i < count; i++)
+		hashes[i] = h(i);
+	struct ribbon ribbon;
+	fail_if(ribbon_create(&ribbon, hashes, count, 0.05) != 0);
+	free(hashes);
+
+	char *buf = malloc(ribbon_store_size(&ribbon));
+	fail_if(buf == NULL);
+	char *end = ribbon_store(&ribbon, buf);
+	is((size_t)(end - buf), ribbon_store_size(&ribbon), "store size");
+
+	struct ribbon test = ribbon;
+	ribbon_destroy(&ribbon);
+	is(ribbon_load_table(&test, buf), 0, "load");
+	free(buf);
+
+	uint32_t mismatch = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!ribbon_maybe_has(&test, h(i)))
+			mismatch++;
+	}
+	is(mismatch, 0, "no false negatives after load");
+	ribbon_destroy(&test);
+	check_plan();
+	footer();
+}
+
+/** Check that a ribbon filter is smaller than a bloom filter. */
+static void
+test_ribbon_size(void)
+{
+	header();
+	plan(1);
+	uint32_t count = 100000;
+	double p = 0.01;
+	uint32_t *hashes = malloc(count * sizeof(*hashes));
+	fail_if(hashes == NULL);
+	for (uint32_t i = 0; i < count; i++)
+		hashes[i] = h(i);
+	struct ribbon ribbon;
+	fail_if(ribbon_create(&ribbon, hashes, count, p) != 0);
+	free(hashes);
+	/* See bloom_create(). */
+	double bloom_size = count * ceil(log(p) / log(0.5)) / log(2) / 8;
+	double ratio = ribbon_store_size(&ribbon) / bloom_size;
+	ok(ratio < 0.8, "ribbon/bloom size ratio %.2f", ratio);
+	ribbon_destroy(&ribbon);
+	check_plan();
+	footer();
+}
+
+int
+main(void)
+{
+	plan(3);
+	test_ribbon();
+	test_ribbon_store_load();
+	test_ribbon_size();
+	return check_plan();
+}
@@ -23,8 +23,8 @@ write_run(struct vy_run *run, const char *dir_name,
 	struct vy_run_writer writer;
 	if (vy_run_writer_create(&writer, run, dir_name,
 				 lsm->space_id, lsm->index_id,
-				 lsm->cmp_def, lsm->key_def,
-				 4096, 0.1, false) != 0)
+				 lsm->cmp_def, lsm->key_def, false,
+				 4096, 0.1, TUPLE_BLOOM_CLASSIC, false) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
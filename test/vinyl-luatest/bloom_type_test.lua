@@ -0,0 +1,75 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new{alias = 'master'}
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_options = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_equals(
+            "Wrong index options: bloom_type must be one of " ..
+            "'classic', 'split_block' or 'ribbon'",
+            s.create_index, s, 'pk', {bloom_type = 'foo'})
+        s:create_index('pk')
+        t.assert_equals(s.index.pk.options.bloom_type, nil)
+        s.index.pk:alter({bloom_type = 'ribbon'})
+        t.assert_equals(s.index.pk.options.bloom_type, 'ribbon')
+        s.index.pk:alter({bloom_type = 'classic'})
+        t.assert_equals(s.index.pk.options.bloom_type, nil)
+    end)
+end
+
+--
+-- Check that all filter types filter out lookups of missing keys
+-- and are loaded from disk on restart.
+--
+for _, bloom_type in ipairs({'classic', 'split_block', 'ribbon'}) do
+    local name = 'test_lookup_' .. bloom_type
+    g[name] = function(cg)
+        cg.server:exec(function(bloom_type)
+            local s = box.schema.space.create('test', {engine = 'vinyl'})
+            s:create_index('pk', {parts = {{1, 'unsigned'}, {2, 'unsigned'}},
+                                  bloom_type = bloom_type})
+            for i = 1, 1000 do
+                s:replace({i, i})
+            end
+            box.snapshot()
+        end, {bloom_type})
+        local function check()
+            cg.server:exec(function()
+                local s = box.space.test
+                for i = 1, 1000 do
+                    t.assert_equals(s:get({i, i}), {i, i})
+                    t.assert_equals(s:select({i}), {{i, i}})
+                end
+                t.assert_gt(s.index.pk:stat().disk.bloom_size, 0)
+                local hit = s.index.pk:stat().disk.iterator.bloom.hit
+                for i = 1001, 2000 do
+                    t.assert_equals(s:get({i, i}), nil)
+                end
+                hit = s.index.pk:stat().disk.iterator.bloom.hit - hit
+                t.assert_gt(hit, 900)
+            end)
+        end
+        check()
+        cg.server:restart()
+        check()
+    end
+end
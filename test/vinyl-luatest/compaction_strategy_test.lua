@@ -0,0 +1,110 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new{alias = 'master'}
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_options = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_equals(
+            "Wrong index options: compaction_strategy must be one of " ..
+            "'tiered', 'leveled' or 'time_window'",
+            s.create_index, s, 'pk', {compaction_strategy = 'foo'})
+        t.assert_error_msg_equals(
+            "Wrong index options: compaction_time_window must be " ..
+            "greater than 0",
+            s.create_index, s, 'pk', {compaction_strategy = 'time_window',
+                                      compaction_time_window = 0})
+        s:create_index('pk')
+        t.assert_equals(s.index.pk.options.compaction_strategy, nil)
+        s.index.pk:alter({compaction_strategy = 'leveled'})
+        t.assert_equals(s.index.pk.options.compaction_strategy, 'leveled')
+        t.assert_equals(s.index.pk.options.compaction_time_window, nil)
+        s.index.pk:alter({compaction_strategy = 'time_window',
+                          compaction_time_window = 60})
+        t.assert_equals(s.index.pk.options.compaction_strategy,
+                        'time_window')
+        t.assert_equals(s.index.pk.options.compaction_time_window, 60)
+    end)
+end
+
+--
+-- Leveled compaction keeps one run per level no matter what
+-- run_count_per_level is.
+--
+g.test_leveled = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {compaction_strategy = 'leveled',
+                              run_count_per_level = 100})
+        for i = 1, 2 do
+            for j = 1, 10 do
+                s:replace({j, i})
+            end
+            box.snapshot()
+        end
+        t.helpers.retrying({}, function()
+            t.assert_covers(box.stat.vinyl().scheduler, {
+                tasks_inprogress = 0, compaction_queue = 0,
+            })
+            t.assert_equals(s.index.pk:stat().run_count, 1)
+        end)
+        t.assert_equals(s:select(), {
+            {1, 2}, {2, 2}, {3, 2}, {4, 2}, {5, 2},
+            {6, 2}, {7, 2}, {8, 2}, {9, 2}, {10, 2},
+        })
+    end)
+end
+
+--
+-- Time window compaction never merges runs dumped in different
+-- time windows, but compacts runs of the same window.
+--
+g.test_time_window = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {compaction_strategy = 'time_window',
+                              compaction_time_window = 10,
+                              run_count_per_level = 1})
+        for i = 1, 3 do
+            box.error.injection.set('ERRINJ_VY_DUMP_TIME', i * 100)
+            s:replace({i})
+            box.snapshot()
+        end
+        t.assert_covers(box.stat.vinyl().scheduler, {
+            tasks_inprogress = 0, compaction_queue = 0,
+        })
+        t.assert_equals(s.index.pk:stat().run_count, 3)
+
+        s.index.pk:alter({compaction_time_window = 1e9})
+        box.error.injection.set('ERRINJ_VY_DUMP_TIME', 400)
+        s:replace({4})
+        box.snapshot()
+        box.error.injection.set('ERRINJ_VY_DUMP_TIME', 0)
+        t.helpers.retrying({}, function()
+            t.assert_covers(box.stat.vinyl().scheduler, {
+                tasks_inprogress = 0, compaction_queue = 0,
+            })
+            t.assert_equals(s.index.pk:stat().run_count, 1)
+        end)
+        t.assert_equals(s:select(), {{1}, {2}, {3}, {4}})
+    end)
+end
@@ -0,0 +1,145 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new{alias = 'master'}
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_options = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "primary index can't be covering",
+            s.create_index, s, 'pk', {covering = true})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, covering = true})
+        t.assert_equals(s.index.sk.options.covering, true)
+        t.assert_error_msg_equals(
+            "Can't create or modify index 'mk' in space 'test': " ..
+            "multikey index can't be covering",
+            s.create_index, s, 'mk',
+            {parts = {{'[3][*]', 'unsigned'}}, covering = true})
+        t.assert_error_msg_equals(
+            "Can't modify space 'test': " ..
+            "covering indexes can't be used with defer_deletes",
+            s.alter, s, {defer_deletes = true})
+        s.index.sk:alter({covering = false})
+        t.assert_equals(s.index.sk.options.covering, nil)
+        s:alter({defer_deletes = true})
+        t.assert_error_msg_equals(
+            "Can't modify space 'test': " ..
+            "covering indexes can't be used with defer_deletes",
+            s.index.sk.alter, s.index.sk, {covering = true})
+    end)
+end
+
+--
+-- Check that reads from a covering index don't look up the primary
+-- index and return up-to-date tuples, both from memory and disk.
+--
+g.test_read = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, covering = true})
+        s:create_index('sk2', {parts = {2, 'unsigned'}, unique = false})
+        for i = 1, 10 do
+            s:insert({i, i * 10, 'foo'})
+        end
+        box.snapshot()
+        for i = 1, 10, 2 do
+            s:update(i, {{'=', 3, 'bar'}})
+        end
+        box.snapshot()
+        s:delete(2)
+        s:update(4, {{'=', 2, 5}})
+        local expected = s.index.sk2:select()
+        t.assert_equals(#expected, 9)
+        local lookup = s.index.pk:stat().lookup
+        t.assert_equals(s.index.sk:select(), expected)
+        t.assert_equals(s.index.sk:select({50}, {iterator = 'le'}),
+                        s.index.sk2:select({50}, {iterator = 'le'}))
+        t.assert_equals(s.index.sk:get(90), {9, 90, 'bar'})
+        t.assert_equals(s.index.sk:get(5), {4, 5, 'foo'})
+        t.assert_equals(s.index.sk:get(20), nil)
+        t.assert_equals(s.index.pk:stat().lookup, lookup)
+        s.index.sk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.sk:stat().disk.compaction.queue.rows, 0)
+        end)
+        box.snapshot()
+        t.assert_equals(s.index.sk:select(), expected)
+        t.assert_equals(s.index.pk:stat().lookup, lookup)
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.sk:select(), s.index.sk2:select())
+        t.assert_equals(s.index.sk:get(10), {1, 10, 'bar'})
+    end)
+end
+
+--
+-- Check that an update that doesn't touch the secondary key doesn't
+-- resurrect the old tuple in a covering index after it's deleted.
+--
+g.test_update_delete = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, covering = true})
+        s:insert({1, 10, 'foo'})
+        box.snapshot()
+        s:update(1, {{'=', 3, 'bar'}})
+        box.snapshot()
+        s:delete(1)
+        box.snapshot()
+        t.assert_equals(s.index.sk:select(), {})
+        s.index.sk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.sk:stat().disk.compaction.queue.rows, 0)
+        end)
+        t.assert_equals(s.index.sk:select(), {})
+    end)
+end
+
+--
+-- Check that a transaction that read a tuple from a covering index
+-- is aborted if the tuple is updated by another transaction.
+--
+g.test_conflict = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, covering = true})
+        s:insert({1, 10, 'foo'})
+        box.begin()
+        t.assert_equals(s.index.sk:get(10), {1, 10, 'foo'})
+        local f = fiber.new(function()
+            s:update(1, {{'=', 3, 'bar'}})
+        end)
+        f:set_joinable(true)
+        t.assert_equals({f:join()}, {true})
+        t.assert_error_msg_equals('Transaction has been aborted by conflict',
+                                  s.replace, s, {2, 20, 'baz'})
+        box.rollback()
+        t.assert_equals(s:select(), {{1, 10, 'bar'}})
+    end)
+end
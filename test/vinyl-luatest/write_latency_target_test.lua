@@ -0,0 +1,126 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new{
+        alias = 'master',
+        box_cfg = {
+            vinyl_memory = 4 * 1024 * 1024,
+            vinyl_write_latency_target = 0.1,
+        },
+    }
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg{vinyl_write_latency_target = 0.1}
+        for _, name in ipairs({'hot', 'cold'}) do
+            if box.space[name] ~= nil then
+                box.space[name]:drop()
+            end
+        end
+    end)
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'vinyl_write_latency_target': " ..
+            "must be greater than or equal to 0",
+            box.cfg, {vinyl_write_latency_target = -1})
+        t.assert_equals(box.cfg.vinyl_write_latency_target, 0.1)
+        local stat = box.stat.vinyl().regulator
+        t.assert_equals(stat.write_latency_target, 0.1)
+        t.assert_type(stat.write_latency, 'number')
+        t.assert_type(stat.predicted_stall, 'number')
+        t.assert_type(stat.throttle_count, 'number')
+        t.assert_type(stat.partial_dumps, 'number')
+        t.assert_type(stat.carried_over_trees, 'number')
+        t.assert_type(stat.carried_over_bytes, 'number')
+    end)
+end
+
+--
+-- Check that dumps triggered by a hot space don't write cold spaces
+-- to disk unless the write latency target is disabled or a checkpoint
+-- is made, and that the data carried over to the next generation is
+-- recovered after restart.
+--
+g.test_partial_dump = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local cold = box.schema.space.create('cold', {engine = 'vinyl'})
+        cold:create_index('pk')
+        cold:create_index('sk', {parts = {2, 'unsigned'}})
+        local hot = box.schema.space.create('hot', {engine = 'vinyl'})
+        hot:create_index('pk')
+        box.snapshot()
+        for i = 1, 10 do
+            cold:replace({i, i * 10})
+        end
+        local stat = box.stat.vinyl().regulator
+        local carried_over = stat.carried_over_trees
+        local partial_dumps = stat.partial_dumps
+        local padding = string.rep('x', 1000)
+        local i = 0
+        t.helpers.retrying({timeout = 60}, function()
+            for _ = 1, 100 do
+                i = i + 1
+                hot:replace({i, padding})
+            end
+            fiber.yield()
+            t.assert_ge(hot.index.pk:stat().disk.dump.count, 2)
+        end)
+        stat = box.stat.vinyl().regulator
+        t.assert_gt(stat.partial_dumps, partial_dumps)
+        t.assert_ge(stat.carried_over_trees, carried_over + 2)
+        t.assert_gt(stat.carried_over_bytes, 0)
+        t.assert_equals(cold.index.pk:stat().disk.dump.count, 0)
+        t.assert_equals(cold.index.sk:stat().disk.dump.count, 0)
+        t.assert_equals(cold.index.pk:stat().memory.rows, 10)
+        t.assert_equals(cold:select(), cold.index.sk:select())
+        t.assert_equals(#cold:select(), 10)
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local cold = box.space.cold
+        t.assert_equals(#cold:select(), 10)
+        t.assert_equals(cold:select(), cold.index.sk:select())
+        box.snapshot()
+        t.assert_equals(cold.index.pk:stat().disk.dump.count, 1)
+        t.assert_equals(cold.index.sk:stat().disk.dump.count, 1)
+    end)
+end
+
+g.test_full_dump = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.cfg{vinyl_write_latency_target = 0}
+        local cold = box.schema.space.create('cold', {engine = 'vinyl'})
+        cold:create_index('pk')
+        local hot = box.schema.space.create('hot', {engine = 'vinyl'})
+        hot:create_index('pk')
+        cold:replace({1})
+        local carried_over = box.stat.vinyl().regulator.carried_over_trees
+        local padding = string.rep('x', 1000)
+        local i = 0
+        t.helpers.retrying({timeout = 60}, function()
+            for _ = 1, 100 do
+                i = i + 1
+                hot:replace({i, padding})
+            end
+            fiber.yield()
+            t.assert_ge(hot.index.pk:stat().disk.dump.count, 1)
+            t.assert_equals(cold.index.pk:stat().disk.dump.count, 1)
+        end)
+        t.assert_equals(box.stat.vinyl().regulator.carried_over_trees,
+                        carried_over)
+    end)
+end
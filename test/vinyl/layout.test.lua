@@ -49,6 +49,8 @@ for i, path in pairs(files) do
             if row.BODY.bloom_filter ~= nil then
                 row.BODY.bloom_filter = '<bloom_filter>'
             end
+            -- Dump time is volatile, drop it.
+            row.BODY.dump_time = nil
             rows[i] = row
             i = i + 1
         end